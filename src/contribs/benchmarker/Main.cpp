@@ -6,6 +6,10 @@
 ------------------------------------------------------------------------------*/
 #include "stdafx.h"
 #include "TestCLString.h"
+#include "TestFSIndexInput.h"
+#include "TestParallelMultiSearcher.h"
+#include "TestTermDocFreq.h"
+#include "TestTermQueries.h"
 
 #ifdef COMPILER_MSVC
 #ifdef _DEBUG
@@ -44,6 +48,10 @@ int main( int argc, char** argv ){
 
 	Benchmarker bench;
 	TestCLString clstring;
+	TestFSIndexInput fsindexinput;
+	TestParallelMultiSearcher parallelmultisearcher;
+	TestTermDocFreq termdocfreq;
+	TestTermQueries termqueries;
 	bool ret_result = false;
 
 	cl_tempDir = NULL;
@@ -92,6 +100,10 @@ int main( int argc, char** argv ){
 
 
 	bench.Add(&clstring);
+	bench.Add(&fsindexinput);
+	bench.Add(&parallelmultisearcher);
+	bench.Add(&termdocfreq);
+	bench.Add(&termqueries);
 	ret_result = bench.run();
 
 
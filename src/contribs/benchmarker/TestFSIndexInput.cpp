@@ -0,0 +1,93 @@
+/*------------------------------------------------------------------------------
+* Copyright (C) 2003-2006 Ben van Klinken and the CLucene Team
+*
+* Distributable under the terms of either the Apache License (Version 2.0) or
+* the GNU Lesser General Public License, as specified in the COPYING file.
+------------------------------------------------------------------------------*/
+#include "stdafx.h"
+#include "TestFSIndexInput.h"
+#include "CLucene/store/FSDirectory.h"
+
+using namespace lucene::util;
+using namespace lucene::store;
+
+#define FSINDEXINPUT_FILE_INTS (2*1024*1024)
+#define FSINDEXINPUT_TOTAL_READS 400000
+#define FSINDEXINPUT_MAX_THREADS 32
+
+struct FSIndexInputReader{
+	IndexInput* input;
+	int32_t reads;
+	uint32_t seed;
+	bool ok;
+};
+
+_LUCENE_THREAD_FUNC(fsIndexInputReadThread, _arg){
+	FSIndexInputReader* r = (FSIndexInputReader*)_arg;
+	uint8_t buf[64];
+	try{
+		for ( int32_t i=0;i<r->reads;i++ ){
+			//small linear congruential generator, rand() is not thread safe
+			r->seed = r->seed * 1103515245 + 12345;
+			int64_t pos = (int64_t)((r->seed >> 8) % (FSINDEXINPUT_FILE_INTS - 16)) * 4;
+			r->input->seek(pos);
+			r->input->readBytes(buf, sizeof(buf));
+		}
+	}catch(CLuceneError&){
+		r->ok = false;
+	}
+	_LUCENE_THREAD_FUNC_RETURN(0);
+}
+
+static int benchmarkConcurrentReads(Timer* timerCase, bool positional, int32_t threads){
+	char path[CL_MAX_PATH];
+	_snprintf(path, CL_MAX_PATH, "%s/%s", cl_tempDir, "fsindexinput.bench");
+	FSDirectory* dir = FSDirectory::getDirectory(path);
+
+	if ( !dir->fileExists("bench.dat") ){
+		IndexOutput* out = dir->createOutput("bench.dat");
+		for ( int32_t i=0;i<FSINDEXINPUT_FILE_INTS;i++ )
+			out->writeInt(i);
+		out->close();
+		_CLDELETE(out);
+	}
+
+	dir->setUsePositionalRead(positional);
+	IndexInput* input = ((Directory*)dir)->openInput("bench.dat");
+
+	FSIndexInputReader readers[FSINDEXINPUT_MAX_THREADS];
+	_LUCENE_THREADID_TYPE ids[FSINDEXINPUT_MAX_THREADS];
+	for ( int32_t i=0;i<threads;i++ ){
+		readers[i].input = input->clone();
+		readers[i].reads = FSINDEXINPUT_TOTAL_READS / threads;
+		readers[i].seed = 1251971 + i;
+		readers[i].ok = true;
+	}
+
+	timerCase->start();
+	for ( int32_t i=0;i<threads;i++ )
+		ids[i] = _LUCENE_THREAD_CREATE(&fsIndexInputReadThread, &readers[i]);
+	for ( int32_t i=0;i<threads;i++ )
+		_LUCENE_THREAD_JOIN(ids[i]);
+	timerCase->stop();
+
+	int ret = 0;
+	for ( int32_t i=0;i<threads;i++ ){
+		if ( !readers[i].ok )
+			ret = 1;
+		readers[i].input->close();
+		_CLDELETE(readers[i].input);
+	}
+	input->close();
+	_CLDELETE(input);
+	dir->close();
+	_CLDECDELETE(dir);
+	return ret;
+}
+
+int BenchmarkSharedRead1(Timer* timerCase){ return benchmarkConcurrentReads(timerCase, false, 1); }
+int BenchmarkSharedRead8(Timer* timerCase){ return benchmarkConcurrentReads(timerCase, false, 8); }
+int BenchmarkSharedRead32(Timer* timerCase){ return benchmarkConcurrentReads(timerCase, false, 32); }
+int BenchmarkPositionalRead1(Timer* timerCase){ return benchmarkConcurrentReads(timerCase, true, 1); }
+int BenchmarkPositionalRead8(Timer* timerCase){ return benchmarkConcurrentReads(timerCase, true, 8); }
+int BenchmarkPositionalRead32(Timer* timerCase){ return benchmarkConcurrentReads(timerCase, true, 32); }
@@ -0,0 +1,37 @@
+/*------------------------------------------------------------------------------
+* Copyright (C) 2003-2006 Ben van Klinken and the CLucene Team
+*
+* Distributable under the terms of either the Apache License (Version 2.0) or
+* the GNU Lesser General Public License, as specified in the COPYING file.
+------------------------------------------------------------------------------*/
+#pragma once
+
+int BenchmarkSharedRead1(Timer*);
+int BenchmarkSharedRead8(Timer*);
+int BenchmarkSharedRead32(Timer*);
+int BenchmarkPositionalRead1(Timer*);
+int BenchmarkPositionalRead8(Timer*);
+int BenchmarkPositionalRead32(Timer*);
+
+/**
+* Random reads on clones of one FSIndexInput from several threads, once
+* through the locked shared file handle and once with positional reads.
+* Every case does the same total number of reads, so the times show how
+* each mode scales with the number of threads.
+*/
+class TestFSIndexInput:public Unit
+{
+protected:
+	void runTests(){
+		this->runTest("BenchmarkSharedRead1",BenchmarkSharedRead1,5);
+		this->runTest("BenchmarkSharedRead8",BenchmarkSharedRead8,5);
+		this->runTest("BenchmarkSharedRead32",BenchmarkSharedRead32,5);
+		this->runTest("BenchmarkPositionalRead1",BenchmarkPositionalRead1,5);
+		this->runTest("BenchmarkPositionalRead8",BenchmarkPositionalRead8,5);
+		this->runTest("BenchmarkPositionalRead32",BenchmarkPositionalRead32,5);
+	}
+public:
+	const char* getName(){
+		return "TestFSIndexInput";
+	}
+};
@@ -0,0 +1,108 @@
+/*------------------------------------------------------------------------------
+* Copyright (C) 2003-2006 Ben van Klinken and the CLucene Team
+*
+* Distributable under the terms of either the Apache License (Version 2.0) or
+* the GNU Lesser General Public License, as specified in the COPYING file.
+------------------------------------------------------------------------------*/
+#include "stdafx.h"
+#include "TestParallelMultiSearcher.h"
+#include "CLucene/util/StringBuffer.h"
+
+using namespace lucene::util;
+using namespace lucene::store;
+using namespace lucene::index;
+using namespace lucene::document;
+using namespace lucene::search;
+using namespace lucene::analysis;
+
+#define PARALLELSEARCH_SHARDS 4
+#define PARALLELSEARCH_DOCS 20000
+#define PARALLELSEARCH_WORDS 20
+#define PARALLELSEARCH_QUERIES 200
+
+static const TCHAR* parallelSearchWords[] = {
+	_T("alpha"), _T("bravo"), _T("charlie"), _T("delta"), _T("echo"), _T("foxtrot"),
+	_T("golf"), _T("hotel"), _T("india"), _T("juliet"), _T("kilo"), _T("lima"),
+	_T("mike"), _T("november"), _T("oscar"), _T("papa"), NULL
+};
+
+static RAMDirectory* parallelSearchShards[PARALLELSEARCH_SHARDS];
+
+//the shards are built once and shared by all the cases
+static void buildParallelSearchShards(){
+	if ( parallelSearchShards[0] != NULL )
+		return;
+	WhitespaceAnalyzer analyzer;
+	uint32_t seed = 1251971;
+	StringBuffer text;
+	StringBuffer num;
+	for ( int32_t s=0;s<PARALLELSEARCH_SHARDS;s++ ){
+		parallelSearchShards[s] = _CLNEW RAMDirectory();
+		IndexWriter writer(parallelSearchShards[s], &analyzer, true);
+		for ( int32_t d=0;d<PARALLELSEARCH_DOCS;d++ ){
+			text.clear();
+			for ( int32_t w=0;w<PARALLELSEARCH_WORDS;w++ ){
+				seed = seed * 1103515245 + 12345;
+				//skewed towards the first words, so term frequencies vary
+				int32_t word = (int32_t)((seed >> 8) % 16);
+				word = (word * word) / 16;
+				text.append(parallelSearchWords[word]);
+				text.appendChar(' ');
+			}
+			Document doc;
+			doc.add(*_CLNEW Field(_T("contents"), text.getBuffer(), Field::STORE_NO | Field::INDEX_TOKENIZED));
+			num.clear();
+			num.appendInt(seed % 100000);
+			doc.add(*_CLNEW Field(_T("num"), num.getBuffer(), Field::STORE_NO | Field::INDEX_UNTOKENIZED));
+			writer.addDocument(&doc);
+		}
+		writer.close();
+	}
+}
+
+static int benchmarkSearch(Timer* timerCase, bool parallel, bool sorted){
+	buildParallelSearchShards();
+
+	Searchable* searchables[PARALLELSEARCH_SHARDS+1];
+	for ( int32_t s=0;s<PARALLELSEARCH_SHARDS;s++ )
+		searchables[s] = _CLNEW IndexSearcher(parallelSearchShards[s]);
+	searchables[PARALLELSEARCH_SHARDS] = NULL;
+
+	MultiSearcher* searcher;
+	if ( parallel )
+		searcher = _CLNEW ParallelMultiSearcher(searchables);
+	else
+		searcher = _CLNEW MultiSearcher(searchables);
+	Sort* sort = sorted ? _CLNEW Sort(_T("num")) : NULL;
+
+	int ret = 0;
+	timerCase->start();
+	for ( int32_t q=0;q<PARALLELSEARCH_QUERIES;q++ ){
+		BooleanQuery query;
+		Term* t1 = _CLNEW Term(_T("contents"), parallelSearchWords[q % 16]);
+		Term* t2 = _CLNEW Term(_T("contents"), parallelSearchWords[(q * 7) % 16]);
+		query.add(_CLNEW TermQuery(t1), true, BooleanClause::SHOULD);
+		query.add(_CLNEW TermQuery(t2), true, BooleanClause::SHOULD);
+		_CLDECDELETE(t1);
+		_CLDECDELETE(t2);
+
+		//the hits fetch the first 50 documents
+		Hits* hits = sort == NULL ? searcher->search(&query) : searcher->search(&query, sort);
+		if ( hits->length() == 0 )
+			ret = 1;
+		_CLDELETE(hits);
+	}
+	timerCase->stop();
+
+	_CLDELETE(sort);
+	searcher->close();
+	_CLDELETE(searcher);
+	for ( int32_t s=0;s<PARALLELSEARCH_SHARDS;s++ )
+		_CLDELETE(searchables[s]);
+	return ret;
+}
+
+int BenchmarkMultiSearcher(Timer* timerCase){ return benchmarkSearch(timerCase, false, false); }
+int BenchmarkParallelMultiSearcher(Timer* timerCase){ return benchmarkSearch(timerCase, true, false); }
+int BenchmarkMultiSearcherSorted(Timer* timerCase){ return benchmarkSearch(timerCase, false, true); }
+int BenchmarkParallelMultiSearcherSorted(Timer* timerCase){ return benchmarkSearch(timerCase, true, true); }
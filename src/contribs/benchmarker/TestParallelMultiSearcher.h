@@ -0,0 +1,32 @@
+/*------------------------------------------------------------------------------
+* Copyright (C) 2003-2006 Ben van Klinken and the CLucene Team
+*
+* Distributable under the terms of either the Apache License (Version 2.0) or
+* the GNU Lesser General Public License, as specified in the COPYING file.
+------------------------------------------------------------------------------*/
+#pragma once
+
+int BenchmarkMultiSearcher(Timer*);
+int BenchmarkParallelMultiSearcher(Timer*);
+int BenchmarkMultiSearcherSorted(Timer*);
+int BenchmarkParallelMultiSearcherSorted(Timer*);
+
+/**
+* Runs the same queries over several RAMDirectory shards, once with a
+* MultiSearcher and once with a ParallelMultiSearcher, both by relevance
+* and sorted by a field.
+*/
+class TestParallelMultiSearcher:public Unit
+{
+protected:
+	void runTests(){
+		this->runTest("BenchmarkMultiSearcher",BenchmarkMultiSearcher,5);
+		this->runTest("BenchmarkParallelMultiSearcher",BenchmarkParallelMultiSearcher,5);
+		this->runTest("BenchmarkMultiSearcherSorted",BenchmarkMultiSearcherSorted,5);
+		this->runTest("BenchmarkParallelMultiSearcherSorted",BenchmarkParallelMultiSearcherSorted,5);
+	}
+public:
+	const char* getName(){
+		return "TestParallelMultiSearcher";
+	}
+};
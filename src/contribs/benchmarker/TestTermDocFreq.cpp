@@ -0,0 +1,100 @@
+/*------------------------------------------------------------------------------
+* Copyright (C) 2003-2006 Ben van Klinken and the CLucene Team
+*
+* Distributable under the terms of either the Apache License (Version 2.0) or
+* the GNU Lesser General Public License, as specified in the COPYING file.
+------------------------------------------------------------------------------*/
+#include "stdafx.h"
+#include "TestTermDocFreq.h"
+#include "CLucene/util/StringBuffer.h"
+
+using namespace lucene::util;
+using namespace lucene::store;
+using namespace lucene::index;
+using namespace lucene::document;
+using namespace lucene::analysis;
+
+#define DOCFREQ_DOCS 20000
+#define DOCFREQ_TOTAL_LOOKUPS 400000
+#define DOCFREQ_MAX_THREADS 32
+
+static RAMDirectory* docFreqDirectory = NULL;
+
+//the index is built once and shared by all the cases
+static void buildDocFreqIndex(){
+	if ( docFreqDirectory != NULL )
+		return;
+	docFreqDirectory = _CLNEW RAMDirectory();
+	WhitespaceAnalyzer analyzer;
+	IndexWriter writer(docFreqDirectory, &analyzer, true);
+	StringBuffer id;
+	for ( int32_t d=0;d<DOCFREQ_DOCS;d++ ){
+		id.clear();
+		id.appendInt(d);
+		Document doc;
+		doc.add(*_CLNEW Field(_T("id"), id.getBuffer(), Field::STORE_NO | Field::INDEX_UNTOKENIZED));
+		writer.addDocument(&doc);
+	}
+	writer.optimize();
+	writer.close();
+}
+
+struct DocFreqLookups{
+	IndexReader* reader;
+	int32_t lookups;
+	uint32_t seed;
+	bool ok;
+};
+
+_LUCENE_THREAD_FUNC(docFreqThread, _arg){
+	DocFreqLookups* l = (DocFreqLookups*)_arg;
+	StringBuffer id;
+	try{
+		for ( int32_t i=0;i<l->lookups;i++ ){
+			//small linear congruential generator, rand() is not thread safe
+			l->seed = l->seed * 1103515245 + 12345;
+			id.clear();
+			id.appendInt((l->seed >> 8) % DOCFREQ_DOCS);
+			Term term(_T("id"), id.getBuffer());
+			if ( l->reader->docFreq(&term) != 1 )
+				l->ok = false;
+		}
+	}catch(CLuceneError&){
+		l->ok = false;
+	}
+	_LUCENE_THREAD_FUNC_RETURN(0);
+}
+
+static int benchmarkDocFreq(Timer* timerCase, int32_t threads){
+	buildDocFreqIndex();
+	IndexReader* reader = IndexReader::open(docFreqDirectory);
+
+	DocFreqLookups lookups[DOCFREQ_MAX_THREADS];
+	_LUCENE_THREADID_TYPE ids[DOCFREQ_MAX_THREADS];
+	for ( int32_t i=0;i<threads;i++ ){
+		lookups[i].reader = reader;
+		lookups[i].lookups = DOCFREQ_TOTAL_LOOKUPS / threads;
+		lookups[i].seed = 1251971 + i;
+		lookups[i].ok = true;
+	}
+
+	timerCase->start();
+	for ( int32_t i=0;i<threads;i++ )
+		ids[i] = _LUCENE_THREAD_CREATE(&docFreqThread, &lookups[i]);
+	for ( int32_t i=0;i<threads;i++ )
+		_LUCENE_THREAD_JOIN(ids[i]);
+	timerCase->stop();
+
+	int ret = 0;
+	for ( int32_t i=0;i<threads;i++ ){
+		if ( !lookups[i].ok )
+			ret = 1;
+	}
+	reader->close();
+	_CLDELETE(reader);
+	return ret;
+}
+
+int BenchmarkDocFreq1(Timer* timerCase){ return benchmarkDocFreq(timerCase, 1); }
+int BenchmarkDocFreq8(Timer* timerCase){ return benchmarkDocFreq(timerCase, 8); }
+int BenchmarkDocFreq32(Timer* timerCase){ return benchmarkDocFreq(timerCase, 32); }
@@ -0,0 +1,32 @@
+/*------------------------------------------------------------------------------
+* Copyright (C) 2003-2006 Ben van Klinken and the CLucene Team
+*
+* Distributable under the terms of either the Apache License (Version 2.0) or
+* the GNU Lesser General Public License, as specified in the COPYING file.
+------------------------------------------------------------------------------*/
+#pragma once
+
+int BenchmarkDocFreq1(Timer*);
+int BenchmarkDocFreq8(Timer*);
+int BenchmarkDocFreq32(Timer*);
+
+/**
+* Looks up the document frequency of random terms in one shared reader
+* from several threads. Every lookup fetches the calling thread's term
+* enumeration from a ThreadLocal, so the times show what that costs
+* as the number of threads grows. Every case does the same total number
+* of lookups.
+*/
+class TestTermDocFreq:public Unit
+{
+protected:
+	void runTests(){
+		this->runTest("BenchmarkDocFreq1",BenchmarkDocFreq1,5);
+		this->runTest("BenchmarkDocFreq8",BenchmarkDocFreq8,5);
+		this->runTest("BenchmarkDocFreq32",BenchmarkDocFreq32,5);
+	}
+public:
+	const char* getName(){
+		return "TestTermDocFreq";
+	}
+};
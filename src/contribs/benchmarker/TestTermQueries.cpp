@@ -0,0 +1,130 @@
+/*------------------------------------------------------------------------------
+* Copyright (C) 2003-2006 Ben van Klinken and the CLucene Team
+*
+* Distributable under the terms of either the Apache License (Version 2.0) or
+* the GNU Lesser General Public License, as specified in the COPYING file.
+------------------------------------------------------------------------------*/
+#include "stdafx.h"
+#include "TestTermQueries.h"
+#include "CLucene/util/StringBuffer.h"
+
+using namespace lucene::util;
+using namespace lucene::store;
+using namespace lucene::index;
+using namespace lucene::document;
+using namespace lucene::search;
+using namespace lucene::analysis;
+
+#define TERMQUERIES_DOCS 20000
+#define TERMQUERIES_WORDS 10
+#define TERMQUERIES_VOCABULARY 2000
+#define TERMQUERIES_TOTAL_QUERIES 3200
+#define TERMQUERIES_MAX_THREADS 32
+
+static RAMDirectory* termQueriesDirectory = NULL;
+
+//the index is built once and shared by all the cases
+static void buildTermQueriesIndex(){
+	if ( termQueriesDirectory != NULL )
+		return;
+	termQueriesDirectory = _CLNEW RAMDirectory();
+	WhitespaceAnalyzer analyzer;
+	IndexWriter writer(termQueriesDirectory, &analyzer, true);
+	uint32_t seed = 1251971;
+	StringBuffer text;
+	for ( int32_t d=0;d<TERMQUERIES_DOCS;d++ ){
+		text.clear();
+		for ( int32_t w=0;w<TERMQUERIES_WORDS;w++ ){
+			seed = seed * 1103515245 + 12345;
+			text.appendChar('w');
+			text.appendInt((seed >> 8) % TERMQUERIES_VOCABULARY);
+			text.appendChar(' ');
+		}
+		Document doc;
+		doc.add(*_CLNEW Field(_T("contents"), text.getBuffer(), Field::STORE_NO | Field::INDEX_TOKENIZED));
+		writer.addDocument(&doc);
+	}
+	writer.optimize();
+	writer.close();
+}
+
+struct TermQueriesRun{
+	Searcher* searcher;
+	int32_t queries;
+	uint32_t seed;
+	bool ok;
+};
+
+_LUCENE_THREAD_FUNC(termQueriesThread, _arg){
+	TermQueriesRun* r = (TermQueriesRun*)_arg;
+	StringBuffer word;
+	try{
+		for ( int32_t q=0;q<r->queries;q++ ){
+			Query* query;
+			if ( q % 4 == 3 ){
+				//a prefix such as w12 matches about a hundred terms
+				r->seed = r->seed * 1103515245 + 12345;
+				word.clear();
+				word.appendChar('w');
+				word.appendInt(10 + (r->seed >> 8) % 90);
+				Term* t = _CLNEW Term(_T("contents"), word.getBuffer());
+				query = _CLNEW PrefixQuery(t);
+				_CLDECDELETE(t);
+			}else{
+				BooleanQuery* bq = _CLNEW BooleanQuery();
+				for ( int32_t c=0;c<4;c++ ){
+					r->seed = r->seed * 1103515245 + 12345;
+					word.clear();
+					word.appendChar('w');
+					word.appendInt((r->seed >> 8) % TERMQUERIES_VOCABULARY);
+					Term* t = _CLNEW Term(_T("contents"), word.getBuffer());
+					bq->add(_CLNEW TermQuery(t), true, BooleanClause::SHOULD);
+					_CLDECDELETE(t);
+				}
+				query = bq;
+			}
+
+			Hits* hits = r->searcher->search(query);
+			if ( hits->length() == 0 )
+				r->ok = false;
+			_CLDELETE(hits);
+			_CLDELETE(query);
+		}
+	}catch(CLuceneError&){
+		r->ok = false;
+	}
+	_LUCENE_THREAD_FUNC_RETURN(0);
+}
+
+static int benchmarkTermQueries(Timer* timerCase, int32_t threads){
+	buildTermQueriesIndex();
+	IndexSearcher searcher(termQueriesDirectory);
+
+	TermQueriesRun runs[TERMQUERIES_MAX_THREADS];
+	_LUCENE_THREADID_TYPE ids[TERMQUERIES_MAX_THREADS];
+	for ( int32_t i=0;i<threads;i++ ){
+		runs[i].searcher = &searcher;
+		runs[i].queries = TERMQUERIES_TOTAL_QUERIES / threads;
+		runs[i].seed = 1251971 + i;
+		runs[i].ok = true;
+	}
+
+	timerCase->start();
+	for ( int32_t i=0;i<threads;i++ )
+		ids[i] = _LUCENE_THREAD_CREATE(&termQueriesThread, &runs[i]);
+	for ( int32_t i=0;i<threads;i++ )
+		_LUCENE_THREAD_JOIN(ids[i]);
+	timerCase->stop();
+
+	int ret = 0;
+	for ( int32_t i=0;i<threads;i++ ){
+		if ( !runs[i].ok )
+			ret = 1;
+	}
+	searcher.close();
+	return ret;
+}
+
+int BenchmarkTermQueries1(Timer* timerCase){ return benchmarkTermQueries(timerCase, 1); }
+int BenchmarkTermQueries8(Timer* timerCase){ return benchmarkTermQueries(timerCase, 8); }
+int BenchmarkTermQueries32(Timer* timerCase){ return benchmarkTermQueries(timerCase, 32); }
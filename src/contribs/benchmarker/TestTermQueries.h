@@ -0,0 +1,32 @@
+/*------------------------------------------------------------------------------
+* Copyright (C) 2003-2006 Ben van Klinken and the CLucene Team
+*
+* Distributable under the terms of either the Apache License (Version 2.0) or
+* the GNU Lesser General Public License, as specified in the COPYING file.
+------------------------------------------------------------------------------*/
+#pragma once
+
+int BenchmarkTermQueries1(Timer*);
+int BenchmarkTermQueries8(Timer*);
+int BenchmarkTermQueries32(Timer*);
+
+/**
+* Runs boolean term queries and prefix queries against one shared searcher
+* from several threads. These create, copy and release many Terms, whose
+* reference counts are shared between the threads, so the times show what
+* the reference counting costs as the number of threads grows. Every case
+* runs the same total number of queries.
+*/
+class TestTermQueries:public Unit
+{
+protected:
+	void runTests(){
+		this->runTest("BenchmarkTermQueries1",BenchmarkTermQueries1,5);
+		this->runTest("BenchmarkTermQueries8",BenchmarkTermQueries8,5);
+		this->runTest("BenchmarkTermQueries32",BenchmarkTermQueries32,5);
+	}
+public:
+	const char* getName(){
+		return "TestTermQueries";
+	}
+};
@@ -13,14 +13,17 @@
 #include "CLucene/index/IndexWriter.h"
 #include "CLucene/index/MultiReader.h"
 #include "CLucene/index/Term.h"
+#include "CLucene/index/DocValues.h"
 #include "CLucene/search/IndexSearcher.h"
 #include "CLucene/search/MultiSearcher.h"
+#include "CLucene/search/ParallelMultiSearcher.h"
 #include "CLucene/search/DateFilter.h"
 #include "CLucene/search/WildcardQuery.h"
 #include "CLucene/search/FuzzyQuery.h"
 #include "CLucene/search/PhraseQuery.h"
 #include "CLucene/search/PrefixQuery.h"
 #include "CLucene/search/RangeQuery.h"
+#include "CLucene/search/NumericRangeQuery.h"
 #include "CLucene/search/BooleanQuery.h"
 #include "CLucene/search/TermQuery.h"
 #include "CLucene/search/SearchHeader.h"
@@ -33,8 +36,10 @@
 #include "CLucene/document/DateField.h"
 #include "CLucene/document/DateTools.h"
 #include "CLucene/document/NumberTools.h"
+#include "CLucene/document/NumericField.h"
 #include "CLucene/store/Directory.h"
 #include "CLucene/store/FSDirectory.h"
+#include "CLucene/store/MMapDirectory.h"
 #include "CLucene/store/RAMDirectory.h"
 #include "CLucene/queryParser/QueryParser.h"
 #include "CLucene/analysis/standard/StandardAnalyzer.h"
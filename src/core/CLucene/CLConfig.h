@@ -41,8 +41,9 @@
 //   Your application
 ////////////////////////////////////////////////////////////////////
 //
-//define this to enable mmap support in the fsdirectory IndexInput
-//EXPERIMENTAL
+//define this to make FSDirectory read files through mmap by default.
+//This can also be changed per directory with FSDirectory::setUseMMap,
+//or use MMapDirectory for chunked mappings with access pattern hints.
 //#define LUCENE_FS_MMAP
 //
 //define to true to actually use it (not just enable it)
@@ -52,6 +53,13 @@
 	#define LUCENE_USE_MMAP false
 #endif
 //
+//define to true to make FSDirectory read with positional reads (pread) by default.
+//Each clone of an FSIndexInput then keeps its own file position and reads
+//without taking the lock on the shared file handle. Can also be changed
+//per directory with FSDirectory::setUsePositionalRead. Ignored on platforms
+//without pread.
+#define LUCENE_USE_POSITIONAL_READ false
+//
 //LOCK_DIR implementation:
 //define this to set an exact directory for the lock dir (not recommended)
 //all other methods of getting the temporary directory will be ignored
@@ -14,6 +14,7 @@
 #include "CLucene/debug/error.cpp"
 #include "CLucene/analysis/Analyzers.cpp"
 #include "CLucene/analysis/AnalysisHeader.cpp"
+#include "CLucene/analysis/NumericTokenStream.cpp"
 #include "CLucene/analysis/standard/StandardAnalyzer.cpp"
 #include "CLucene/analysis/standard/StandardFilter.cpp"
 #include "CLucene/analysis/standard/StandardTokenizer.cpp"
@@ -22,11 +23,13 @@
 #include "CLucene/document/Document.cpp"
 #include "CLucene/document/FieldSelector.cpp"
 #include "CLucene/document/NumberTools.cpp"
+#include "CLucene/document/NumericField.cpp"
 #include "CLucene/document/Field.cpp"
 #include "CLucene/index/CompoundFile.cpp"
 #include "CLucene/index/DirectoryIndexReader.cpp"
 #include "CLucene/index/DocumentsWriter.cpp"
 #include "CLucene/index/DocumentsWriterThreadState.cpp"
+#include "CLucene/index/DocValues.cpp"
 #include "CLucene/index/FieldInfos.cpp"
 #include "CLucene/index/FieldsReader.cpp"
 #include "CLucene/index/FieldsWriter.cpp"
@@ -58,6 +61,7 @@
 #include "CLucene/index/Terms.cpp"
 #include "CLucene/index/TermInfo.cpp"
 #include "CLucene/index/TermInfosReader.cpp"
+#include "CLucene/index/TermInfosIndex.cpp"
 #include "CLucene/index/TermInfosWriter.cpp"
 #include "CLucene/index/TermVectorReader.cpp"
 #include "CLucene/index/TermVectorWriter.cpp"
@@ -76,12 +80,14 @@
 #include "CLucene/search/DateFilter.cpp"
 #include "CLucene/search/ConjunctionScorer.cpp"
 #include "CLucene/search/DisjunctionSumScorer.cpp"
+#include "CLucene/search/WANDScorer.cpp"
 #include "CLucene/search/ExactPhraseScorer.cpp"
 #include "CLucene/search/Explanation.cpp"
 #include "CLucene/search/FieldCache.cpp"
 #include "CLucene/search/FieldCacheImpl.cpp"
 #include "CLucene/search/FieldDocSortedHitQueue.cpp"
 #include "CLucene/search/FieldSortedHitQueue.cpp"
+#include "CLucene/search/Filter.cpp"
 #include "CLucene/search/FilteredTermEnum.cpp"
 #include "CLucene/search/FuzzyQuery.cpp"
 #include "CLucene/search/Hits.cpp"
@@ -89,6 +95,7 @@
 #include "CLucene/search/IndexSearcher.cpp"
 #include "CLucene/search/MatchAllDocsQuery.cpp"
 #include "CLucene/search/MultiSearcher.cpp"
+#include "CLucene/search/ParallelMultiSearcher.cpp"
 #include "CLucene/search/MultiTermQuery.cpp"
 #include "CLucene/search/MultiPhraseQuery.cpp"
 #include "CLucene/search/PhrasePositions.cpp"
@@ -98,6 +105,8 @@
 #include "CLucene/search/QueryFilter.cpp"
 #include "CLucene/search/RangeQuery.cpp"
 #include "CLucene/search/RangeFilter.cpp"
+#include "CLucene/search/NumericRangeFilter.cpp"
+#include "CLucene/search/NumericRangeQuery.cpp"
 #include "CLucene/search/SearchHeader.cpp"
 #include "CLucene/search/Similarity.cpp"
 #include "CLucene/search/SloppyPhraseScorer.cpp"
@@ -105,6 +114,7 @@
 #include "CLucene/search/ScorerDocQueue.cpp"
 #include "CLucene/search/Sort.cpp"
 #include "CLucene/search/TermQuery.cpp"
+#include "CLucene/search/TermAutomaton.cpp"
 #include "CLucene/search/TermScorer.cpp"
 #include "CLucene/search/WildcardQuery.cpp"
 #include "CLucene/search/WildcardTermEnum.cpp"
@@ -113,15 +123,21 @@
 #include "CLucene/store/Lock.cpp"
 #include "CLucene/store/LockFactory.cpp"
 #include "CLucene/store/MMapInput.cpp"
+#include "CLucene/store/MMapDirectory.cpp"
+#include "CLucene/store/RateLimiter.cpp"
 #include "CLucene/store/IndexOutput.cpp"
 #include "CLucene/store/Directory.cpp"
 #include "CLucene/store/RAMDirectory.cpp"
 #include "CLucene/util/BitSet.cpp"
+#include "CLucene/util/SortedVIntList.cpp"
 #include "CLucene/util/Equators.cpp"
 #include "CLucene/util/FastCharStream.cpp"
+#include "CLucene/util/FastCompress.cpp"
 #include "CLucene/util/MD5Digester.cpp"
+#include "CLucene/util/NumericUtils.cpp"
 #include "CLucene/util/Reader.cpp"
 #include "CLucene/util/StringIntern.cpp"
 #include "CLucene/util/ThreadLocal.cpp"
+#include "CLucene/util/ThreadPool.cpp"
 
 #include "CLucene/CLSharedMonolithic.cpp"
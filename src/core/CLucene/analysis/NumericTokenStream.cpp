@@ -0,0 +1,73 @@
+/*------------------------------------------------------------------------------
+* Copyright (C) 2003-2006 Ben van Klinken and the CLucene Team
+*
+* Distributable under the terms of either the Apache License (Version 2.0) or
+* the GNU Lesser General Public License, as specified in the COPYING file.
+------------------------------------------------------------------------------*/
+#include "CLucene/_ApiHeader.h"
+#include "NumericTokenStream.h"
+
+CL_NS_DEF(analysis)
+CL_NS_USE(util)
+
+const TCHAR* NumericTokenStream::TOKEN_TYPE_FULL_PREC = _T("fullPrecNumeric");
+const TCHAR* NumericTokenStream::TOKEN_TYPE_LOWER_PREC = _T("lowerPrecNumeric");
+
+NumericTokenStream::NumericTokenStream(const int32_t _precisionStep):
+	shift(0), valSize(0), precisionStep(_precisionStep), value(0)
+{
+	if ( precisionStep < 1 )
+		_CLTHROWA(CL_ERR_IllegalArgument, "precisionStep must be >=1");
+}
+NumericTokenStream::~NumericTokenStream(){
+}
+
+NumericTokenStream* NumericTokenStream::setInt64Value(const int64_t _value){
+	value = _value;
+	valSize = 64;
+	shift = 0;
+	return this;
+}
+NumericTokenStream* NumericTokenStream::setInt32Value(const int32_t _value){
+	value = _value;
+	valSize = 32;
+	shift = 0;
+	return this;
+}
+NumericTokenStream* NumericTokenStream::setDoubleValue(const double _value){
+	return setInt64Value(NumericUtils::doubleToSortableInt64(_value));
+}
+NumericTokenStream* NumericTokenStream::setFloatValue(const float _value){
+	return setInt32Value(NumericUtils::floatToSortableInt32(_value));
+}
+
+int32_t NumericTokenStream::getPrecisionStep() const{
+	return precisionStep;
+}
+
+Token* NumericTokenStream::next(Token* token){
+	if ( valSize == 0 )
+		_CLTHROWA(CL_ERR_IllegalState, "call one of the set*Value() methods before using NumericTokenStream");
+	if ( shift >= valSize )
+		return NULL;
+
+	TCHAR buffer[NumericUtils::BUF_SIZE_INT64];
+	if ( valSize == 64 )
+		NumericUtils::int64ToPrefixCoded(value, shift, buffer);
+	else
+		NumericUtils::int32ToPrefixCoded((int32_t)value, shift, buffer);
+	token->set(buffer, 0, 0, shift == 0 ? TOKEN_TYPE_FULL_PREC : TOKEN_TYPE_LOWER_PREC);
+	//all the precisions of a value are at the same position
+	token->setPositionIncrement(shift == 0 ? 1 : 0);
+	shift += precisionStep;
+	return token;
+}
+
+void NumericTokenStream::reset(){
+	shift = 0;
+}
+
+void NumericTokenStream::close(){
+}
+
+CL_NS_END
@@ -0,0 +1,64 @@
+/*------------------------------------------------------------------------------
+* Copyright (C) 2003-2006 Ben van Klinken and the CLucene Team
+*
+* Distributable under the terms of either the Apache License (Version 2.0) or
+* the GNU Lesser General Public License, as specified in the COPYING file.
+------------------------------------------------------------------------------*/
+#ifndef _lucene_analysis_NumericTokenStream_
+#define _lucene_analysis_NumericTokenStream_
+
+#include "CLucene/analysis/AnalysisHeader.h"
+#include "CLucene/util/NumericUtils.h"
+
+CL_NS_DEF(analysis)
+
+/**
+* A TokenStream which returns the terms of a single numeric value, one for
+* each precision of <code>precisionStep</code>, as described in
+* {@link lucene::util::NumericUtils}. It is normally used through
+* {@link lucene::document::NumericField}, but can also be given to any
+* field with Field::setValue(TokenStream*).
+*
+* <p>A value must be set with one of the set methods before the stream is
+* used. The stream can be reused by setting a new value, which also resets it.
+*/
+class CLUCENE_EXPORT NumericTokenStream : public TokenStream {
+private:
+	int32_t shift;
+	int32_t valSize;
+	int32_t precisionStep;
+	int64_t value;
+
+public:
+	/** The type of the full precision token */
+	static const TCHAR* TOKEN_TYPE_FULL_PREC;
+	/** The type of the lower precision tokens */
+	static const TCHAR* TOKEN_TYPE_LOWER_PREC;
+
+	/**
+	* Creates a stream with the given precisionStep. A value must be set
+	* before the stream is used.
+	* @throws CL_ERR_IllegalArgument if precisionStep is less than 1
+	*/
+	NumericTokenStream(const int32_t precisionStep = CL_NS(util)::NumericUtils::PRECISION_STEP_DEFAULT);
+	virtual ~NumericTokenStream();
+
+	/** Sets the stream to the terms of a 64 bit integer */
+	NumericTokenStream* setInt64Value(const int64_t value);
+	/** Sets the stream to the terms of a 32 bit integer */
+	NumericTokenStream* setInt32Value(const int32_t value);
+	/** Sets the stream to the terms of a double */
+	NumericTokenStream* setDoubleValue(const double value);
+	/** Sets the stream to the terms of a float */
+	NumericTokenStream* setFloatValue(const float value);
+
+	/** Returns the precision step of this stream */
+	int32_t getPrecisionStep() const;
+
+	Token* next(Token* token);
+	void reset();
+	void close();
+};
+
+CL_NS_END
+#endif
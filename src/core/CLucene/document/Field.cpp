@@ -15,7 +15,7 @@ CL_NS_USE(util)
 CL_NS_DEF(document)
 
 Field::Field(const TCHAR* Name, Reader* reader, int config):
-	lazy(false)
+	lazy(false), omitTf(false)
 {
 	CND_PRECONDITION(Name != NULL, "Name cannot be NULL");
 	CND_PRECONDITION(reader != NULL, "reader cannot be NULL");
@@ -31,7 +31,7 @@ Field::Field(const TCHAR* Name, Reader* reader, int config):
 
 
 Field::Field(const TCHAR* Name, const TCHAR* Value, int _config, const bool duplicateValue):
-	lazy(false)
+	lazy(false), omitTf(false)
 {
 	CND_PRECONDITION(Name != NULL, "Name cannot be NULL");
 	CND_PRECONDITION(Value != NULL, "value cannot be NULL");
@@ -59,7 +59,7 @@ Field::Field(const TCHAR* Name, const TCHAR* Value, int _config, const bool dupl
 }
 
 Field::Field(const TCHAR* Name, ValueArray<uint8_t>* Value, int config, bool duplicateValue):
-	lazy(false)
+	lazy(false), omitTf(false)
 {
 	CND_PRECONDITION(Name != NULL, "Name cannot be NULL");
 	CND_PRECONDITION(Value != NULL, "value cannot be NULL");
@@ -81,7 +81,7 @@ Field::Field(const TCHAR* Name, ValueArray<uint8_t>* Value, int config, bool dup
 }
 
 Field::Field(const TCHAR* Name, int config):
-	lazy(false)
+	lazy(false), omitTf(false)
 {
 	CND_PRECONDITION(Name != NULL, "Name cannot be NULL");
 
@@ -129,6 +129,11 @@ void Field::setOmitNorms(const bool omitNorms) {
         config &= ~INDEX_NONORMS;
 }
 
+int32_t Field::getDocValuesType() const { return config & (DOCVALUES_NUMERIC | DOCVALUES_SORTED); }
+
+bool Field::getOmitTf() const { return omitTf; }
+void Field::setOmitTf(const bool _omitTf) { omitTf = _omitTf; }
+
 bool Field::isLazy() const { return lazy; }
 
 void Field::setValue(TCHAR* value, const bool duplicateValue) {
@@ -197,7 +202,11 @@ void Field::setConfig(const uint32_t x){
 	}else
 		newConfig |= INDEX_NO;
 
-	if ( newConfig & INDEX_NO && newConfig & STORE_NO )
+	if ( x & DOCVALUES_NUMERIC && x & DOCVALUES_SORTED )
+		_CLTHROWA(CL_ERR_IllegalArgument,"a field can only have one type of doc values");
+	newConfig |= x & (DOCVALUES_NUMERIC | DOCVALUES_SORTED);
+
+	if ( newConfig & INDEX_NO && newConfig & STORE_NO && (newConfig & (DOCVALUES_NUMERIC | DOCVALUES_SORTED)) == 0 )
 		_CLTHROWA(CL_ERR_IllegalArgument,"it doesn't make sense to have a field that is neither indexed nor stored");
 
 	//set termvector settings
@@ -270,6 +279,12 @@ TCHAR* Field::toString() {
     }
     if (getOmitNorms()) {
       result.append( _T(",omitNorms") );
+    }
+    if (getOmitTf()) {
+      result.append( _T(",omitTf") );
+    }
+    if (getDocValuesType() != 0) {
+      result.append( _T(",docValues") );
     }
 	if (isLazy()){
       result.append( _T(",lazy") );
@@ -113,6 +113,27 @@ public:
 		TERMVECTOR_WITH_POSITIONS_OFFSETS = TERMVECTOR_WITH_OFFSETS | TERMVECTOR_WITH_POSITIONS
 	};
 
+	enum DocValues{
+		/** Store the field value as an integer in a per document column of the
+		* segment, so that sorting on it needs no un-inversion of the terms.
+		* The value must be a decimal integer. A field with doc values need not be
+		* indexed nor stored.
+		*
+		* @see IndexReader#getNumericDocValues
+		*/
+		DOCVALUES_NUMERIC=4096,
+
+		/** Store the field value in a per document column of the segment, as
+		* the ordinal of the value in a sorted dictionary of the values of the
+		* segment. Used to sort on strings without un-inversion.
+		* <p>A document holds one value of each doc values field. If the
+		* field is added more than once, the last value is kept.
+		*
+		* @see IndexReader#getSortedDocValues
+		*/
+		DOCVALUES_SORTED=8192
+	};
+
 	bool lazy;
 
 	enum ValueType {
@@ -251,6 +272,21 @@ public:
 	*/
 	void setOmitNorms(const bool omitNorms);
 
+	/** Returns DOCVALUES_NUMERIC or DOCVALUES_SORTED if the value of the field
+	* is stored in a column of the segment, 0 if not */
+	int32_t getDocValuesType() const;
+
+	/** True if tf is omitted for this indexed field */
+	bool getOmitTf() const;
+
+	/** Expert:
+	*
+	* If set, omit term freq, positions and payloads from postings for this field.
+	* Every matching document then scores as if the term occurred once, and
+	* phrase and span queries can no longer match on this field.
+	*/
+	void setOmitTf(const bool omitTf);
+
 	/**
 	* Indicates whether a Field is Lazy or not.  The semantics of Lazy loading are such that if a Field is lazily loaded, retrieving
 	* it's values via {@link #stringValue()} or {@link #binaryValue()} is only valid as long as the {@link org.apache.lucene.index.IndexReader} that
@@ -308,6 +344,7 @@ protected:
 
 	const TCHAR* _name;
 	uint32_t config;
+	bool omitTf;
 	float_t boost;
 };
 CL_NS_END
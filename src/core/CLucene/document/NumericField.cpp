@@ -0,0 +1,82 @@
+/*------------------------------------------------------------------------------
+* Copyright (C) 2003-2006 Ben van Klinken and the CLucene Team
+*
+* Distributable under the terms of either the Apache License (Version 2.0) or
+* the GNU Lesser General Public License, as specified in the COPYING file.
+------------------------------------------------------------------------------*/
+#include "CLucene/_ApiHeader.h"
+#include "NumericField.h"
+#include "CLucene/analysis/NumericTokenStream.h"
+#include "CLucene/util/Misc.h"
+
+CL_NS_DEF(document)
+CL_NS_USE(analysis)
+
+NumericField::NumericField(const TCHAR* name, const int _config, const int32_t precisionStep):
+	Field(name, (_config & (STORE_YES|STORE_COMPRESS)) | TERMVECTOR_NO |
+		((_config & INDEX_NO) ? INDEX_NO : INDEX_TOKENIZED)),
+	tokenStream(NULL)
+{
+	tokenStream = _CLNEW NumericTokenStream(precisionStep);
+	if ( isIndexed() ){
+		setOmitNorms(true);
+		setOmitTf(true);
+	}
+}
+
+NumericField::~NumericField(){
+	_CLDELETE(tokenStream);
+}
+
+NumericField* NumericField::setInt64Value(const int64_t value){
+	TCHAR buf[24];
+	_i64tot(value, buf, 10);
+	setValue(buf);
+	tokenStream->setInt64Value(value);
+	return this;
+}
+
+NumericField* NumericField::setInt32Value(const int32_t value){
+	TCHAR buf[24];
+	_i64tot(value, buf, 10);
+	setValue(buf);
+	tokenStream->setInt32Value(value);
+	return this;
+}
+
+NumericField* NumericField::setDoubleValue(const double value){
+	char abuf[32];
+	TCHAR buf[32];
+	_snprintf(abuf, 32, "%.17g", value);
+	STRCPY_AtoT(buf, abuf, 32);
+	setValue(buf);
+	tokenStream->setDoubleValue(value);
+	return this;
+}
+
+NumericField* NumericField::setFloatValue(const float value){
+	char abuf[32];
+	TCHAR buf[32];
+	_snprintf(abuf, 32, "%.9g", (double)value);
+	STRCPY_AtoT(buf, abuf, 32);
+	setValue(buf);
+	tokenStream->setFloatValue(value);
+	return this;
+}
+
+int32_t NumericField::getPrecisionStep() const{
+	return tokenStream->getPrecisionStep();
+}
+
+TokenStream* NumericField::tokenStreamValue(){
+	return isIndexed() ? tokenStream : NULL;
+}
+
+const char* NumericField::getObjectName() const{
+	return getClassName();
+}
+const char* NumericField::getClassName(){
+	return "NumericField";
+}
+
+CL_NS_END
@@ -0,0 +1,74 @@
+/*------------------------------------------------------------------------------
+* Copyright (C) 2003-2006 Ben van Klinken and the CLucene Team
+*
+* Distributable under the terms of either the Apache License (Version 2.0) or
+* the GNU Lesser General Public License, as specified in the COPYING file.
+------------------------------------------------------------------------------*/
+#ifndef _lucene_document_NumericField_
+#define _lucene_document_NumericField_
+
+#include "Field.h"
+#include "CLucene/util/NumericUtils.h"
+
+CL_CLASS_DEF(analysis,NumericTokenStream)
+
+CL_NS_DEF(document)
+
+/**
+* A field holding a single int32_t, int64_t, float or double, which is
+* indexed with one term per precision (see {@link lucene::util::NumericUtils}),
+* so that {@link lucene::search::NumericRangeQuery} and
+* {@link lucene::search::NumericRangeFilter} can match any range of values
+* with a few dozen terms.
+*
+* <pre>
+*   NumericField* field = _CLNEW NumericField(_T("price"), Field::STORE_YES);
+*   field->setDoubleValue(19.95);
+*   doc.add(*field);
+* </pre>
+*
+* <p>The terms are not analyzed, have no norms and no term frequencies. If the
+* field is stored, its value is stored as decimal text, which is also its
+* stringValue().
+*
+* <p>The range queries must use the same precisionStep as the field. Smaller
+* steps index more terms and make ranges faster; the default of
+* NumericUtils::PRECISION_STEP_DEFAULT suits most uses.
+*/
+class CLUCENE_EXPORT NumericField : public Field {
+private:
+	CL_NS(analysis)::NumericTokenStream* tokenStream;
+
+public:
+	/**
+	* Creates a field without a value, which must be set before the field is
+	* added to a document.
+	* @param _config STORE_YES or STORE_NO, optionally with INDEX_NO for a
+	*   stored only value
+	* @throws CL_ERR_IllegalArgument if precisionStep is less than 1
+	*/
+	NumericField(const TCHAR* name, const int _config = Field::STORE_NO,
+		const int32_t precisionStep = CL_NS(util)::NumericUtils::PRECISION_STEP_DEFAULT);
+	virtual ~NumericField();
+
+	/** Sets the value of the field to a 64 bit integer */
+	NumericField* setInt64Value(const int64_t value);
+	/** Sets the value of the field to a 32 bit integer */
+	NumericField* setInt32Value(const int32_t value);
+	/** Sets the value of the field to a double */
+	NumericField* setDoubleValue(const double value);
+	/** Sets the value of the field to a float */
+	NumericField* setFloatValue(const float value);
+
+	/** Returns the precision step of the field */
+	int32_t getPrecisionStep() const;
+
+	/** Returns the stream of the terms of the value, or NULL if the field is not indexed */
+	CL_NS(analysis)::TokenStream* tokenStreamValue();
+
+	virtual const char* getObjectName() const;
+	static const char* getClassName();
+};
+
+CL_NS_END
+#endif
@@ -69,6 +69,7 @@ public:
 	CL_NS(store)::IndexInput* clone() const;
 
 	int64_t length() const { return _length; }
+	CL_NS(store)::IndexInput* mapBytes(const int64_t pos, const int64_t len, const uint8_t*& bytes);
 
 	const char* getDirectoryType() const{ return CompoundFileReader::getClassName(); }
   const char* getObjectName() const{ return getClassName(); }
@@ -119,6 +120,13 @@ CSIndexInput::CSIndexInput(const CSIndexInput& clone): BufferedIndexInput(clone)
 void CSIndexInput::close(){
 }
 
+IndexInput* CSIndexInput::mapBytes(const int64_t pos, const int64_t len, const uint8_t*& bytes){
+   if ( pos < 0 || pos + len > _length )
+      return NULL;
+   SCOPED_LOCK_MUTEX(base->THIS_LOCK)
+   return base->mapBytes(fileOffset + pos, len, bytes);
+}
+
 
 
 CompoundFileReader::CompoundFileReader(Directory* dir, const char* name, int32_t _readBufferSize):
@@ -22,6 +22,16 @@ CL_NS_DEF(index)
 
 
   void DirectoryIndexReader::doClose() {
+    // the writer clears writer under READERS_LOCK before it is deleted.
+    // The readers it closes itself are never from it, so they do not
+    // take READERS_LOCK while it holds its THIS_LOCK
+    if (fromWriter){
+      SCOPED_LOCK_MUTEX(IndexWriter::READERS_LOCK)
+      if (writer != NULL){
+        writer->readerClosed(this);
+        writer = NULL;
+      }
+    }
     if(closeDirectory && _directory){
         _directory->close();
     }
@@ -111,6 +121,8 @@ CL_NS_DEF(index)
     this->deletionPolicy = NULL;
     this->stale = false;
     this->writeLock = NULL;
+    this->writer = NULL;
+    this->fromWriter = false;
     this->rollbackSegmentInfos = NULL;
     this->_directory = _CL_POINTER(__directory);
     this->segmentInfos = segmentInfos;
@@ -206,6 +218,9 @@ CL_NS_DEF(index)
     SCOPED_LOCK_MUTEX(THIS_LOCK)
     ensureOpen();
 
+    if (writer != NULL)
+      return writer->reopenReader(this);
+
     if (this->hasChanges || this->isCurrent()) {
       // the index hasn't changed - nothing to do here
       return this;
@@ -256,6 +271,8 @@ CL_NS_DEF(index)
    */
   bool DirectoryIndexReader::isCurrent(){
     ensureOpen();
+    if (writer != NULL)
+      return writer->isReaderCurrent(this);
     return SegmentInfos::readCurrentVersion(_directory) == segmentInfos->getVersion();
   }
 
@@ -13,6 +13,7 @@ CL_CLASS_DEF(store,LuceneLock)
 
 CL_NS_DEF(index)
 class IndexDeletionPolicy;
+class IndexWriter;
 
 /**
  * IndexReader implementation that has access to a Directory.
@@ -28,6 +29,13 @@ private:
   CL_NS(store)::LuceneLock* writeLock;
   bool stale;
 
+  //the writer which returned this reader from getReader, or NULL
+  //once it is closed. Guarded by IndexWriter::READERS_LOCK
+  IndexWriter* writer;
+  //true if this reader was returned by IndexWriter::getReader. Set
+  //before it is returned, and never changed after
+  bool fromWriter;
+
   /** Used by commit() to record pre-commit state in case
    * rollback is necessary */
   bool rollbackHasChanges;
@@ -37,6 +45,7 @@ private:
   class FindSegmentsFile_Reopen;
   friend class FindSegmentsFile_Open;
   friend class FindSegmentsFile_Reopen;
+  friend class IndexWriter;
 
 protected:
   CL_NS(store)::Directory* _directory;
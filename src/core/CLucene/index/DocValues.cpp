@@ -0,0 +1,423 @@
+/*------------------------------------------------------------------------------
+* Copyright (C) 2003-2006 Ben van Klinken and the CLucene Team
+*
+* Distributable under the terms of either the Apache License (Version 2.0) or
+* the GNU Lesser General Public License, as specified in the COPYING file.
+------------------------------------------------------------------------------*/
+#include "CLucene/_ApiHeader.h"
+#include "CLucene/store/Directory.h"
+#include "CLucene/store/IndexInput.h"
+#include "CLucene/store/IndexOutput.h"
+#include "CLucene/document/Field.h"
+#include "_IndexFileNames.h"
+#include "_DocValues.h"
+#include <algorithm>
+
+CL_NS_USE(store)
+CL_NS_USE(util)
+CL_NS_DEF(index)
+
+NumericDocValues::~NumericDocValues(){
+}
+
+SortedDocValues::~SortedDocValues(){
+}
+
+const TCHAR* SortedDocValues::get(const int32_t doc) const{
+	const int32_t ord = getOrd(doc);
+	return ord == -1 ? NULL : lookupOrd(ord);
+}
+
+
+//writes values of bitsPerValue bits each, lowest bits first
+class DocValuesPackedWriter{
+	IndexOutput* output;
+	const int32_t bitsPerValue;
+	uint64_t pending;
+	int32_t pendingBits;
+public:
+	DocValuesPackedWriter(IndexOutput* output, const int32_t bitsPerValue):
+		output(output), bitsPerValue(bitsPerValue), pending(0), pendingBits(0)
+	{
+		output->writeByte((uint8_t)bitsPerValue);
+	}
+	void add(const uint64_t value){
+		if ( bitsPerValue == 64 ){
+			for ( int32_t i = 0; i < 64; i += 8 )
+				output->writeByte((uint8_t)(value >> i));
+			return;
+		}
+		//less than 8 bits are pending, so with at most 57 bits per value this fits
+		pending |= value << pendingBits;
+		pendingBits += bitsPerValue;
+		while ( pendingBits >= 8 ){
+			output->writeByte((uint8_t)pending);
+			pending >>= 8;
+			pendingBits -= 8;
+		}
+	}
+	void finish(){
+		if ( pendingBits > 0 )
+			output->writeByte((uint8_t)pending);
+		pending = 0;
+		pendingBits = 0;
+	}
+};
+
+DocValuesWriter::DocValuesWriter(Directory* directory, const char* segment){
+	output = directory->createOutput( (string(segment) + "." + IndexFileNames::DOCVALUES_EXTENSION).c_str() );
+	output->writeInt(FORMAT);
+}
+
+DocValuesWriter::~DocValuesWriter(){
+	if ( output != NULL ){
+		try{
+			output->close();
+		}catch(...){
+		}
+		_CLDELETE(output);
+	}
+	for ( size_t i = 0; i < names.size(); i++ )
+		_CLDELETE_CARRAY(names[i]);
+}
+
+int32_t DocValuesWriter::bitsRequired(const uint64_t maxValue){
+	int32_t bits = 0;
+	while ( bits < 64 && (maxValue >> bits) != 0 )
+		bits++;
+	//the reader reads a value from at most 8 bytes, which only
+	//holds the wider values if they are byte aligned
+	return bits > 57 ? 64 : bits;
+}
+
+void DocValuesWriter::addNumeric(const TCHAR* field, const int64_t* values, const int32_t numDocs){
+	names.push_back(stringDuplicate(field));
+	types.push_back((uint8_t)TYPE_NUMERIC);
+	pointers.push_back(output->getFilePointer());
+
+	int64_t minValue = 0;
+	int64_t maxValue = 0;
+	for ( int32_t i = 0; i < numDocs; i++ ){
+		if ( i == 0 || values[i] < minValue )
+			minValue = values[i];
+		if ( i == 0 || values[i] > maxValue )
+			maxValue = values[i];
+	}
+	output->writeLong(minValue);
+	DocValuesPackedWriter packed(output, bitsRequired((uint64_t)maxValue - (uint64_t)minValue));
+	for ( int32_t i = 0; i < numDocs; i++ )
+		packed.add((uint64_t)values[i] - (uint64_t)minValue);
+	packed.finish();
+}
+
+void DocValuesWriter::addSorted(const TCHAR* field, const TCHAR* const* values, const int32_t valueCount,
+	const int32_t* ords, const int32_t numDocs)
+{
+	names.push_back(stringDuplicate(field));
+	types.push_back((uint8_t)TYPE_SORTED);
+	pointers.push_back(output->getFilePointer());
+
+	output->writeVInt(valueCount);
+	for ( int32_t i = 0; i < valueCount; i++ )
+		output->writeString(values[i], _tcslen(values[i]));
+	DocValuesPackedWriter packed(output, bitsRequired((uint64_t)valueCount));
+	for ( int32_t i = 0; i < numDocs; i++ )
+		packed.add((uint64_t)(ords[i] + 1));
+	packed.finish();
+}
+
+void DocValuesWriter::close(){
+	const int64_t directoryPointer = output->getFilePointer();
+	output->writeVInt(names.size());
+	for ( size_t i = 0; i < names.size(); i++ ){
+		output->writeString(names[i], _tcslen(names[i]));
+		output->writeByte(types[i]);
+		output->writeLong(pointers[i]);
+	}
+	output->writeLong(directoryPointer);
+	output->close();
+	_CLDELETE(output);
+}
+
+
+//the packed values of a column, used in place if the file is mapped
+class DocValuesReader::PackedValues{
+	const uint8_t* bytes;
+	uint8_t* ownBytes;
+	IndexInput* mappedInput;
+	const int32_t bitsPerValue;
+	const uint64_t mask;
+public:
+	PackedValues(IndexInput* input, const int32_t numValues):
+		bytes(NULL),
+		ownBytes(NULL),
+		mappedInput(NULL),
+		bitsPerValue(input->readByte()),
+		mask(bitsPerValue == 64 ? ~(uint64_t)0 : ((uint64_t)1 << bitsPerValue) - 1)
+	{
+		if ( bitsPerValue > 64 || (bitsPerValue > 57 && bitsPerValue < 64) )
+			_CLTHROWA(CL_ERR_CorruptIndex, "invalid number of bits per doc value");
+		const int64_t length = ((int64_t)numValues * bitsPerValue + 7) / 8;
+		if ( length == 0 )
+			return;
+		mappedInput = input->mapBytes(input->getFilePointer(), length, bytes);
+		if ( mappedInput == NULL ){
+			ownBytes = _CL_NEWARRAY(uint8_t, (size_t)length);
+			input->readBytes(ownBytes, (int32_t)length);
+			bytes = ownBytes;
+		}
+	}
+	~PackedValues(){
+		_CLDELETE_ARRAY(ownBytes);
+		if ( mappedInput != NULL ){
+			mappedInput->close();
+			_CLDELETE(mappedInput);
+		}
+	}
+	uint64_t get(const int32_t index) const{
+		if ( bitsPerValue == 0 )
+			return 0;
+		const uint64_t bitPos = (uint64_t)index * bitsPerValue;
+		const uint8_t* p = bytes + (bitPos >> 3);
+		const int32_t shift = (int32_t)(bitPos & 7);
+		const int32_t numBytes = (shift + bitsPerValue + 7) >> 3;
+		uint64_t value = 0;
+		for ( int32_t i = 0; i < numBytes; i++ )
+			value |= (uint64_t)p[i] << (i << 3);
+		return (value >> shift) & mask;
+	}
+};
+
+class DocValuesReader::NumericColumn: public NumericDocValues{
+	const int64_t minValue;
+	PackedValues* values;
+public:
+	NumericColumn(IndexInput* input, const int32_t maxDoc):
+		minValue(input->readLong()),
+		values(NULL)
+	{
+		values = _CLNEW PackedValues(input, maxDoc);
+	}
+	~NumericColumn(){
+		_CLDELETE(values);
+	}
+	int64_t get(const int32_t doc) const{
+		return (int64_t)((uint64_t)minValue + values->get(doc));
+	}
+};
+
+class DocValuesReader::SortedColumn: public SortedDocValues{
+	TCHAR** lookup;
+	const int32_t valueCount;
+	PackedValues* ords;
+public:
+	SortedColumn(IndexInput* input, const int32_t maxDoc):
+		lookup(NULL),
+		valueCount(input->readVInt()),
+		ords(NULL)
+	{
+		lookup = _CL_NEWARRAY(TCHAR*, valueCount + 1);
+		memset(lookup, 0, sizeof(TCHAR*) * (valueCount + 1));
+		try{
+			for ( int32_t i = 0; i < valueCount; i++ )
+				lookup[i] = input->readString();
+			ords = _CLNEW PackedValues(input, maxDoc);
+		}catch(CLuceneError&){
+			_CLDELETE_CARRAY_ALL(lookup);
+			throw;
+		}
+	}
+	~SortedColumn(){
+		_CLDELETE(ords);
+		_CLDELETE_CARRAY_ALL(lookup);
+	}
+	int32_t getOrd(const int32_t doc) const{
+		return (int32_t)ords->get(doc) - 1;
+	}
+	int32_t getValueCount() const{
+		return valueCount;
+	}
+	const TCHAR* lookupOrd(const int32_t ord) const{
+		return lookup[ord];
+	}
+};
+
+class DocValuesReader::Entry{
+public:
+	const uint8_t type;
+	const int64_t pointer;
+	NumericDocValues* numeric;
+	SortedDocValues* sorted;
+
+	Entry(const uint8_t type, const int64_t pointer):
+		type(type), pointer(pointer), numeric(NULL), sorted(NULL)
+	{
+	}
+	~Entry(){
+		_CLDELETE(numeric);
+		_CLDELETE(sorted);
+	}
+};
+
+DocValuesReader::DocValuesReader(Directory* directory, const char* segment, const int32_t maxDoc):
+	entries(true, true),
+	input(NULL),
+	maxDoc(maxDoc)
+{
+	input = directory->openInput( (string(segment) + "." + IndexFileNames::DOCVALUES_EXTENSION).c_str() );
+	try{
+		const int32_t format = input->readInt();
+		if ( format != DocValuesWriter::FORMAT )
+			_CLTHROWA(CL_ERR_CorruptIndex, "unknown doc values format");
+		input->seek(input->length() - 8);
+		input->seek(input->readLong());
+		const int32_t numFields = input->readVInt();
+		for ( int32_t i = 0; i < numFields; i++ ){
+			TCHAR* name = input->readString();
+			const uint8_t type = input->readByte();
+			const int64_t pointer = input->readLong();
+			entries.put(name, _CLNEW Entry(type, pointer));
+		}
+	}catch(CLuceneError&){
+		input->close();
+		_CLDELETE(input);
+		throw;
+	}
+}
+
+DocValuesReader::~DocValuesReader(){
+	entries.clear();
+	if ( input != NULL ){
+		input->close();
+		_CLDELETE(input);
+	}
+}
+
+DocValuesReader::Entry* DocValuesReader::load(const TCHAR* field, const uint8_t type){
+	Entry* entry = entries.get((TCHAR*)field);
+	if ( entry == NULL || entry->type != type )
+		return NULL;
+
+	SCOPED_LOCK_MUTEX(THIS_LOCK)
+	if ( entry->numeric == NULL && entry->sorted == NULL ){
+		input->seek(entry->pointer);
+		if ( type == DocValuesWriter::TYPE_NUMERIC )
+			entry->numeric = _CLNEW NumericColumn(input, maxDoc);
+		else
+			entry->sorted = _CLNEW SortedColumn(input, maxDoc);
+	}
+	return entry;
+}
+
+NumericDocValues* DocValuesReader::getNumeric(const TCHAR* field){
+	Entry* entry = load(field, DocValuesWriter::TYPE_NUMERIC);
+	return entry == NULL ? NULL : entry->numeric;
+}
+
+SortedDocValues* DocValuesReader::getSorted(const TCHAR* field){
+	Entry* entry = load(field, DocValuesWriter::TYPE_SORTED);
+	return entry == NULL ? NULL : entry->sorted;
+}
+
+
+class BufferedDocValues::Column{
+public:
+	const int32_t type;
+	std::vector<int64_t> numbers;
+	std::vector<TCHAR*> texts;
+
+	Column(const int32_t type): type(type){
+	}
+	~Column(){
+		for ( size_t i = 0; i < texts.size(); i++ )
+			_CLDELETE_CARRAY(texts[i]);
+	}
+};
+
+BufferedDocValues::BufferedDocValues():
+	columns(true, true)
+{
+}
+
+BufferedDocValues::~BufferedDocValues(){
+}
+
+BufferedDocValues::Column* BufferedDocValues::getColumn(const TCHAR* field, const int32_t type){
+	Column* column = columns.get((TCHAR*)field);
+	if ( column == NULL ){
+		column = _CLNEW Column(type);
+		columns.put(stringDuplicate(field), column);
+	}
+	return column->type == type ? column : NULL;
+}
+
+void BufferedDocValues::add(const int32_t docID, std::vector<Value>& values){
+	for ( size_t i = 0; i < values.size(); i++ ){
+		Value& value = values[i];
+		Column* column = getColumn(value.field, value.type);
+		if ( column == NULL )
+			continue;
+		//a document holds one value per column, a later value of the
+		//field replaces the earlier one
+		if ( value.type == CL_NS(document)::Field::DOCVALUES_NUMERIC ){
+			column->numbers.resize(docID, 0);
+			column->numbers.push_back(value.number);
+		}else if ( (int32_t)column->texts.size() > docID ){
+			_CLDELETE_CARRAY(column->texts[docID]);
+			column->texts[docID] = value.text;
+			value.text = NULL;
+		}else{
+			column->texts.resize(docID, NULL);
+			column->texts.push_back(value.text);
+			value.text = NULL;
+		}
+	}
+	clear(values);
+}
+
+bool BufferedDocValues::empty() const{
+	return columns.size() == 0;
+}
+
+void BufferedDocValues::write(Directory* directory, const char* segment, const int32_t numDocs){
+	DocValuesWriter writer(directory, segment);
+	for ( ColumnsType::iterator itr = columns.begin(); itr != columns.end(); ++itr ){
+		Column* column = itr->second;
+		if ( column->type == CL_NS(document)::Field::DOCVALUES_NUMERIC ){
+			column->numbers.resize(numDocs, 0);
+			writer.addNumeric(itr->first, numDocs == 0 ? NULL : &column->numbers[0], numDocs);
+		}else{
+			column->texts.resize(numDocs, NULL);
+
+			//the distinct values in order, and the ordinal of each document
+			std::vector<const TCHAR*> values;
+			for ( int32_t i = 0; i < numDocs; i++ )
+				if ( column->texts[i] != NULL )
+					values.push_back(column->texts[i]);
+			std::sort(values.begin(), values.end(), Compare::TChar());
+			values.erase(std::unique(values.begin(), values.end(), Equals::TChar()), values.end());
+
+			std::vector<int32_t> ords(numDocs, -1);
+			for ( int32_t i = 0; i < numDocs; i++ )
+				if ( column->texts[i] != NULL )
+					ords[i] = (int32_t)(std::lower_bound(values.begin(), values.end(),
+						(const TCHAR*)column->texts[i], Compare::TChar()) - values.begin());
+
+			writer.addSorted(itr->first, values.empty() ? NULL : &values[0], (int32_t)values.size(),
+				numDocs == 0 ? NULL : &ords[0], numDocs);
+		}
+	}
+	writer.close();
+}
+
+void BufferedDocValues::reset(){
+	columns.clear();
+}
+
+void BufferedDocValues::clear(std::vector<Value>& values){
+	for ( size_t i = 0; i < values.size(); i++ )
+		_CLDELETE_CARRAY(values[i].text);
+	values.clear();
+}
+
+CL_NS_END
@@ -0,0 +1,57 @@
+/*------------------------------------------------------------------------------
+* Copyright (C) 2003-2006 Ben van Klinken and the CLucene Team
+*
+* Distributable under the terms of either the Apache License (Version 2.0) or
+* the GNU Lesser General Public License, as specified in the COPYING file.
+------------------------------------------------------------------------------*/
+#ifndef _lucene_index_DocValues_
+#define _lucene_index_DocValues_
+
+CL_NS_DEF(index)
+
+/**
+* The integer values of a field which was added with
+* {@link lucene::document::Field::DOCVALUES_NUMERIC}, one per document.
+* The values are stored in a column of the segment, so that they can be
+* read without un-inverting the terms of the field.
+*
+* @see IndexReader#getNumericDocValues
+*/
+class CLUCENE_EXPORT NumericDocValues {
+public:
+	virtual ~NumericDocValues();
+
+	/** Returns the value of doc, or 0 if doc has no value */
+	virtual int64_t get(const int32_t doc) const = 0;
+};
+
+/**
+* The values of a field which was added with
+* {@link lucene::document::Field::DOCVALUES_SORTED}. The distinct values of
+* the segment are kept in sorted order, and each document refers to its value
+* by its ordinal in that order.
+*
+* @see IndexReader#getSortedDocValues
+*/
+class CLUCENE_EXPORT SortedDocValues {
+public:
+	virtual ~SortedDocValues();
+
+	/** Returns the ordinal of the value of doc, or -1 if doc has no value */
+	virtual int32_t getOrd(const int32_t doc) const = 0;
+
+	/** Returns the number of distinct values */
+	virtual int32_t getValueCount() const = 0;
+
+	/**
+	* Returns the value of ordinal ord, which must be less than getValueCount().
+	* @memory the value belongs to the reader
+	*/
+	virtual const TCHAR* lookupOrd(const int32_t ord) const = 0;
+
+	/** Returns the value of doc, or NULL if doc has no value */
+	const TCHAR* get(const int32_t doc) const;
+};
+
+CL_NS_END
+#endif
@@ -50,6 +50,7 @@ const uint8_t DocumentsWriter::defaultNorm = Similarity::encodeNorm(1.0f);
 const int32_t DocumentsWriter::nextLevelArray[10] = {1, 2, 3, 4, 5, 6, 7, 8, 9, 9};
 const int32_t DocumentsWriter::levelSizeArray[10] = {5, 14, 20, 30, 40, 40, 80, 80, 120, 200};
 const int32_t DocumentsWriter::POSTING_NUM_BYTE = OBJECT_HEADER_BYTES + 9*INT_NUM_BYTE + 5*POINTER_NUM_BYTE;
+const int32_t DocumentsWriter::POSTINGS_BLOCK_SIZE = 512;
 
 const int32_t DocumentsWriter::BYTE_BLOCK_SHIFT = 15;
 const int32_t DocumentsWriter::BYTE_BLOCK_SIZE = (int32_t)pow(2.0, BYTE_BLOCK_SHIFT);
@@ -108,6 +109,9 @@ DocumentsWriter::DocumentsWriter(CL_NS(store)::Directory* directory, IndexWriter
   fieldsWriter = NULL;
   tvx = tvf = tvd = NULL;
   postingsFreeCountDW = postingsAllocCountDW = numWaiting = pauseThreads = abortCount = 0;
+  postingsBlockUpto = POSTINGS_BLOCK_SIZE;
+  postingsFreeOrderedDW = 0;
+  numPostingsBlockAllocs = numByteBlockAllocs = numCharBlockAllocs = 0;
   docStoreOffset = nextDocID = numDocsInRAM = numDocsInStore = nextWriteDocID = 0;
 }
 DocumentsWriter::~DocumentsWriter(){
@@ -121,15 +125,8 @@ DocumentsWriter::~DocumentsWriter(){
     _CLLDELETE(threadStates.values[i]);
   }
 
-  // Make sure unused posting slots aren't attempted delete on
-  if (this->postingsFreeListDW.values){
-      if (this->postingsFreeCountDW < this->postingsFreeListDW.length) {
-          memset(this->postingsFreeListDW.values + this->postingsFreeCountDW
-              , NULL
-              , sizeof(Posting*));
-      }
-      postingsFreeListDW.deleteUntilNULL();
-  }
+  for (size_t i = 0; i < postingsBlocks.size(); i++)
+    _CLDELETE_LARRAY(postingsBlocks[i]);
 }
 
 void DocumentsWriter::setInfoStream(std::ostream* infoStream) {
@@ -204,10 +201,11 @@ std::string DocumentsWriter::closeDocStore() {
 
     if (fieldsWriter != NULL) {
       assert (!docStoreSegment.empty());
+      const int32_t fieldsFormatSize = fieldsWriter->getFormatSize();
       fieldsWriter->close();
       _CLDELETE(fieldsWriter);
 
-      assert(numDocsInStore*8 == directory->fileLength( (docStoreSegment + "." + IndexFileNames::FIELDS_INDEX_EXTENSION).c_str() ) );// "after flush: fdx size mismatch: " + numDocsInStore + " docs vs " + directory->fileLength(docStoreSegment + "." + IndexFileNames::FIELDS_INDEX_EXTENSION) + " length in bytes of " + docStoreSegment + "." + IndexFileNames::FIELDS_INDEX_EXTENSION;
+      assert(fieldsFormatSize+numDocsInStore*8 == directory->fileLength( (docStoreSegment + "." + IndexFileNames::FIELDS_INDEX_EXTENSION).c_str() ) );// "after flush: fdx size mismatch: " + numDocsInStore + " docs vs " + directory->fileLength(docStoreSegment + "." + IndexFileNames::FIELDS_INDEX_EXTENSION) + " length in bytes of " + docStoreSegment + "." + IndexFileNames::FIELDS_INDEX_EXTENSION;
     }
 
     std::string s = docStoreSegment;
@@ -390,14 +388,18 @@ void DocumentsWriter::resetPostingsData() {
   nextDocID = 0;
   nextWriteDocID = 0;
   _CLDELETE(_files);
-  balanceRAM();
   bufferIsFull = false;
   flushPending = false;
   for(size_t i=0;i<threadStates.length;i++) {
     threadStates[i]->numThreads = 0;
     threadStates[i]->resetPostings();
   }
+  docValues.reset();
   numBytesUsed = 0;
+  // Now that all postings are free, their blocks can be
+  // freed too if we are over our RAM budget
+  orderFreePostings();
+  balanceRAM();
 }
 
 // Returns true if an abort is in progress
@@ -620,6 +622,11 @@ void DocumentsWriter::writeSegment(std::vector<std::string>& flushedFiles) {
     flushedFiles.push_back(segmentFileName(IndexFileNames::NORMS_EXTENSION));
   }
 
+  if (!docValues.empty()) {
+    docValues.write(directory, segmentName.c_str(), numDocsInRAM);
+    flushedFiles.push_back(segmentFileName(IndexFileNames::DOCVALUES_EXTENSION));
+  }
+
   if (infoStream != NULL) {
     const int64_t newSegmentSize = segmentSize(segmentName);
 
@@ -627,7 +634,12 @@ void DocumentsWriter::writeSegment(std::vector<std::string>& flushedFiles) {
 				string(" newFlushedSize=") << Misc::toString(newSegmentSize) <<
         string(" docs/MB=") << Misc::toString((float_t)(numDocsInRAM/(newSegmentSize/1024.0/1024.0))) <<
         string(" new/old=") << Misc::toString((float_t)(100.0*newSegmentSize/numBytesUsed)) << string("%\n");
+    (*infoStream) << string("  allocated blocks: postings=") << Misc::toString(numPostingsBlockAllocs) <<
+        string(" bytes=") << Misc::toString(numByteBlockAllocs) <<
+        string(" chars=") << Misc::toString(numCharBlockAllocs) <<
+        string(" per doc=") << Misc::toString((float_t)(numPostingsBlockAllocs+numByteBlockAllocs+numCharBlockAllocs)/numDocsInRAM) << string("\n");
   }
+  numPostingsBlockAllocs = numByteBlockAllocs = numCharBlockAllocs = 0;
 
   resetPostingsData();
 
@@ -702,6 +714,7 @@ void DocumentsWriter::appendPostings(ArrayBase<ThreadState::FieldData*>* fields,
 
   const int32_t skipInterval = termsOut->skipInterval;
   currentFieldStorePayloads = (*fields)[0]->fieldInfo->storePayloads;
+  const bool currentFieldOmitTf = (*fields)[0]->fieldInfo->omitTf;
 
   ValueArray<FieldMergeState*> termStates(numFields);
 
@@ -762,39 +775,45 @@ void DocumentsWriter::appendPostings(ArrayBase<ThreadState::FieldData*>* fields,
       const int32_t newDocCode = (doc-lastDoc)<<1;
       lastDoc = doc;
 
-      ByteSliceReader& prox = minState->prox;
-
-      // Carefully copy over the prox + payload info,
-      // changing the format to match Lucene's segment
-      // format.
-      for(int32_t j=0;j<termDocFreq;j++) {
-        const int32_t code = prox.readVInt();
-        if (currentFieldStorePayloads) {
-          int32_t payloadLength;
-          if ((code & 1) != 0) {
-            // This position has a payload
-            payloadLength = prox.readVInt();
-          } else
-            payloadLength = 0;
-          if (payloadLength != lastPayloadLength) {
-            proxOut->writeVInt(code|1);
-            proxOut->writeVInt(payloadLength);
-            lastPayloadLength = payloadLength;
-          } else
-            proxOut->writeVInt(code & (~1));
-          if (payloadLength > 0)
-            copyBytes(&prox, proxOut, payloadLength);
-        } else {
-          assert ( 0 == (code & 1) );
-          proxOut->writeVInt(code>>1);
+      if (currentFieldOmitTf) {
+        // Only the doc delta is written; the positions
+        // buffered before tf was omitted are dropped
+        freqOut->writeVInt(newDocCode>>1);
+      } else {
+        ByteSliceReader& prox = minState->prox;
+
+        // Carefully copy over the prox + payload info,
+        // changing the format to match Lucene's segment
+        // format.
+        for(int32_t j=0;j<termDocFreq;j++) {
+          const int32_t code = prox.readVInt();
+          if (currentFieldStorePayloads) {
+            int32_t payloadLength;
+            if ((code & 1) != 0) {
+              // This position has a payload
+              payloadLength = prox.readVInt();
+            } else
+              payloadLength = 0;
+            if (payloadLength != lastPayloadLength) {
+              proxOut->writeVInt(code|1);
+              proxOut->writeVInt(payloadLength);
+              lastPayloadLength = payloadLength;
+            } else
+              proxOut->writeVInt(code & (~1));
+            if (payloadLength > 0)
+              copyBytes(&prox, proxOut, payloadLength);
+          } else {
+            assert ( 0 == (code & 1) );
+            proxOut->writeVInt(code>>1);
+          }
         }
-      }
 
-      if (1 == termDocFreq) {
-        freqOut->writeVInt(newDocCode|1);
-      } else {
-        freqOut->writeVInt(newDocCode);
-        freqOut->writeVInt(termDocFreq);
+        if (1 == termDocFreq) {
+          freqOut->writeVInt(newDocCode|1);
+        } else {
+          freqOut->writeVInt(newDocCode);
+          freqOut->writeVInt(termDocFreq);
+        }
       }
 
       if (!minState->nextDoc()) {
@@ -1186,6 +1205,8 @@ void DocumentsWriter::getPostings(ValueArray<Posting*>& postings) {
     memcpy(postings.values, this->postingsFreeListDW.values+start, sizeof(Posting*)*numToCopy);
   }
   this->postingsFreeCountDW -= numToCopy;
+  if (postingsFreeOrderedDW > this->postingsFreeCountDW)
+    postingsFreeOrderedDW = this->postingsFreeCountDW;
 
   // Directly allocate the remainder if any
   if (numToCopy < postings.length) {
@@ -1196,13 +1217,54 @@ void DocumentsWriter::getPostings(ValueArray<Posting*>& postings) {
 
     balanceRAM();
     for(size_t i=numToCopy;i<postings.length;i++) {
-      postings.values[i] = _CLNEW Posting();
+      if (postingsBlockUpto == POSTINGS_BLOCK_SIZE) {
+        Posting* block = _CL_NEWARRAY(Posting, POSTINGS_BLOCK_SIZE);
+        memset(block, 0, POSTINGS_BLOCK_SIZE * sizeof(Posting));
+        postingsBlocks.push_back(block);
+        postingsBlockUpto = 0;
+        numPostingsBlockAllocs++;
+      }
+      postings.values[i] = postingsBlocks.back() + postingsBlockUpto++;
       numBytesAlloc += POSTING_NUM_BYTE;
       this->postingsAllocCountDW++;
     }
   }
 }
 
+void DocumentsWriter::orderFreePostings() {
+  // All postings are free: lay the free list out block by
+  // block, last block first, so that the postings of the
+  // trailing blocks are handed out last
+  assert (this->postingsFreeCountDW == this->postingsAllocCountDW);
+  int32_t upto = 0;
+  for (size_t i = postingsBlocks.size(); i-- > 0; ) {
+    const int32_t numInBlock = (i == postingsBlocks.size()-1) ? postingsBlockUpto : POSTINGS_BLOCK_SIZE;
+    for (int32_t j = 0; j < numInBlock; j++)
+      this->postingsFreeListDW.values[upto++] = postingsBlocks[i] + j;
+  }
+  postingsFreeOrderedDW = upto;
+}
+
+bool DocumentsWriter::canFreePostingsBlock() {
+  return !postingsBlocks.empty() && postingsFreeOrderedDW >= postingsBlockUpto;
+}
+
+void DocumentsWriter::freeLastPostingsBlock() {
+  assert (canFreePostingsBlock());
+  const int32_t numToFree = postingsBlockUpto;
+  _CLDELETE_LARRAY(postingsBlocks.back());
+  postingsBlocks.pop_back();
+  this->postingsFreeCountDW -= numToFree;
+  this->postingsAllocCountDW -= numToFree;
+  postingsFreeOrderedDW -= numToFree;
+  memmove(this->postingsFreeListDW.values, this->postingsFreeListDW.values + numToFree,
+    this->postingsFreeCountDW * sizeof(Posting*));
+  numBytesAlloc -= numToFree * POSTING_NUM_BYTE;
+
+  // All remaining blocks are full
+  postingsBlockUpto = POSTINGS_BLOCK_SIZE;
+}
+
 void DocumentsWriter::recyclePostings(ValueArray<Posting*>& postings, int32_t numPostings) {
 	SCOPED_LOCK_MUTEX(THIS_LOCK)
   // Move all Postings from this ThreadState back to our
@@ -1220,6 +1282,7 @@ uint8_t* DocumentsWriter::getByteBlock(bool trackAllocations) {
   uint8_t* b;
   if (0 == size) {
     numBytesAlloc += BYTE_BLOCK_SIZE;
+    numByteBlockAllocs++;
     balanceRAM();
     b = _CL_NEWARRAY(uint8_t, BYTE_BLOCK_SIZE);
     memset(b,0,sizeof(uint8_t) * BYTE_BLOCK_SIZE);
@@ -1247,6 +1310,7 @@ TCHAR* DocumentsWriter::getCharBlock() {
   TCHAR* c;
   if (0 == size) {
     numBytesAlloc += CHAR_BLOCK_SIZE * CHAR_NUM_BYTE;
+    numCharBlockAllocs++;
     balanceRAM();
     c = _CL_NEWARRAY(TCHAR, CHAR_BLOCK_SIZE);
     memset(c,0,sizeof(TCHAR) * CHAR_BLOCK_SIZE);
@@ -1294,6 +1358,7 @@ void DocumentsWriter::balanceRAM() {
                          string(" allocMB=") << toMB(numBytesAlloc) <<
                          string(" vs trigger=") << toMB(freeTrigger) <<
                          string(" postingsFree=") << toMB(this->postingsFreeCountDW*POSTING_NUM_BYTE) <<
+                         string(" postingsBlocks=") << postingsBlocks.size() <<
                          string(" byteBlockFree=") << toMB(freeByteBlocks.size()*BYTE_BLOCK_SIZE) <<
                          string(" charBlockFree=") << toMB(freeCharBlocks.size()*CHAR_BLOCK_SIZE*CHAR_NUM_BYTE) << string("\n");
 
@@ -1302,8 +1367,6 @@ void DocumentsWriter::balanceRAM() {
     // to 95%
     const int64_t startBytesAlloc = numBytesAlloc;
 
-    const int32_t postingsFreeChunk = (int32_t) (BYTE_BLOCK_SIZE / POSTING_NUM_BYTE);
-
     int32_t iter = 0;
 
     // We free equally from each pool in 64 KB
@@ -1311,7 +1374,10 @@ void DocumentsWriter::balanceRAM() {
     // (freeLevel)
 
     while(numBytesAlloc > freeLevel) {
-      if (0 == freeByteBlocks.size() && 0 == freeCharBlocks.size() && 0 == this->postingsFreeCountDW) {
+      // A block of postings can only be freed once none
+      // of its postings is in use
+      const bool postingsFree = canFreePostingsBlock();
+      if (0 == freeByteBlocks.size() && 0 == freeCharBlocks.size() && !postingsFree) {
         // Nothing else to free -- must flush now.
         bufferIsFull = true;
         if (infoStream != NULL)
@@ -1329,19 +1395,8 @@ void DocumentsWriter::balanceRAM() {
         numBytesAlloc -= CHAR_BLOCK_SIZE * CHAR_NUM_BYTE;
       }
 
-      if ((2 == iter % 3) && this->postingsFreeCountDW > 0) {
-        int32_t numToFree;
-        if (this->postingsFreeCountDW >= postingsFreeChunk)
-          numToFree = postingsFreeChunk;
-        else
-          numToFree = this->postingsFreeCountDW;
-        for ( size_t i = this->postingsFreeCountDW-numToFree;i< this->postingsFreeCountDW; i++ ){
-          _CLDELETE(this->postingsFreeListDW.values[i]);
-        }
-        this->postingsFreeCountDW -= numToFree;
-        this->postingsAllocCountDW -= numToFree;
-        numBytesAlloc -= numToFree * POSTING_NUM_BYTE;
-      }
+      if ((2 == iter % 3) && postingsFree)
+        freeLastPostingsBlock();
 
       iter++;
     }
@@ -1425,7 +1480,10 @@ bool DocumentsWriter::FieldMergeState::nextTerm(){
   else
     freq.bufferOffset = freq.upto = freq.endIndex = 0;
 
-  prox.init(field->threadState->postingsPool, p->proxStart, p->proxUpto);
+  if (p->proxUpto > p->proxStart)
+    prox.init(field->threadState->postingsPool, p->proxStart, p->proxUpto);
+  else
+    prox.bufferOffset = prox.upto = prox.endIndex = 0;
 
   // Should always be true
   bool result = nextDoc();
@@ -87,6 +87,7 @@ DocumentsWriter::ThreadState::~ThreadState(){
   _CLDELETE(stringReader);
   _CLDELETE(tvfLocal);
   _CLDELETE(fdtLocal);
+  BufferedDocValues::clear(docValues);
 
   for ( size_t i=0; i<allFieldDataArray.length;i++)
     _CLDELETE(allFieldDataArray.values[i]);
@@ -157,6 +158,10 @@ void DocumentsWriter::ThreadState::writeDocument() {
         bn->add(norm);
       }
     }
+
+    // Append the doc values of this doc:
+    if (!docValues.empty())
+      _parent->docValues.add(docID, docValues);
   } catch (CLuceneError& t) {
     // Forcefully idle this threadstate -- its state will
     // be reset by abort()
@@ -192,6 +197,36 @@ void DocumentsWriter::ThreadState::init(Document* doc, int32_t docID) {
   const int32_t numDocFields = docFields.size();
   bool docHasVectors = false;
 
+  // Take the doc values now, as the document may be gone
+  // by the time this doc is written. A value which is
+  // not a number rejects the document here, before
+  // anything was changed:
+  BufferedDocValues::clear(docValues);
+  for(int32_t i=0;i<numDocFields;i++) {
+    Field* field = docFields[i];
+    const int32_t type = field->getDocValuesType();
+    if (type == 0)
+      continue;
+    const TCHAR* text = field->stringValue();
+    if (text == NULL)
+      _CLTHROWA(CL_ERR_IllegalArgument, "doc values need a field with a string value");
+
+    BufferedDocValues::Value value;
+    value.field = field->name();
+    value.type = type;
+    value.number = 0;
+    value.text = NULL;
+    if (type == Field::DOCVALUES_NUMERIC) {
+      TCHAR* end = NULL;
+      value.number = _tcstoi64(text, &end, 10);
+      if (end == text || *end != 0)
+        _CLTHROWA(CL_ERR_NumberFormat, "numeric doc values must be decimal integers");
+    } else {
+      value.text = stringDuplicate(text);
+    }
+    docValues.push_back(value);
+  }
+
   // Absorb any new fields first seen in this document.
   // Also absorb any changes to fields we had already
   // seen before (eg suddenly turning on norms or
@@ -202,7 +237,7 @@ void DocumentsWriter::ThreadState::init(Document* doc, int32_t docID) {
 
     FieldInfo* fi = _parent->fieldInfos->add(field->name(), field->isIndexed(), field->isTermVectorStored(),
                                   field->isStorePositionWithTermVector(), field->isStoreOffsetWithTermVector(),
-                                  field->getOmitNorms(), false);
+                                  field->getOmitNorms(), false, field->getOmitTf());
     if (fi->isIndexed && !fi->omitNorms) {
       // Maybe grow our buffered norms
       if (_parent->norms.length <= fi->number) {
@@ -291,6 +326,10 @@ void DocumentsWriter::ThreadState::init(Document* doc, int32_t docID) {
     fp->docFields.values[fp->fieldCount++] = field;
   }
 
+  // The names of the field infos outlive the document
+  for(size_t i=0;i<docValues.size();i++)
+    docValues[i].field = _parent->fieldInfos->fieldInfo(docValues[i].field)->name;
+
   // Maybe init the local & global fieldsWriter
   if (localFieldsWriter == NULL) {
     if (_parent->fieldsWriter == NULL) {
@@ -302,7 +341,8 @@ void DocumentsWriter::ThreadState::init(Document* doc, int32_t docID) {
       // because those files will be in an unknown
       // state:
       try {
-        _parent->fieldsWriter = _CLNEW FieldsWriter(_parent->directory, _parent->docStoreSegment.c_str(), _parent->fieldInfos);
+        _parent->fieldsWriter = _CLNEW FieldsWriter(_parent->directory, _parent->docStoreSegment.c_str(), _parent->fieldInfos,
+                                                    _parent->writer->getStoredFieldsCompression());
       } catch (CLuceneError& t) {
         throw AbortException(t,_parent);
       }
@@ -1162,19 +1202,23 @@ void DocumentsWriter::ThreadState::FieldData::addPosition(Token* token) {
       proxCode = position;
     }
 
-    threadState->proxUpto = threadState->p->proxUpto & BYTE_BLOCK_MASK;
-    threadState->prox = threadState->postingsPool->buffers[threadState->p->proxUpto >> BYTE_BLOCK_SHIFT];
-    assert (threadState->prox != NULL);
-
-    if (payload != NULL && payload->length() > 0) {
-      threadState->writeProxVInt((proxCode<<1)|1);
-      threadState->writeProxVInt(payload->length());
-      threadState->writeProxBytes(payload->getData().values, payload->getOffset(), payload->length());
-      fieldInfo->storePayloads = true;
-    } else
-      threadState->writeProxVInt(proxCode<<1);
-
-    threadState->p->proxUpto = threadState->proxUpto + (threadState->p->proxUpto & BYTE_BLOCK_NOT_MASK);
+    // Positions and payloads of a field that omits tf
+    // are never flushed, so don't buffer them
+    if (!fieldInfo->omitTf) {
+      threadState->proxUpto = threadState->p->proxUpto & BYTE_BLOCK_MASK;
+      threadState->prox = threadState->postingsPool->buffers[threadState->p->proxUpto >> BYTE_BLOCK_SHIFT];
+      assert (threadState->prox != NULL);
+
+      if (payload != NULL && payload->length() > 0) {
+        threadState->writeProxVInt((proxCode<<1)|1);
+        threadState->writeProxVInt(payload->length());
+        threadState->writeProxBytes(payload->getData().values, payload->getOffset(), payload->length());
+        fieldInfo->storePayloads = true;
+      } else
+        threadState->writeProxVInt(proxCode<<1);
+
+      threadState->p->proxUpto = threadState->proxUpto + (threadState->p->proxUpto & BYTE_BLOCK_NOT_MASK);
+    }
 
     threadState->p->lastPosition = position++;
 
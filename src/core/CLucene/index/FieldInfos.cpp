@@ -29,14 +29,15 @@ FieldInfo::FieldInfo(	const TCHAR* _fieldName,
 						const bool _storeOffsetWithTermVector,
 						const bool _storePositionWithTermVector,
 						const bool _omitNorms,
-						const bool _storePayloads):
+						const bool _storePayloads,
+						const bool _omitTf):
 	name(CLStringIntern::intern(_fieldName )),
 	isIndexed(_isIndexed),
 	number(_fieldNumber),
 	storeTermVector(_storeTermVector),
 	storeOffsetWithTermVector(_storeOffsetWithTermVector),
 	storePositionWithTermVector(_storePositionWithTermVector),
-	omitNorms(_omitNorms), storePayloads(_storePayloads)
+	omitNorms(_omitNorms), storePayloads(_storePayloads), omitTf(_omitTf)
 {
 }
 
@@ -46,7 +47,7 @@ FieldInfo::~FieldInfo(){
 
 FieldInfo* FieldInfo::clone() {
 	return _CLNEW FieldInfo(name, isIndexed, number, storeTermVector, storePositionWithTermVector,
-		storeOffsetWithTermVector, omitNorms, storePayloads);
+		storeOffsetWithTermVector, omitNorms, storePayloads, omitTf);
 }
 
 FieldInfos::FieldInfos():
@@ -88,7 +89,7 @@ void FieldInfos::add(const Document* doc) {
   for ( Document::FieldsType::const_iterator itr = fields.begin() ; itr != fields.end() ; itr++ ){
 			field = *itr;
 			add(field->name(), field->isIndexed(), field->isTermVectorStored(), field->isStorePositionWithTermVector(),
-              field->isStoreOffsetWithTermVector(), field->getOmitNorms());
+              field->isStoreOffsetWithTermVector(), field->getOmitNorms(), false, field->getOmitTf());
 	}
 }
 
@@ -102,24 +103,25 @@ void FieldInfos::addIndexed(const TCHAR** names, const bool storeTermVectors, co
 }
 
 void FieldInfos::add(const TCHAR** names,const bool isIndexed, const bool storeTermVectors,
-					 const bool storePositionWithTermVector, const bool storeOffsetWithTermVector, const bool omitNorms, const bool storePayloads)
+					 const bool storePositionWithTermVector, const bool storeOffsetWithTermVector, const bool omitNorms, const bool storePayloads,
+					 const bool omitTf)
 {
 	size_t i=0;      
 	while ( names[i] != NULL ){
 		add(names[i], isIndexed, storeTermVectors, storePositionWithTermVector, 
-			storeOffsetWithTermVector, omitNorms, storePayloads);
+			storeOffsetWithTermVector, omitNorms, storePayloads, omitTf);
 		++i;
 	}
 }
 
 FieldInfo* FieldInfos::add( const TCHAR* name, const bool isIndexed, const bool storeTermVector,
 		const bool storePositionWithTermVector, const bool storeOffsetWithTermVector, const bool omitNorms,
-		const bool storePayloads) {
+		const bool storePayloads, const bool omitTf) {
 	FieldInfo* fi = fieldInfo(name);
 	if (fi == NULL) {
 		return addInternal(name, isIndexed, storeTermVector, 
 			storePositionWithTermVector, 
-			storeOffsetWithTermVector, omitNorms, storePayloads);
+			storeOffsetWithTermVector, omitNorms, storePayloads, omitTf);
 	} else {
 		if (fi->isIndexed != isIndexed) {
 			fi->isIndexed = true;                      // once indexed, always index
@@ -139,16 +141,19 @@ FieldInfo* FieldInfos::add( const TCHAR* name, const bool isIndexed, const bool
 		if (fi->storePayloads != storePayloads) {
 			fi->storePayloads = true;
 		}
+		if (fi->omitTf != omitTf) {
+			fi->omitTf = true;                // once tf is omitted, always omit it
+		}
 	}
 	return fi;
 }
 
 FieldInfo* FieldInfos::addInternal( const TCHAR* name, const bool isIndexed, const bool storeTermVector,
 		const bool storePositionWithTermVector, const bool storeOffsetWithTermVector,
-		const bool omitNorms, const bool storePayloads) {
+		const bool omitNorms, const bool storePayloads, const bool omitTf) {
 
 	FieldInfo* fi = _CLNEW FieldInfo(name, isIndexed, byNumber.size(), storeTermVector, 
-		storePositionWithTermVector, storeOffsetWithTermVector, omitNorms, storePayloads);
+		storePositionWithTermVector, storeOffsetWithTermVector, omitNorms, storePayloads, omitTf);
 	byNumber.push_back(fi);
 	byName.put( fi->name, fi);
 	return fi;
@@ -210,6 +215,7 @@ void FieldInfos::write(IndexOutput* output) const{
  		if (fi->storeOffsetWithTermVector) bits |= STORE_OFFSET_WITH_TERMVECTOR;
  		if (fi->omitNorms) bits |= OMIT_NORMS;
 		if (fi->storePayloads) bits |= STORE_PAYLOADS;
+		if (fi->omitTf) bits |= OMIT_TF;
 
 	    output->writeString(fi->name,_tcslen(fi->name));
 	    output->writeByte(bits);
@@ -219,7 +225,7 @@ void FieldInfos::write(IndexOutput* output) const{
 void FieldInfos::read(IndexInput* input) {
 	int32_t size = input->readVInt();//read in the size
     uint8_t bits;
-	bool isIndexed,storeTermVector,storePositionsWithTermVector,storeOffsetWithTermVector,omitNorms,storePayloads;
+	bool isIndexed,storeTermVector,storePositionsWithTermVector,storeOffsetWithTermVector,omitNorms,storePayloads,omitTf;
 	for (int32_t i = 0; i < size; ++i){
 	    TCHAR* name = input->readString(); //we could read name into a string buffer, but we can't be sure what the maximum field length will be.
 		bits = input->readByte();
@@ -229,8 +235,9 @@ void FieldInfos::read(IndexInput* input) {
    		storeOffsetWithTermVector = (bits & STORE_OFFSET_WITH_TERMVECTOR) != 0;
    		omitNorms = (bits & OMIT_NORMS) != 0;
 		storePayloads = (bits & STORE_PAYLOADS) != 0;
+		omitTf = (bits & OMIT_TF) != 0;
    
-   		addInternal(name, isIndexed, storeTermVector, storePositionsWithTermVector, storeOffsetWithTermVector, omitNorms, storePayloads);
+   		addInternal(name, isIndexed, storeTermVector, storePositionsWithTermVector, storeOffsetWithTermVector, omitNorms, storePayloads, omitTf);
    		_CLDELETE_CARRAY(name);
 	}
 }
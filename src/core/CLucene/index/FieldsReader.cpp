@@ -9,6 +9,7 @@
 #include <assert.h>
 #include "CLucene/util/Misc.h"
 #include "CLucene/util/_StringIntern.h"
+#include "CLucene/util/_FastCompress.h"
 #include "CLucene/util/CLStreams.h"
 #include "CLucene/store/Directory.h"
 #include "CLucene/store/IndexInput.h"
@@ -27,7 +28,8 @@ CL_NS_DEF(index)
 
 FieldsReader::FieldsReader(Directory* d, const char* segment, FieldInfos* fn, int32_t _readBufferSize, int32_t _docStoreOffset, int32_t size):
 	fieldInfos(fn), cloneableFieldsStream(NULL), fieldsStream(NULL), indexStream(NULL),
-        numTotalDocs(0),_size(0), closed(false),docStoreOffset(0)
+        numTotalDocs(0),_size(0), closed(false),docStoreOffset(0), format(0), formatSize(0),
+	blocksStream(NULL), blockInput(NULL), blockPointer(-1), blockDocBase(0), blockNumDocs(0)
 {
 //Func - Constructor
 //Pre  - d contains a valid reference to a Directory
@@ -41,10 +43,23 @@ FieldsReader::FieldsReader(Directory* d, const char* segment, FieldInfos* fn, in
 
 	try {
 		cloneableFieldsStream = d->openInput( Misc::segmentname(segment,".fdt").c_str(), _readBufferSize );
-		fieldsStream = cloneableFieldsStream->clone();
 
 		indexStream = d->openInput( Misc::segmentname(segment,".fdx").c_str(), _readBufferSize );
 
+		// The first entry of a file without a format points to
+		// its first document, at 0
+		if (indexStream->length() >= FieldsWriter::FORMAT_SIZE)
+			format = indexStream->readInt();
+		if (format > FieldsWriter::FORMAT_COMPRESSED_BLOCKS)
+			_CLTHROWA(CL_ERR_CorruptIndex, "Incompatible format version for stored fields");
+		if (format != 0) {
+			formatSize = FieldsWriter::FORMAT_SIZE;
+			blocksStream = cloneableFieldsStream->clone();
+			fieldsStream = blockInput = _CLNEW BlockInput();
+		} else
+			fieldsStream = cloneableFieldsStream->clone();
+
+		const int64_t indexSize = indexStream->length() - formatSize;
 		if (_docStoreOffset != -1) {
 			// We read only a slice out of this shared fields file
 			this->docStoreOffset = _docStoreOffset;
@@ -52,16 +67,16 @@ FieldsReader::FieldsReader(Directory* d, const char* segment, FieldInfos* fn, in
 
 			// Verify the file is long enough to hold all of our
 			// docs
-			CND_CONDITION(((int32_t) (indexStream->length() / 8)) >= size + this->docStoreOffset,
+			CND_CONDITION(((int32_t) (indexSize / 8)) >= size + this->docStoreOffset,
 				"the file is not long enough to hold all of our docs");
 		} else {
 			this->docStoreOffset = 0;
-			this->_size = (int32_t) (indexStream->length() >> 3);
+			this->_size = (int32_t) (indexSize >> 3);
 		}
 
 		//_size = (int32_t)indexStream->length()/8;
 
-		numTotalDocs = (int32_t) (indexStream->length() >> 3);
+		numTotalDocs = (int32_t) (indexSize >> 3);
 		success = true;
 	} _CLFINALLY ({
 		// With lock-less commits, it's entirely possible (and
@@ -94,6 +109,11 @@ void FieldsReader::close() {
 		if (fieldsStream){
 			fieldsStream->close();
 			_CLDELETE(fieldsStream);
+			blockInput = NULL;
+		}
+		if (blocksStream){
+			blocksStream->close();
+			_CLDELETE(blocksStream);
 		}
 		if (cloneableFieldsStream){
 			cloneableFieldsStream->close();
@@ -118,11 +138,14 @@ int32_t FieldsReader::size() const{
 }
 
 bool FieldsReader::doc(int32_t n, Document& doc, const CL_NS(document)::FieldSelector* fieldSelector) {
-  if ( (n + docStoreOffset) * 8L > indexStream->length() )
+  if ( formatSize + (n + docStoreOffset) * 8L > indexStream->length() )
       return false;
-	indexStream->seek((n + docStoreOffset) * 8L);
+	indexStream->seek(formatSize + (n + docStoreOffset) * 8L);
 	int64_t position = indexStream->readLong();
-	fieldsStream->seek(position);
+	if (blockInput != NULL)
+		seekBlockDocument(n + docStoreOffset, position);
+	else
+		fieldsStream->seek(position);
 
 	int32_t numFields = fieldsStream->readVInt();
 	for (int32_t i = 0; i < numFields; i++) {
@@ -153,7 +176,12 @@ bool FieldsReader::doc(int32_t n, Document& doc, const CL_NS(document)::FieldSel
 			break;//Get out of this loop
 		}
 		else if (acceptField == FieldSelector::LAZY_LOAD) {
-			addFieldLazy(doc, fi, binary, compressed, tokenize);
+			// a lazy field can't point into a block, but the
+			// block is already decompressed anyway
+			if (blockInput != NULL)
+				addField(doc, fi, binary, compressed, tokenize);
+			else
+				addFieldLazy(doc, fi, binary, compressed, tokenize);
 		}
 		else if (acceptField == FieldSelector::SIZE){
 			skipField(binary, compressed, addFieldSize(doc, fi, binary, compressed));
@@ -168,7 +196,85 @@ bool FieldsReader::doc(int32_t n, Document& doc, const CL_NS(document)::FieldSel
 	return true;
 }
 
+void FieldsReader::loadBlock(const int64_t pointer) {
+	if (pointer == blockPointer)
+		return;
+	blockPointer = -1;
+
+	blocksStream->seek(pointer);
+	blockDocBase = blocksStream->readVInt();
+	blockNumDocs = blocksStream->readVInt();
+	if (blockOffsets.length < (size_t)blockNumDocs + 1)
+		blockOffsets.resize(blockNumDocs + 1);
+	int32_t length = 0;
+	blockOffsets.values[0] = 0;
+	for (int32_t i = 0; i < blockNumDocs; i++) {
+		length += blocksStream->readVInt();
+		blockOffsets.values[i + 1] = length;
+	}
+
+	const uint8_t codec = blocksStream->readByte();
+	const int32_t dataLength = blocksStream->readVInt();
+	if (codec == FieldsWriter::BLOCK_STORED) {
+		if (dataLength != length)
+			_CLTHROWA(CL_ERR_CorruptIndex, "stored fields block has an invalid length");
+		if (block.length < (size_t)length)
+			block.resize(length);
+		blocksStream->readBytes(block.values, length);
+	} else {
+		if (compressedBlock.length < (size_t)dataLength)
+			compressedBlock.resize(dataLength);
+		blocksStream->readBytes(compressedBlock.values, dataLength);
+		if (codec == FieldsWriter::BLOCK_FAST) {
+			if (block.length < (size_t)length)
+				block.resize(length);
+			FastCompress::decompress(compressedBlock.values, dataLength, block.values, length);
+		} else if (codec == FieldsWriter::BLOCK_DEFLATE) {
+			ValueArray<uint8_t> input;
+			input.values = compressedBlock.values;
+			input.length = dataLength;
+			try {
+				uncompress(input, block);
+			} _CLFINALLY( input.values = NULL; )
+			if (block.length != (size_t)length + 1)
+				_CLTHROWA(CL_ERR_CorruptIndex, "stored fields block has an invalid length");
+		} else
+			_CLTHROWA(CL_ERR_CorruptIndex, "unknown stored fields block codec");
+	}
+	blockPointer = pointer;
+}
+
+void FieldsReader::seekBlockDocument(const int32_t docID, const int64_t pointer) {
+	loadBlock(pointer);
+	const int32_t i = docID - blockDocBase;
+	if (i < 0 || i >= blockNumDocs)
+		_CLTHROWA(CL_ERR_CorruptIndex, "stored fields block doesn't hold the document");
+	blockInput->reset(block.values, blockOffsets[blockNumDocs]);
+	blockInput->seek(blockOffsets[i]);
+}
+
 CL_NS(store)::IndexInput* FieldsReader::rawDocs(int32_t* lengths, const int32_t startDocID, const int32_t numDocs) {
+	if (blockInput != NULL) {
+		// hand out the decompressed documents, which writers
+		// of both formats can copy
+		indexStream->seek(formatSize + (docStoreOffset+startDocID) * 8L);
+		int32_t length = 0;
+		for (int32_t count = 0; count < numDocs; count++) {
+			loadBlock(indexStream->readLong());
+			const int32_t i = docStoreOffset + startDocID + count - blockDocBase;
+			if (i < 0 || i >= blockNumDocs)
+				_CLTHROWA(CL_ERR_CorruptIndex, "stored fields block doesn't hold the document");
+			const int32_t docLength = blockOffsets[i + 1] - blockOffsets[i];
+			if (rawBlock.length < (size_t)(length + docLength))
+				rawBlock.resize((length + docLength) * 2);
+			memcpy(rawBlock.values + length, block.values + blockOffsets[i], docLength);
+			lengths[count] = docLength;
+			length += docLength;
+		}
+		blockInput->reset(rawBlock.values, length);
+		return blockInput;
+	}
+
 	indexStream->seek((docStoreOffset+startDocID) * 8L);
 	int64_t startOffset = indexStream->readLong();
 	int64_t lastOffset = startOffset;
@@ -225,6 +331,7 @@ void FieldsReader::addFieldLazy(CL_NS(document)::Document& doc, const FieldInfo*
 			//skip over the part that we aren't loading
 			fieldsStream->seek(pointer + toRead);
 			f->setOmitNorms(fi->omitNorms);
+			f->setOmitTf(fi->omitTf);
 		} else {
 			int32_t length = fieldsStream->readVInt();
 			int64_t pointer = fieldsStream->getFilePointer();
@@ -232,6 +339,7 @@ void FieldsReader::addFieldLazy(CL_NS(document)::Document& doc, const FieldInfo*
 			fieldsStream->skipChars(length);
 			f = _CLNEW LazyField(this, fi->name, Field::STORE_YES | getIndexType(fi, tokenize) | getTermVectorType(fi), length, pointer);
 			f->setOmitNorms(fi->omitNorms);
+			f->setOmitTf(fi->omitTf);
 		}
 		doc.add(*f);
 	}
@@ -317,6 +425,7 @@ void FieldsReader::addField(CL_NS(document)::Document& doc, const FieldInfo* fi,
         bits, false);
 #endif
       f->setOmitNorms(fi->omitNorms);
+      f->setOmitTf(fi->omitTf);
 		} else {
 			bits |= Field::STORE_YES;
       TCHAR* str = fieldsStream->readString();
@@ -324,6 +433,7 @@ void FieldsReader::addField(CL_NS(document)::Document& doc, const FieldInfo* fi,
 				str, // read value
 				bits, false);
 			f->setOmitNorms(fi->omitNorms);
+			f->setOmitTf(fi->omitTf);
 		}
 		doc.add(*f);
 	}
@@ -545,6 +655,63 @@ const char* FieldsReader::FieldForMerge::getObjectName() const{
   return getClassName();
 }
 
+FieldsReader::BlockInput::BlockInput():
+	data(NULL), _length(0), pos(0)
+{
+}
+FieldsReader::BlockInput::BlockInput(const BlockInput& other):
+	IndexInput(other), data(other.data), _length(other._length), pos(other.pos)
+{
+}
+FieldsReader::BlockInput::~BlockInput(){
+}
+
+void FieldsReader::BlockInput::reset(const uint8_t* _data, const int32_t len) {
+	data = _data;
+	_length = len;
+	pos = 0;
+}
+
+uint8_t FieldsReader::BlockInput::readByte() {
+	if (pos >= _length)
+		_CLTHROWA(CL_ERR_IO, "read past EOF");
+	return data[pos++];
+}
+
+void FieldsReader::BlockInput::readBytes(uint8_t* b, const int32_t len) {
+	if (len > _length - pos)
+		_CLTHROWA(CL_ERR_IO, "read past EOF");
+	memcpy(b, data + pos, len);
+	pos += len;
+}
+
+int64_t FieldsReader::BlockInput::getFilePointer() const {
+	return pos;
+}
+
+void FieldsReader::BlockInput::seek(const int64_t _pos) {
+	if (_pos < 0 || _pos > _length)
+		_CLTHROWA(CL_ERR_IO, "seek past EOF");
+	pos = (int32_t)_pos;
+}
+
+int64_t FieldsReader::BlockInput::length() const {
+	return _length;
+}
+
+void FieldsReader::BlockInput::close() {
+	data = NULL;
+	_length = pos = 0;
+}
+
+CL_NS(store)::IndexInput* FieldsReader::BlockInput::clone() const {
+	return _CLNEW BlockInput(*this);
+}
+
+const char* FieldsReader::BlockInput::getDirectoryType() const { return "BLOCK"; }
+const char* FieldsReader::BlockInput::getObjectName() const { return getClassName(); }
+const char* FieldsReader::BlockInput::getClassName() { return "FieldsReader::BlockInput"; }
+
 void FieldsReader::uncompress(const CL_NS(util)::ValueArray<uint8_t>& input, CL_NS(util)::ValueArray<uint8_t>& output){
   stringstream out;
   string err;
@@ -10,6 +10,7 @@
 //#include "CLucene/util/VoidMap.h"
 #include "CLucene/util/CLStreams.h"
 #include "CLucene/util/Misc.h"
+#include "CLucene/util/_FastCompress.h"
 #include "CLucene/store/Directory.h"
 #include "CLucene/store/_RAMDirectory.h"
 #include "CLucene/store/IndexOutput.h"
@@ -24,8 +25,9 @@ CL_NS_USE(util)
 CL_NS_USE(document)
 CL_NS_DEF(index)
 
-FieldsWriter::FieldsWriter(Directory* d, const char* segment, FieldInfos* fn):
-	fieldInfos(fn)
+FieldsWriter::FieldsWriter(Directory* d, const char* segment, FieldInfos* fn, const int32_t _compression):
+	fieldInfos(fn), compression(_compression), blocksStream(NULL), blockBuffer(NULL),
+	blockNumDocs(0), numDocs(0)
 {
 //Func - Constructor
 //Pre  - d contains a valid reference to a directory
@@ -42,11 +44,19 @@ FieldsWriter::FieldsWriter(Directory* d, const char* segment, FieldInfos* fn):
 
 	CND_CONDITION(indexStream != NULL,"indexStream is NULL");
 
+	if (compression != 0) {
+		indexStream->writeInt(FORMAT_COMPRESSED_BLOCKS);
+		blocksStream = fieldsStream;
+		fieldsStream = blockBuffer = _CLNEW RAMOutputStream();
+		blockDocLengths.resize(MAX_BLOCK_DOCS);
+	}
+
 	doClose = true;
 }
 
 FieldsWriter::FieldsWriter(CL_NS(store)::IndexOutput* fdx, CL_NS(store)::IndexOutput* fdt, FieldInfos* fn):
-	fieldInfos(fn)
+	fieldInfos(fn), compression(0), blocksStream(NULL), blockBuffer(NULL),
+	blockNumDocs(0), numDocs(0)
 {
 	fieldsStream = fdt;
 	CND_CONDITION(fieldsStream != NULL,"fieldsStream is NULL");
@@ -71,6 +81,17 @@ void FieldsWriter::close() {
 	if (! doClose )
 		return;
 
+	if (blocksStream){
+		try {
+			flushBlock();
+		} _CLFINALLY (
+			blocksStream->close();
+			_CLDELETE( blocksStream );
+			_CLDELETE( blockBuffer );
+			fieldsStream = NULL;
+		);
+	}
+
 	//Check if fieldsStream is valid
 	if (fieldsStream){
 		//Close fieldsStream
@@ -96,7 +117,8 @@ void FieldsWriter::addDocument(Document* doc) {
 	CND_PRECONDITION(indexStream != NULL,"indexStream is NULL");
 	CND_PRECONDITION(fieldsStream != NULL,"fieldsStream is NULL");
 
-	indexStream->writeLong(fieldsStream->getFilePointer());
+	startDocument();
+	const int64_t start = fieldsStream->getFilePointer();
 
 	int32_t storedCount = 0;
   {
@@ -117,6 +139,79 @@ void FieldsWriter::addDocument(Document* doc) {
 		  }
 	  }
   }
+  finishDocument(start);
+}
+
+void FieldsWriter::startDocument() {
+	// documents of the pending block will be found at the
+	// pointer the block is written to
+	if (blocksStream != NULL)
+		indexStream->writeLong(blocksStream->getFilePointer());
+	else
+		indexStream->writeLong(fieldsStream->getFilePointer());
+}
+
+void FieldsWriter::finishDocument(const int64_t start) {
+	numDocs++;
+	if (blocksStream == NULL)
+		return;
+	blockDocLengths.values[blockNumDocs++] = (int32_t)(fieldsStream->getFilePointer() - start);
+	if (blockNumDocs == MAX_BLOCK_DOCS || fieldsStream->getFilePointer() >= BLOCK_SIZE)
+		flushBlock();
+}
+
+void FieldsWriter::flushBlock() {
+	if (blockNumDocs == 0)
+		return;
+
+	const int32_t length = (int32_t)blockBuffer->getFilePointer();
+	if (blockBytes.length < (size_t)length)
+		blockBytes.resize(length);
+	blockBuffer->writeTo(blockBytes.values);
+
+	blocksStream->writeVInt(numDocs - blockNumDocs);
+	blocksStream->writeVInt(blockNumDocs);
+	for (int32_t i = 0; i < blockNumDocs; i++)
+		blocksStream->writeVInt(blockDocLengths[i]);
+
+	const uint8_t* data = blockBytes.values;
+	int32_t dataLength = length;
+	uint8_t codec = BLOCK_STORED;
+	if (compression == BLOCK_FAST) {
+		const int32_t maxLength = FastCompress::maxCompressedLength(length);
+		if (compressedBytes.length < (size_t)maxLength)
+			compressedBytes.resize(maxLength);
+		dataLength = FastCompress::compress(blockBytes.values, length, compressedBytes.values);
+		data = compressedBytes.values;
+		codec = BLOCK_FAST;
+	} else if (compression == BLOCK_DEFLATE) {
+		CL_NS(util)::ValueArray<uint8_t> input;
+		input.values = blockBytes.values;
+		input.length = length;
+		try {
+			compress(input, compressedBytes);
+		} _CLFINALLY( input.values = NULL; )
+		dataLength = (int32_t)compressedBytes.length;
+		data = compressedBytes.values;
+		codec = BLOCK_DEFLATE;
+	}
+	if (dataLength >= length) {
+		// not worth decompressing
+		data = blockBytes.values;
+		dataLength = length;
+		codec = BLOCK_STORED;
+	}
+
+	blocksStream->writeByte(codec);
+	blocksStream->writeVInt(dataLength);
+	blocksStream->writeBytes(data, dataLength);
+
+	blockBuffer->reset();
+	blockNumDocs = 0;
+}
+
+int32_t FieldsWriter::getFormatSize() const {
+	return compression != 0 ? FORMAT_SIZE : 0;
 }
 
 void FieldsWriter::writeField(FieldInfo* fi, CL_NS(document)::Field* field)
@@ -229,17 +324,34 @@ void FieldsWriter::writeField(FieldInfo* fi, CL_NS(document)::Field* field)
 }
 
 void FieldsWriter::flushDocument(int32_t numStoredFields, CL_NS(store)::RAMOutputStream* buffer) {
-	indexStream->writeLong(fieldsStream->getFilePointer());
+	startDocument();
+	const int64_t start = fieldsStream->getFilePointer();
 	fieldsStream->writeVInt(numStoredFields);
 	buffer->writeTo(fieldsStream);
+	finishDocument(start);
 }
 
 void FieldsWriter::flush() {
+  if (blocksStream != NULL) {
+    flushBlock();
+    blocksStream->flush();
+  }
   indexStream->flush();
   fieldsStream->flush();
 }
 
 void FieldsWriter::addRawDocuments(CL_NS(store)::IndexInput* stream, const int32_t* lengths, const int32_t numDocs) {
+	if (blocksStream != NULL) {
+		// the raw documents are in the format of the blocks' data
+		for(int32_t i=0;i<numDocs;i++) {
+			startDocument();
+			const int64_t start = fieldsStream->getFilePointer();
+			fieldsStream->copyBytes(stream, lengths[i]);
+			finishDocument(start);
+		}
+		return;
+	}
+
 	int64_t position = fieldsStream->getFilePointer();
 	const int64_t start = position;
 	for(int32_t i=0;i<numDocs;i++) {
@@ -248,6 +360,7 @@ void FieldsWriter::addRawDocuments(CL_NS(store)::IndexInput* stream, const int32
 	}
 	fieldsStream->copyBytes(stream, position-start);
 	CND_CONDITION(fieldsStream->getFilePointer() == position,"fieldsStream->getFilePointer() != position");
+	this->numDocs += numDocs;
 }
 
 void FieldsWriter::compress(const CL_NS(util)::ValueArray<uint8_t>& input, CL_NS(util)::ValueArray<uint8_t>& output){
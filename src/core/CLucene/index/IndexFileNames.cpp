@@ -33,6 +33,7 @@ CL_NS_DEF(index)
 	const char* IndexFileNames::PLAIN_NORMS_EXTENSION = "f";
 	const char* IndexFileNames::SEPARATE_NORMS_EXTENSION = "s";
 	const char* IndexFileNames::GEN_EXTENSION = "gen";
+	const char* IndexFileNames::DOCVALUES_EXTENSION = "dv";
 
 	const char* IndexFileNames_INDEX_EXTENSIONS_s[] =
 		{
@@ -50,9 +51,10 @@ CL_NS_DEF(index)
 			IndexFileNames::VECTORS_FIELDS_EXTENSION,
 			IndexFileNames::GEN_EXTENSION,
 			IndexFileNames::NORMS_EXTENSION,
-			IndexFileNames::COMPOUND_FILE_STORE_EXTENSION
+			IndexFileNames::COMPOUND_FILE_STORE_EXTENSION,
+			IndexFileNames::DOCVALUES_EXTENSION
 		};
-	CL_NS(util)::ConstValueArray<const char*> IndexFileNames::INDEX_EXTENSIONS(IndexFileNames_INDEX_EXTENSIONS_s, 15 );
+	CL_NS(util)::ConstValueArray<const char*> IndexFileNames::INDEX_EXTENSIONS(IndexFileNames_INDEX_EXTENSIONS_s, 16 );
 
 	const char* IndexFileNames_INDEX_EXTENSIONS_IN_COMPOUND_FILE_s[] = {
 		IndexFileNames::FIELD_INFOS_EXTENSION,
@@ -65,9 +67,10 @@ CL_NS_DEF(index)
 		IndexFileNames::VECTORS_INDEX_EXTENSION,
 		IndexFileNames::VECTORS_DOCUMENTS_EXTENSION,
 		IndexFileNames::VECTORS_FIELDS_EXTENSION,
-		IndexFileNames::NORMS_EXTENSION
+		IndexFileNames::NORMS_EXTENSION,
+		IndexFileNames::DOCVALUES_EXTENSION
 	};
-	CL_NS(util)::ConstValueArray<const char*> IndexFileNames::INDEX_EXTENSIONS_IN_COMPOUND_FILE(IndexFileNames_INDEX_EXTENSIONS_IN_COMPOUND_FILE_s, 11 );
+	CL_NS(util)::ConstValueArray<const char*> IndexFileNames::INDEX_EXTENSIONS_IN_COMPOUND_FILE(IndexFileNames_INDEX_EXTENSIONS_IN_COMPOUND_FILE_s, 12 );
 
 	const char* IndexFileNames_STORE_INDEX_EXTENSIONS_s[] = {
 		IndexFileNames::VECTORS_INDEX_EXTENSION,
@@ -84,9 +87,10 @@ CL_NS_DEF(index)
 		IndexFileNames::PROX_EXTENSION,
 		IndexFileNames::TERMS_EXTENSION,
 		IndexFileNames::TERMS_INDEX_EXTENSION,
-		IndexFileNames::NORMS_EXTENSION
+		IndexFileNames::NORMS_EXTENSION,
+		IndexFileNames::DOCVALUES_EXTENSION
 	};
-	CL_NS(util)::ConstValueArray<const char*> IndexFileNames::NON_STORE_INDEX_EXTENSIONS(IndexFileNames_NON_STORE_INDEX_EXTENSIONS_s, 6 );
+	CL_NS(util)::ConstValueArray<const char*> IndexFileNames::NON_STORE_INDEX_EXTENSIONS(IndexFileNames_NON_STORE_INDEX_EXTENSIONS_s, 7 );
 
 	const char* IndexFileNames_COMPOUND_EXTENSIONS_s[] = {
 		IndexFileNames::FIELD_INFOS_EXTENSION,
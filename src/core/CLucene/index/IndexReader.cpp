@@ -196,6 +196,28 @@ CL_NS_DEF(index)
     _CLTHROWA(CL_ERR_UnsupportedOperation, "This reader does not support this method.");
   }
 
+  const CL_NS(util)::ArrayBase<IndexReader*>* IndexReader::getSubReaders() const{
+    return NULL;
+  }
+
+  void IndexReader::gatherSubReaders(std::vector<IndexReader*>& ret){
+    const CL_NS(util)::ArrayBase<IndexReader*>* subReaders = getSubReaders();
+    if ( subReaders == NULL ){
+      ret.push_back(this);
+      return;
+    }
+    for ( size_t i=0;i<subReaders->length;i++ )
+      subReaders->values[i]->gatherSubReaders(ret);
+  }
+
+  NumericDocValues* IndexReader::getNumericDocValues(const TCHAR* /*field*/){
+    return NULL;
+  }
+
+  SortedDocValues* IndexReader::getSortedDocValues(const TCHAR* /*field*/){
+    return NULL;
+  }
+
   uint64_t IndexReader::lastModified(Directory* directory2) {
   //Func - Static method
   //       Returns the time the index in this directory was last modified.
@@ -266,6 +288,39 @@ CL_NS_DEF(index)
       return _termDocs;
   }
 
+  int32_t IndexReader::maxTermFreq(Term* term){
+      TermDocs* _termDocs = termDocs(term);
+      int32_t docs[32];
+      int32_t freqs[32];
+      int32_t ret = 0;
+      try{
+        int32_t n;
+        while ( (n = _termDocs->read(docs, freqs, 32)) > 0 ){
+          for ( int32_t i=0;i<n;i++ ){
+            if ( freqs[i] > ret )
+              ret = freqs[i];
+          }
+        }
+      }_CLFINALLY(
+        _termDocs->close();
+        _CLDELETE(_termDocs);
+      )
+      return ret;
+  }
+
+  uint8_t IndexReader::maxNorm(const TCHAR* field){
+      uint8_t* bytes = norms(field);
+      uint8_t ret = 0;
+      if ( bytes == NULL )
+        return ret;
+      const int32_t len = maxDoc();
+      for ( int32_t i=0;i<len;i++ ){
+        if ( bytes[i] > ret )
+          ret = bytes[i];
+      }
+      return ret;
+  }
+
   TermPositions* IndexReader::termPositions(Term* term){
   //Func - Returns an enumeration of all the documents which contain  term. For each
   //       document, in addition to the document number and frequency of the term in
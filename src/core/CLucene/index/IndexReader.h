@@ -26,6 +26,8 @@ class TermDocs;
 class TermPositions;
 class IndexDeletionPolicy;
 class TermVectorMapper;
+class NumericDocValues;
+class SortedDocValues;
 
 /** IndexReader is an abstract class, providing an interface for accessing an
  index.  Search of an index is done entirely through this abstract interface,
@@ -134,7 +136,9 @@ public:
 		/** all fields where termvectors with offset and position values set */
 		TERMVECTOR_WITH_POSITION_OFFSET = 256,
 		/** all fields that store payloads */
-		STORES_PAYLOADS = 512
+		STORES_PAYLOADS = 512,
+		/** all fields that omit tf */
+		OMIT_TF = 1024
 	};
 
   /** Returns an IndexReader reading the index in an FSDirectory in the named
@@ -363,13 +367,13 @@ public:
    * an IllegalStateException is thrown.
    * @throws IllegalStateException if the term index has already been loaded into memory
    */
-  void setTermInfosIndexDivisor(int32_t indexDivisor);
+  virtual void setTermInfosIndexDivisor(int32_t indexDivisor);
 
   /** <p>For IndexReader implementations that use
    *  TermInfosReader to read terms, this returns the
    *  current indexDivisor.
    *  @see #setTermInfosIndexDivisor */
-  int32_t getTermInfosIndexDivisor();
+  virtual int32_t getTermInfosIndexDivisor();
 
   /**
    * Check whether this IndexReader is still using the
@@ -399,6 +403,38 @@ public:
    */
   virtual bool isOptimized();
 
+  /**
+   * Expert: returns the readers this reader is composed of, in document
+   * order, or NULL if it is not composed of other readers (for example a
+   * single segment). Caches which are kept per sub reader, like the
+   * FieldCache, survive a {@link #reopen()} which keeps the sub reader.
+   */
+  virtual const CL_NS(util)::ArrayBase<IndexReader*>* getSubReaders() const;
+
+  /**
+   * Expert: appends the readers of the single segments this reader is
+   * composed of to ret, in document order, following the
+   * {@link #getSubReaders sub readers} of sub readers. A reader which is not
+   * composed of other readers appends itself.
+   */
+  void gatherSubReaders(std::vector<IndexReader*>& ret);
+
+  /**
+   * Expert: returns the values of field which were added with
+   * {@link lucene::document::Field::DOCVALUES_NUMERIC}, or NULL if there are
+   * none. Only readers of a single segment hold doc values, the values of
+   * other readers are held by their {@link #getSubReaders sub readers}.
+   * @memory the values belong to the reader and are valid until it is closed
+   */
+  virtual NumericDocValues* getNumericDocValues(const TCHAR* field);
+
+  /**
+   * Expert: returns the values of field which were added with
+   * {@link lucene::document::Field::DOCVALUES_SORTED}, or NULL if there are
+   * none. See {@link #getNumericDocValues}.
+   */
+  virtual SortedDocValues* getSortedDocValues(const TCHAR* field);
+
   /**
    *  Return an array of term frequency vectors for the specified document.
    *  The array contains a vector for each vectorized field in the document.
@@ -549,6 +585,21 @@ public:
    */
 	virtual int32_t docFreq(const Term* t) = 0;
 
+	/** Expert: returns the highest frequency of the term <code>t</code> in
+	* the documents which are not deleted, or 0 if there is none. Used as
+	* an upper bound of the term's score by dynamic pruning.
+	* The default implementation scans the postings of the term, SegmentReader
+	* caches the result.
+	* @throws IOException if there is a low-level IO error
+	*/
+	virtual int32_t maxTermFreq(Term* t);
+
+	/** Expert: returns the highest byte-encoded normalization factor of the
+	* named field, see {@link #norms(const TCHAR*)}.
+	* The default implementation scans the norms, SegmentReader caches the result.
+	*/
+	virtual uint8_t maxNorm(const TCHAR* field);
+
 	/* Returns an unpositioned TermPositions enumerator.
    * @throws IOException if there is a low-level IO error
 	 * @memory Caller must clean up
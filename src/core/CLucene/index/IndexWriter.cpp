@@ -15,6 +15,7 @@
 #include "CLucene/store/_Lock.h"
 #include "CLucene/store/_RAMDirectory.h"
 #include "CLucene/store/FSDirectory.h"
+#include "CLucene/store/IndexInput.h"
 #include "CLucene/util/Array.h"
 #include "CLucene/util/PriorityQueue.h"
 #include "_DocumentsWriter.h"
@@ -28,9 +29,13 @@
 #include "MergeScheduler.h"
 #include "_IndexFileDeleter.h"
 #include "_Term.h"
+#include "_MultiSegmentReader.h"
+#include "DirectoryIndexReader.h"
 #include <assert.h>
 #include <algorithm>
 #include <iostream>
+#include <map>
+#include <set>
 
 CL_NS_USE(store)
 CL_NS_USE(util)
@@ -52,6 +57,7 @@ const int32_t IndexWriter::DEFAULT_MAX_MERGE_DOCS = LogDocMergePolicy::DEFAULT_M
 const int32_t IndexWriter::DEFAULT_MERGE_FACTOR = LogMergePolicy::DEFAULT_MERGE_FACTOR;
 
 DEFINE_MUTEX(IndexWriter::MESSAGE_ID_LOCK)
+DEFINE_MUTEX(IndexWriter::READERS_LOCK)
 int32_t IndexWriter::MESSAGE_ID = 0;
 const int32_t IndexWriter::MAX_TERM_LENGTH = DocumentsWriter::MAX_TERM_LENGTH;
 
@@ -69,9 +75,28 @@ public:
 
   // Apply buffered delete terms to this reader.
   void applyDeletes(const DocumentsWriter::TermNumMapType& deleteTerms, IndexReader* reader);
+
+  // The open readers returned by getReader and the files they reference
+  typedef std::map<DirectoryIndexReader*, std::vector<std::string> > ReadersType;
+  ReadersType readers;
+
+  // A segment reader kept open across flushes and merges
+  struct PooledReader{
+    SegmentReader* reader;
+    std::vector<std::string> files; // referenced in the deleter while it is open
+    int64_t delGen;                 // the generation of the deletions it has
+    int32_t refCount;               // the number of users, which is at most 1
+  };
+  typedef std::map<std::string, PooledReader> PooledReadersType;
+  PooledReadersType pooledReaders;
+
+  // Closes the pooled reader
+  void dropPooledReader(PooledReadersType::iterator itr);
 };
 
 IndexWriter::~IndexWriter(){
+  detachReaders();
+  dropPooledReaders(true);
   if (writeLock != NULL) {
     writeLock->release();                        // release write lock
     _CLLDELETE(writeLock);
@@ -150,6 +175,18 @@ int32_t IndexWriter::getTermIndexInterval() {
   return termIndexInterval;
 }
 
+void IndexWriter::setStoredFieldsCompression(int32_t compression) {
+  ensureOpen();
+  if (compression < STORED_FIELDS_UNCOMPRESSED || compression > STORED_FIELDS_DEFLATE)
+    _CLTHROWA(CL_ERR_IllegalArgument, "unknown stored fields compression");
+  this->storedFieldsCompression = compression;
+}
+
+int32_t IndexWriter::getStoredFieldsCompression() {
+  ensureOpen();
+  return storedFieldsCompression;
+}
+
 IndexWriter::IndexWriter(const char* path, Analyzer* a, bool create):bOwnsDirectory(true){
     init(FSDirectory::getDirectory(path, create), a, create, true, (IndexDeletionPolicy*)NULL, true);
 }
@@ -178,7 +215,9 @@ void IndexWriter::init(Directory* d, Analyzer* a, const bool create, const bool
                        IndexDeletionPolicy* deletionPolicy, const bool autoCommit){
   this->_internal = new Internal(this);
   this->termIndexInterval = IndexWriter::DEFAULT_TERM_INDEX_INTERVAL;
-  this->mergeScheduler = _CLNEW SerialMergeScheduler(); //TODO: implement and use ConcurrentMergeScheduler
+  this->storedFieldsCompression = IndexWriter::STORED_FIELDS_UNCOMPRESSED;
+  this->mergeScheduler = _CLNEW ConcurrentMergeScheduler();
+  this->mergeThreadPool = NULL;
   this->mergingSegments = _CLNEW MergingSegmentsType;
   this->pendingMerges = _CLNEW PendingMergesType;
   this->runningMerges = _CLNEW RunningMergesType;
@@ -309,6 +348,16 @@ MergeScheduler* IndexWriter::getMergeScheduler() {
   return mergeScheduler;
 }
 
+void IndexWriter::setMergeThreadPool(ThreadPool* pool) {
+  ensureOpen();
+  this->mergeThreadPool = pool;
+}
+
+ThreadPool* IndexWriter::getMergeThreadPool() {
+  ensureOpen();
+  return mergeThreadPool;
+}
+
 void IndexWriter::setMaxMergeDocs(int32_t maxMergeDocs) {
   getLogMergePolicy()->setMaxMergeDocs(maxMergeDocs);
 }
@@ -515,6 +564,10 @@ void IndexWriter::closeInternal(bool waitForMerges) {
 
     mergeScheduler->close();
 
+    // the files of the readers stay referenced, so they
+    // are not deleted by the commit below
+    detachReaders();
+
     { SCOPED_LOCK_MUTEX(this->THIS_LOCK)
       if (commitPending) {
         bool success = false;
@@ -542,6 +595,7 @@ void IndexWriter::closeInternal(bool waitForMerges) {
       if (infoStream != NULL)
         message("at close: " + segString());
 
+      dropPooledReaders(true);
       _CLDELETE(docWriter);
       deleter->close();
     }
@@ -572,7 +626,8 @@ void IndexWriter::closeInternal(bool waitForMerges) {
 bool IndexWriter::flushDocStores() {
 	SCOPED_LOCK_MUTEX(THIS_LOCK)
 
-  const std::vector<std::string>& files = docWriter->files();
+  // a copy, since closing the doc store clears the files of docWriter
+  const std::vector<std::string> files = docWriter->files();
 
   bool useCompoundDocStore = false;
 
@@ -878,16 +933,12 @@ bool IndexWriter::optimizeMergesPending() {
       it != pendingMerges->end(); it++){
     if ((*it)->optimize)
       return true;
-
-    it++;
   }
 
   for(RunningMergesType::iterator it = runningMerges->begin();
       it != runningMerges->end(); it++){
     if ((*it)->optimize)
       return true;
-
-    it++;
   }
 
   return false;
@@ -980,33 +1031,40 @@ void IndexWriter::startTransaction() {
 }
 
 void IndexWriter::rollbackTransaction() {
-	SCOPED_LOCK_MUTEX(THIS_LOCK)
+  { SCOPED_LOCK_MUTEX(this->THIS_LOCK)
 
-  if (infoStream != NULL)
-    message(string("now rollback transaction"));
+    if (infoStream != NULL)
+      message(string("now rollback transaction"));
 
-  // First restore autoCommit in case we hit an exception below:
-  autoCommit = localAutoCommit;
+    // First restore autoCommit in case we hit an exception below:
+    autoCommit = localAutoCommit;
 
-  // Keep the same segmentInfos instance but replace all
-  // of its SegmentInfo instances.  This is so the next
-  // attempt to commit using this instance of IndexWriter
-  // will always write to a _CLNEW generation ("write once").
-  segmentInfos->clear();
-  segmentInfos->insert(localRollbackSegmentInfos, true);
-  _CLDELETE(localRollbackSegmentInfos);
+    // Keep the same segmentInfos instance but replace all
+    // of its SegmentInfo instances.  This is so the next
+    // attempt to commit using this instance of IndexWriter
+    // will always write to a _CLNEW generation ("write once").
+    segmentInfos->clear();
+    segmentInfos->insert(localRollbackSegmentInfos, true);
+    _CLDELETE(localRollbackSegmentInfos);
 
-  // Ask deleter to locate unreferenced files we had
-  // created & remove them:
-  deleter->checkpoint(segmentInfos, false);
+    // Ask deleter to locate unreferenced files we had
+    // created & remove them:
+    deleter->checkpoint(segmentInfos, false);
 
-  if (!autoCommit)
-    // Remove the incRef we did in startTransaction:
-    deleter->decRef(segmentInfos);
+    if (!autoCommit)
+      // Remove the incRef we did in startTransaction:
+      deleter->decRef(segmentInfos);
 
-  deleter->refresh();
+    deleter->refresh();
+  }
+
+  // finishMerges may wait for background merges, which
+  // need THIS_LOCK: don't hold it more than once while
+  // waiting, or the wait would not release it
   finishMerges(false);
-  stopMerges = false;
+  { SCOPED_LOCK_MUTEX(this->THIS_LOCK)
+    stopMerges = false;
+  }
 }
 
 void IndexWriter::commitTransaction() {
@@ -1144,6 +1202,9 @@ void IndexWriter::finishMerges(bool waitForMerges) {
 
 void IndexWriter::checkpoint() {
 	SCOPED_LOCK_MUTEX(THIS_LOCK)
+  //tells the readers returned by getReader that they are not current
+  segmentInfos->changed();
+  dropPooledReaders(false);
   if (autoCommit) {
     segmentInfos->write(directory);
     commitPending = false;
@@ -1324,6 +1385,217 @@ void IndexWriter::flush(bool triggerMerge, bool _flushDocStores) {
     maybeMerge();
 }
 
+IndexReader* IndexWriter::getReader() {
+  std::vector<std::string> files;
+  SegmentInfos* infos = getReaderSegmentInfos(files);
+
+  DirectoryIndexReader* reader = NULL;
+  bool success = false;
+  try {
+    if (infos->size() == 1)
+      reader = SegmentReader::get(infos, infos->info(0), false);
+    else
+      reader = _CLNEW MultiSegmentReader(directory, infos, false);
+    success = true;
+  } _CLFINALLY (
+    if (!success)
+      releaseReaderFiles(files);
+  )
+  readerOpened(reader, files);
+  return reader;
+}
+
+SegmentInfos* IndexWriter::getReaderSegmentInfos(std::vector<std::string>& files) {
+  // The doc stores are flushed too, since a reader can not
+  // read the stored fields which are still being written
+  flush(true, true);
+
+  SCOPED_LOCK_MUTEX(THIS_LOCK)
+  ensureOpen();
+  SegmentInfos* infos = segmentInfos->clone();
+  infos->version = segmentInfos->getVersion();
+  for (int32_t i = 0; i < infos->size(); i++) {
+    SegmentInfo* info = infos->info(i);
+    if (info->dir == directory) {
+      const vector<string>& segmentFiles = info->files();
+      files.insert(files.end(), segmentFiles.begin(), segmentFiles.end());
+    }
+  }
+  // the files are not deleted while the reader uses them,
+  // even if merges replace their segments
+  deleter->incRef(files);
+  return infos;
+}
+
+void IndexWriter::releaseReaderFiles(const std::vector<std::string>& files) {
+  SCOPED_LOCK_MUTEX(THIS_LOCK)
+  if (!closed)
+    deleter->decRef(files);
+}
+
+void IndexWriter::readerOpened(DirectoryIndexReader* reader, const std::vector<std::string>& files) {
+  SCOPED_LOCK_MUTEX(READERS_LOCK)
+  { SCOPED_LOCK_MUTEX(THIS_LOCK)
+    if (closing || closed)
+      return; // detachReaders may be done already
+    reader->fromWriter = true;
+    reader->writer = this;
+    _internal->readers[reader] = files;
+  }
+}
+
+void IndexWriter::readerClosed(DirectoryIndexReader* reader) {
+  // READERS_LOCK is held by the reader
+  SCOPED_LOCK_MUTEX(THIS_LOCK)
+  Internal::ReadersType::iterator itr = _internal->readers.find(reader);
+  if (itr != _internal->readers.end()) {
+    deleter->decRef(itr->second);
+    _internal->readers.erase(itr);
+  }
+}
+
+void IndexWriter::detachReaders() {
+  SCOPED_LOCK_MUTEX(READERS_LOCK)
+  { SCOPED_LOCK_MUTEX(THIS_LOCK)
+    // the files of the readers stay until the next writer
+    // opened on the index finds them unreferenced
+    Internal::ReadersType::iterator itr = _internal->readers.begin();
+    for (; itr != _internal->readers.end(); ++itr)
+      itr->first->writer = NULL;
+    _internal->readers.clear();
+  }
+}
+
+SegmentReader* IndexWriter::getPooledReader(SegmentInfo* info, bool doOpenStores, int32_t readBufferSize) {
+  SCOPED_LOCK_MUTEX(THIS_LOCK)
+  if (info->dir != directory)
+    return SegmentReader::get(info, readBufferSize, doOpenStores);
+
+  Internal::PooledReadersType::iterator itr = _internal->pooledReaders.find(info->name);
+  if (itr != _internal->pooledReaders.end()) {
+    Internal::PooledReader& pooled = itr->second;
+    if (pooled.refCount == 0 && pooled.delGen == info->getDelGen()) {
+      if (!doOpenStores || pooled.reader->getFieldsReader() != NULL) {
+        pooled.refCount++;
+        pooled.reader->si = info;
+        return pooled.reader;
+      }
+      // reopened below with the stored fields and vectors
+    } else if (pooled.refCount > 0 || segmentInfos->indexOf(info) == -1) {
+      // a merge reads the pooled reader, or info is the copy
+      // of a segment whose deletions changed since it was taken
+      return SegmentReader::get(info, readBufferSize, doOpenStores);
+    }
+    _internal->dropPooledReader(itr);
+  }
+
+  Internal::PooledReader pooled;
+  pooled.reader = SegmentReader::get(info, readBufferSize, doOpenStores);
+  pooled.files = info->files();
+  pooled.delGen = info->getDelGen();
+  pooled.refCount = 1;
+  // keep the files while the reader is open, even if the
+  // segment is merged away or its deletions are rewritten
+  deleter->incRef(pooled.files);
+  _internal->pooledReaders[info->name] = pooled;
+  return pooled.reader;
+}
+
+void IndexWriter::releasePooledReader(SegmentReader* reader, bool commit) {
+  SCOPED_LOCK_MUTEX(THIS_LOCK)
+  Internal::PooledReadersType::iterator itr = _internal->pooledReaders.find(reader->segment);
+  bool pooled = itr != _internal->pooledReaders.end() && itr->second.reader == reader;
+
+  bool success = false;
+  try {
+    if (commit)
+      reader->doCommit();
+    success = true;
+  } _CLFINALLY (
+    if (!pooled) {
+      reader->doClose();
+      _CLDELETE(reader);
+    } else {
+      itr->second.refCount--;
+      if (success && commit)
+        itr->second.delGen = reader->si->getDelGen();
+      // si may be a copy of a merge, which is deleted after it
+      SegmentInfo* info = NULL;
+      for (int32_t i = 0; info == NULL && i < segmentInfos->size(); i++) {
+        if (reader->segment.compare(segmentInfos->info(i)->name) == 0)
+          info = segmentInfos->info(i);
+      }
+      if (info != NULL)
+        reader->si = info;
+      if (!success || info == NULL)
+        // the deletions of the reader are not those of its
+        // segment, or the segment is gone
+        _internal->dropPooledReader(itr);
+    }
+  )
+}
+
+void IndexWriter::dropPooledReaders(bool all) {
+  SCOPED_LOCK_MUTEX(THIS_LOCK)
+  std::set<std::string> names;
+  if (!all) {
+    for (int32_t i = 0; i < segmentInfos->size(); i++)
+      names.insert(segmentInfos->info(i)->name);
+  }
+  Internal::PooledReadersType::iterator itr = _internal->pooledReaders.begin();
+  while (itr != _internal->pooledReaders.end()) {
+    Internal::PooledReadersType::iterator cur = itr++;
+    if (all || (cur->second.refCount == 0 && names.find(cur->first) == names.end()))
+      _internal->dropPooledReader(cur);
+  }
+}
+
+void IndexWriter::Internal::dropPooledReader(PooledReadersType::iterator itr) {
+  SegmentReader* reader = itr->second.reader;
+  reader->doClose();
+  _CLDELETE(reader);
+  if (!_this->closed)
+    _this->deleter->decRef(itr->second.files);
+  pooledReaders.erase(itr);
+}
+
+bool IndexWriter::isReaderCurrent(DirectoryIndexReader* reader) {
+  SCOPED_LOCK_MUTEX(THIS_LOCK)
+  return reader->segmentInfos->getVersion() == segmentInfos->getVersion() &&
+    docWriter->getNumDocsInRAM() == 0 && !docWriter->hasDeletes();
+}
+
+DirectoryIndexReader* IndexWriter::reopenReader(DirectoryIndexReader* reader) {
+  std::vector<std::string> files;
+  SegmentInfos* infos = getReaderSegmentInfos(files);
+  if (infos->getVersion() == reader->segmentInfos->getVersion()) {
+    // nothing changed since reader was opened
+    releaseReaderFiles(files);
+    _CLDELETE(infos);
+    return reader;
+  }
+
+  DirectoryIndexReader* newReader = NULL;
+  bool success = false;
+  try {
+    newReader = reader->doReopen(infos);
+    success = true;
+  } _CLFINALLY (
+    if (!success)
+      releaseReaderFiles(files);
+  )
+  if (newReader == reader) {
+    releaseReaderFiles(files);
+    _CLDELETE(infos);
+    return reader;
+  }
+  // a reopened single segment reader does not have the segments yet
+  if (newReader->segmentInfos == NULL)
+    newReader->segmentInfos = infos;
+  readerOpened(newReader, files);
+  return newReader;
+}
+
 bool IndexWriter::doFlush(bool _flushDocStores) {
 	SCOPED_LOCK_MUTEX(THIS_LOCK)
 
@@ -2042,9 +2314,10 @@ int32_t IndexWriter::mergeMiddle(MergePolicy::OneMerge* _merge) {
     message("merging " + _merge->segString(directory));
 
   SegmentMerger merger (this, mergedName.c_str(), _merge) ;
+  ValueArray<SegmentReader*> readers(numSegments);
 
   // This is try/finally to make sure merger's readers are
-  // closed:
+  // released:
 
   bool success = false;
 
@@ -2053,9 +2326,9 @@ int32_t IndexWriter::mergeMiddle(MergePolicy::OneMerge* _merge) {
 
     for (int32_t i = 0; i < numSegments; i++) {
       SegmentInfo* si = sourceSegmentsClone->info(i);
-      IndexReader* reader = SegmentReader::get(si, MERGE_READ_BUFFER_SIZE, _merge->mergeDocStores); // no need to set deleter (yet)
-      merger.add(reader);
-      totDocCount += reader->numDocs();
+      readers.values[i] = getPooledReader(si, _merge->mergeDocStores, MERGE_READ_BUFFER_SIZE);
+      merger.add(readers[i]);
+      totDocCount += readers[i]->numDocs();
     }
     if (infoStream != NULL) {
       message(string("merge: total ")+ Misc::toString(totDocCount)+" docs");
@@ -2070,9 +2343,12 @@ int32_t IndexWriter::mergeMiddle(MergePolicy::OneMerge* _merge) {
     success = true;
 
   } _CLFINALLY (
-    // close readers before we attempt to delete
+    // release readers before we attempt to delete
     // now-obsolete segments
-    merger.closeReaders();
+    for (int32_t i = 0; i < numSegments; i++) {
+      if (readers[i] != NULL)
+        releasePooledReader(readers[i], false);
+    }
     if (!success) {
       if (infoStream != NULL)
         message("hit exception during merge; now refresh deleter on segment " + mergedName);
@@ -2178,6 +2454,7 @@ void IndexWriter::addMergeException(MergePolicy::OneMerge* _merge) {
       if ( x == _merge ){
         return;
       }
+      itr++;
     }
   }
   mergeExceptions->push_back(_merge);
@@ -2206,26 +2483,20 @@ void IndexWriter::applyDeletes(bool flushedNewSegment) {
           " deleted docIDs on " + Misc::toString((int32_t)segmentInfos->size()) + " segments.");
 
   if (flushedNewSegment) {
-    IndexReader* reader = NULL;
+    SegmentReader* reader = NULL;
     try {
       // Open readers w/o opening the stored fields /
       // vectors because these files may still be held
       // open for writing by docWriter
-      reader = SegmentReader::get(segmentInfos->info(segmentInfos->size() - 1), false);
+      reader = getPooledReader(segmentInfos->info(segmentInfos->size() - 1), false, BufferedIndexInput::BUFFER_SIZE);
 
       // Apply delete terms to the segment just flushed from ram
       // apply appropriately so that a delete term is only applied to
       // the documents buffered before it, not those buffered after it.
       _internal->applyDeletesSelectively(bufferedDeleteTerms, *bufferedDeleteDocIDs, reader);
     } _CLFINALLY (
-      if (reader != NULL) {
-        try {
-          reader->doCommit();
-        } _CLFINALLY (
-          reader->doClose();
-          _CLLDELETE(reader);
-        )
-      }
+      if (reader != NULL)
+        releasePooledReader(reader, true);
     )
   }
 
@@ -2235,21 +2506,16 @@ void IndexWriter::applyDeletes(bool flushedNewSegment) {
   }
 
   for (int32_t i = 0; i < infosEnd; i++) {
-    IndexReader* reader = NULL;
+    SegmentReader* reader = NULL;
     try {
-      reader = SegmentReader::get(segmentInfos->info(i), false);
+      reader = getPooledReader(segmentInfos->info(i), false, BufferedIndexInput::BUFFER_SIZE);
 
       // Apply delete terms to disk segments
       // except the one just flushed from ram.
       _internal->applyDeletes(bufferedDeleteTerms, reader);
     } _CLFINALLY (
-      if (reader != NULL) {
-        try {
-          reader->doCommit();
-        } _CLFINALLY (
-          reader->doClose();
-        )
-      }
+      if (reader != NULL)
+        releasePooledReader(reader, true);
     )
   }
 
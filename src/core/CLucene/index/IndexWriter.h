@@ -15,6 +15,7 @@ CL_CLASS_DEF(analysis,Analyzer)
 CL_CLASS_DEF(store,Directory)
 CL_CLASS_DEF(store,LuceneLock)
 CL_CLASS_DEF(document,Document)
+CL_CLASS_DEF(util,ThreadPool)
 
 #include "MergePolicy.h"
 #include "CLucene/LuceneThreads.h"
@@ -24,6 +25,7 @@ class SegmentInfo;
 class SegmentInfos;
 class MergePolicy;
 class IndexReader;
+class DirectoryIndexReader;
 class SegmentReader;
 class MergeScheduler;
 class DocumentsWriter;
@@ -148,7 +150,14 @@ class Term;
   {@link LogByteSizeMergePolicy}.  Then, the {@link
   MergeScheduler} is invoked with the requested merges and
   it decides when and how to run the merges.  The default is
-  {@link ConcurrentMergeScheduler}. </p>
+  {@link ConcurrentMergeScheduler}, which runs the merges in
+  background threads: an error hit by such a merge is not
+  thrown by the call that triggered it (except by a waiting
+  optimize()).  It is only written to the infoStream and
+  reported by {@link
+  ConcurrentMergeScheduler#anyUnhandledExceptions}.  Use
+  {@link SerialMergeScheduler} to get merge errors thrown by
+  the call that triggered the merge. </p>
  */
 /*
  * Clarification: Check Points (and commits)
@@ -192,6 +201,7 @@ class CLUCENE_EXPORT IndexWriter:LUCENE_BASE {
   MergingSegmentsType* mergingSegments;
   MergePolicy* mergePolicy;
   MergeScheduler* mergeScheduler;
+  CL_NS(util)::ThreadPool* mergeThreadPool;
 
   typedef  CL_NS(util)::CLLinkedList<MergePolicy::OneMerge*,
   CL_NS(util)::Deletor::Object<MergePolicy::OneMerge> > PendingMergesType;
@@ -246,6 +256,7 @@ class CLUCENE_EXPORT IndexWriter:LUCENE_BASE {
   int32_t minMergeDocs;
   int32_t maxMergeDocs;
   int32_t termIndexInterval;
+  int32_t storedFieldsCompression;
 
   int64_t writeLockTimeout;
   int64_t commitLockTimeout;
@@ -258,6 +269,10 @@ class CLUCENE_EXPORT IndexWriter:LUCENE_BASE {
   // LUCENE-888 for details.
   static const int32_t MERGE_READ_BUFFER_SIZE;
 
+  // Guards the writer of the readers returned by getReader, which
+  // may be closed while this writer is. Taken before THIS_LOCK
+  STATIC_DEFINE_MUTEX(READERS_LOCK)
+
   // Used for printing messages
   STATIC_DEFINE_MUTEX(MESSAGE_ID_LOCK)
   static int32_t MESSAGE_ID;
@@ -442,6 +457,36 @@ public:
    */
   int32_t getTermIndexInterval();
 
+  /** Stored fields are written one document at a time, and only fields
+   *  stored with Field::STORE_COMPRESS are compressed.  This is the default. */
+  LUCENE_STATIC_CONSTANT(int32_t, STORED_FIELDS_UNCOMPRESSED = 0);
+  /** Stored fields are written in blocks of documents compressed with a
+   *  fast LZ77 codec, which costs little to decompress. */
+  LUCENE_STATIC_CONSTANT(int32_t, STORED_FIELDS_FAST = 1);
+  /** Stored fields are written in blocks of documents compressed with
+   *  zlib, for a better ratio at a higher cost. */
+  LUCENE_STATIC_CONSTANT(int32_t, STORED_FIELDS_DEFLATE = 2);
+
+  /** Expert: Set how stored fields are compressed.  Compressing blocks of
+   * several documents together gives a much better ratio than compressing
+   * each field on its own, which pays off for small fields, and a reader
+   * keeps the last block it decompressed, so loading the documents of
+   * nearby hits is cheap.  Lazy fields are loaded eagerly from such blocks.
+   *
+   * <p>This applies to stored fields files started after the call; readers
+   * detect the format of each file, so an index can mix them.
+   *
+   * @see #STORED_FIELDS_UNCOMPRESSED
+   * @see #STORED_FIELDS_FAST
+   * @see #STORED_FIELDS_DEFLATE
+   */
+  void setStoredFieldsCompression(int32_t compression);
+  /** Expert: Return how stored fields are compressed.
+   *
+   * @see #setStoredFieldsCompression(int32_t)
+   */
+  int32_t getStoredFieldsCompression();
+
   /**Determines the largest number of documents ever merged by addDocument().
    *  Small values (e.g., less than 10,000) are best for interactive indexing,
    *  as this limits the length of pauses while indexing to a few seconds.
@@ -661,9 +706,25 @@ public:
 
   /**
    * Expert: set the merge scheduler used by this writer.
+   * The default is a {@link ConcurrentMergeScheduler}, see
+   * the <a href="#mergePolicy">class docs</a> for how it
+   * reports errors.
    */
   void setMergeScheduler(MergeScheduler* mergeScheduler);
 
+  /**
+   * Expert: sets a pool used to run the parts of each merge in parallel.
+   * The stored fields, postings, norms and term vectors of the merged
+   * segment are written to separate files, so each of them is merged in
+   * its own task, which shortens {@link #optimize} on machines with several
+   * cores. Set to NULL (the default) to merge them one after the other in
+   * the merging thread.
+   * @memory the pool is not deleted
+   */
+  void setMergeThreadPool(CL_NS(util)::ThreadPool* pool);
+  /** Returns the pool set by {@link #setMergeThreadPool}, or NULL */
+  CL_NS(util)::ThreadPool* getMergeThreadPool();
+
   /** Determines the amount of RAM that may be used for
    * buffering added documents before they are flushed as a
    * new Segment.  Generally for faster indexing performance
@@ -908,6 +969,33 @@ public:
    */
   void flush();
 
+  /**
+   * Returns a reader of the documents added, updated and deleted so far,
+   * including the changes which are not committed yet, so they can be
+   * searched without the cost of a commit. The buffered documents and
+   * deletes are flushed (but not committed) first.
+   *
+   * <p>{@link IndexReader#reopen} of the returned reader flushes this
+   * writer again and opens the changes made since, reusing the segments
+   * which did not change, and {@link IndexReader#isCurrent} tells whether
+   * there are such changes. The reader can not delete documents or set
+   * norms, since this writer holds the write lock.
+   *
+   * <p>The files of the segments the reader uses are kept while it is open.
+   * It may be closed after this writer, in which case the files no longer
+   * referenced are removed by the next writer opened on the index.
+   *
+   * <p>The reader opens its own segment readers instead of sharing the ones
+   * this writer pools for merges and deletes. An IndexReader has no
+   * reference count which would let the caller delete a shared one, and
+   * the pooled readers take new deletions at once, while the reader must
+   * only show them after it is reopened.
+   * @memory the caller must close and delete the reader
+   * @throws CorruptIndexException if the index is corrupt
+   * @throws IOException if there is a low-level IO error
+   */
+  IndexReader* getReader();
+
   /**
    * Adds a document to this index.  If the document contains more than
    * {@link #setMaxFieldLength(int)} terms for a given field, the remainder are
@@ -1105,6 +1193,37 @@ private:
   friend class LockWith2;
   friend class LockWithCFS;
   friend class DocumentsWriter;
+  friend class DirectoryIndexReader;
+
+  /** Flushes and returns a copy of the segments. Their files, which are
+   * added to files, are referenced until they are released */
+  SegmentInfos* getReaderSegmentInfos(std::vector<std::string>& files);
+  void releaseReaderFiles(const std::vector<std::string>& files);
+  /** Registers reader, which reads the files returned by getReaderSegmentInfos */
+  void readerOpened(DirectoryIndexReader* reader, const std::vector<std::string>& files);
+  /** Releases the files of a reader returned by getReader */
+  void readerClosed(DirectoryIndexReader* reader);
+  /** Returns true if reader, returned by getReader, has all changes */
+  bool isReaderCurrent(DirectoryIndexReader* reader);
+  /** Returns a reader of the current changes which shares the unchanged
+   * segments of reader, returned by getReader, or reader if it is current */
+  DirectoryIndexReader* reopenReader(DirectoryIndexReader* reader);
+  /** Stops the open readers returned by getReader from calling this writer.
+   * Must not be called with THIS_LOCK held, see READERS_LOCK */
+  void detachReaders();
+
+  /** Returns a reader of info from the pool of segment readers which deletes
+   * are applied with and merges read from, opening it if needed. The reader
+   * is not shared while it is in use: if the pooled one is, or it does not
+   * have the deletions of info, which is not one of the current segments,
+   * a reader of its own is opened. Call releasePooledReader when done */
+  SegmentReader* getPooledReader(SegmentInfo* info, bool doOpenStores, int32_t readBufferSize);
+  /** Returns reader to the pool, first writing its deletions if commit is
+   * true, or closes it if it is not pooled */
+  void releasePooledReader(SegmentReader* reader, bool commit);
+  /** Closes the pooled readers not in use whose segment was dropped, or all
+   * of them if all is true */
+  void dropPooledReaders(bool all);
 
   /** Merges all RAM-resident segments. */
   void flushRamSegments();
@@ -29,6 +29,7 @@ MergePolicy::OneMerge::OneMerge(SegmentInfos* segments, bool _useCompoundFile):
   this->segmentsClone = NULL;
   this->mergeGen = 0;
   this->maxNumSegmentsOptimize = 0;
+  this->rateLimiter = NULL;
   aborted = mergeDocStores = optimize = increfDone = registerDone = isExternal = false;
 }
 MergePolicy::OneMerge::~OneMerge(){
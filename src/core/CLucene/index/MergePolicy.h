@@ -9,6 +9,7 @@
 
 #include "CLucene/util/VoidList.h"
 CL_CLASS_DEF(store,Directory)
+CL_CLASS_DEF(store,RateLimiter)
 CL_NS_DEF(index)
 
 class SegmentInfo;
@@ -63,6 +64,7 @@ public:
     int64_t mergeGen;                  // used by IndexWriter
     bool isExternal;             // used by IndexWriter
     int32_t maxNumSegmentsOptimize;     // used by IndexWriter
+    CL_NS(store)::RateLimiter* rateLimiter; // used by MergeScheduler, not owned
 
     SegmentInfos* segments;
     const bool useCompoundFile;
@@ -7,8 +7,14 @@
 #include "CLucene/_ApiHeader.h"
 #include "MergeScheduler.h"
 #include "IndexWriter.h"
+#include "CLucene/store/_RateLimiter.h"
+#include "CLucene/util/Misc.h"
+#include <list>
+#include <vector>
+#include <utility>
 
-
+CL_NS_USE(util)
+CL_NS_USE(store)
 CL_NS_DEF(index)
 
 
@@ -31,4 +37,249 @@ void SerialMergeScheduler::merge(IndexWriter* writer){
 
 void SerialMergeScheduler::close() {}
 
+
+//a merge thread started by merge(). The value returned by
+//_LUCENE_THREAD_CREATE is what joins it: on win32 it is a
+//handle, not the id of the thread
+class ConcurrentMergeScheduler::MergeThread{
+public:
+  ConcurrentMergeScheduler* cms;
+  _LUCENE_THREADID_TYPE thread;
+  bool finished;
+
+  MergeThread(ConcurrentMergeScheduler* _cms):
+    cms(_cms),
+    thread(),
+    finished(false)
+  {
+  }
+};
+
+class ConcurrentMergeScheduler::Internal{
+public:
+  DEFINE_MUTEX(THIS_LOCK)
+  DEFINE_CONDITION(THIS_WAIT_CONDITION)
+
+  //merges taken from the writers, waiting for a free merge thread
+  typedef std::list< std::pair<IndexWriter*, MergePolicy::OneMerge*> > QueueType;
+  QueueType queue;
+
+  int32_t activeThreads;  //merge threads started and not yet finished
+  int32_t runningMerges;  //merges being run by the merge threads
+
+  //threads which have not been joined yet
+  typedef std::list<MergeThread*> ThreadsType;
+  ThreadsType threads;
+
+  bool hitException;
+  RateLimiter rateLimiter;
+
+  Internal():
+    activeThreads(0),
+    runningMerges(0),
+    hitException(false),
+    rateLimiter(0)
+  {
+  }
+};
+
+ConcurrentMergeScheduler::ConcurrentMergeScheduler():
+  _internal(_CLNEW Internal),
+  maxThreadCount(DEFAULT_MAX_THREAD_COUNT),
+  maxMergeCount(DEFAULT_MAX_MERGE_COUNT),
+  maxMergeWriteMBPerSec(0)
+{
+}
+ConcurrentMergeScheduler::~ConcurrentMergeScheduler(){
+  close();
+  _CLDELETE(_internal);
+}
+
+const char* ConcurrentMergeScheduler::getObjectName() const{
+  return getClassName();
+}
+const char* ConcurrentMergeScheduler::getClassName(){
+  return "ConcurrentMergeScheduler";
+}
+
+void ConcurrentMergeScheduler::setMaxThreadCount(int32_t count){
+  if (count < 1)
+    _CLTHROWA(CL_ERR_IllegalArgument, "count should be at least 1");
+  SCOPED_LOCK_MUTEX(_internal->THIS_LOCK)
+  maxThreadCount = count;
+  if (maxMergeCount < count)
+    maxMergeCount = count;
+}
+int32_t ConcurrentMergeScheduler::getMaxThreadCount() const{
+  return maxThreadCount;
+}
+
+void ConcurrentMergeScheduler::setMaxMergeCount(int32_t count){
+  SCOPED_LOCK_MUTEX(_internal->THIS_LOCK)
+  if (count < maxThreadCount)
+    _CLTHROWA(CL_ERR_IllegalArgument, "maxMergeCount should be at least maxThreadCount");
+  maxMergeCount = count;
+  //stalled threads may be able to go on now
+  CONDITION_NOTIFYALL(_internal->THIS_WAIT_CONDITION)
+}
+int32_t ConcurrentMergeScheduler::getMaxMergeCount() const{
+  return maxMergeCount;
+}
+
+void ConcurrentMergeScheduler::setMaxMergeWriteMBPerSec(float_t mbPerSec){
+  if (mbPerSec < 0)
+    _CLTHROWA(CL_ERR_IllegalArgument, "mbPerSec should not be negative");
+  maxMergeWriteMBPerSec = mbPerSec;
+  _internal->rateLimiter.setMbPerSec(mbPerSec);
+}
+float_t ConcurrentMergeScheduler::getMaxMergeWriteMBPerSec() const{
+  return maxMergeWriteMBPerSec;
+}
+
+int32_t ConcurrentMergeScheduler::mergeThreadCount(){
+  SCOPED_LOCK_MUTEX(_internal->THIS_LOCK)
+  return _internal->activeThreads;
+}
+
+bool ConcurrentMergeScheduler::anyUnhandledExceptions(){
+  SCOPED_LOCK_MUTEX(_internal->THIS_LOCK)
+  bool ret = _internal->hitException;
+  _internal->hitException = false;
+  return ret;
+}
+
+void ConcurrentMergeScheduler::handleMergeException(IndexWriter* writer, CLuceneError& error){
+  if (writer->getInfoStream() != NULL)
+    writer->message(string("CMS: merge thread hit exception: ") + error.what());
+  SCOPED_LOCK_MUTEX(_internal->THIS_LOCK)
+  _internal->hitException = true;
+}
+
+void ConcurrentMergeScheduler::merge(IndexWriter* writer){
+  joinFinishedThreads();
+
+  if (writer->getInfoStream() != NULL)
+    writer->message(string("CMS: now merge, ") + Misc::toString(mergeThreadCount()) + " merge threads");
+
+  // Iterate, pulling from the IndexWriter's queue of
+  // pending merges, until it's empty:
+  while(true) {
+    MergePolicy::OneMerge* merge = writer->getNextMerge();
+    if (merge == NULL)
+      break;
+
+    if (merge->isExternal) {
+      // The writer relies on external segments being
+      // copied before addIndexesNoOptimize returns
+      if (writer->getInfoStream() != NULL)
+        writer->message(string("CMS: merge involves segments from an external directory; now run in foreground"));
+      writer->merge(merge);
+      continue;
+    }
+
+    SCOPED_LOCK_MUTEX(_internal->THIS_LOCK)
+    _internal->queue.push_back(std::pair<IndexWriter*, MergePolicy::OneMerge*>(writer, merge));
+    if (_internal->activeThreads < maxThreadCount) {
+      _internal->activeThreads++;
+      MergeThread* thread = _CLNEW MergeThread(this);
+      _internal->threads.push_back(thread);
+      //the thread cannot finish before we release the lock,
+      //so it is only joined once its handle is stored
+      thread->thread = _LUCENE_THREAD_CREATE(&mergeThread, thread);
+    }
+
+    // Stall the calling thread while too many merges are
+    // in flight, so that indexing does not outrun merging
+    while ((int32_t)_internal->queue.size() + _internal->runningMerges > maxMergeCount) {
+      if (writer->getInfoStream() != NULL)
+        writer->message(string("CMS: too many merges pending; stalling"));
+      CONDITION_WAIT(_internal->THIS_LOCK, _internal->THIS_WAIT_CONDITION)
+    }
+  }
+}
+
+_LUCENE_THREAD_FUNC(ConcurrentMergeScheduler::mergeThread, arg){
+  MergeThread* thread = (MergeThread*)arg;
+  thread->cms->runMergeThread(thread);
+  _LUCENE_THREAD_FUNC_RETURN(0);
+}
+
+void ConcurrentMergeScheduler::runMergeThread(MergeThread* thread){
+  IndexWriter* writer = NULL;
+  MergePolicy::OneMerge* merge = NULL;
+
+  while (true) {
+    { SCOPED_LOCK_MUTEX(_internal->THIS_LOCK)
+      if (merge == NULL) {
+        if (_internal->queue.empty()) {
+          _internal->activeThreads--;
+          thread->finished = true;
+          CONDITION_NOTIFYALL(_internal->THIS_WAIT_CONDITION)
+          return;
+        }
+        writer = _internal->queue.front().first;
+        merge = _internal->queue.front().second;
+        _internal->queue.pop_front();
+      }
+      _internal->runningMerges++;
+    }
+
+    if (maxMergeWriteMBPerSec > 0)
+      merge->rateLimiter = &_internal->rateLimiter;
+
+    try {
+      // the writer deletes the merge when it is done
+      writer->merge(merge);
+    } catch (CLuceneError& e) {
+      handleMergeException(writer, e);
+    } catch (...) {
+      CLuceneError e(CL_ERR_Runtime, "unknown error in merge thread", false);
+      handleMergeException(writer, e);
+    }
+
+    { SCOPED_LOCK_MUTEX(_internal->THIS_LOCK)
+      _internal->runningMerges--;
+      CONDITION_NOTIFYALL(_internal->THIS_WAIT_CONDITION)
+    }
+
+    // Subsequent merges registered by the one that just
+    // finished are picked up directly from the writer
+    merge = writer->getNextMerge();
+    if (merge != NULL && writer->getInfoStream() != NULL)
+      writer->message("CMS: merge thread: do another merge " + merge->segString(writer->getDirectory()));
+  }
+}
+
+void ConcurrentMergeScheduler::joinFinishedThreads(){
+  std::vector<MergeThread*> finished;
+  {
+    SCOPED_LOCK_MUTEX(_internal->THIS_LOCK)
+    Internal::ThreadsType::iterator itr = _internal->threads.begin();
+    while (itr != _internal->threads.end()) {
+      if ((*itr)->finished) {
+        finished.push_back(*itr);
+        itr = _internal->threads.erase(itr);
+      } else
+        ++itr;
+    }
+  }
+  for (size_t i = 0; i < finished.size(); i++) {
+    _LUCENE_THREAD_JOIN(finished[i]->thread);
+    _CLDELETE(finished[i]);
+  }
+}
+
+void ConcurrentMergeScheduler::sync(){
+  {
+    SCOPED_LOCK_MUTEX(_internal->THIS_LOCK)
+    while (_internal->activeThreads > 0)
+      CONDITION_WAIT(_internal->THIS_LOCK, _internal->THIS_WAIT_CONDITION)
+  }
+  joinFinishedThreads();
+}
+
+void ConcurrentMergeScheduler::close(){
+  sync();
+}
+
 CL_NS_END
@@ -45,6 +45,99 @@ public:
   static const char* getClassName();
 };
 
+/** A {@link MergeScheduler} that runs each merge using a
+ *  separate thread, up until a maximum number of threads
+ *  ({@link #setMaxThreadCount}) at which point merges are
+ *  queued for the busy threads.  If more than {@link
+ *  #getMaxMergeCount} merges are queued or running, the
+ *  thread asking for more merges (usually an indexing
+ *  thread, through {@link IndexWriter#maybeMerge}) is
+ *  stalled until merges complete.
+ *
+ *  <p>The total bandwidth written by merges can optionally
+ *  be limited with {@link #setMaxMergeWriteMBPerSec}, so
+ *  that large merges do not starve searches of I/O.</p>
+ *
+ *  <p>Merges involving segments of external directories
+ *  (see {@link IndexWriter#addIndexesNoOptimize}) are run in
+ *  the calling thread.</p>
+ * <p><b>NOTE:</b> This API is new and still experimental
+ * (subject to change suddenly in the next release)</p>
+ */
+class CLUCENE_EXPORT ConcurrentMergeScheduler: public MergeScheduler {
+private:
+  class Internal;
+  class MergeThread;
+  Internal* _internal;
+
+  int32_t maxThreadCount;
+  int32_t maxMergeCount;
+  float_t maxMergeWriteMBPerSec;
+
+  void runMergeThread(MergeThread* thread);
+  void joinFinishedThreads();
+  static _LUCENE_THREAD_FUNC(mergeThread, arg);
+protected:
+  /** Called when a merge thread hits an error. The error
+   *  is not rethrown to the thread that added documents: the
+   *  default implementation logs it to the writer's infoStream
+   *  and records it, see {@link #anyUnhandledExceptions}. The
+   *  merge has already been cleaned up by the writer at this
+   *  point. */
+  virtual void handleMergeException(IndexWriter* writer, CLuceneError& error);
+public:
+  LUCENE_STATIC_CONSTANT(int32_t, DEFAULT_MAX_THREAD_COUNT=3);
+  LUCENE_STATIC_CONSTANT(int32_t, DEFAULT_MAX_MERGE_COUNT=5);
+
+  ConcurrentMergeScheduler();
+  virtual ~ConcurrentMergeScheduler();
+
+  /** Sets the max # simultaneous threads that may be
+   *  running.  If a merge is necessary yet we already have
+   *  this many threads running, the merge is queued until
+   *  a thread is free. */
+  void setMaxThreadCount(int32_t count);
+
+  /** Get the max # simultaneous threads that may be
+   *  running. @see #setMaxThreadCount. */
+  int32_t getMaxThreadCount() const;
+
+  /** Sets the max # merges that may be queued or running
+   *  before the thread asking for merges is stalled. Must
+   *  be at least {@link #getMaxThreadCount}. */
+  void setMaxMergeCount(int32_t count);
+
+  /** @see #setMaxMergeCount */
+  int32_t getMaxMergeCount() const;
+
+  /** Limits the total rate at which all merge threads
+   *  write, in MB per second. 0 (the default) disables the
+   *  limit. Takes effect for merges started after the
+   *  call. */
+  void setMaxMergeWriteMBPerSec(float_t mbPerSec);
+
+  /** @see #setMaxMergeWriteMBPerSec */
+  float_t getMaxMergeWriteMBPerSec() const;
+
+  /** Returns the number of merge threads that are alive. */
+  int32_t mergeThreadCount();
+
+  /** Returns true if a merge thread hit an error since the
+   *  last call, and clears the flag. */
+  bool anyUnhandledExceptions();
+
+  /** Waits until all queued and running merges are done. */
+  void sync();
+
+  void merge(IndexWriter* writer);
+
+  /** Waits for the running merges and stops the merge
+   *  threads. */
+  void close();
+
+  const char* getObjectName() const;
+  static const char* getClassName();
+};
 
 CL_NS_END
 #endif
@@ -99,6 +99,8 @@ public:
 
 	//Returns the document frequency of the current term in the set
 	int32_t docFreq(const Term* t=NULL);
+	int32_t maxTermFreq(Term* t);
+	uint8_t maxNorm(const TCHAR* field);
 	TermDocs* termDocs();
 	TermPositions* termPositions();
 
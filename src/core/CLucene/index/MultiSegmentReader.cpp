@@ -342,6 +342,28 @@ int32_t MultiSegmentReader::docFreq(const Term* t) {
 	return total;
 }
 
+int32_t MultiSegmentReader::maxTermFreq(Term* t) {
+    ensureOpen();
+	int32_t ret = 0;
+	for (size_t i = 0; i < subReaders->length; i++){
+	  int32_t f = (*subReaders)[i]->maxTermFreq(t);
+	  if ( f > ret )
+	    ret = f;
+	}
+	return ret;
+}
+
+uint8_t MultiSegmentReader::maxNorm(const TCHAR* field) {
+    ensureOpen();
+	uint8_t ret = 0;
+	for (size_t i = 0; i < subReaders->length; i++){
+	  uint8_t n = (*subReaders)[i]->maxNorm(field);
+	  if ( n > ret )
+	    ret = n;
+	}
+	return ret;
+}
+
 TermDocs* MultiSegmentReader::termDocs() {
     ensureOpen();
 	TermDocs* ret =  _CLNEW MultiTermDocs(subReaders, starts);
@@ -337,6 +337,10 @@ string SegmentInfo::segString(Directory* dir) {
 	   clearFiles();
    }
 
+   int64_t SegmentInfo::getDelGen() const {
+	   return delGen;
+   }
+
    SegmentInfo* SegmentInfo::clone () {
 	   SegmentInfo* si = _CLNEW SegmentInfo(name.c_str(), docCount, dir);
 	   si->isCompoundFile = isCompoundFile;
@@ -856,6 +860,7 @@ string SegmentInfo::segString(Directory* dir) {
   }
 
   int64_t SegmentInfos::getVersion() const { return version; }
+  void SegmentInfos::changed() { version++; }
   int64_t SegmentInfos::getGeneration() const { return generation; }
   int64_t SegmentInfos::getLastGeneration() const { return lastGeneration; }
 
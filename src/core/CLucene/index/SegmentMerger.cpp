@@ -18,6 +18,10 @@
 #include "_CompoundFile.h"
 #include "_SkipListWriter.h"
 #include "CLucene/document/FieldSelector.h"
+#include "CLucene/store/_RateLimiter.h"
+#include "CLucene/util/ThreadPool.h"
+#include "_DocValues.h"
+#include <algorithm>
 
 CL_NS_USE(util)
 CL_NS_USE(document)
@@ -36,7 +40,11 @@ void SegmentMerger::init(){
   queue            = NULL;
   fieldInfos       = NULL;
   checkAbort       = NULL;
+  storedFieldsCompression = 0;
   skipInterval     = 0;
+  ownDirectory     = false;
+  pool             = NULL;
+  readers.setDoDelete(false);
 }
 
 SegmentMerger::SegmentMerger(IndexWriter* writer, const char* name, MergePolicy::OneMerge* merge){
@@ -50,9 +58,17 @@ SegmentMerger::SegmentMerger(IndexWriter* writer, const char* name, MergePolicy:
   this->init();
   this->directory		   = writer->getDirectory();
   this->segment        = name;
-  if (merge != NULL)
+  if (merge != NULL){
     this->checkAbort = _CLNEW CheckAbort(merge, directory);
+    //throttle everything this merge writes
+    if (merge->rateLimiter != NULL){
+      this->directory = _CLNEW RateLimitedDirectory(directory, merge->rateLimiter);
+      this->ownDirectory = true;
+    }
+  }
   this->termIndexInterval= writer->getTermIndexInterval();
+  this->storedFieldsCompression = writer->getStoredFieldsCompression();
+  this->pool = writer->getMergeThreadPool();
   this->mergedDocs = 0;
   this->maxSkipLevels = 0;
 }
@@ -90,6 +106,8 @@ SegmentMerger::~SegmentMerger(){
 
   _CLDELETE(checkAbort);
   _CLDELETE(skipListWriter);
+  if (ownDirectory)
+    _CLDECDELETE(directory);
 
 }
 
@@ -116,6 +134,29 @@ IndexReader* SegmentMerger::segmentReader(const int32_t i) {
     return ret;
 }
 
+//runs one phase of a merge on the pool of the merger
+class SegmentMerger::PhaseTask: public ThreadPool::Task{
+  SegmentMerger* merger;
+  Phase phase;
+  //the work of each phase is counted separately, so they do not share a count
+  CheckAbort* abortCheck;
+public:
+  PhaseTask(SegmentMerger* merger, Phase phase):
+    merger(merger),
+    phase(phase),
+    abortCheck(NULL)
+  {
+    if (merger->checkAbort != NULL)
+      abortCheck = _CLNEW CheckAbort(*merger->checkAbort);
+  }
+  ~PhaseTask(){
+    _CLDELETE(abortCheck);
+  }
+  void run(){
+    merger->mergePhase(phase, abortCheck);
+  }
+};
+
 int32_t SegmentMerger::merge(bool mergeDocStores) {
   this->mergeDocStores = mergeDocStores;
 
@@ -126,21 +167,58 @@ int32_t SegmentMerger::merge(bool mergeDocStores) {
   // IndexWriter.close(false) takes to actually stop the
   // threads.
 
-  mergedDocs = mergeFields();
-
-	mergeTerms();
-	mergeNorms();
-
-	if (mergeDocStores && fieldInfos->hasVectors())
-		mergeVectors();
+  mergedDocs = mergeFieldInfos();
+
+  //the phases write separate files and only read the readers and the
+  //merged field infos, so they can run at the same time. The terms
+  //usually take longest, so they are started first
+  Phase phases[5];
+  int32_t numPhases = 0;
+  phases[numPhases++] = PHASE_TERMS;
+  if (mergeDocStores){
+    phases[numPhases++] = PHASE_FIELDS;
+    if (fieldInfos->hasVectors())
+      phases[numPhases++] = PHASE_VECTORS;
+  }
+  phases[numPhases++] = PHASE_NORMS;
+  phases[numPhases++] = PHASE_DOCVALUES;
+
+  if (pool == NULL){
+    for (int32_t i = 0; i < numPhases; i++)
+      mergePhase(phases[i], checkAbort);
+  }else{
+    PhaseTask** tasks = _CL_NEWARRAY(PhaseTask*, numPhases);
+    for (int32_t i = 0; i < numPhases; i++)
+      tasks[i] = _CLNEW PhaseTask(this, phases[i]);
+    try{
+      pool->invokeAll((ThreadPool::Task**)tasks, numPhases);
+    }_CLFINALLY(
+      for (int32_t i = 0; i < numPhases; i++)
+        _CLDELETE(tasks[i]);
+      _CLDELETE_ARRAY(tasks);
+    );
+  }
 
 	return mergedDocs;
 }
 
-void SegmentMerger::closeReaders(){
-  for (uint32_t i = 0; i < readers.size(); i++) {  // close readers
-      IndexReader* reader = readers[i];
-      reader->close();
+void SegmentMerger::mergePhase(Phase phase, CheckAbort* abortCheck){
+  switch (phase){
+  case PHASE_TERMS:
+    mergeTerms(abortCheck);
+    break;
+  case PHASE_FIELDS:
+    mergeFields(abortCheck);
+    break;
+  case PHASE_VECTORS:
+    mergeVectors(abortCheck);
+    break;
+  case PHASE_NORMS:
+    mergeNorms(abortCheck);
+    break;
+  case PHASE_DOCVALUES:
+    mergeDocValues(abortCheck);
+    break;
   }
 }
 
@@ -172,6 +250,11 @@ void SegmentMerger::createCompoundFile(const char* filename, std::vector<std::st
 		}
 	}
 
+  // Doc values file
+  const string docValuesFile = segment + "." + IndexFileNames::DOCVALUES_EXTENSION;
+  if (directory->fileExists(docValuesFile.c_str()))
+    files->push_back(docValuesFile);
+
   // Vector files
   if ( mergeDocStores && fieldInfos->hasVectors()) {
       for (int32_t i = 0; i < IndexFileNames::VECTOR_EXTENSIONS_LENGTH; i++) {
@@ -192,13 +275,13 @@ void SegmentMerger::createCompoundFile(const char* filename, std::vector<std::st
 
 void SegmentMerger::addIndexed(IndexReader* reader, FieldInfos* fieldInfos, StringArrayWithDeletor& names,
 	  bool storeTermVectors, bool storePositionWithTermVector,
-    bool storeOffsetWithTermVector, bool storePayloads){
+    bool storeOffsetWithTermVector, bool storePayloads, bool omitTf){
 
 	StringArrayWithDeletor::const_iterator itr = names.begin();
 	while ( itr != names.end() ){
 		fieldInfos->add(*itr, true,
 			storeTermVectors, storePositionWithTermVector,
-			storeOffsetWithTermVector, !reader->hasNorms(*itr), storePayloads);
+			storeOffsetWithTermVector, !reader->hasNorms(*itr), storePayloads, omitTf);
 
 		++itr;
 	}
@@ -215,10 +298,10 @@ public:
 };
 
 
-int32_t SegmentMerger::mergeFields() {
-//Func - Merge the fields of all segments
+int32_t SegmentMerger::mergeFieldInfos() {
+//Func - Merge the field infos of all segments
 //Pre  - true
-//Post - The field infos and field values of all segments have been merged.
+//Post - The field infos of all segments have been merged and written.
 
   if (!mergeDocStores) {
     // When we are not merging by doc stores, that means
@@ -228,7 +311,6 @@ int32_t SegmentMerger::mergeFields() {
     // with the fieldInfos of the last segment in this
     // case, to keep that numbering.
     assert(readers[readers.size()-1]->instanceOf(SegmentReader::getClassName()));
-    assert(false);//check last...and remove if correct...
     SegmentReader* sr = (SegmentReader*)readers[readers.size()-1];
     fieldInfos = sr->fieldInfos()->clone();
   } else {
@@ -253,28 +335,31 @@ int32_t SegmentMerger::mergeFields() {
         FieldInfo* fi = segmentReader->getFieldInfos()->fieldInfo(j);
         fieldInfos->add(fi->name, fi->isIndexed, fi->storeTermVector,
           fi->storePositionWithTermVector, fi->storeOffsetWithTermVector,
-          !reader->hasNorms(fi->name), fi->storePayloads);
+          !reader->hasNorms(fi->name), fi->storePayloads, fi->omitTf);
       }
     } else {
 	    StringArrayWithDeletor tmp;
 
 	    tmp.clear(); reader->getFieldNames(IndexReader::TERMVECTOR_WITH_POSITION_OFFSET, tmp);
-	    addIndexed(reader, fieldInfos, tmp, true, true, true, false);
+	    addIndexed(reader, fieldInfos, tmp, true, true, true, false, false);
 
 	    tmp.clear(); reader->getFieldNames(IndexReader::TERMVECTOR_WITH_POSITION, tmp);
-	    addIndexed(reader, fieldInfos, tmp, true, true, false, false);
+	    addIndexed(reader, fieldInfos, tmp, true, true, false, false, false);
 
 	    tmp.clear(); reader->getFieldNames(IndexReader::TERMVECTOR_WITH_OFFSET, tmp);
-	    addIndexed(reader, fieldInfos, tmp, true, false, true, false);
+	    addIndexed(reader, fieldInfos, tmp, true, false, true, false, false);
 
 	    tmp.clear(); reader->getFieldNames(IndexReader::TERMVECTOR, tmp);
-	    addIndexed(reader, fieldInfos, tmp, true, false, false, false);
+	    addIndexed(reader, fieldInfos, tmp, true, false, false, false, false);
 
 	    tmp.clear(); reader->getFieldNames(IndexReader::STORES_PAYLOADS, tmp);
-	    addIndexed(reader, fieldInfos, tmp, false, false, false, true);
+	    addIndexed(reader, fieldInfos, tmp, false, false, false, true, false);
+
+	    tmp.clear(); reader->getFieldNames(IndexReader::OMIT_TF, tmp);
+	    addIndexed(reader, fieldInfos, tmp, false, false, false, false, true);
 
 	    tmp.clear(); reader->getFieldNames(IndexReader::INDEXED, tmp);
-	    addIndexed(reader, fieldInfos, tmp, false, false, false, false);
+	    addIndexed(reader, fieldInfos, tmp, false, false, false, false, false);
 
 	    tmp.clear(); reader->getFieldNames(IndexReader::UNINDEXED, tmp);
 	    if ( tmp.size() > 0 ){
@@ -289,101 +374,106 @@ int32_t SegmentMerger::mergeFields() {
   //Write the new FieldInfos file to the directory
   fieldInfos->write(directory, Misc::segmentname(segment.c_str(),".fnm").c_str() );
 
+  // Deleted documents are not merged, so the merged
+  // segment has the sum of numDocs() of the segments
 	int32_t docCount = 0;
+  for (size_t i = 0; i < readers.size(); i++)
+    docCount += readers[i]->numDocs();
+  return docCount;
+}
 
-  if (mergeDocStores) {
+void SegmentMerger::mergeFields(CheckAbort* abortCheck) {
+//Func - Merge the stored fields of all segments
+//Pre  - fieldInfos != NULL
+//Post - The field values of all segments have been merged.
 
-    // If the i'th reader is a SegmentReader and has
-    // identical fieldName -> number mapping, then this
-    // array will be non-NULL at position i:
-    ValueArray<SegmentReader*> matchingSegmentReaders(readers.size());
+	CND_PRECONDITION(fieldInfos != NULL, "fieldInfos is NULL");
 
-    // If this reader is a SegmentReader, and all of its
-    // field name -> number mappings match the "merged"
-    // FieldInfos, then we can do a bulk copy of the
-    // stored fields:
-    for (size_t i = 0; i < readers.size(); i++) {
-      IndexReader* reader = readers[i];
-      if (reader->instanceOf(SegmentReader::getClassName())) {
-        SegmentReader* segmentReader = (SegmentReader*) reader;
-        bool same = true;
-        FieldInfos* segmentFieldInfos = segmentReader->getFieldInfos();
-        for (size_t j = 0; same && j < segmentFieldInfos->size(); j++)
-          same = _tcscmp(fieldInfos->fieldName(j), segmentFieldInfos->fieldName(j)) == 0;
-        if (same) {
-          matchingSegmentReaders.values[i] = segmentReader;
-        }
+	int32_t docCount = 0;
+
+  // If the i'th reader is a SegmentReader and has
+  // identical fieldName -> number mapping, then this
+  // array will be non-NULL at position i:
+  ValueArray<SegmentReader*> matchingSegmentReaders(readers.size());
+
+  // If this reader is a SegmentReader, and all of its
+  // field name -> number mappings match the "merged"
+  // FieldInfos, then we can do a bulk copy of the
+  // stored fields:
+  for (size_t i = 0; i < readers.size(); i++) {
+    IndexReader* reader = readers[i];
+    if (reader->instanceOf(SegmentReader::getClassName())) {
+      SegmentReader* segmentReader = (SegmentReader*) reader;
+      bool same = true;
+      FieldInfos* segmentFieldInfos = segmentReader->getFieldInfos();
+      for (size_t j = 0; same && j < segmentFieldInfos->size(); j++)
+        same = _tcscmp(fieldInfos->fieldName(j), segmentFieldInfos->fieldName(j)) == 0;
+      if (same) {
+        matchingSegmentReaders.values[i] = segmentReader;
       }
     }
+  }
 
-    // Used for bulk-reading raw bytes for stored fields
-    ValueArray<int32_t> rawDocLengths(MAX_RAW_MERGE_DOCS);
-
-    // merge field values
-    FieldsWriter fieldsWriter(directory, segment.c_str(), fieldInfos);
-
-    try {
-      for (size_t i = 0; i < readers.size(); i++) {
-        IndexReader* reader = readers[i];
-        SegmentReader* matchingSegmentReader = matchingSegmentReaders[i];
-        FieldsReader* matchingFieldsReader;
-        if (matchingSegmentReader != NULL)
-          matchingFieldsReader = matchingSegmentReader->getFieldsReader();
-        else
-          matchingFieldsReader = NULL;
-        const int32_t maxDoc = reader->maxDoc();
-        Document doc;
-        FieldSelectorMerge fieldSelectorMerge;
-        for (int32_t j = 0; j < maxDoc;) {
-          if (!reader->isDeleted(j)) { // skip deleted docs
-            if (matchingSegmentReader != NULL) {
-              // We can optimize this case (doing a bulk
-              // byte copy) since the field numbers are
-              // identical
-              int32_t start = j;
-              int32_t numDocs = 0;
-              do {
-                j++;
-                numDocs++;
-              } while(j < maxDoc && !matchingSegmentReader->isDeleted(j) && numDocs < MAX_RAW_MERGE_DOCS);
-
-              IndexInput* stream = matchingFieldsReader->rawDocs(rawDocLengths.values, start, numDocs);
-              fieldsWriter.addRawDocuments(stream, rawDocLengths.values, numDocs);
-              docCount += numDocs;
-              if (checkAbort != NULL)
-                checkAbort->work(300*numDocs);
-            } else {
-              doc.clear();
-              reader->document(j, doc, &fieldSelectorMerge);
-              fieldsWriter.addDocument(&doc);
+  // Used for bulk-reading raw bytes for stored fields
+  ValueArray<int32_t> rawDocLengths(MAX_RAW_MERGE_DOCS);
+
+  // merge field values
+  FieldsWriter fieldsWriter(directory, segment.c_str(), fieldInfos, storedFieldsCompression);
+
+  try {
+    for (size_t i = 0; i < readers.size(); i++) {
+      IndexReader* reader = readers[i];
+      SegmentReader* matchingSegmentReader = matchingSegmentReaders[i];
+      FieldsReader* matchingFieldsReader;
+      if (matchingSegmentReader != NULL)
+        matchingFieldsReader = matchingSegmentReader->getFieldsReader();
+      else
+        matchingFieldsReader = NULL;
+      const int32_t maxDoc = reader->maxDoc();
+      Document doc;
+      FieldSelectorMerge fieldSelectorMerge;
+      for (int32_t j = 0; j < maxDoc;) {
+        if (!reader->isDeleted(j)) { // skip deleted docs
+          if (matchingSegmentReader != NULL) {
+            // We can optimize this case (doing a bulk
+            // byte copy) since the field numbers are
+            // identical
+            int32_t start = j;
+            int32_t numDocs = 0;
+            do {
               j++;
-              docCount++;
-              if (checkAbort != NULL)
-                checkAbort->work(300);
-            }
-          } else
+              numDocs++;
+            } while(j < maxDoc && !matchingSegmentReader->isDeleted(j) && numDocs < MAX_RAW_MERGE_DOCS);
+
+            IndexInput* stream = matchingFieldsReader->rawDocs(rawDocLengths.values, start, numDocs);
+            fieldsWriter.addRawDocuments(stream, rawDocLengths.values, numDocs);
+            docCount += numDocs;
+            if (abortCheck != NULL)
+              abortCheck->work(300*numDocs);
+          } else {
+            doc.clear();
+            reader->document(j, doc, &fieldSelectorMerge);
+            fieldsWriter.addDocument(&doc);
             j++;
-        }
+            docCount++;
+            if (abortCheck != NULL)
+              abortCheck->work(300);
+          }
+        } else
+          j++;
       }
-    } _CLFINALLY (
-      fieldsWriter.close();
-    )
-
-    CND_PRECONDITION (docCount*8 == directory->fileLength( (segment + "." + IndexFileNames::FIELDS_INDEX_EXTENSION).c_str() ),
-    (string("after mergeFields: fdx size mismatch: ") + Misc::toString(docCount) + " docs vs " + Misc::toString(directory->fileLength( (segment + "." + IndexFileNames::FIELDS_INDEX_EXTENSION).c_str() )) + " length in bytes of " + segment + "." + IndexFileNames::FIELDS_INDEX_EXTENSION).c_str() );
-
-  } else{
-    // If we are skipping the doc stores, that means there
-    // are no deletions in any of these segments, so we
-    // just sum numDocs() of each segment to get total docCount
-    for (size_t i = 0; i < readers.size(); i++)
-      docCount += readers[i]->numDocs();
-  }
-  return docCount;
+    }
+  } _CLFINALLY (
+    fieldsWriter.close();
+  )
+
+  CND_PRECONDITION (fieldsWriter.getFormatSize()+docCount*8 == directory->fileLength( (segment + "." + IndexFileNames::FIELDS_INDEX_EXTENSION).c_str() ),
+  (string("after mergeFields: fdx size mismatch: ") + Misc::toString(docCount) + " docs vs " + Misc::toString(directory->fileLength( (segment + "." + IndexFileNames::FIELDS_INDEX_EXTENSION).c_str() )) + " length in bytes of " + segment + "." + IndexFileNames::FIELDS_INDEX_EXTENSION).c_str() );
+  CND_CONDITION(docCount == mergedDocs, "stored documents do not match the documents of the readers");
 }
 
 
-void SegmentMerger::mergeVectors(){
+void SegmentMerger::mergeVectors(CheckAbort* abortCheck){
 	TermVectorsWriter* termVectorsWriter =
 		_CLNEW TermVectorsWriter(directory, segment.c_str(), fieldInfos);
 
@@ -401,8 +491,8 @@ void SegmentMerger::mergeVectors(){
 					termVectorsWriter->addAllDocVectors(tmp);
 				  _CLLDELETE(tmp);
 //        }
-          if (checkAbort != NULL)
-            checkAbort->work(300);
+          if (abortCheck != NULL)
+            abortCheck->work(300);
 			}
 		}
 	}_CLFINALLY(
@@ -418,7 +508,7 @@ void SegmentMerger::mergeVectors(){
 }
 
 
-void SegmentMerger::mergeTerms() {
+void SegmentMerger::mergeTerms(CheckAbort* abortCheck) {
 //Func - Merge the terms of all segments
 //Pre  - fieldInfos != NULL
 //Post - The terms of all segments have been merged
@@ -445,7 +535,7 @@ void SegmentMerger::mergeTerms() {
       queue = _CLNEW SegmentMergeQueue(readers.size());
 
       //And merge the Term Infos
-      mergeTermInfos();
+      mergeTermInfos(abortCheck);
     }_CLFINALLY(
       if ( freqOutput != NULL ){
         freqOutput->close();
@@ -466,7 +556,7 @@ void SegmentMerger::mergeTerms() {
     );
 }
 
-void SegmentMerger::mergeTermInfos(){
+void SegmentMerger::mergeTermInfos(CheckAbort* abortCheck){
 //Func - Merges all TermInfos into a single segment
 //Pre  - true
 //Post - All TermInfos have been merged into a single segment
@@ -547,8 +637,8 @@ void SegmentMerger::mergeTermInfos(){
         top = queue->top();
       }
       int32_t df = mergeTermInfo(match, matchSize);		  // add new TermInfo
-      if (checkAbort != NULL)
-        checkAbort->work(df/3.0);
+      if (abortCheck != NULL)
+        abortCheck->work(df/3.0);
 
       //Restore the SegmentTermInfo instances in the match array back into the queue
       while (matchSize > 0){
@@ -627,7 +717,9 @@ int32_t SegmentMerger::appendPostings(SegmentMergeInfo** smis, int32_t n){
   int32_t df = 0;       //Document Counter
 
   skipListWriter->resetSkip();
-  bool storePayloads = fieldInfos->fieldInfo(smis[0]->term->field())->storePayloads;
+  FieldInfo* fieldInfo = fieldInfos->fieldInfo(smis[0]->term->field());
+  bool storePayloads = fieldInfo->storePayloads;
+  bool omitTf = fieldInfo->omitTf;
   int32_t lastPayloadLength = -1;   // ensures that we write the first length
 
   SegmentMergeInfo* smi = NULL;
@@ -674,6 +766,12 @@ int32_t SegmentMerger::appendPostings(SegmentMergeInfo** smis, int32_t n){
       int32_t docCode = (doc - lastDoc) << 1;
       lastDoc = doc;
 
+      if (omitTf) {
+        //write doc only, tf and positions are dropped
+        freqOutput->writeVInt(docCode >> 1);
+        continue;
+      }
+
       //Get the frequency of the Term
       int32_t freq = postings->freq();
       if (freq == 1){
@@ -723,7 +821,7 @@ int32_t SegmentMerger::appendPostings(SegmentMergeInfo** smis, int32_t n){
   return df;
 }
 
-void SegmentMerger::mergeNorms() {
+void SegmentMerger::mergeNorms(CheckAbort* abortCheck) {
 //Func - Merges the norms for all fields
 //Pre  - fieldInfos != NULL
 //Post - The norms for all fields have been merged
@@ -760,6 +858,9 @@ void SegmentMerger::mergeNorms() {
 
 			    //Get the total number of documents including the documents that have been marked deleted
 			    size_t maxDoc = reader->maxDoc();
+			    //a merge of segments whose documents were all deleted leaves an empty one
+			    if (maxDoc == 0)
+			      continue;
 
 			    //Get an IndexInput to the norm file for this field in this segment
           if ( normBuffer.length < maxDoc ){
@@ -783,8 +884,8 @@ void SegmentMerger::mergeNorms() {
 					    }
 				    }
 			    }
-          if (checkAbort != NULL)
-            checkAbort->work(maxDoc);
+          if (abortCheck != NULL)
+            abortCheck->work(maxDoc);
 		    }
 	    }
 	  }
@@ -797,6 +898,91 @@ void SegmentMerger::mergeNorms() {
 }
 
 
+void SegmentMerger::mergeDocValues(CheckAbort* abortCheck) {
+  std::vector<IndexReader*> leaves;
+  for (size_t i = 0; i < readers.size(); i++)
+    readers[i]->gatherSubReaders(leaves);
+
+  DocValuesWriter* writer = NULL;
+  try {
+    for (size_t i = 0; i < fieldInfos->size(); i++) {
+      const TCHAR* field = fieldInfos->fieldInfo(i)->name;
+
+      // the field takes the type of the first segment with values,
+      // segments with values of the other type have none
+      bool numeric = false;
+      bool sorted = false;
+      for (size_t j = 0; j < leaves.size() && !numeric && !sorted; j++) {
+        numeric = leaves[j]->getNumericDocValues(field) != NULL;
+        sorted = !numeric && leaves[j]->getSortedDocValues(field) != NULL;
+      }
+      if (!numeric && !sorted)
+        continue;
+
+      if (writer == NULL)
+        writer = _CLNEW DocValuesWriter(directory, segment.c_str());
+
+      int32_t docUpto = 0;
+      if (numeric) {
+        ValueArray<int64_t> values(mergedDocs);
+        for (size_t j = 0; j < leaves.size(); j++) {
+          IndexReader* reader = leaves[j];
+          NumericDocValues* dv = reader->getNumericDocValues(field);
+          const int32_t maxDoc = reader->maxDoc();
+          for (int32_t k = 0; k < maxDoc; k++) {
+            if (!reader->isDeleted(k))
+              values.values[docUpto++] = dv == NULL ? 0 : dv->get(k);
+          }
+          if (abortCheck != NULL)
+            abortCheck->work(maxDoc);
+        }
+        writer->addNumeric(field, values.values, mergedDocs);
+      } else {
+        // the dictionary of the merged segment holds the values of all the segments
+        std::vector<const TCHAR*> dictionary;
+        for (size_t j = 0; j < leaves.size(); j++) {
+          SortedDocValues* dv = leaves[j]->getSortedDocValues(field);
+          if (dv == NULL)
+            continue;
+          for (int32_t ord = 0; ord < dv->getValueCount(); ord++)
+            dictionary.push_back(dv->lookupOrd(ord));
+        }
+        std::sort(dictionary.begin(), dictionary.end(), Compare::TChar());
+        dictionary.erase(std::unique(dictionary.begin(), dictionary.end(), Equals::TChar()), dictionary.end());
+
+        ValueArray<int32_t> ords(mergedDocs);
+        for (size_t j = 0; j < leaves.size(); j++) {
+          IndexReader* reader = leaves[j];
+          SortedDocValues* dv = reader->getSortedDocValues(field);
+          const int32_t maxDoc = reader->maxDoc();
+
+          // maps the ordinals of this segment to the merged dictionary
+          ValueArray<int32_t> ordMap(dv == NULL ? 0 : dv->getValueCount());
+          for (size_t ord = 0; ord < ordMap.length; ord++)
+            ordMap.values[ord] = (int32_t)(std::lower_bound(dictionary.begin(), dictionary.end(),
+              dv->lookupOrd(ord), Compare::TChar()) - dictionary.begin());
+
+          for (int32_t k = 0; k < maxDoc; k++) {
+            if (reader->isDeleted(k))
+              continue;
+            const int32_t ord = dv == NULL ? -1 : dv->getOrd(k);
+            ords.values[docUpto++] = ord == -1 ? -1 : ordMap[ord];
+          }
+          if (abortCheck != NULL)
+            abortCheck->work(maxDoc);
+        }
+        writer->addSorted(field, dictionary.empty() ? NULL : &dictionary[0], (int32_t)dictionary.size(),
+          ords.values, mergedDocs);
+      }
+      CND_CONDITION(docUpto == mergedDocs, "doc values do not match the documents of the readers");
+    }
+    if (writer != NULL)
+      writer->close();
+  }_CLFINALLY(
+    _CLDELETE(writer);
+  );
+}
+
 SegmentMerger::CheckAbort::CheckAbort(MergePolicy::OneMerge* merge, Directory* dir) {
   this->merge = merge;
   this->dir = dir;
@@ -17,6 +17,7 @@
 #include "CLucene/store/FSDirectory.h"
 #include "CLucene/util/PriorityQueue.h"
 #include "_SegmentMerger.h"
+#include "_DocValues.h"
 #include <assert.h>
 
 CL_NS_USE(util)
@@ -33,12 +34,14 @@ CL_NS_DEF(index)
     useSingleNormStream(_useSingleNormStream),
 	in(instrm),
 	bytes(NULL),
+	mappedInput(NULL),
+	mapped(false),
 	dirty(false){
   //Func - Constructor
   //Pre  - instrm is a valid reference to an IndexInput
   //Post - A Norm instance has been created with an empty bytes array
 
-    refCount = 1;
+    _LUCENE_ATOMIC_INT_SET(refCount, 1);
 	  bytes = NULL;
     dirty = false;
   }
@@ -54,12 +57,17 @@ CL_NS_DEF(index)
       if ( in != _this->singleNormStream )
     	  _CLDELETE(in);
 
-	  //Delete the bytes array
-      _CLDELETE_ARRAY(bytes);
+	  //Delete the bytes array, unless it points into the mapping
+      if ( !mapped )
+        _CLDELETE_ARRAY(bytes);
+      if ( mappedInput != NULL ){
+        mappedInput->close();
+        _CLDELETE(mappedInput);
+      }
 
   }
   void SegmentReader::Norm::doDelete(Norm* norm){
-    if ( norm->refCount == 0 ){
+    if ( _LUCENE_ATOMIC_INT_GET(norm->refCount) == 0 ){
       _CLLDELETE(norm);
     }
   }
@@ -74,18 +82,16 @@ CL_NS_DEF(index)
   }
 
   void SegmentReader::Norm::incRef() {
-    SCOPED_LOCK_MUTEX(THIS_LOCK)
-    assert (refCount > 0);
-    refCount++;
+    assert (_LUCENE_ATOMIC_INT_GET(refCount) > 0);
+    _LUCENE_ATOMIC_INC(&refCount);
   }
 
   void SegmentReader::Norm::decRef(){
-    SCOPED_LOCK_MUTEX(THIS_LOCK)
-    assert (refCount > 0);
-    if (refCount == 1) {
+    assert (_LUCENE_ATOMIC_INT_GET(refCount) > 0);
+    //only the last reference closes the input, which takes the lock
+    if (_LUCENE_ATOMIC_DEC(&refCount) == 0) {
       close();
     }
-    refCount--;
   }
   void SegmentReader::Norm::reWrite(SegmentInfo* si){
       // NOTE: norms are re-written in regular directory, not cfs
@@ -125,6 +131,7 @@ CL_NS_DEF(index)
     this->freqStream       = NULL;
     this->proxStream       = NULL;
     this->singleNormStream = NULL;
+    this->docValues = NULL;
     this->termVectorsReaderOrig = NULL;
     this->_fieldInfos = NULL;
     this->tis = NULL;
@@ -200,6 +207,9 @@ CL_NS_DEF(index)
       proxStream = cfsDir->openInput( (segment + ".prx").c_str(), readBufferSize);
       openNorms(cfsDir, readBufferSize);
 
+      if (cfsDir->fileExists( (segment + "." + IndexFileNames::DOCVALUES_EXTENSION).c_str() ))
+        docValues = _CLNEW DocValuesReader(cfsDir, segment.c_str(), si->docCount);
+
       if (doOpenStores && _fieldInfos->hasVectors()) { // open term vector files only as needed
         string vectorsSegment;
         if (si->getDocStoreOffset() != -1)
@@ -250,7 +260,11 @@ CL_NS_DEF(index)
 
   SegmentReader::SegmentReader():
     DirectoryIndexReader(),
-    _norms(false,true)
+    _norms(false,true),
+    maxTermFreqs(true,true),
+    firstMaxTermFreq(NULL),
+    lastMaxTermFreq(NULL),
+    maxNorms(true,false)
   {
   }
   SegmentReader::~SegmentReader(){
@@ -344,6 +358,9 @@ CL_NS_DEF(index)
           _CLDELETE(termVectorsReaderOrig);
       }
 
+      // the columns may read from the compound file
+      _CLDELETE(docValues);
+
       if (cfsReader != NULL){
         cfsReader->close();
         _CLDECDELETE(cfsReader);
@@ -418,6 +435,9 @@ CL_NS_DEF(index)
       _CLDELETE(deletedDocs);
       deletedDocsDirty = false;
       undeleteAll = true;
+
+      SCOPED_LOCK_MUTEX(THIS_LOCK)
+      clearMaxTermFreqs(); //computed without the deleted documents
   }
 
   void SegmentReader::files(vector<string>& retarray) {
@@ -507,6 +527,73 @@ CL_NS_DEF(index)
       return _CLNEW SegmentTermPositions(this);
   }
 
+  int32_t SegmentReader::maxTermFreq(Term* t) {
+      {
+        SCOPED_LOCK_MUTEX(THIS_LOCK)
+        MaxTermFreqsType::iterator itr = maxTermFreqs.find(t);
+        if ( itr != maxTermFreqs.end() ){
+          MaxTermFreq* entry = itr->second;
+          if ( entry != firstMaxTermFreq ){ //move to the front
+            entry->prev->next = entry->next;
+            if ( entry->next == NULL )
+              lastMaxTermFreq = entry->prev;
+            else
+              entry->next->prev = entry->prev;
+            entry->prev = NULL;
+            entry->next = firstMaxTermFreq;
+            firstMaxTermFreq->prev = entry;
+            firstMaxTermFreq = entry;
+          }
+          return entry->freq;
+        }
+      }
+      //scanning the postings is done outside the lock
+      int32_t ret = DirectoryIndexReader::maxTermFreq(t);
+
+      SCOPED_LOCK_MUTEX(THIS_LOCK)
+      if ( maxTermFreqs.exists(t) )
+        return ret; //cached by another thread meanwhile
+      if ( maxTermFreqs.size() >= MAX_TERM_FREQS_CACHE_SIZE ){
+        //evict the least recently used term
+        MaxTermFreq* evicted = lastMaxTermFreq;
+        lastMaxTermFreq = evicted->prev;
+        lastMaxTermFreq->next = NULL;
+        maxTermFreqs.remove(evicted->term);
+      }
+      MaxTermFreq* entry = _CLNEW MaxTermFreq;
+      entry->term = _CLNEW Term(t->field(), t->text());
+      entry->freq = ret;
+      entry->prev = NULL;
+      entry->next = firstMaxTermFreq;
+      if ( firstMaxTermFreq == NULL )
+        lastMaxTermFreq = entry;
+      else
+        firstMaxTermFreq->prev = entry;
+      firstMaxTermFreq = entry;
+      maxTermFreqs.put(entry->term, entry);
+      return ret;
+  }
+
+  void SegmentReader::clearMaxTermFreqs() {
+      maxTermFreqs.clear();
+      firstMaxTermFreq = lastMaxTermFreq = NULL;
+  }
+
+  uint8_t SegmentReader::maxNorm(const TCHAR* field) {
+      {
+        SCOPED_LOCK_MUTEX(THIS_LOCK)
+        MaxNormsType::iterator itr = maxNorms.find((TCHAR*)field);
+        if ( itr != maxNorms.end() )
+          return (uint8_t)itr->second;
+      }
+      uint8_t ret = DirectoryIndexReader::maxNorm(field);
+
+      SCOPED_LOCK_MUTEX(THIS_LOCK)
+      if ( !maxNorms.exists((TCHAR*)field) )
+        maxNorms.put(stringDuplicate(field), ret);
+      return ret;
+  }
+
   int32_t SegmentReader::docFreq(const Term* t) {
   //Func - Returns the number of documents which contain the term t
   //Pre  - t holds a valid reference to a Term
@@ -586,6 +673,8 @@ void SegmentReader::getFieldNames(FieldOption fldOption, StringArrayWithDeletor&
 			else if (fi->isIndexed && (fldOption & IndexReader::INDEXED) )
 				v=true;
       else if (fi->storePayloads && (fldOption & IndexReader::STORES_PAYLOADS) )
+        v=true;
+      else if (fi->omitTf && (fldOption & IndexReader::OMIT_TF) )
         v=true;
 			else if (fi->isIndexed && fi->storeTermVector == false && ( fldOption & IndexReader::INDEXED_NO_TERMVECTOR) )
 				v=true;
@@ -616,6 +705,16 @@ bool SegmentReader::hasNorms(const TCHAR* field){
 	return _norms.find(field) != _norms.end();
 }
 
+  NumericDocValues* SegmentReader::getNumericDocValues(const TCHAR* field){
+    ensureOpen();
+    return docValues == NULL ? NULL : docValues->getNumeric(field);
+  }
+
+  SortedDocValues* SegmentReader::getSortedDocValues(const TCHAR* field){
+    ensureOpen();
+    return docValues == NULL ? NULL : docValues->getSorted(field);
+  }
+
 
   void SegmentReader::norms(const TCHAR* field, uint8_t* bytes) {
   //Func - Reads the Norms for field from disk starting at offset in the inputstream
@@ -677,9 +776,18 @@ bool SegmentReader::hasNorms(const TCHAR* field){
 
     {SCOPED_LOCK_MUTEX(norm->THIS_LOCK)
       if (norm->bytes == NULL) {                     // value not yet read
-        uint8_t* bytes = _CL_NEWARRAY(uint8_t, maxDoc());
-        norms(field, bytes);
-        norm->bytes = bytes;                         // cache it
+        // use the norms in place if the file is mapped in memory
+        IndexInput* normStream = norm->useSingleNormStream ? singleNormStream : norm->in;
+        const uint8_t* mapped = NULL;
+        norm->mappedInput = normStream->mapBytes(norm->normSeek, maxDoc(), mapped);
+        if ( norm->mappedInput != NULL ){
+          norm->bytes = const_cast<uint8_t*>(mapped);
+          norm->mapped = true;
+        }else{
+          uint8_t* bytes = _CL_NEWARRAY(uint8_t, maxDoc());
+          norms(field, bytes);
+          norm->bytes = bytes;                         // cache it
+        }
         // it's OK to close the underlying IndexInput as we have cached the
         // norms and will never read them again.
         norm->close();
@@ -743,8 +851,24 @@ bool SegmentReader::hasNorms(const TCHAR* field){
       return;
     norm->dirty = true;                            // mark it dirty
     normsDirty = true;
+    {
+      SCOPED_LOCK_MUTEX(THIS_LOCK)
+      maxNorms.clear();
+    }
 
     uint8_t* bits = norms(field);
+    {
+      SCOPED_LOCK_MUTEX(norm->THIS_LOCK)
+      if (norm->mapped) {
+        // mapped norms are read only, so copy them before the first change.
+        // The mapping is kept, as the old array may still be in use
+        bits = _CL_NEWARRAY(uint8_t, maxDoc());
+        memcpy(bits, norm->bytes, maxDoc());
+        norm->bytes = bits;
+        norm->mapped = false;
+      }
+      bits = norm->bytes;
+    }
     bits[doc] = value;                    // set the value
   }
 
@@ -942,6 +1066,7 @@ bool SegmentReader::hasNorms(const TCHAR* field){
       clone->freqStream = freqStream;
       clone->proxStream = proxStream;
       clone->termVectorsReaderOrig = termVectorsReaderOrig;
+      clone->docValues = docValues;
 
       // we have to open a new FieldsReader, because it is not thread-safe
       // and can thus not be shared among multiple SegmentReaders
@@ -1044,6 +1169,7 @@ bool SegmentReader::hasNorms(const TCHAR* field){
     this->cfsReader = NULL;
     this->storeCFSReader = NULL;
     this->singleNormStream = NULL;
+    this->docValues = NULL;
 
     return clone;
   }
@@ -1111,7 +1237,7 @@ bool SegmentReader::hasNorms(const TCHAR* field){
     NormsType::iterator it = _norms.begin();
     while ( it != _norms.end() ) {
       Norm* norm = it->second;
-      if (norm->refCount > 0) {
+      if (_LUCENE_ATOMIC_INT_GET(norm->refCount) > 0) {
         return false;
       }
     }
@@ -57,6 +57,7 @@ CL_NS_DEF(index)
 	  count = 0;
 	  FieldInfo* fi = parent->_fieldInfos->fieldInfo(term->field());
 	  currentFieldStoresPayloads = (fi != NULL) ? fi->storePayloads : false;
+	  currentFieldOmitTf = (fi != NULL) ? fi->omitTf : false;
 	  if (ti == NULL) {
 		  df = 0;
 	  } else {					// punt case
@@ -88,11 +89,16 @@ CL_NS_DEF(index)
         return false;
 
       uint32_t docCode = freqStream->readVInt();
-      _doc += docCode >> 1; //unsigned shift
-      if ((docCode & 1) != 0)			  // if low bit is set
-        _freq = 1;				  // _freq is one
-      else
-        _freq = freqStream->readVInt();		  // else read _freq
+      if (currentFieldOmitTf) {
+        _doc += docCode;  // only the doc delta is stored
+        _freq = 1;
+      } else {
+        _doc += docCode >> 1; //unsigned shift
+        if ((docCode & 1) != 0)			  // if low bit is set
+          _freq = 1;				  // _freq is one
+        else
+          _freq = freqStream->readVInt();		  // else read _freq
+      }
       count++;
 
       if ( (deletedDocs == NULL) || (_doc >= 0 && deletedDocs->get(_doc) == false ) )
@@ -102,24 +108,102 @@ CL_NS_DEF(index)
     return true;
   }
 
+  //decodes a VInt from a buffer which is known to hold all of its bytes
+  static inline uint32_t decodeVInt(const uint8_t*& p){
+	  uint8_t b = *p++;
+	  uint32_t i = b & 0x7F;
+	  for (int32_t shift = 7; (b & 0x80) != 0; shift += 7) {
+		  b = *p++;
+		  i |= (b & 0x7F) << shift;
+	  }
+	  return i;
+  }
+
+  int32_t SegmentTermDocs::readPostings(int32_t* docs, int32_t* freqs, const int32_t max) {
+	  int32_t n = 0;
+	  int32_t doc = _doc;
+	  if (currentFieldOmitTf) {
+		  // postings are bare doc deltas and every freq is one
+		  while (n < max) {
+			  int32_t available;
+			  const uint8_t* window = freqStream->peekBuffer(available);
+			  if (window != NULL && available >= 5) {
+				  const uint8_t* p = window;
+				  const uint8_t* end = window + available - 5;
+				  while (n < max && p <= end) {
+					  doc += decodeVInt(p);
+					  docs[n] = doc;
+					  freqs[n] = 1;
+					  n++;
+				  }
+				  freqStream->consumeBuffer((int32_t)(p - window));
+			  } else {
+				  doc += freqStream->readVInt();
+				  docs[n] = doc;
+				  freqs[n] = 1;
+				  n++;
+			  }
+		  }
+		  _doc = doc;
+		  if (n > 0)
+			  _freq = 1;
+		  return n;
+	  }
+	  while (n < max) {
+		  int32_t available;
+		  const uint8_t* window = freqStream->peekBuffer(available);
+		  if (window != NULL && available >= 10) {
+			  // a posting is at most two VInts of 5 bytes, so the loop only
+			  // needs to check the window bounds once per posting
+			  const uint8_t* p = window;
+			  const uint8_t* end = window + available - 10;
+			  while (n < max && p <= end) {
+				  const uint32_t docCode = decodeVInt(p);
+				  doc += docCode >> 1;
+				  docs[n] = doc;
+				  freqs[n] = (docCode & 1) != 0 ? 1 : decodeVInt(p);
+				  n++;
+			  }
+			  freqStream->consumeBuffer((int32_t)(p - window));
+		  } else {
+			  // no buffer, or the posting may cross its end
+			  const uint32_t docCode = freqStream->readVInt();
+			  doc += docCode >> 1;
+			  docs[n] = doc;
+			  freqs[n] = (docCode & 1) != 0 ? 1 : freqStream->readVInt();
+			  n++;
+		  }
+	  }
+	  _doc = doc;
+	  if (n > 0)
+		  _freq = freqs[n-1];
+	  return n;
+  }
+
   int32_t SegmentTermDocs::read(int32_t* docs, int32_t* freqs, int32_t length) {
 	  int32_t i = 0;
-	  //todo: one optimization would be to get the pointer buffer for ram or mmap dirs 
-	  //and iterate over them instead of using readByte() intensive functions.
 	  while (i<length && count < df) {
-		  // manually inlined call to next() for speed
-		  uint32_t docCode = freqStream->readVInt();
-		  _doc += docCode >> 1;
-		  if ((docCode & 1) != 0)			  // if low bit is set
-			  _freq = 1;				  // _freq is one
-		  else
-			  _freq = freqStream->readVInt();		  // else read _freq
-		  count++;
-
-		  if (deletedDocs == NULL || (_doc >= 0 && !deletedDocs->get(_doc))) {
-			  docs[i] = _doc;
-			  freqs[i] = _freq;
-			  i++;
+		  const int32_t start = i;
+		  const int32_t max = (length - i) < (df - count) ? (length - i) : (df - count);
+		  const int32_t n = readPostings(docs + start, freqs + start, max);
+		  count += n;
+		  i += n;
+
+		  if (deletedDocs == NULL)
+			  continue;
+		  // a dense block is checked for deletions a byte of docs at a time,
+		  // and only a block with deletions is filtered doc by doc
+		  const int32_t first = docs[start];
+		  const int32_t last = docs[start + n - 1];
+		  if ( ((last - first) >> 3) <= n && !deletedDocs->anySet(first, last) )
+			  continue;
+		  i = start;
+		  for (int32_t j = start; j < start + n; j++) {
+			  if (!deletedDocs->get(docs[j])) {
+				  docs[i] = docs[j];
+				  freqs[i] = freqs[j];
+				  i++;
+			  }
 		  }
 	  }
 	  return i;
@@ -17,6 +17,60 @@
 CL_NS_USE(store)
 CL_NS_DEF(index)
 
+	/** Encodes len TCHARs the way IndexOutput::writeChars does, so that
+	* the bytes compare with memcmp like the terms of the Term Infos File */
+	static int32_t encodeChars(const TCHAR* s, const size_t len, uint8_t* out){
+		uint8_t* p = out;
+		for (size_t i = 0; i < len; ++i) {
+			const int32_t code = (int32_t)s[i];
+			if (code >= 0x01 && code <= 0x7F)
+				*p++ = (uint8_t)code;
+			else if (((code >= 0x80) && (code <= 0x7FF)) || code == 0) {
+				*p++ = (uint8_t)(0xC0 | (code >> 6));
+				*p++ = (uint8_t)(0x80 | (code & 0x3F));
+			} else {
+				*p++ = (uint8_t)(0xE0 | (((uint32_t)code) >> 12));
+				*p++ = (uint8_t)(0x80 | ((code >> 6) & 0x3F));
+				*p++ = (uint8_t)(0x80 | (code & 0x3F));
+			}
+		}
+		return (int32_t)(p - out);
+	}
+
+	/** Decodes length bytes like IndexInput::readChars, returns the number of TCHARs */
+	static int32_t decodeChars(const uint8_t* in, const int32_t length, TCHAR* out){
+		const uint8_t* end = in + length;
+		TCHAR* p = out;
+		while ( in < end ){
+			TCHAR b = *in++;
+			if ((b & 0x80) == 0) {
+				// Do Nothing.
+			} else if ((b & 0xE0) != 0xE0) {
+				b = (((b & 0x1F) << 6) | (*in++ & 0x3F));
+			} else {
+				b = ((b & 0x0F) << 12) | ((*in++ & 0x3F) << 6);
+				b |= (*in++ & 0x3F);
+			}
+			*p++ = b;
+		}
+		return (int32_t)(p - out);
+	}
+
+	/** Returns the number of bytes taken by the first chars characters */
+	static inline int32_t charsToBytes(const uint8_t* in, const int32_t chars){
+		const uint8_t* p = in;
+		for (int32_t i = 0; i < chars; ++i) {
+			const uint8_t b = *p;
+			if ((b & 0x80) == 0)
+				p++;
+			else if ((b & 0xE0) != 0xE0)
+				p += 2;
+			else
+				p += 3;
+		}
+		return (int32_t)(p - in);
+	}
+
 	SegmentTermEnum::SegmentTermEnum(IndexInput* i, FieldInfos* fis, const bool isi):
 		fieldInfos(fis){
 	//Func - Constructor
@@ -34,6 +88,13 @@ CL_NS_DEF(index)
 		buffer       = NULL;
 		bufferLength = 0;
 		prev         = NULL;
+		textBytesCapacity = 0;
+		textBytes    = NULL;
+		prevTextBytes = NULL;
+		textBytesLength = 0;
+		prevTextBytesLength = 0;
+		fieldNumber  = -1;
+		prevFieldNumber = -1;
 		formatM1SkipInterval = 0;
 		maxSkipLevels = 1;
 		
@@ -108,6 +169,20 @@ CL_NS_DEF(index)
 		prev         = clone.prev==NULL?NULL:_CLNEW Term(clone.prev->field(),clone.prev->text(),false);
 		size         = clone.size;
 
+		textBytesCapacity = clone.textBytesCapacity;
+		textBytes    = NULL;
+		prevTextBytes = NULL;
+		if ( textBytesCapacity > 0 ){
+			textBytes = (uint8_t*)malloc(textBytesCapacity);
+			prevTextBytes = (uint8_t*)malloc(textBytesCapacity);
+			memcpy(textBytes,clone.textBytes,clone.textBytesLength);
+			memcpy(prevTextBytes,clone.prevTextBytes,clone.prevTextBytesLength);
+		}
+		textBytesLength = clone.textBytesLength;
+		prevTextBytesLength = clone.prevTextBytesLength;
+		fieldNumber  = clone.fieldNumber;
+		prevFieldNumber = clone.prevFieldNumber;
+
       format       = clone.format;
       indexInterval= clone.indexInterval;
       skipInterval = clone.skipInterval;
@@ -138,6 +213,8 @@ CL_NS_DEF(index)
 
 		//Delete the buffer if necessary
 		if ( buffer != NULL ) free(buffer);
+		if ( textBytes != NULL ) free(textBytes);
+		if ( prevTextBytes != NULL ) free(prevTextBytes);
 		//Delete termInfo if necessary
 		_CLDELETE(termInfo);
 
@@ -179,6 +256,12 @@ CL_NS_DEF(index)
 		//term becomes the next term read from inputStream input
 		_term = readTerm(tmp);
 
+		readTermInfo();
+
+		return true;
+	}
+
+	void SegmentTermEnum::readTermInfo(){
 		//Read docFreq, the number of documents which contain the term.
 		termInfo->docFreq = input->readVInt();
 		//Read freqPointer, a pointer into the TermFreqs file (.frq)
@@ -204,8 +287,6 @@ CL_NS_DEF(index)
 		if (isIndex)
 			//read index pointer
 			indexPointer += input->readVLong();
-
-		return true;
 	}
 
 	Term* SegmentTermEnum::term(bool pointer) {
@@ -215,14 +296,68 @@ CL_NS_DEF(index)
 			return _term;
 	}
 
-	void SegmentTermEnum::scanTo(const Term *term){
+	bool SegmentTermEnum::scanTo(const Term *term){
 	//Func - Scan for Term without allocating new Terms
 	//Pre  - term != NULL
 	//Post - The iterator term has been moved to the position where Term is expected to be
 	//       in the enumeration
-		while ( term->compareTo(this->_term) > 0 && next()) 
-		{
-		}
+		if ( _term == NULL )
+			return false;
+
+		//encode term like the Term Infos File, so that the terms skipped over
+		//are compared without being decoded
+		uint8_t stackBytes[256];
+		const size_t len = term->textLength();
+		uint8_t* bytes = len * 3 <= sizeof(stackBytes) ? stackBytes : _CL_NEWARRAY(uint8_t, len * 3);
+		int32_t c = 0;
+		try{
+			const int32_t length = encodeChars(term->text(), len, bytes);
+			const int32_t number = fieldInfos->fieldNumber(term->field());
+
+			int64_t scanned = 0;
+			while ( (c = compareToCurrent(term->field(), number, bytes, length)) > 0 && position < size-1 ){
+				//the current term becomes the previous one
+				uint8_t* tmp = prevTextBytes;
+				prevTextBytes = textBytes;
+				textBytes = tmp;
+				prevTextBytesLength = textBytesLength;
+				prevFieldNumber = fieldNumber;
+
+				position++;
+				int32_t start;
+				readTermBytes(true, start);
+				readTermInfo();
+				scanned++;
+			}
+
+			if ( scanned > 0 ){
+				//bring prev and term up to date with the bytes. Terms that
+				//are referenced elsewhere cannot be reused
+				if ( prev != NULL && _LUCENE_ATOMIC_INT_GET(prev->__cl_refcount) > 1 )
+					_CLDECDELETE(prev);
+				prev = decodeTerm(prev, prevFieldNumber, prevTextBytes, prevTextBytesLength);
+				if ( _LUCENE_ATOMIC_INT_GET(_term->__cl_refcount) > 1 )
+					_CLDECDELETE(_term);
+				_term = decodeTerm(_term, fieldNumber, textBytes, textBytesLength);
+			}
+		}_CLFINALLY(
+			if ( bytes != stackBytes )
+				_CLDELETE_LARRAY(bytes);
+		)
+
+		//term sorts after the last term
+		if ( c > 0 )
+			next();
+		return c == 0;
+	}
+
+	int32_t SegmentTermEnum::compareToCurrent(const TCHAR* field, int32_t number, const uint8_t* bytes, int32_t length) const{
+		if ( number != fieldNumber || number == -1 )
+			return _tcscmp(field, fieldInfos->fieldName(fieldNumber));
+		const int32_t c = memcmp(bytes, textBytes, cl_min(length, textBytesLength));
+		if ( c != 0 )
+			return c;
+		return length - textBytesLength;
 	}
 
 	void SegmentTermEnum::close() {
@@ -264,6 +399,10 @@ CL_NS_DEF(index)
 		}
 		_term->set(t,t->text());
 
+		fieldNumber = fieldInfos->fieldNumber(t->field());
+		growTextBytes((int32_t)t->textLength() * 3);
+		textBytesLength = encodeChars(t->text(), t->textLength(), textBytes);
+
 		//finalize prev
 		_CLDECDELETE(prev);
 
@@ -327,26 +466,25 @@ CL_NS_DEF(index)
 	//Pre  - true
 	//Post - The next Term in the enumeration has been read and returned
 
-		//Read the start position from the inputStream input
-		int32_t start = input->readVInt();
-		//Read the length of term in the inputStream input
-		int32_t length = input->readVInt();
+		//The buffer holds the text of the previous term, which shares all
+		//but the bytes read with the new one
+		int32_t start;
+		const int32_t byteStart = readTermBytes(false, start);
 
 		//Calculated the total lenght of bytes that buffer must be to contain the current
 		//chars in buffer and the new ones yet to be read
-		uint32_t totalLength = start + length;
+		uint32_t totalLength = start + textBytesLength - byteStart;
 
 		if (static_cast<uint32_t>(bufferLength) < totalLength+1)
 			growBuffer(totalLength, false); //dont copy the buffer over.
 
-		//Read a length number of characters into the buffer from position start in the inputStream input
-		input->readChars(buffer, start, length);
+		//Decode the new characters into the buffer from position start
+		totalLength = start + decodeChars(textBytes + byteStart, textBytesLength - byteStart, buffer + start);
 		//Null terminate the string
 		buffer[totalLength] = 0;
 
 		//Return a new Term	
-		int32_t field = input->readVInt();
-		const TCHAR* fieldname = fieldInfos->fieldName(field);
+		const TCHAR* fieldname = fieldInfos->fieldName(fieldNumber);
 		if ( reuse == NULL )
 			reuse = _CLNEW Term;
 
@@ -354,6 +492,43 @@ CL_NS_DEF(index)
 		return reuse;
 	}
 
+	int32_t SegmentTermEnum::readTermBytes(bool fromPrev, int32_t& start) {
+		//Read the start position from the inputStream input
+		start = input->readVInt();
+		//Read the length of term in the inputStream input
+		const int32_t length = input->readVInt();
+
+		//start and length count characters, of up to 3 bytes each
+		const int32_t byteStart = charsToBytes(fromPrev ? prevTextBytes : textBytes, start);
+		growTextBytes(byteStart + length * 3);
+		if ( fromPrev )
+			memcpy(textBytes, prevTextBytes, byteStart);
+
+		textBytesLength = byteStart + input->readCharsUTF8(textBytes + byteStart, length);
+		fieldNumber = input->readVInt();
+		return byteStart;
+	}
+
+	Term* SegmentTermEnum::decodeTerm(Term* reuse, int32_t field, const uint8_t* bytes, int32_t length) {
+		//each character takes at least one byte
+		if (static_cast<uint32_t>(bufferLength) < static_cast<uint32_t>(length)+1)
+			growBuffer(length, false);
+		buffer[decodeChars(bytes, length, buffer)] = 0;
+
+		if ( reuse == NULL )
+			reuse = _CLNEW Term;
+		reuse->set(fieldInfos->fieldName(field), buffer, false);
+		return reuse;
+	}
+
+	void SegmentTermEnum::growTextBytes(const int32_t length) {
+		if ( textBytesCapacity >= length )
+			return;
+		textBytesCapacity = cl_max(length, cl_max(textBytesCapacity * 2, 32));
+		textBytes = (uint8_t*)realloc(textBytes, textBytesCapacity);
+		prevTextBytes = (uint8_t*)realloc(prevTextBytes, textBytesCapacity);
+	}
+
 	void SegmentTermEnum::growBuffer(const uint32_t length, bool force_copy) {
 	//Func - Instantiate a buffer of length length+1
 	//Pre  - length > 0
@@ -51,6 +51,9 @@ void SegmentTermPositions::close() {
 }
 
 int32_t SegmentTermPositions::nextPosition() {
+    if (currentFieldOmitTf)
+      // the field has no positions, every occurrence is at position 0
+      return 0;
     // perform lazy skips if neccessary
 	lazySkip();
     proxCount--;
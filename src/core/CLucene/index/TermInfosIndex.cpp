@@ -0,0 +1,447 @@
+/*------------------------------------------------------------------------------
+* Copyright (C) 2003-2006 Ben van Klinken and the CLucene Team
+*
+* Distributable under the terms of either the Apache License (Version 2.0) or
+* the GNU Lesser General Public License, as specified in the COPYING file.
+------------------------------------------------------------------------------*/
+#include "CLucene/_ApiHeader.h"
+#include "_TermInfosIndex.h"
+#include "Term.h"
+#include "Terms.h"
+#include "_FieldInfos.h"
+#include "_TermInfo.h"
+#include "_SegmentTermEnum.h"
+
+CL_NS_DEF(index)
+
+	//the longest UTF-8 sequence a single TCHAR is encoded to
+	#define TERMINDEX_MAX_CHAR_BYTES 6
+
+	static inline uint32_t charValue(TCHAR c){
+		uint32_t v = (uint32_t)c;
+		if ( sizeof(TCHAR) == 1 )
+			v &= 0xFF;
+		else if ( sizeof(TCHAR) == 2 )
+			v &= 0xFFFF;
+		return v;
+	}
+
+	/** UTF-8 encodes each TCHAR on its own, so a UTF-16 surrogate pair stays
+	* two units and the bytes still sort like the TCHARs. */
+	static int32_t encodeText(const TCHAR* text, size_t len, uint8_t* out){
+		uint8_t* p = out;
+		for ( size_t i=0;i<len;i++ ){
+			const uint32_t c = charValue(text[i]);
+			if ( c < 0x80 ){
+				*p++ = (uint8_t)c;
+			}else if ( c < 0x800 ){
+				*p++ = (uint8_t)(0xC0 | (c >> 6));
+				*p++ = (uint8_t)(0x80 | (c & 0x3F));
+			}else if ( c < 0x10000 ){
+				*p++ = (uint8_t)(0xE0 | (c >> 12));
+				*p++ = (uint8_t)(0x80 | ((c >> 6) & 0x3F));
+				*p++ = (uint8_t)(0x80 | (c & 0x3F));
+			}else if ( c < 0x200000 ){
+				*p++ = (uint8_t)(0xF0 | (c >> 18));
+				*p++ = (uint8_t)(0x80 | ((c >> 12) & 0x3F));
+				*p++ = (uint8_t)(0x80 | ((c >> 6) & 0x3F));
+				*p++ = (uint8_t)(0x80 | (c & 0x3F));
+			}else if ( c < 0x4000000 ){
+				*p++ = (uint8_t)(0xF8 | (c >> 24));
+				*p++ = (uint8_t)(0x80 | ((c >> 18) & 0x3F));
+				*p++ = (uint8_t)(0x80 | ((c >> 12) & 0x3F));
+				*p++ = (uint8_t)(0x80 | ((c >> 6) & 0x3F));
+				*p++ = (uint8_t)(0x80 | (c & 0x3F));
+			}else{
+				*p++ = (uint8_t)(0xFC | ((c >> 30) & 0x01));
+				*p++ = (uint8_t)(0x80 | ((c >> 24) & 0x3F));
+				*p++ = (uint8_t)(0x80 | ((c >> 18) & 0x3F));
+				*p++ = (uint8_t)(0x80 | ((c >> 12) & 0x3F));
+				*p++ = (uint8_t)(0x80 | ((c >> 6) & 0x3F));
+				*p++ = (uint8_t)(0x80 | (c & 0x3F));
+			}
+		}
+		return (int32_t)(p - out);
+	}
+
+	/** Decodes len bytes written by encodeText, returns the number of TCHARs */
+	static int32_t decodeText(const uint8_t* in, int32_t len, TCHAR* out){
+		const uint8_t* end = in + len;
+		TCHAR* p = out;
+		while ( in < end ){
+			const uint8_t b = *in++;
+			uint32_t c;
+			int32_t more;
+			if ( b < 0x80 ){ c = b; more = 0; }
+			else if ( b < 0xE0 ){ c = b & 0x1F; more = 1; }
+			else if ( b < 0xF0 ){ c = b & 0x0F; more = 2; }
+			else if ( b < 0xF8 ){ c = b & 0x07; more = 3; }
+			else if ( b < 0xFC ){ c = b & 0x03; more = 4; }
+			else{ c = b & 0x01; more = 5; }
+			while ( more-- > 0 )
+				c = (c << 6) | (*in++ & 0x3F);
+			*p++ = (TCHAR)c;
+		}
+		return (int32_t)(p - out);
+	}
+
+	static inline int32_t readVInt(const uint8_t*& p){
+		uint8_t b = *p++;
+		int32_t i = b & 0x7F;
+		for ( int32_t shift = 7; (b & 0x80) != 0; shift += 7 ){
+			b = *p++;
+			i |= (b & 0x7F) << shift;
+		}
+		return i;
+	}
+	static inline int64_t readVLong(const uint8_t*& p){
+		uint8_t b = *p++;
+		int64_t i = b & 0x7F;
+		for ( int32_t shift = 7; (b & 0x80) != 0; shift += 7 ){
+			b = *p++;
+			i |= ((int64_t)(b & 0x7F)) << shift;
+		}
+		return i;
+	}
+	static inline void writeVLong(uint8_t*& p, uint64_t i){
+		while ( (i & ~((uint64_t)0x7F)) != 0 ){
+			*p++ = (uint8_t)((i & 0x7F) | 0x80);
+			i >>= 7;
+		}
+		*p++ = (uint8_t)i;
+	}
+
+	//the first 8 bytes, big endian and padded with 0, which no text byte is
+	static inline uint64_t textKey(const uint8_t* text, int32_t len){
+		uint64_t key = 0;
+		for ( int32_t i=0;i<8;i++ )
+			key = (key << 8) | (i < len ? text[i] : 0);
+		return key;
+	}
+
+	static inline int32_t compareBytes(const uint8_t* a, int32_t alen, const uint8_t* b, int32_t blen){
+		const int32_t c = memcmp(a, b, cl_min(alen, blen));
+		if ( c != 0 )
+			return c;
+		return alen - blen;
+	}
+
+
+	/** The text of a term being looked up, encoded like the entries */
+	class TermInfosIndex::EncodedTerm{
+		uint8_t buffer[256];
+	public:
+		const TCHAR* field;
+		int32_t fieldNumber;
+		uint8_t* bytes;
+		int32_t length;
+		uint64_t key;
+
+		EncodedTerm(const Term* term, FieldInfos* fieldInfos){
+			field = term->field();
+			fieldNumber = fieldInfos->fieldNumber(field);
+			const size_t len = term->textLength();
+			if ( len * TERMINDEX_MAX_CHAR_BYTES <= sizeof(buffer) )
+				bytes = buffer;
+			else
+				bytes = _CL_NEWARRAY(uint8_t, len * TERMINDEX_MAX_CHAR_BYTES);
+			length = encodeText(term->text(), len, bytes);
+			key = textKey(bytes, length);
+		}
+		~EncodedTerm(){
+			if ( bytes != buffer )
+				_CLDELETE_LARRAY(bytes);
+		}
+	};
+
+	/** An entry as read from the packed bytes */
+	class TermInfosIndex::Entry{
+	public:
+		int32_t fieldNumber;
+		const uint8_t* prefix;   ///the text of the block's first entry
+		int32_t prefixLength;
+		const uint8_t* suffix;
+		int32_t suffixLength;
+		int32_t docFreq;
+		int32_t skipOffset;
+		int64_t freqPointer;
+		int64_t proxPointer;
+		int64_t indexPointer;
+	};
+
+
+	TermInfosIndex::TermInfosIndex(SegmentTermEnum* indexEnum, FieldInfos* _fieldInfos, int32_t indexDivisor):
+		fieldInfos(_fieldInfos),
+		length(0),
+		bytes(NULL),
+		bytesLength(0),
+		blockOffsets(NULL),
+		entryOffsets(NULL),
+		blockFields(NULL),
+		blockKeys(NULL)
+	{
+		const int32_t maxLength = (int32_t)((indexEnum->size + indexDivisor - 1) / indexDivisor);
+		const int32_t maxBlocks = (maxLength + RESTART_INTERVAL - 1) / RESTART_INTERVAL;
+		entryOffsets = _CL_NEWARRAY(uint32_t, cl_max(maxLength, 1));
+		blockOffsets = _CL_NEWARRAY(int64_t, cl_max(maxBlocks, 1));
+		blockFields = _CL_NEWARRAY(int32_t, cl_max(maxBlocks, 1));
+		blockKeys = _CL_NEWARRAY(uint64_t, cl_max(maxBlocks, 1));
+
+		int64_t capacity = cl_max((int64_t)maxLength * 16, (int64_t)64);
+		bytes = _CL_NEWARRAY(uint8_t, (size_t)capacity);
+
+		//the text of the current block's first entry, and of the current entry
+		int32_t textCapacity = 256;
+		uint8_t* blockText = _CL_NEWARRAY(uint8_t, textCapacity);
+		uint8_t* text = _CL_NEWARRAY(uint8_t, textCapacity);
+		int32_t blockTextLength = 0;
+		int32_t blockField = -1;
+		TermInfo ti;
+		int64_t blockFreqPointer = 0, blockProxPointer = 0, blockIndexPointer = 0;
+
+		try{
+			while ( length < maxLength && indexEnum->next() ){
+				const Term* term = indexEnum->term(false);
+				indexEnum->getTermInfo(&ti);
+				const int32_t fieldNumber = fieldInfos->fieldNumber(term->field());
+
+				const int32_t maxTextLength = (int32_t)term->textLength() * TERMINDEX_MAX_CHAR_BYTES;
+				if ( maxTextLength > textCapacity ){
+					textCapacity = maxTextLength;
+					uint8_t* tmp = _CL_NEWARRAY(uint8_t, textCapacity);
+					memcpy(tmp, blockText, blockTextLength);
+					_CLDELETE_LARRAY(blockText);
+					blockText = tmp;
+					_CLDELETE_LARRAY(text);
+					text = _CL_NEWARRAY(uint8_t, textCapacity);
+				}
+				const int32_t textLength = encodeText(term->text(), term->textLength(), text);
+
+				//field, prefix and suffix lengths, docFreq, skipOffset and 3 pointers
+				if ( bytesLength + textLength + 3*5 + 2*5 + 3*10 > capacity ){
+					capacity = cl_max(capacity * 2, bytesLength + textLength + 64);
+					uint8_t* tmp = _CL_NEWARRAY(uint8_t, (size_t)capacity);
+					memcpy(tmp, bytes, (size_t)bytesLength);
+					_CLDELETE_LARRAY(bytes);
+					bytes = tmp;
+				}
+
+				const int32_t block = length / RESTART_INTERVAL;
+				int32_t prefixLength = 0;
+				if ( length % RESTART_INTERVAL == 0 ){
+					blockOffsets[block] = bytesLength;
+					blockFields[block] = fieldNumber;
+					blockKeys[block] = textKey(text, textLength);
+					memcpy(blockText, text, textLength);
+					blockTextLength = textLength;
+					blockField = fieldNumber;
+					blockFreqPointer = blockProxPointer = blockIndexPointer = 0;
+				}else if ( fieldNumber == blockField ){
+					const int32_t max = cl_min(textLength, blockTextLength);
+					while ( prefixLength < max && text[prefixLength] == blockText[prefixLength] )
+						prefixLength++;
+				}
+				entryOffsets[length] = (uint32_t)(bytesLength - blockOffsets[block]);
+
+				uint8_t* p = bytes + bytesLength;
+				writeVLong(p, fieldNumber);
+				writeVLong(p, prefixLength);
+				writeVLong(p, textLength - prefixLength);
+				memcpy(p, text + prefixLength, textLength - prefixLength);
+				p += textLength - prefixLength;
+				writeVLong(p, ti.docFreq);
+				writeVLong(p, ti.skipOffset);
+				//the pointers only grow, so the deltas are small and positive
+				writeVLong(p, ti.freqPointer - blockFreqPointer);
+				writeVLong(p, ti.proxPointer - blockProxPointer);
+				writeVLong(p, indexEnum->indexPointer - blockIndexPointer);
+				bytesLength = p - bytes;
+
+				if ( length % RESTART_INTERVAL == 0 ){
+					blockFreqPointer = ti.freqPointer;
+					blockProxPointer = ti.proxPointer;
+					blockIndexPointer = indexEnum->indexPointer;
+				}
+				length++;
+
+				for (int32_t j = 1; j < indexDivisor; j++)
+					if (!indexEnum->next())
+						break;
+			}
+		}catch(...){
+			_CLDELETE_LARRAY(blockText);
+			_CLDELETE_LARRAY(text);
+			_CLDELETE_LARRAY(bytes);
+			_CLDELETE_LARRAY(entryOffsets);
+			_CLDELETE_LARRAY(blockOffsets);
+			_CLDELETE_LARRAY(blockFields);
+			_CLDELETE_LARRAY(blockKeys);
+			throw;
+		}
+		_CLDELETE_LARRAY(blockText);
+		_CLDELETE_LARRAY(text);
+
+		//give back the unused part of the buffer, the index is read only from now on
+		if ( capacity > bytesLength ){
+			uint8_t* tmp = _CL_NEWARRAY(uint8_t, (size_t)cl_max(bytesLength, (int64_t)1));
+			memcpy(tmp, bytes, (size_t)bytesLength);
+			_CLDELETE_LARRAY(bytes);
+			bytes = tmp;
+		}
+	}
+
+	TermInfosIndex::~TermInfosIndex(){
+		_CLDELETE_LARRAY(bytes);
+		_CLDELETE_LARRAY(entryOffsets);
+		_CLDELETE_LARRAY(blockOffsets);
+		_CLDELETE_LARRAY(blockFields);
+		_CLDELETE_LARRAY(blockKeys);
+	}
+
+	int32_t TermInfosIndex::size() const{
+		return length;
+	}
+
+	int64_t TermInfosIndex::ramBytesUsed() const{
+		const int32_t blocks = (length + RESTART_INTERVAL - 1) / RESTART_INTERVAL;
+		return sizeof(TermInfosIndex) + bytesLength + (int64_t)length * sizeof(uint32_t) +
+			(int64_t)blocks * (sizeof(int64_t) + sizeof(int32_t) + sizeof(uint64_t));
+	}
+
+	void TermInfosIndex::readEntry(int32_t indexOffset, Entry& entry) const{
+		const int32_t block = indexOffset / RESTART_INTERVAL;
+		const uint8_t* p = bytes + blockOffsets[block];
+
+		//the block's first entry holds the prefix and the base of the pointers
+		entry.fieldNumber = readVInt(p);
+		readVInt(p);
+		entry.prefix = NULL;
+		entry.prefixLength = 0;
+		entry.suffixLength = readVInt(p);
+		entry.suffix = p;
+		p += entry.suffixLength;
+		entry.docFreq = readVInt(p);
+		entry.skipOffset = readVInt(p);
+		entry.freqPointer = readVLong(p);
+		entry.proxPointer = readVLong(p);
+		entry.indexPointer = readVLong(p);
+		if ( indexOffset % RESTART_INTERVAL == 0 )
+			return;
+
+		const uint8_t* blockText = entry.suffix;
+		p = bytes + blockOffsets[block] + entryOffsets[indexOffset];
+		entry.fieldNumber = readVInt(p);
+		entry.prefix = blockText;
+		entry.prefixLength = readVInt(p);
+		entry.suffixLength = readVInt(p);
+		entry.suffix = p;
+		p += entry.suffixLength;
+		entry.docFreq = readVInt(p);
+		entry.skipOffset = readVInt(p);
+		entry.freqPointer += readVLong(p);
+		entry.proxPointer += readVLong(p);
+		entry.indexPointer += readVLong(p);
+	}
+
+	int32_t TermInfosIndex::compareField(const EncodedTerm& term, int32_t fieldNumber) const{
+		if ( term.fieldNumber == fieldNumber )
+			return 0;
+		return _tcscmp(term.field, fieldInfos->fieldName(fieldNumber));
+	}
+
+	int32_t TermInfosIndex::compareTo(const EncodedTerm& term, int32_t indexOffset) const{
+		Entry entry;
+		readEntry(indexOffset, entry);
+		int32_t c = compareField(term, entry.fieldNumber);
+		if ( c != 0 )
+			return c;
+
+		if ( entry.prefixLength > 0 ){
+			c = memcmp(term.bytes, entry.prefix, cl_min(term.length, entry.prefixLength));
+			if ( c != 0 )
+				return c;
+			if ( term.length < entry.prefixLength )
+				return -1;
+		}
+		return compareBytes(term.bytes + entry.prefixLength, term.length - entry.prefixLength,
+			entry.suffix, entry.suffixLength);
+	}
+
+	int32_t TermInfosIndex::compareToBlock(const EncodedTerm& term, int32_t block) const{
+		const int32_t c = compareField(term, blockFields[block]);
+		if ( c != 0 )
+			return c;
+		if ( term.key != blockKeys[block] )
+			return term.key < blockKeys[block] ? -1 : 1;
+		return compareTo(term, block * RESTART_INTERVAL);
+	}
+
+	int32_t TermInfosIndex::compareTo(const Term* term, int32_t indexOffset) const{
+		EncodedTerm encoded(term, fieldInfos);
+		return compareTo(encoded, indexOffset);
+	}
+
+	int32_t TermInfosIndex::getIndexOffset(const Term* term) const{
+		EncodedTerm encoded(term, fieldInfos);
+
+		//find the last block starting at or before term...
+		int32_t lo = 0;
+		int32_t hi = (length + RESTART_INTERVAL - 1) / RESTART_INTERVAL - 1;
+		while (hi >= lo) {
+			const int32_t mid = (lo + hi) >> 1;
+			const int32_t delta = compareToBlock(encoded, mid);
+			if (delta < 0)
+				hi = mid - 1;
+			else if (delta > 0)
+				lo = mid + 1;
+			else
+				return mid * RESTART_INTERVAL;
+		}
+		if ( hi < 0 )
+			return -1;
+
+		//...and the last entry in it at or before term
+		lo = hi * RESTART_INTERVAL + 1;
+		hi = cl_min(length, lo - 1 + RESTART_INTERVAL) - 1;
+		while (hi >= lo) {
+			const int32_t mid = (lo + hi) >> 1;
+			const int32_t delta = compareTo(encoded, mid);
+			if (delta < 0)
+				hi = mid - 1;
+			else if (delta > 0)
+				lo = mid + 1;
+			else
+				return mid;
+		}
+		return hi;
+	}
+
+	void TermInfosIndex::seekEnum(SegmentTermEnum* enumerator, int32_t indexOffset, int32_t totalIndexInterval) const{
+		CND_PRECONDITION(indexOffset >= 0 && indexOffset < length, "indexOffset out of range");
+
+		Entry entry;
+		readEntry(indexOffset, entry);
+
+		//each TCHAR took at least one byte
+		TCHAR buffer[128];
+		const int32_t maxChars = entry.prefixLength + entry.suffixLength + 1;
+		TCHAR* text = maxChars <= 128 ? buffer : _CL_NEWARRAY(TCHAR, maxChars);
+		int32_t len = decodeText(entry.prefix, entry.prefixLength, text);
+		len += decodeText(entry.suffix, entry.suffixLength, text + len);
+		text[len] = 0;
+
+		Term* term = _CLNEW Term();
+		term->set(fieldInfos->fieldName(entry.fieldNumber), text, false);
+		if ( text != buffer )
+			_CLDELETE_LARRAY(text);
+		TermInfo ti;
+		ti.set(entry.docFreq, entry.freqPointer, entry.proxPointer, entry.skipOffset);
+
+		try{
+			enumerator->seek(entry.indexPointer, (indexOffset * totalIndexInterval) - 1, term, &ti);
+		}_CLFINALLY(
+			_CLDECDELETE(term);
+		)
+	}
+
+CL_NS_END
@@ -26,7 +26,7 @@ CL_NS_DEF(index)
 
 
   TermInfosReader::TermInfosReader(Directory* dir, const char* seg, FieldInfos* fis, const int32_t readBufferSize):
-      directory (dir),fieldInfos (fis), indexTerms(NULL), indexInfos(NULL), indexPointers(NULL), indexDivisor(1)
+      directory (dir),fieldInfos (fis), index(NULL), indexDivisor(1)
   {
   //Func - Constructor.
   //       Reads the TermInfos file (.tis) and eventually the Term Info Index file (.tii)
@@ -46,7 +46,7 @@ CL_NS_DEF(index)
 	  string tiiFile = Misc::segmentname(segment,".tii");
 	  bool success = false;
     origEnum = indexEnum = NULL;
-    _size = indexTermsLength = totalIndexInterval = 0;
+    _size = totalIndexInterval = 0;
 
 	  try {
 		  //Create an SegmentTermEnum for storing all the terms read of the segment
@@ -79,8 +79,7 @@ CL_NS_DEF(index)
   //Post - The instance has been destroyed
 
       //Close the TermInfosReader to be absolutly sure that enumerator has been closed
-	  //and the arrays indexTerms, indexPointers and indexInfos and  their elements
-	  //have been destroyed
+	  //and the term index has been destroyed
       close();
   }
   int32_t TermInfosReader::getSkipInterval() const {
@@ -92,10 +91,10 @@ CL_NS_DEF(index)
   }
 
   void TermInfosReader::setIndexDivisor(const int32_t _indexDivisor) {
-	  if (indexDivisor < 1)
+	  if (_indexDivisor < 1)
 		  _CLTHROWA(CL_ERR_IllegalArgument, "indexDivisor must be > 0");
 
-	  if (indexTerms != NULL)
+	  if (index != NULL)
 		  _CLTHROWA(CL_ERR_IllegalArgument, "index terms are already loaded");
 
 	  this->indexDivisor = _indexDivisor;
@@ -105,22 +104,8 @@ CL_NS_DEF(index)
   int32_t TermInfosReader::getIndexDivisor() const { return indexDivisor; }
   void TermInfosReader::close() {
 
-	  //Check if indexTerms and indexInfos exist
-     if (indexTerms && indexInfos){
-          //Iterate through arrays indexTerms and indexPointer to
-	      //destroy their elements
-#ifdef _DEBUG
-         for ( int32_t i=0; i<indexTermsLength;++i ){
-            indexTerms[i].__cl_refcount--;
-         }
-#endif
-         //Delete the arrays
-         delete [] indexTerms;
-         _CLDELETE_ARRAY(indexInfos);
-     }
-
-      //Delete the arrays
-      _CLDELETE_ARRAY(indexPointers);
+      //Delete the term index
+      _CLDELETE(index);
 
       if (origEnum != NULL){
         origEnum->close();
@@ -183,6 +168,7 @@ CL_NS_DEF(index)
 	  }
 
     //random-access: must seek
+    ensureIndexIsRead();
     seekEnum(position / totalIndexInterval);
 
 	//Get the Term at position
@@ -229,11 +215,11 @@ CL_NS_DEF(index)
 
 		// but before end of block
 		if (
-			//the length of indexTerms (the number of terms in enumerator) equals
+			//the number of index entries equals
 			//_enum_offset OR
-			indexTermsLength == _enumOffset	 ||
-			//term is positioned in front of term found at _enumOffset in indexTerms
-			term->compareTo(&indexTerms[_enumOffset]) < 0){
+			index->size() == _enumOffset	 ||
+			//term is positioned in front of the index entry at _enumOffset
+			index->compareTo(term, _enumOffset) < 0){
 
 			//no need to seek, retrieve the TermInfo for term
 			return scanEnum(term);
@@ -304,41 +290,17 @@ CL_NS_DEF(index)
   //       This file contains every IndexInterval-th entry from the .tis file,
   //       along with its location in the "tis" file. This is designed to be read entirely
   //       into memory and used to provide random access to the "tis" file.
-  //Pre  - indexTerms    = NULL
-  //       indexInfos    = NULL
-  //       indexPointers = NULL
+  //Pre  - index = NULL
   //Post - The term info index file has been read into memory
 
     SCOPED_LOCK_MUTEX(THIS_LOCK)
 
-	  if ( indexTerms != NULL )
+	  if ( index != NULL )
 		  return;
 
       try {
-          indexTermsLength = (size_t)indexEnum->size;
-
-		      //Instantiate an block of Term's,so that each one doesn't have to be new'd
-          indexTerms    = new Term[indexTermsLength];
-          CND_CONDITION(indexTerms != NULL,"No memory could be allocated for indexTerms");//Check if is indexTerms is a valid array
-
-		  //Instantiate an big block of TermInfo's, so that each one doesn't have to be new'd
-          indexInfos    = _CL_NEWARRAY(TermInfo,indexTermsLength);
-          CND_CONDITION(indexInfos != NULL,"No memory could be allocated for indexInfos"); //Check if is indexInfos is a valid array
-
-          //Instantiate an array indexPointers that contains pointers to the term info index file
-          indexPointers = _CL_NEWARRAY(int64_t,indexTermsLength);
-          CND_CONDITION(indexPointers != NULL,"No memory could be allocated for indexPointers");//Check if is indexPointers is a valid array
-
-		  //Iterate through the terms of indexEnum
-          for (int32_t i = 0; indexEnum->next(); ++i){
-              indexTerms[i].set(indexEnum->term(false),indexEnum->term(false)->text());
-              indexEnum->getTermInfo(&indexInfos[i]);
-              indexPointers[i] = indexEnum->indexPointer;
-
-			        for (int32_t j = 1; j < indexDivisor; j++)
-				        if (!indexEnum->next())
-					        break;
-          }
+          //Pack the entries of indexEnum into one block of memory
+          index = _CLNEW TermInfosIndex(indexEnum, fieldInfos, indexDivisor);
     }_CLFINALLY(
           indexEnum->close();
 		  //Close and delete the IndexInput is. The close is done by the destructor.
@@ -351,62 +313,23 @@ CL_NS_DEF(index)
   int32_t TermInfosReader::getIndexOffset(const Term* term){
   //Func - Returns the offset of the greatest index entry which is less than or equal to term.
   //Pre  - term holds a reference to a valid term
-  //       indexTerms != NULL
+  //       index != NULL
   //Post - The new offset has been returned
 
-      //Check if is indexTerms is a valid array
-      CND_PRECONDITION(indexTerms != NULL,"indexTerms is NULL");
-
-      int32_t lo = 0;
-      int32_t hi = indexTermsLength - 1;
-	  int32_t mid;
-	  int32_t delta;
-
-      while (hi >= lo) {
-          //Start in the middle betwee hi and lo
-          mid = (lo + hi) >> 1;
-
-          //Check if is indexTerms[mid] is a valid instance of Term
-          CND_PRECONDITION(&indexTerms[mid] != NULL,"indexTerms[mid] is NULL");
-          CND_PRECONDITION(mid < indexTermsLength,"mid >= indexTermsLength");
-
-		  //Determine if term is before mid or after mid
-          delta = term->compareTo(&indexTerms[mid]);
-          if (delta < 0){
-              //Calculate the new hi
-              hi = mid - 1;
-          }else if (delta > 0){
-                  //Calculate the new lo
-                  lo = mid + 1;
-			  }else{
-                  //term has been found so return its position
-                  return mid;
-          }
-     }
-     // the new starting offset
-     return hi;
+      CND_PRECONDITION(index != NULL,"index is NULL");
+      return index->getIndexOffset(term);
   }
 
   void TermInfosReader::seekEnum(const int32_t indexOffset) {
   //Func - Reposition the current Term and TermInfo to indexOffset
   //Pre  - indexOffset >= 0
-  //       indexTerms    != NULL
-  //       indexInfos    != NULL
-  //       indexPointers != NULL
+  //       index != NULL
   //Post - The current Term and Terminfo have been repositioned to indexOffset
 
       CND_PRECONDITION(indexOffset >= 0, "indexOffset contains a negative number");
-      CND_PRECONDITION(indexTerms != NULL,    "indexTerms is NULL");
-      CND_PRECONDITION(indexInfos != NULL,    "indexInfos is NULL");
-      CND_PRECONDITION(indexPointers != NULL, "indexPointers is NULL");
-
-	  SegmentTermEnum* enumerator =  getEnum();
-	  enumerator->seek(
-          indexPointers[indexOffset],
-		  (indexOffset * totalIndexInterval) - 1,
-          &indexTerms[indexOffset],
-		  &indexInfos[indexOffset]
-	      );
+      CND_PRECONDITION(index != NULL, "index is NULL");
+
+      index->seekEnum(getEnum(), indexOffset, totalIndexInterval);
   }
 
 
@@ -419,10 +342,8 @@ CL_NS_DEF(index)
   //       has been returned
 
       SegmentTermEnum* enumerator = getEnum();
-	  enumerator->scanTo(term);
-
       //Check if the at the position the Term term can be found
-	  if (enumerator->term(false) != NULL && term->equals(enumerator->term(false)) ){
+	  if ( enumerator->scanTo(term) ){
 		  //Return the TermInfo instance about term
           return enumerator->getTermInfo();
      }else{
@@ -0,0 +1,146 @@
+/*------------------------------------------------------------------------------
+* Copyright (C) 2003-2006 Ben van Klinken and the CLucene Team
+*
+* Distributable under the terms of either the Apache License (Version 2.0) or
+* the GNU Lesser General Public License, as specified in the COPYING file.
+------------------------------------------------------------------------------*/
+#ifndef _lucene_index_internal_DocValues_
+#define _lucene_index_internal_DocValues_
+
+#include "CLucene/util/VoidMap.h"
+#include "CLucene/util/Equators.h"
+#include "DocValues.h"
+#include <vector>
+CL_CLASS_DEF(store,Directory)
+CL_CLASS_DEF(store,IndexInput)
+CL_CLASS_DEF(store,IndexOutput)
+
+CL_NS_DEF(index)
+
+/**
+* Writes the doc values of a segment to &lt;segment&gt;.dv.
+*
+* <p>The file holds one column per field, each with a value for every
+* document of the segment, followed by a directory of the columns:
+* <pre>
+* DocValues    --&gt; Format, Column<sup>NumFields</sup>, Directory, DirectoryPointer
+* Column       --&gt; NumericColumn | SortedColumn
+* NumericColumn--&gt; MinValue, BitsPerValue, PackedValues
+* SortedColumn --&gt; ValueCount, Value<sup>ValueCount</sup>, BitsPerValue, PackedValues
+* Directory    --&gt; NumFields, &lt;FieldName, Type, ColumnPointer&gt;<sup>NumFields</sup>
+* </pre>
+* The packed values hold BitsPerValue bits for each document, lowest bits
+* first, so that a value can be read straight from the bytes without decoding
+* the column. A numeric column packs the value minus MinValue, a sorted column
+* the ordinal of the value of the document plus one, or 0 for no value.
+*/
+class DocValuesWriter: LUCENE_BASE{
+	CL_NS(store)::IndexOutput* output;
+	std::vector<TCHAR*> names;
+	std::vector<uint8_t> types;
+	std::vector<int64_t> pointers;
+public:
+	LUCENE_STATIC_CONSTANT(int32_t, FORMAT = -1);
+	LUCENE_STATIC_CONSTANT(uint8_t, TYPE_NUMERIC = 1);
+	LUCENE_STATIC_CONSTANT(uint8_t, TYPE_SORTED = 2);
+
+	DocValuesWriter(CL_NS(store)::Directory* directory, const char* segment);
+	~DocValuesWriter();
+
+	/** Adds the column of field, with values[i] being the value of document i */
+	void addNumeric(const TCHAR* field, const int64_t* values, const int32_t numDocs);
+
+	/**
+	* Adds the column of field.
+	* @param values the distinct values, in sorted order
+	* @param ords ords[i] is the index in values of the value of document i, or -1
+	*/
+	void addSorted(const TCHAR* field, const TCHAR* const* values, const int32_t valueCount,
+		const int32_t* ords, const int32_t numDocs);
+
+	/** Writes the directory and closes the file */
+	void close();
+
+	/** Returns the number of bits needed for values up to maxValue */
+	static int32_t bitsRequired(const uint64_t maxValue);
+};
+
+/**
+* Reads the columns of &lt;segment&gt;.dv. A column is loaded when it is first
+* asked for, and then shared by all threads. Its packed values are used in
+* place if the file is mapped into memory, so that a column costs no heap
+* however many documents the segment holds.
+*/
+class DocValuesReader: LUCENE_BASE{
+	class Entry;
+	class PackedValues;
+	class NumericColumn;
+	class SortedColumn;
+
+	typedef CL_NS(util)::CLHashMap<TCHAR*,Entry*,
+		CL_NS(util)::Compare::TChar, CL_NS(util)::Equals::TChar,
+		CL_NS(util)::Deletor::tcArray, CL_NS(util)::Deletor::Object<Entry> > EntriesType;
+	EntriesType entries;
+
+	CL_NS(store)::IndexInput* input;
+	const int32_t maxDoc;
+	DEFINE_MUTEX(THIS_LOCK)
+
+	Entry* load(const TCHAR* field, const uint8_t type);
+	PackedValues* readPacked();
+public:
+	DocValuesReader(CL_NS(store)::Directory* directory, const char* segment, const int32_t maxDoc);
+	~DocValuesReader();
+
+	/** Returns the numeric column of field, or NULL if there is none */
+	NumericDocValues* getNumeric(const TCHAR* field);
+	/** Returns the sorted column of field, or NULL if there is none */
+	SortedDocValues* getSorted(const TCHAR* field);
+};
+
+/**
+* Holds the doc values of the documents buffered by DocumentsWriter until
+* they are flushed. Documents are added in the order of their ids.
+*/
+class BufferedDocValues: LUCENE_BASE{
+	class Column;
+	typedef CL_NS(util)::CLHashMap<TCHAR*,Column*,
+		CL_NS(util)::Compare::TChar, CL_NS(util)::Equals::TChar,
+		CL_NS(util)::Deletor::tcArray, CL_NS(util)::Deletor::Object<Column> > ColumnsType;
+	ColumnsType columns;
+
+	Column* getColumn(const TCHAR* field, const int32_t type);
+public:
+	/** A value of a document which is not yet added */
+	struct Value{
+		const TCHAR* field;
+		int32_t type;
+		int64_t number;
+		TCHAR* text;
+	};
+
+	BufferedDocValues();
+	~BufferedDocValues();
+
+	/**
+	* Adds the values of document docID. Fields of another type than the one
+	* they were first seen with are skipped.
+	* @memory takes the texts of the values
+	*/
+	void add(const int32_t docID, std::vector<Value>& values);
+
+	/** True if no values were added since the last reset */
+	bool empty() const;
+
+	/** Writes the values of the first numDocs documents to &lt;segment&gt;.dv */
+	void write(CL_NS(store)::Directory* directory, const char* segment, const int32_t numDocs);
+
+	/** Discards all the values */
+	void reset();
+
+	/** Frees the texts of values and clears it */
+	static void clear(std::vector<Value>& values);
+};
+
+CL_NS_END
+#endif
@@ -12,6 +12,7 @@
 #include "CLucene/util/Array.h"
 #include "CLucene/store/_RAMDirectory.h"
 #include "_TermInfo.h"
+#include "_DocValues.h"
 
 CL_CLASS_DEF(analysis,Analyzer)
 CL_CLASS_DEF(analysis,Token)
@@ -303,10 +304,28 @@ private:
   static const int32_t CHAR_NUM_BYTE;
 
   // Holds free pool of Posting instances
-  CL_NS(util)::ObjectArray<Posting> postingsFreeListDW;
+  CL_NS(util)::ValueArray<Posting*> postingsFreeListDW;
   int32_t postingsFreeCountDW;
   int32_t postingsAllocCountDW;
 
+  // Postings are allocated POSTINGS_BLOCK_SIZE at a time, instead of
+  // one by one.  Only the last block can be freed, once none of its
+  // postings is in use: the first postingsFreeOrderedDW entries of the
+  // free list hold the postings of the trailing blocks, last block first
+  typedef std::vector<Posting*> PostingsBlocksType;
+  PostingsBlocksType postingsBlocks;
+  int32_t postingsBlockUpto;                  // next unused Posting of the last block
+  int32_t postingsFreeOrderedDW;
+  static const int32_t POSTINGS_BLOCK_SIZE;
+  void orderFreePostings();
+  bool canFreePostingsBlock();
+  void freeLastPostingsBlock();
+
+  // Number of heap allocations of each pool since the last flush
+  int32_t numPostingsBlockAllocs;
+  int32_t numByteBlockAllocs;
+  int32_t numCharBlockAllocs;
+
   typedef CL_NS(util)::CLArrayList<TCHAR*, CL_NS(util)::Deletor::tcArray> FreeCharBlocksType;
   FreeCharBlocksType freeCharBlocks;
 
@@ -477,6 +496,7 @@ private:
     CL_NS(util)::ValueArray<int32_t> vectorFieldNumbers;
 
     int32_t numStoredFields;                  // How many stored fields in current doc
+    std::vector<BufferedDocValues::Value> docValues; // Doc values of current doc
     float_t docBoost;                       // Boost for current doc
 
     CL_NS(util)::ValueArray<FieldData*> fieldDataArray;           // Fields touched by current doc
@@ -734,6 +754,7 @@ private:
   int32_t abortCount;                         // Non-zero while abort is pending or running
 
   CL_NS(util)::ObjectArray<BufferedNorms> norms;   // Holds norms until we flush
+  BufferedDocValues docValues;                // Holds doc values until we flush
 
   /** Does the synchronized work to finish/flush the
    * inverted document. */
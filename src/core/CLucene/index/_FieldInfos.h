@@ -34,6 +34,8 @@ class FieldInfo :LUCENE_BASE{
 
 	bool storePayloads; // whether this field stores payloads together with term positions
 
+	bool omitTf; // omit tf, positions and payloads from the postings of this field
+
 	//Func - Constructor
 	//       Initialises FieldInfo.
 	//       na holds the name of the field
@@ -53,7 +55,8 @@ class FieldInfo :LUCENE_BASE{
 		const bool storeOffsetWithTermVector,
 		const bool storePositionWithTermVector,
 		const bool omitNorms,
-		const bool storePayloads);
+		const bool storePayloads,
+		const bool omitTf=false);
 
     //Func - Destructor
 	//Pre  - true
@@ -87,7 +90,8 @@ public:
 		STORE_POSITIONS_WITH_TERMVECTOR = 0x4,
 		STORE_OFFSET_WITH_TERMVECTOR = 0x8,
 		OMIT_NORMS = 0x10,
-		STORE_PAYLOADS = 0x20
+		STORE_PAYLOADS = 0x20,
+		OMIT_TF = 0x40
 	};
 
 	FieldInfos();
@@ -131,7 +135,7 @@ public:
 	*/
 	void add(const TCHAR** names, const bool isIndexed, const bool storeTermVector=false,
               const bool storePositionWithTermVector=false, const bool storeOffsetWithTermVector=false,
-			  const bool omitNorms=false, const bool storePayloads=false);
+			  const bool omitNorms=false, const bool storePayloads=false, const bool omitTf=false);
 
 	// Merges in information from another FieldInfos. 
 	void add(FieldInfos* other);
@@ -148,13 +152,16 @@ public:
 	* @param storeOffsetWithTermVector true if the term vector with offsets should be stored
 	* @param omitNorms true if the norms for the indexed field should be omitted
 	* @param storePayloads true if payloads should be stored for this field
+	* @param omitTf true if term freqs and positions should be omitted for this field
 	*/
 	FieldInfo* add(const TCHAR* name, const bool isIndexed, const bool storeTermVector=false,
-	          const bool storePositionWithTermVector=false, const bool storeOffsetWithTermVector=false, const bool omitNorms=false, const bool storePayloads=false);
+	          const bool storePositionWithTermVector=false, const bool storeOffsetWithTermVector=false, const bool omitNorms=false, const bool storePayloads=false,
+	          const bool omitTf=false);
 
 	// was void
 	FieldInfo* addInternal( const TCHAR* name,const bool isIndexed, const bool storeTermVector,
-		const bool storePositionWithTermVector, const bool storeOffsetWithTermVector, const bool omitNorms, const bool storePayloads);
+		const bool storePositionWithTermVector, const bool storeOffsetWithTermVector, const bool omitNorms, const bool storePayloads,
+		const bool omitTf=false);
 
 	int32_t fieldNumber(const TCHAR* fieldName)const;
 	
@@ -43,6 +43,29 @@ CL_NS_DEF(index)
 		// file.  This will be 0 if we have our own private file.
 		int32_t docStoreOffset;
 
+		// The format of the files, and the size of the .fdx header
+		int32_t format;
+		int32_t formatSize;
+
+		class BlockInput;
+		// When the documents are in compressed blocks, fieldsStream reads
+		// the documents out of the last block, which is read from blocksStream
+		CL_NS(store)::IndexInput* blocksStream;
+		BlockInput* blockInput;
+		int64_t blockPointer;
+		int32_t blockDocBase;
+		int32_t blockNumDocs;
+		CL_NS(util)::ValueArray<int32_t> blockOffsets;
+		CL_NS(util)::ValueArray<uint8_t> block;
+		CL_NS(util)::ValueArray<uint8_t> compressedBlock;
+		// The raw documents of rawDocs
+		CL_NS(util)::ValueArray<uint8_t> rawBlock;
+
+		/** Decompresses the block at pointer, unless it is the last one read */
+		void loadBlock(const int64_t pointer);
+		/** Positions fieldsStream on document docID of the block at pointer */
+		void seekBlockDocument(const int32_t docID, const int64_t pointer);
+
 		DEFINE_MUTEX(THIS_LOCK)
 		CL_NS(util)::ThreadLocal<CL_NS(store)::IndexInput*, CL_NS(util)::Deletor::Object<CL_NS(store)::IndexInput> > fieldsStreamTL;
     static void uncompress(const CL_NS(util)::ValueArray<uint8_t>& input, CL_NS(util)::ValueArray<uint8_t>& output);
@@ -164,6 +187,34 @@ CL_NS_DEF(index)
       virtual const char* getObjectName() const;
       static const char* getClassName();
 		};
+
+		/** Reads the documents of a decompressed block */
+		class BlockInput : public CL_NS(store)::IndexInput {
+		private:
+			const uint8_t* data;
+			int32_t _length;
+			int32_t pos;
+
+			BlockInput(const BlockInput& other);
+		public:
+			BlockInput();
+			virtual ~BlockInput();
+
+			/** Reads len bytes of data, which the caller keeps valid */
+			void reset(const uint8_t* data, const int32_t len);
+
+			uint8_t readByte();
+			void readBytes(uint8_t* b, const int32_t len);
+			int64_t getFilePointer() const;
+			void seek(const int64_t _pos);
+			int64_t length() const;
+			void close();
+			CL_NS(store)::IndexInput* clone() const;
+
+			const char* getDirectoryType() const;
+			const char* getObjectName() const;
+			static const char* getClassName();
+		};
 	};
 CL_NS_END
 #endif
@@ -22,11 +22,30 @@ class FieldsWriter :LUCENE_BASE{
 private:
 	FieldInfos* fieldInfos;
 
+	// The stream documents are written to. When compressing blocks, this
+	// is blockBuffer, and the blocks are written to blocksStream.
 	CL_NS(store)::IndexOutput* fieldsStream;
 	CL_NS(store)::IndexOutput* indexStream;
 
 	bool doClose;
 
+	// The codec of the blocks, or 0 to write one document at a time
+	int32_t compression;
+	CL_NS(store)::IndexOutput* blocksStream;
+	CL_NS(store)::RAMOutputStream* blockBuffer;
+	CL_NS(util)::ValueArray<int32_t> blockDocLengths;
+	int32_t blockNumDocs;
+	int32_t numDocs;
+	CL_NS(util)::ValueArray<uint8_t> blockBytes;
+	CL_NS(util)::ValueArray<uint8_t> compressedBytes;
+
+	// Adds the index entry of the next document
+	void startDocument();
+	// Ends the document which was written to fieldsStream from start
+	void finishDocument(const int64_t start);
+	// Compresses the buffered documents and writes them as a block
+	void flushBlock();
+
   static void compress(const CL_NS(util)::ValueArray<uint8_t>& input, CL_NS(util)::ValueArray<uint8_t>& output);
 
 public:
@@ -34,7 +53,31 @@ public:
 	LUCENE_STATIC_CONSTANT(uint8_t, FIELD_IS_BINARY = 0x2);
 	LUCENE_STATIC_CONSTANT(uint8_t, FIELD_IS_COMPRESSED = 0x4);
 
-	FieldsWriter(CL_NS(store)::Directory* d, const char* segment, FieldInfos* fn);
+	/**
+	* The .fdx of a file of compressed blocks starts with this format,
+	* while the first entry of a file written a document at a time is 0.
+	* Each entry then points to the block holding the document, which is:
+	* the VInt docID of its first document, the VInt number of documents,
+	* their VInt lengths, the codec byte, the VInt length of the data and
+	* the data, which holds the documents in the format used without blocks.
+	*/
+	LUCENE_STATIC_CONSTANT(int32_t, FORMAT_COMPRESSED_BLOCKS = 1);
+	LUCENE_STATIC_CONSTANT(int32_t, FORMAT_SIZE = 4);
+
+	// The block codecs; the codec of a block which doesn't compress is BLOCK_STORED
+	LUCENE_STATIC_CONSTANT(uint8_t, BLOCK_STORED = 0);
+	LUCENE_STATIC_CONSTANT(uint8_t, BLOCK_FAST = 1);
+	LUCENE_STATIC_CONSTANT(uint8_t, BLOCK_DEFLATE = 2);
+
+	// A block is written once it holds this many bytes or documents
+	LUCENE_STATIC_CONSTANT(int32_t, BLOCK_SIZE = 16384);
+	LUCENE_STATIC_CONSTANT(int32_t, MAX_BLOCK_DOCS = 128);
+
+	/**
+	* @param compression one of the IndexWriter::STORED_FIELDS_* values,
+	* which are the block codecs, or 0 to write a document at a time
+	*/
+	FieldsWriter(CL_NS(store)::Directory* d, const char* segment, FieldInfos* fn, const int32_t compression = 0);
 	FieldsWriter(CL_NS(store)::IndexOutput* fdx, CL_NS(store)::IndexOutput* fdt, FieldInfos* fn);
 	~FieldsWriter();
 
@@ -57,6 +100,9 @@ public:
   *  bytes. */
   void addRawDocuments(CL_NS(store)::IndexInput* stream, const int32_t* lengths, const int32_t numDocs);
 	void addDocument(CL_NS(document)::Document* doc);
+
+	/** The number of bytes the .fdx holds before its entries */
+	int32_t getFormatSize() const;
 };
 CL_NS_END
 #endif
@@ -14,6 +14,7 @@
 #include "CLucene/store/IndexOutput.h"
 #include "CLucene/index/IndexReader.h"
 #include "Term.h"
+#include "_Term.h"
 #include "Terms.h"
 #include "_TermInfo.h"
 //#include "FieldInfos.h"
@@ -28,6 +29,7 @@
 
 CL_NS_DEF(index)
 class SegmentReader;
+class DocValuesReader;
 
 class SegmentTermDocs:public virtual TermDocs {
 protected:
@@ -50,8 +52,12 @@ private:
   int64_t skipPointer;
   bool haveSkipped;
 
+  /** Decodes the next max postings, deleted or not, into docs and freqs. */
+  int32_t readPostings(int32_t* docs, int32_t* freqs, const int32_t max);
+
 protected:
   bool currentFieldStoresPayloads;
+  bool currentFieldOmitTf;
 
 public:
   ///\param Parent must be a segment reader
@@ -169,14 +175,15 @@ private:
 class SegmentReader: public DirectoryIndexReader {
   /**
    * The class Norm represents the normalizations for a field.
-   * These normalizations are read from an IndexInput in into an array of bytes called bytes
+   * These normalizations are read from an IndexInput in into an array of bytes called bytes,
+   * or, if the file is mapped in memory, bytes points into the mapping until they are changed
    */
   class Norm :LUCENE_BASE{
     int32_t number;
     int64_t normSeek;
     SegmentReader* _this;
     const char* segment; ///< pointer to segment name
-    volatile int32_t refCount;
+    _LUCENE_ATOMIC_INT refCount;
     bool useSingleNormStream;
     bool rollbackDirty;
 
@@ -191,6 +198,8 @@ class SegmentReader: public DirectoryIndexReader {
 
     CL_NS(store)::IndexInput* in;
     uint8_t* bytes;
+    CL_NS(store)::IndexInput* mappedInput; ///< keeps the mapped norms valid, NULL if they are not mapped
+    bool mapped; ///< bytes points into the mapping
     bool dirty;
     //Constructor
     Norm(CL_NS(store)::IndexInput* instrm, bool useSingleNormStream, int32_t number, int64_t normSeek, SegmentReader* reader, const char* segment);
@@ -232,9 +241,33 @@ class SegmentReader: public DirectoryIndexReader {
   uint8_t* ones;
   uint8_t* fakeNorms();
 
+  //an entry of the maxTermFreqs cache, linked in order of use
+  struct MaxTermFreq {
+    Term* term; //the key of the entry in maxTermFreqs
+    int32_t freq;
+    MaxTermFreq* prev;
+    MaxTermFreq* next;
+  };
+
+  //cached score upper bounds, see maxTermFreq and maxNorm
+  typedef CL_NS(util)::CLHashMap<Term*,MaxTermFreq*, Term_Compare,Term_Equals,
+    CL_NS(util)::Deletor::Object<Term>, CL_NS(util)::Deletor::Object<MaxTermFreq> > MaxTermFreqsType;
+  typedef CL_NS(util)::CLHashMap<TCHAR*,int32_t,
+    CL_NS(util)::Compare::TChar, CL_NS(util)::Equals::TChar,
+    CL_NS(util)::Deletor::tcArray, CL_NS(util)::Deletor::DummyInt32 > MaxNormsType;
+  MaxTermFreqsType maxTermFreqs;
+  MaxTermFreq* firstMaxTermFreq; //most recently used
+  MaxTermFreq* lastMaxTermFreq;  //least recently used, evicted first
+  MaxNormsType maxNorms;
+  LUCENE_STATIC_CONSTANT(size_t, MAX_TERM_FREQS_CACHE_SIZE=4096);
+  void clearMaxTermFreqs();
+
   // optionally used for the .nrm file shared by multiple norms
   CL_NS(store)::IndexInput* singleNormStream;
 
+  // the columns of the .dv file, or NULL if the segment has none
+  DocValuesReader* docValues;
+
   // Compound File Reader when based on a compound file segment
   CompoundFileReader* cfsReader;
   CompoundFileReader* storeCFSReader;
@@ -338,6 +371,8 @@ public:
 
   ///Returns the number of documents which contain the term t
   int32_t docFreq(const Term* t);
+  int32_t maxTermFreq(Term* t);
+  uint8_t maxNorm(const TCHAR* field);
 
   ///Returns the actual number of documents in the segment
   int32_t numDocs();
@@ -357,6 +392,9 @@ public:
   ///Reads the Norms for field from disk
   void norms(const TCHAR* field, uint8_t* bytes);
 
+  NumericDocValues* getNumericDocValues(const TCHAR* field);
+  SortedDocValues* getSortedDocValues(const TCHAR* field);
+
   ///concatenating segment with ext and x
   std::string SegmentName(const char* ext, const int32_t x=-1);
   ///Creates a filename in buffer by concatenating segment with ext and x
@@ -105,6 +105,8 @@ CL_NS_DEF(index)
 
 		void advanceDelGen();
 		void clearDelGen();
+		/** Returns the generation of the deletions, which changes every time they are written */
+		int64_t getDelGen() const;
 
 		SegmentInfo* clone ();
 
@@ -399,6 +401,8 @@ CL_NS_DEF(index)
 		* version number when this SegmentInfos was generated.
 		*/
 		int64_t getVersion() const;
+		/** Increments the version, to tell that the segments changed even though they were not written */
+		void changed();
 		int64_t getGeneration() const;
 		int64_t getLastGeneration() const;
 
@@ -9,6 +9,7 @@
 
 
 CL_CLASS_DEF(store,Directory)
+CL_CLASS_DEF(util,ThreadPool)
 #include "CLucene/store/_RAMDirectory.h"
 #include "_SegmentMergeInfo.h"
 #include "_SegmentMergeQueue.h"
@@ -35,9 +36,11 @@ class SegmentMerger:LUCENE_BASE {
 	
 	//Directory of the segment
 	CL_NS(store)::Directory* directory;     
+	//true if directory is a rate limiting wrapper created for the merge
+	bool ownDirectory;
 	//name of the new segment
   std::string segment;
-	//Set of IndexReaders
+	//Set of IndexReaders, which are owned by the caller
 	CL_NS(util)::CLVector<IndexReader*,CL_NS(util)::Deletor::Object<IndexReader> > readers;
 	//Field Infos for t	he FieldInfo instances of all fields
 	FieldInfos* fieldInfos;
@@ -65,10 +68,14 @@ class SegmentMerger:LUCENE_BASE {
 	TermInfo termInfo; //(new) minimize consing
 
   int32_t termIndexInterval;
+  int32_t storedFieldsCompression;
 	int32_t skipInterval;
   int32_t maxSkipLevels;
   DefaultSkipListWriter* skipListWriter;
 
+  //runs the phases of merge concurrently if not NULL
+  CL_NS(util)::ThreadPool* pool;
+
 public:
   static const uint8_t NORMS_HEADER[]; 
   static const int NORMS_HEADER_length;
@@ -111,12 +118,6 @@ public:
    * @throws IOException if there is a low-level IO error
    */
 	int32_t merge(bool mergeDocStores);
-	/**
-	* close all IndexReaders that have been added.
-	* Should not be called before merge().
-	* @throws IOException
-	*/
-	void closeReaders();
 
   
   class CheckAbort {
@@ -141,29 +142,49 @@ public:
 private:
   CheckAbort* checkAbort;
 
+  /** The parts of a merge which write their own files */
+  enum Phase{
+    PHASE_TERMS,
+    PHASE_FIELDS,
+    PHASE_VECTORS,
+    PHASE_NORMS,
+    PHASE_DOCVALUES
+  };
+  class PhaseTask;
+  friend class PhaseTask;
+
+  /** Runs phase, reporting its work to abortCheck, which may be NULL */
+  void mergePhase(Phase phase, CheckAbort* abortCheck);
+
 	void addIndexed(IndexReader* reader, FieldInfos* fieldInfos, StringArrayWithDeletor& names, 
 		bool storeTermVectors, bool storePositionWithTermVector,
-		bool storeOffsetWithTermVector, bool storePayloads);
+		bool storeOffsetWithTermVector, bool storePayloads, bool omitTf);
 
 	/**
-	* Merge the fields of all segments 
+	* Merge the field infos of all segments and write them
 	* @return The number of documents in all of the readers
+  * @throws IOException if there is a low-level IO error
+	*/
+	int32_t mergeFieldInfos();
+
+	/**
+	* Merge the stored fields of all segments
   * @throws CorruptIndexException if the index is corrupt
   * @throws IOException if there is a low-level IO error
 	*/
-	int32_t mergeFields();
+	void mergeFields(CheckAbort* abortCheck);
 
 	/**
 	* Merge the TermVectors from each of the segments into the new one.
 	* @throws IOException
 	*/
-  	void mergeVectors();
+  	void mergeVectors(CheckAbort* abortCheck);
 
 	/** Merge the terms of all segments */
-	void mergeTerms();
+	void mergeTerms(CheckAbort* abortCheck);
 
 	/** Merges all TermInfos into a single segment */
-	void mergeTermInfos();
+	void mergeTermInfos(CheckAbort* abortCheck);
 
 	/** Merge one term found in one or more segments. The array <code>smis</code>
 	*  contains segments that are positioned at the same term. <code>N</code>
@@ -189,7 +210,10 @@ private:
 	int32_t appendPostings(SegmentMergeInfo** smis, int32_t n);
 
 	//Merges the norms for all fields 
-	void mergeNorms();
+	void mergeNorms(CheckAbort* abortCheck);
+
+	//Merges the doc values of all fields into the .dv file
+	void mergeDocValues(CheckAbort* abortCheck);
 
 	void createCompoundFile(const char* filename, std::vector<std::string>* files=NULL);
 	friend class IndexWriter; //allow IndexWriter to use createCompoundFile
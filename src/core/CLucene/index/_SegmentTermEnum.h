@@ -38,11 +38,19 @@ private:
 	int64_t position;		///The position of the current (term) in the enumeration
 	int64_t indexPointer;
 	Term* prev;				///The previous current
+	uint8_t* textBytes;		///The UTF-8 bytes of the current term, as read from the Term Infos File
+	int32_t textBytesLength;
+	uint8_t* prevTextBytes;	///The UTF-8 bytes of the previous term, only kept up to date by scanTo
+	int32_t prevTextBytesLength;
+	int32_t textBytesCapacity;	///Length of both textBytes and prevTextBytes
+	int32_t fieldNumber;	///The field number of the current term
+	int32_t prevFieldNumber;
 	int32_t indexInterval;
 	int32_t skipInterval;
 	int32_t maxSkipLevels;
 
 	friend class TermInfosReader;
+	friend class TermInfosIndex;
 	friend class SegmentTermDocs;
 protected:
 
@@ -70,9 +78,11 @@ public:
 	Term* term(bool pointer=true);
 
     /**
-	 * Scan for Term term without allocating new Terms
+	 * Scan for Term term without allocating new Terms. The terms skipped
+	 * over are compared to term as UTF-8 bytes, without being decoded.
+	 * Returns true if the enumeration stopped on term
 	 */
-	void scanTo(const Term *term);
+	bool scanTo(const Term *term);
 
 	/**
 	 * Closes the enumeration to further activity, freeing resources.
@@ -122,6 +132,26 @@ private:
 	 * Reads the next term in the enumeration
 	 */
 	Term* readTerm(Term* reuse);
+	/**
+	 * Reads the next term into textBytes. Its shared prefix is taken from
+	 * prevTextBytes if fromPrev is set, and from textBytes otherwise.
+	 * Returns the offset in bytes of the part which was read, and sets
+	 * start to its offset in characters
+	 */
+	int32_t readTermBytes(bool fromPrev, int32_t& start);
+	/**
+	 * Reads the TermInfo of the next term
+	 */
+	void readTermInfo();
+	/**
+	 * Decodes bytes into the buffer and sets reuse, or a new Term, to it
+	 */
+	Term* decodeTerm(Term* reuse, int32_t field, const uint8_t* bytes, int32_t length);
+	/**
+	 * Compares the field and UTF-8 text of a term to the current term
+	 */
+	int32_t compareToCurrent(const TCHAR* field, int32_t fieldNumber, const uint8_t* bytes, int32_t length) const;
+	void growTextBytes(const int32_t length);
    /** 
 	 * Instantiate a buffer of length length+1
    * TODO: deprecate this...
@@ -0,0 +1,87 @@
+/*------------------------------------------------------------------------------
+* Copyright (C) 2003-2006 Ben van Klinken and the CLucene Team
+*
+* Distributable under the terms of either the Apache License (Version 2.0) or
+* the GNU Lesser General Public License, as specified in the COPYING file.
+------------------------------------------------------------------------------*/
+#ifndef _lucene_index_TermInfosIndex_
+#define _lucene_index_TermInfosIndex_
+
+CL_CLASS_DEF(index,Term)
+
+CL_NS_DEF(index)
+class SegmentTermEnum;
+class FieldInfos;
+
+/**
+* The in memory copy of the term info index (.tii) of a segment, packed
+* into one block of bytes instead of a Term, TermInfo and pointer per entry.
+*
+* <p>Each entry is stored as
+* <pre>
+*   FieldNumber, PrefixLength, SuffixLength, SuffixBytes, DocFreq, SkipOffset,
+*   FreqDelta, ProxDelta, IndexPointerDelta
+* </pre>
+* all as VInts or VLongs. The entries are grouped in blocks of
+* RESTART_INTERVAL. The first entry of a block is stored in full; the others
+* share PrefixLength bytes of its text and store their pointers as deltas
+* from its pointers, so any entry can be read without reading its
+* predecessors. The offsets of the blocks and entries have a fixed stride,
+* and the first bytes of each block's first term are kept next to each
+* other, so most steps of the binary search do not touch the entry bytes.
+*
+* <p>Term text is stored by UTF-8 encoding each TCHAR. The bytes of two
+* texts compare like the texts do with _tcscmp, so terms are compared
+* without being decoded.
+*/
+class TermInfosIndex: LUCENE_BASE{
+public:
+	/** The number of entries per block */
+	LUCENE_STATIC_CONSTANT(int32_t, RESTART_INTERVAL = 16);
+
+	/**
+	* Reads every indexDivisor-th entry of indexEnum.
+	* @memory indexEnum is not closed or deleted
+	*/
+	TermInfosIndex(SegmentTermEnum* indexEnum, FieldInfos* fieldInfos, int32_t indexDivisor);
+	~TermInfosIndex();
+
+	/** Returns the number of entries */
+	int32_t size() const;
+
+	/** Returns the offset of the greatest entry which is less than or equal to term,
+	* or -1 if term sorts before every entry */
+	int32_t getIndexOffset(const Term* term) const;
+
+	/** Compares term to the term of the entry at indexOffset. The result has the
+	* sign of term->compareTo(entry term) */
+	int32_t compareTo(const Term* term, int32_t indexOffset) const;
+
+	/** Positions enumerator on the entry at indexOffset */
+	void seekEnum(SegmentTermEnum* enumerator, int32_t indexOffset, int32_t totalIndexInterval) const;
+
+	/** Returns the number of bytes held by this index */
+	int64_t ramBytesUsed() const;
+
+private:
+	class EncodedTerm;
+	class Entry;
+
+	FieldInfos* fieldInfos;
+	int32_t length;
+
+	uint8_t* bytes;
+	int64_t bytesLength;
+	int64_t* blockOffsets;      ///the offset in bytes of the first entry of each block
+	uint32_t* entryOffsets;     ///the offset of each entry from its block's offset
+	int32_t* blockFields;       ///the field number of the first entry of each block
+	uint64_t* blockKeys;        ///the first 8 text bytes of each block's first entry, big endian
+
+	void readEntry(int32_t indexOffset, Entry& entry) const;
+	int32_t compareTo(const EncodedTerm& term, int32_t indexOffset) const;
+	int32_t compareToBlock(const EncodedTerm& term, int32_t block) const;
+	int32_t compareField(const EncodedTerm& term, int32_t fieldNumber) const;
+};
+
+CL_NS_END
+#endif
@@ -10,6 +10,7 @@
 
 //#include "Terms.h"
 #include "_SegmentTermEnum.h"
+#include "_TermInfosIndex.h"
 CL_CLASS_DEF(store,Directory)
 //CL_CLASS_DEF(store,IndexInput)
 #include "CLucene/util/_ThreadLocal.h"
@@ -38,10 +39,7 @@ CL_NS_DEF(index)
 		SegmentTermEnum* indexEnum;
 		int64_t _size;
 
-		Term* indexTerms; //note: this is a list of objects, not arrays!
-    int32_t indexTermsLength;
-		TermInfo* indexInfos;
-		int64_t* indexPointers;
+		TermInfosIndex* index;
 
 		int32_t indexDivisor;
 		int32_t totalIndexInterval;
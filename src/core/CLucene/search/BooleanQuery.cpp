@@ -17,6 +17,10 @@
 #include "Similarity.h"
 #include "Explanation.h"
 #include "_BooleanScorer2.h"
+#include "_WANDScorer.h"
+#include "Searchable.h"
+#include "TermQuery.h"
+#include "CLucene/index/Term.h"
 #include "Scorer.h"
 
 #include <assert.h>
@@ -52,6 +56,8 @@ CL_NS_DEF(search)
 		void normalize(float_t norm);
 		Scorer* scorer(CL_NS(index)::IndexReader* reader);
 		Explanation* explain(CL_NS(index)::IndexReader* reader, int32_t doc);
+	private:
+		Scorer* wandScorer(CL_NS(index)::IndexReader* reader);
 	};// BooleanWeight
 
 
@@ -342,7 +348,55 @@ CL_NS_DEF(search)
       }
     }
 
+    /** Returns a WANDScorer if the query is a pure disjunction of term queries
+    * and the searcher allows dynamic pruning, or NULL. */
+    Scorer* BooleanWeight::wandScorer(IndexReader* reader){
+      if ( !searcher->getDynamicPruning() || parentQuery->getMinNrShouldMatch() != 0 || weights.size() < 2 )
+        return NULL;
+      for (size_t i = 0 ; i < weights.size(); i++) {
+        BooleanClause* c = (*clauses)[i];
+        if ( c->getOccur() != BooleanClause::SHOULD || !c->getQuery()->instanceOf(TermQuery::getClassName()) )
+          return NULL;
+      }
+
+      const size_t len = weights.size();
+      Scorer** subScorers = _CL_NEWARRAY(Scorer*,len);
+      float_t* maxScores = _CL_NEWARRAY(float_t,len);
+      int32_t count = 0;
+      for (size_t i = 0 ; i < len; i++) {
+        Weight* w = weights[i];
+        Scorer* subScorer = w->scorer(reader);
+        if (subScorer == NULL)
+          continue;
+        // the term score is tf * weight value * norm, bounded by the largest
+        // frequency and norm of the term in the reader. The slack keeps the
+        // bound above the computed scores despite float rounding.
+        Term* term = ((TermQuery*)(*clauses)[i]->getQuery())->getTerm(false);
+        maxScores[count] = subScorer->getSimilarity()->tf(reader->maxTermFreq(term))
+          * w->getValue() * Similarity::decodeNorm(reader->maxNorm(term->field()))
+          * 1.00001f;
+        subScorers[count++] = subScorer;
+      }
+
+      Scorer* result;
+      if ( count >= 2 ){
+        result = _CLNEW WANDScorer(similarity, subScorers, maxScores, count, count);
+      }else{
+        BooleanScorer2* bs = _CLNEW BooleanScorer2(similarity, 0, parentQuery->allowDocsOutOfOrder);
+        for ( int32_t i=0;i<count;i++ )
+          bs->add(subScorers[i], false, false);
+        result = bs;
+      }
+      _CLDELETE_LARRAY(subScorers);
+      _CLDELETE_LARRAY(maxScores);
+      return result;
+    }
+
     Scorer* BooleanWeight::scorer(IndexReader* reader){
+      Scorer* wand = wandScorer(reader);
+      if ( wand != NULL )
+        return wand;
+
       BooleanScorer2* result = _CLNEW BooleanScorer2(similarity,
                                                  parentQuery->minNrShouldMatch,
                                                  parentQuery->allowDocsOutOfOrder);
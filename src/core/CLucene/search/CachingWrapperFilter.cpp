@@ -7,6 +7,7 @@
 #include "CLucene/_ApiHeader.h"
 #include "CachingWrapperFilter.h"
 #include "CLucene/util/BitSet.h"
+#include "CLucene/util/SortedVIntList.h"
 #include "CLucene/index/IndexReader.h"
 
 CL_NS_DEF(search)
@@ -15,15 +16,28 @@ CL_NS_USE(util)
 
 
 class BitSetHolder: LUCENE_BASE{
-	bool deleteBs;
 public:
+	/** the set of bits(), loaded on first use */
 	CL_NS(util)::BitSet* bits;
+	bool bitsLoaded;
+	bool deleteBs;
+	/** the set of getDocIdSet(), either bits or a compact copy of it */
+	DocIdSet* docIdSet;
+	bool docIdSetLoaded;
 
-	BitSetHolder(CL_NS(util)::BitSet* bits, bool deleteBs){
+	BitSetHolder():
+		bits(NULL), bitsLoaded(false), deleteBs(false),
+		docIdSet(NULL), docIdSetLoaded(false)
+	{
+	}
+	void setBits(CL_NS(util)::BitSet* bits, bool deleteBs){
 		this->bits = bits;
 		this->deleteBs = deleteBs;
+		bitsLoaded = true;
 	}
 	~BitSetHolder(){
+		if ( docIdSet != bits )
+			_CLDELETE(docIdSet);
 		if ( deleteBs )
 			_CLDELETE(bits);
 	}
@@ -43,6 +57,14 @@ struct AbstractCachingFilter::Internal{
 		cache(false,true)
 	{
 	}
+	BitSetHolder* getHolder(IndexReader* reader){
+		BitSetHolder* cached = cache.get(reader);
+		if ( cached == NULL ){
+			cached = _CLNEW BitSetHolder();
+			cache.put(reader,cached);
+		}
+		return cached;
+	}
 };
 
 AbstractCachingFilter::AbstractCachingFilter():
@@ -59,13 +81,38 @@ AbstractCachingFilter::~AbstractCachingFilter(){
 
 BitSet* AbstractCachingFilter::bits(IndexReader* reader){
 	SCOPED_LOCK_MUTEX(_internal->cache_LOCK)
-	BitSetHolder* cached = _internal->cache.get(reader);
-	if ( cached != NULL )
-		return cached->bits;
-	BitSet* bs = doBits(reader);
-	BitSetHolder* bsh = _CLNEW BitSetHolder(bs, doShouldDeleteBitSet(bs));
-	_internal->cache.put(reader,bsh);
-	return bs;
+	BitSetHolder* cached = _internal->getHolder(reader);
+	if ( !cached->bitsLoaded ){
+		BitSet* bs = doBits(reader);
+		cached->setBits(bs, doShouldDeleteBitSet(bs));
+	}
+	return cached->bits;
+}
+DocIdSet* AbstractCachingFilter::getDocIdSet(IndexReader* reader){
+	SCOPED_LOCK_MUTEX(_internal->cache_LOCK)
+	BitSetHolder* cached = _internal->getHolder(reader);
+	if ( cached->docIdSetLoaded )
+		return cached->docIdSet;
+
+	if ( cached->bitsLoaded ){
+		cached->docIdSet = cached->bits;
+	}else{
+		BitSet* bs = doBits(reader);
+		//a set of few documents is kept as a list of one or two bytes
+		//per document, instead of maxDoc bits
+		if ( bs != NULL && bs->count() < bs->size() / 32 ){
+			cached->docIdSet = _CLNEW SortedVIntList(bs);
+			if ( doShouldDeleteBitSet(bs) ){
+				_CLDELETE(bs); //bits() loads it again if it is asked for
+			}else
+				cached->setBits(bs, false);
+		}else{
+			cached->setBits(bs, doShouldDeleteBitSet(bs));
+			cached->docIdSet = bs;
+		}
+	}
+	cached->docIdSetLoaded = true;
+	return cached->docIdSet;
 }
 void AbstractCachingFilter::closeCallback(CL_NS(index)::IndexReader* reader, void*){
 	SCOPED_LOCK_MUTEX(_internal->cache_LOCK)
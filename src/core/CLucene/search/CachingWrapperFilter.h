@@ -34,10 +34,16 @@ public:
 	search results, and false for those that should not. */
 	CL_NS(util)::BitSet* bits( CL_NS(index)::IndexReader* reader );
 
+	/** Returns the cached set of the reader. If the filter permits less than
+	* 1/32 of the documents, a SortedVIntList is cached instead of the
+	* BitSet, which takes a fraction of the memory. */
+	DocIdSet* getDocIdSet( CL_NS(index)::IndexReader* reader );
+
 	virtual Filter *clone() const = 0;
 	virtual TCHAR *toString() = 0;
 
 	bool shouldDeleteBitSet( const CL_NS(util)::BitSet* /*bits*/ ) const{ return false; }
+	bool shouldDeleteDocIdSet( const DocIdSet* /*set*/ ) const{ return false; }
 };
 
 /**
@@ -114,14 +114,12 @@ BitSet* ChainedFilter::bits( IndexReader* reader, int logic )
 	// see discussion at top of file
 	if( *filter ) {
 		BitSet* tmp = (*filter)->bits( reader );
-		if ( (*filter)->shouldDeleteBitSet(tmp) ) //if we are supposed to delete this BitSet, then
+		if ( tmp == NULL ){
+			bts = _CLNEW BitSet( reader->maxDoc() ); //bitset returned null, which means match _all_
+			bts->flip();
+		}else if ( (*filter)->shouldDeleteBitSet(tmp) ) //if we are supposed to delete this BitSet, then
 			bts = tmp; //we can safely call it our own
-		else if ( tmp == NULL ){
-			int32_t len = reader->maxDoc();
-			bts = _CLNEW BitSet( len ); //bitset returned null, which means match _all_
-			for (int32_t i=0;i<len;i++ )
-				bts->set(i);
-		}else{
+		else{
 			bts = tmp->clone(); //else it is probably cached, so we need to copy it before using it.
 		}
 		filter++;
@@ -148,14 +146,12 @@ BitSet* ChainedFilter::bits( IndexReader* reader, int* _logicArray )
 	// see discussion at top of file
 	if( *filter ) {
 		BitSet* tmp = (*filter)->bits( reader );
-		if ( (*filter)->shouldDeleteBitSet(tmp) ) //if we are supposed to delete this BitSet, then
-			bts = tmp; //we can safely call it our own
-		else if ( tmp == NULL ){
-			int32_t len = reader->maxDoc();
-			bts = _CLNEW BitSet( len ); //bitset returned null, which means match _all_
-			for (int32_t i=0;i<len;i++ )
-				bts->set(i); //todo: this could mean that we can skip certain types of filters
+		if ( tmp == NULL ){
+			bts = _CLNEW BitSet( reader->maxDoc() ); //bitset returned null, which means match _all_
+			bts->flip(); //todo: this could mean that we can skip certain types of filters
 		}
+		else if ( (*filter)->shouldDeleteBitSet(tmp) ) //if we are supposed to delete this BitSet, then
+			bts = tmp; //we can safely call it our own
 		else
 		{
 			bts = tmp->clone(); //else it is probably cached, so we need to copy it before using it.
@@ -182,28 +178,35 @@ void ChainedFilter::doUserChain( CL_NS(util)::BitSet* /*chain*/, CL_NS(util)::Bi
 BitSet* ChainedFilter::doChain( BitSet* resultset, IndexReader* reader, int logic, Filter* filter )
 {
 	BitSet* filterbits = filter->bits( reader );
-	int32_t maxDoc = reader->maxDoc();
-	int32_t i=0;
+
+	//the sets are combined a word (64 docs) at a time. A NULL filter
+	//bitset matches all documents.
 	if ( logic >= ChainedFilter::USER ){
 		doUserChain(resultset,filterbits,logic);
 	}else{
 		switch( logic )
 		{
 		case OR:
-			for( i=0; i < maxDoc; i++ )
-				resultset->set( i, (resultset->get(i) || (filterbits==NULL || filterbits->get(i) ))?1:0 );
+			if ( filterbits == NULL ){
+				resultset->clear();
+				resultset->flip();
+			}else
+				resultset->orBits(filterbits);
 			break;
 		case AND:
-			for( i=0; i < maxDoc; i++ )
-				resultset->set( i, (resultset->get(i) && (filterbits==NULL || filterbits->get(i) ))?1:0 );
+			if ( filterbits != NULL )
+				resultset->andBits(filterbits);
 			break;
 		case ANDNOT:
-			for( i=0; i < maxDoc; i++ )
-				resultset->set( i, (resultset->get(i) && (filterbits==NULL || filterbits->get(i)))?0:1 );
+			if ( filterbits != NULL )
+				resultset->andBits(filterbits);
+			resultset->flip();
 			break;
 		case XOR:
-			for( i=0; i < maxDoc; i++ )
-				resultset->set( i, resultset->get(i) ^ ((filterbits==NULL || filterbits->get(i) )?1:0) );
+			if ( filterbits == NULL )
+				resultset->flip();
+			else
+				resultset->xorBits(filterbits);
 			break;
 		default:
 			doChain( resultset, reader, DEFAULT, filter );
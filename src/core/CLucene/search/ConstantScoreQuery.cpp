@@ -11,6 +11,7 @@
 #include "Scorer.h"
 #include "RangeFilter.h"
 #include "Similarity.h"
+#include "DocIdSet.h"
 #include "CLucene/index/IndexReader.h"
 #include "CLucene/util/BitSet.h"
 #include "CLucene/util/StringBuffer.h"
@@ -22,22 +23,40 @@ CL_NS_USE(util)
 CL_NS_DEF(search)
 
 class ConstantScorer : public Scorer {
-    BitSet* bits;
+    IndexReader* reader;
+    Filter* filter;
+    DocIdSet* docIdSet;
+    DocIdSetIterator* docIdSetIterator;
+    const int32_t maxDoc;
     const float_t theScore;
     int32_t _doc;
 
 public:
     ConstantScorer(Similarity* similarity, IndexReader* reader, Weight* w, Filter* filter) : Scorer(similarity),
-        bits(filter->bits(reader)), theScore(w->getValue()), _doc(-1)
+        reader(reader), filter(filter), docIdSet(filter->getDocIdSet(reader)), docIdSetIterator(NULL),
+        maxDoc(reader->maxDoc()), theScore(w->getValue()), _doc(-1)
     {
+        if ( docIdSet != NULL )
+            docIdSetIterator = docIdSet->iterator();
     }
     virtual ~ConstantScorer() {
-        _CLLDELETE(bits);
+        _CLLDELETE(docIdSetIterator);
+        if ( docIdSet != NULL && filter->shouldDeleteDocIdSet(docIdSet) )
+            _CLLDELETE(docIdSet);
     }
 
     bool next() {
-        _doc = bits->nextSetBit(_doc+1);
-        return _doc >= 0;
+        if ( docIdSetIterator == NULL ){ // a NULL set permits all undeleted documents
+            while ( ++_doc < maxDoc ){
+                if ( !reader->isDeleted(_doc) )
+                    return true;
+            }
+            return false;
+        }
+        if ( !docIdSetIterator->next() )
+            return false;
+        _doc = docIdSetIterator->doc();
+        return true;
     }
 
     int32_t doc() const {
@@ -49,8 +68,17 @@ public:
     }
 
     bool skipTo(int32_t target) {
-        _doc = bits->nextSetBit(target);
-        return _doc >= 0;
+        if ( docIdSetIterator == NULL ){
+            for ( _doc = cl_max(_doc+1, target); _doc < maxDoc; ++_doc ){
+                if ( !reader->isDeleted(_doc) )
+                    return true;
+            }
+            return false;
+        }
+        if ( !docIdSetIterator->skipTo(target) )
+            return false;
+        _doc = docIdSetIterator->doc();
+        return true;
     }
 
     Explanation* explain(int32_t /*doc*/) {
@@ -104,7 +132,7 @@ public:
 
     Explanation* explain(IndexReader* reader, int32_t doc) {
         ConstantScorer* cs = (ConstantScorer*)scorer(reader);
-        bool exists = cs->bits->get(doc);
+        bool exists = cs->skipTo(doc) && cs->doc() == doc;
         _CLDELETE(cs);
 
         ComplexExplanation* result = _CLNEW ComplexExplanation();
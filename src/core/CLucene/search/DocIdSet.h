@@ -0,0 +1,75 @@
+/*------------------------------------------------------------------------------
+* Copyright (C) 2003-2006 Ben van Klinken and the CLucene Team
+*
+* Distributable under the terms of either the Apache License (Version 2.0) or
+* the GNU Lesser General Public License, as specified in the COPYING file.
+------------------------------------------------------------------------------*/
+#ifndef _lucene_search_DocIdSet_
+#define _lucene_search_DocIdSet_
+
+CL_CLASS_DEF(util,BitSet)
+
+CL_NS_DEF(search)
+
+  /**
+  * Iterates over the document numbers of a {@link DocIdSet} in increasing
+  * order. Like a Scorer, an iterator is positioned before the first
+  * document until next() or skipTo() is called.
+  */
+  class CLUCENE_EXPORT DocIdSetIterator: LUCENE_BASE {
+  public:
+    virtual ~DocIdSetIterator(){
+    }
+
+    /** Returns the current document number.
+    * <p>This is invalid until {@link #next()} is called for the first time.
+    */
+    virtual int32_t doc() const = 0;
+
+    /** Moves to the next docId in the set. Returns true, iff
+    * there is such a docId.
+    */
+    virtual bool next() = 0;
+
+    /** Skips entries to the first beyond the current whose document number is
+    * greater than or equal to <i>target</i>. Returns true iff there is such
+    * an entry.
+    * <p>Behaves as if written:
+    * <pre>
+    *   bool skipTo(int32_t target) {
+    *     do {
+    *       if (!next())
+    *         return false;
+    *     } while (target > doc());
+    *     return true;
+    *   }
+    * </pre>
+    * Some implementations are considerably more efficient than that.
+    */
+    virtual bool skipTo(int32_t target) = 0;
+  };
+
+  /**
+  * A set of document numbers. The set may be a bit set, which answers
+  * random access, or a compact sorted list for sets which only hold a
+  * small part of the documents; either can be iterated over.
+  */
+  class CLUCENE_EXPORT DocIdSet: LUCENE_BASE {
+  public:
+    virtual ~DocIdSet(){
+    }
+
+    /** Returns an iterator over the documents of this set.
+    * @memory the caller deletes the iterator, which must not outlive the set
+    */
+    virtual DocIdSetIterator* iterator() const = 0;
+
+    /** Returns this set if it is a BitSet, else NULL. Lets filters
+    * which mix BitSets and other sets decide their ownership
+    * without a downcast.
+    */
+    virtual const CL_NS(util)::BitSet* asBitSet() const{ return NULL; }
+  };
+
+CL_NS_END
+#endif
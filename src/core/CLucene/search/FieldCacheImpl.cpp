@@ -9,6 +9,7 @@
 #include "CLucene/index/IndexReader.h"
 #include "CLucene/index/Term.h"
 #include "CLucene/index/Terms.h"
+#include "CLucene/index/DocValues.h"
 #include "CLucene/util/_StringIntern.h"
 #include "CLucene/util/Misc.h"
 #include "Sort.h"
@@ -231,11 +232,20 @@ FieldCacheImpl::FileEntry::FileEntry (const TCHAR* field, int32_t type) {
 
 
 
- // inherit javadocs
- FieldCacheAuto* FieldCacheImpl::getInts (IndexReader* reader, const TCHAR* field) {
-    field = CLStringIntern::intern(field);
-    FieldCacheAuto* ret = lookup (reader, field, SortField::INT);
-    if (ret == NULL) {
+  //throws if the index has no terms at or after field. A single segment
+  //without terms is not an error, its documents get the default value.
+  static void checkHasTerms(IndexReader* reader, const TCHAR* field){
+    Term* term = _CLNEW Term (field, LUCENE_BLANK_STRING, false);
+    TermEnum* termEnum = reader->terms (term);
+    _CLDECDELETE(term);
+    bool empty = termEnum->term(false) == NULL;
+    termEnum->close();
+    _CLDELETE(termEnum);
+    if ( empty )
+      _CLTHROWA(CL_ERR_Runtime,"no terms in field"); //todo: add detailed error:  + field);
+  }
+
+  static FieldCacheAuto* readInts (IndexReader* reader, const TCHAR* field, bool requireTerms) {
       int32_t retLen = reader->maxDoc();
       int32_t* retArray = _CL_NEWARRAY(int32_t,retLen);
 	    memset(retArray,0,sizeof(int32_t)*retLen);
@@ -247,9 +257,9 @@ FieldCacheImpl::FileEntry::FileEntry (const TCHAR* field, int32_t type) {
 	    _CLDECDELETE(term);
       try {
           if (termEnum->term(false) == NULL) {
-			      _CLTHROWA(CL_ERR_Runtime,"no terms in field"); //todo: add detailed error:  + field);
-          }
-          do {
+            if ( requireTerms )
+			        _CLTHROWA(CL_ERR_Runtime,"no terms in field"); //todo: add detailed error:  + field);
+          }else do {
             Term* term = termEnum->term(false);
             if (term->field() != field)
 				      break;
@@ -270,20 +280,10 @@ FieldCacheImpl::FileEntry::FileEntry (const TCHAR* field, int32_t type) {
 
       FieldCacheAuto* fa = _CLNEW FieldCacheAuto(retLen,FieldCacheAuto::INT_ARRAY);
       fa->intArray = retArray;
-
-      store (reader, field, SortField::INT, fa);
-	    CLStringIntern::unintern(field);
       return fa;
-    }
-	  CLStringIntern::unintern(field);
-    return ret;
   }
 
-  // inherit javadocs
-  FieldCacheAuto* FieldCacheImpl::getFloats (IndexReader* reader, const TCHAR* field){
-	field = CLStringIntern::intern(field);
-    FieldCacheAuto* ret = lookup (reader, field, SortField::FLOAT);
-    if (ret == NULL) {
+  static FieldCacheAuto* readFloats (IndexReader* reader, const TCHAR* field, bool requireTerms){
 	  int32_t retLen = reader->maxDoc();
       float_t* retArray = _CL_NEWARRAY(float_t,retLen);
 	  memset(retArray,0,sizeof(float_t)*retLen);
@@ -296,9 +296,9 @@ FieldCacheImpl::FileEntry::FileEntry (const TCHAR* field, int32_t type) {
 
         try {
           if (termEnum->term(false) == NULL) {
-            _CLTHROWA(CL_ERR_Runtime,"no terms in field "); //todo: make richer error + field);
-          }
-          do {
+            if ( requireTerms )
+              _CLTHROWA(CL_ERR_Runtime,"no terms in field "); //todo: make richer error + field);
+          }else do {
             Term* term = termEnum->term(false);
             if (term->field() != field)
 				break;
@@ -319,71 +319,11 @@ FieldCacheImpl::FileEntry::FileEntry (const TCHAR* field, int32_t type) {
 
 	  FieldCacheAuto* fa = _CLNEW FieldCacheAuto(retLen,FieldCacheAuto::FLOAT_ARRAY);
 	  fa->floatArray = retArray;
-
-      store (reader, field, SortField::FLOAT, fa);
-	  CLStringIntern::unintern(field);
       return fa;
-    }
-	CLStringIntern::unintern(field);
-    return ret;
   }
 
-
-  // inherit javadocs
-  FieldCacheAuto* FieldCacheImpl::getStrings (IndexReader* reader, const TCHAR* field){
-   //todo: this is not really used, i think?
-	field = CLStringIntern::intern(field);
-    FieldCacheAuto* ret = lookup (reader, field, SortField::STRING);
-    if (ret == NULL) {
-	  int32_t retLen = reader->maxDoc();
-      TCHAR** retArray = _CL_NEWARRAY(TCHAR*,retLen+1);
-      memset(retArray,0,sizeof(TCHAR*)*(retLen+1));
-      if (retLen > 0) {
-        TermDocs* termDocs = reader->termDocs();
-
-		    Term* term = _CLNEW Term (field, LUCENE_BLANK_STRING, false);
-        TermEnum* termEnum = reader->terms (term);
-		    _CLDECDELETE(term);
-
-        try {
-          if (termEnum->term(false) == NULL) {
-            _CLTHROWA(CL_ERR_Runtime,"no terms in field "); //todo: extend to + field);
-          }
-          do {
-            Term* term = termEnum->term(false);
-            if (term->field() != field)
-				break;
-            const TCHAR* termval = term->text();
-            termDocs->seek (termEnum);
-            while (termDocs->next()) {
-              retArray[termDocs->doc()] = STRDUP_TtoT(termval); //todo: any better way of doing this???
-            }
-          } while (termEnum->next());
-        } _CLFINALLY(
-		  retArray[retLen]=NULL;
-          termDocs->close();
-          _CLDELETE(termDocs);
-          termEnum->close();
-          _CLDELETE(termEnum);
-        )
-      }
-	    FieldCacheAuto* fa = _CLNEW FieldCacheAuto(retLen,FieldCacheAuto::STRING_ARRAY);
-	    fa->stringArray = retArray;
-	    fa->ownContents=true;
-      store (reader, field, SortField::STRING, fa);
-	    CLStringIntern::unintern(field);
-      return fa;
-    }
-	  CLStringIntern::unintern(field);
-    return ret;
-  }
-
-  // inherit javadocs
-  FieldCacheAuto* FieldCacheImpl::getStringIndex (IndexReader* reader, const TCHAR* field){
-	  field = CLStringIntern::intern(field);
-    FieldCacheAuto* ret = lookup (reader, field, STRING_INDEX);
+  static FieldCacheAuto* readStringIndex (IndexReader* reader, const TCHAR* field, bool requireTerms){
     int32_t t = 0;  // current term number
-    if (ret == NULL) {
 	    int32_t retLen = reader->maxDoc();
       int32_t* retArray = _CL_NEWARRAY(int32_t,retLen);
 	    memset(retArray,0,sizeof(int32_t)*retLen);
@@ -408,9 +348,9 @@ FieldCacheImpl::FileEntry::FileEntry (const TCHAR* field, int32_t type) {
 
         try {
           if (termEnum->term(false) == NULL) {
-            _CLTHROWA(CL_ERR_Runtime,"no terms in field"); //todo: make rich message " + field);
-          }
-          do {
+            if ( requireTerms )
+              _CLTHROWA(CL_ERR_Runtime,"no terms in field"); //todo: make rich message " + field);
+          }else do {
             Term* term = termEnum->term(false);
             if (term->field() != field)
 			        break;
@@ -459,10 +399,317 @@ FieldCacheImpl::FileEntry::FileEntry (const TCHAR* field, int32_t type) {
 	    FieldCacheAuto* fa = _CLNEW FieldCacheAuto(retLen,FieldCacheAuto::STRING_INDEX);
 	    fa->stringIndex = value;
 	    fa->ownContents=true;
-      store (reader, field, STRING_INDEX, fa);
-      CLStringIntern::unintern(field);
+      return fa;
+  }
+
+  /** Builds the values of a segment from its doc values, so that the terms
+  * need not be un-inverted. Returns NULL if the segment has no doc values
+  * which can serve type. */
+  static FieldCacheAuto* readDocValues (IndexReader* segment, const TCHAR* field, int32_t type){
+    NumericDocValues* numeric = segment->getNumericDocValues(field);
+    SortedDocValues* sorted = numeric == NULL ? segment->getSortedDocValues(field) : NULL;
+    if ( numeric == NULL && sorted == NULL )
+      return NULL;
+    const int32_t retLen = segment->maxDoc();
+
+    if ( type == SortField::INT ){
+      //the values of a sorted column are parsed once each, the
+      //first entry is for documents without a value
+      const int32_t valueCount = sorted == NULL ? 0 : sorted->getValueCount();
+      int32_t* parsed = _CL_NEWARRAY(int32_t,valueCount+1);
+      for ( int32_t i=0;i<valueCount;i++ )
+        parsed[i+1] = _ttoi(sorted->lookupOrd(i));
+      int32_t* retArray = _CL_NEWARRAY(int32_t,retLen);
+      for ( int32_t i=0;i<retLen;i++ )
+        retArray[i] = numeric != NULL ? (int32_t)numeric->get(i) : parsed[sorted->getOrd(i)+1];
+      _CLDELETE_ARRAY(parsed);
+
+      FieldCacheAuto* fa = _CLNEW FieldCacheAuto(retLen,FieldCacheAuto::INT_ARRAY);
+      fa->intArray = retArray;
       return fa;
     }
+    if ( type == SortField::FLOAT ){
+      const int32_t valueCount = sorted == NULL ? 0 : sorted->getValueCount();
+      float_t* parsed = _CL_NEWARRAY(float_t,valueCount+1);
+      for ( int32_t i=0;i<valueCount;i++ )
+        parsed[i+1] = _tcstod(sorted->lookupOrd(i),NULL);
+      float_t* retArray = _CL_NEWARRAY(float_t,retLen);
+      for ( int32_t i=0;i<retLen;i++ )
+        retArray[i] = numeric != NULL ? (float_t)numeric->get(i) : parsed[sorted->getOrd(i)+1];
+      _CLDELETE_ARRAY(parsed);
+
+      FieldCacheAuto* fa = _CLNEW FieldCacheAuto(retLen,FieldCacheAuto::FLOAT_ARRAY);
+      fa->floatArray = retArray;
+      return fa;
+    }
+
+    //only a sorted column holds the order of the values as text
+    if ( sorted == NULL )
+      return NULL;
+    const int32_t valueCount = sorted->getValueCount();
+    int32_t* retArray = _CL_NEWARRAY(int32_t,retLen);
+    for ( int32_t i=0;i<retLen;i++ )
+      retArray[i] = sorted->getOrd(i) + 1;
+    TCHAR** mterms = _CL_NEWARRAY(TCHAR*,valueCount+2);
+    mterms[0] = NULL;
+    for ( int32_t i=0;i<valueCount;i++ )
+      mterms[i+1] = STRDUP_TtoT(sorted->lookupOrd(i));
+    mterms[valueCount+1] = NULL;
+
+    //same shape as readStringIndex: an empty segment has no entries at all
+    FieldCache::StringIndex* value = _CLNEW FieldCache::StringIndex (retArray, mterms, retLen > 0 ? valueCount+1 : 0);
+    FieldCacheAuto* fa = _CLNEW FieldCacheAuto(retLen,FieldCacheAuto::STRING_INDEX);
+    fa->stringIndex = value;
+    fa->ownContents=true;
+    return fa;
+  }
+
+  //true if a segment of reader has doc values for field
+  static bool hasDocValues (const std::vector<IndexReader*>& segments, const TCHAR* field){
+    for ( size_t i=0;i<segments.size();i++ ){
+      if ( segments[i]->getNumericDocValues(field) != NULL || segments[i]->getSortedDocValues(field) != NULL )
+        return true;
+    }
+    return false;
+  }
+
+  /** Merges the sorted term lists of the segments into one, and maps the
+  * term numbers of each segment's documents to the merged numbers. */
+  static FieldCacheAuto* mergeStringIndex (const std::vector<IndexReader*>& segments,
+      FieldCacheAuto** values, int32_t maxDoc){
+    const int32_t len = (int32_t)segments.size();
+    int32_t totalTerms = 0;
+    for ( int32_t i=0;i<len;i++ )
+      totalTerms += cl_max(values[i]->stringIndex->count - 1, 0);
+
+    int32_t* retArray = _CL_NEWARRAY(int32_t,cl_max(maxDoc,1));
+    TCHAR** mterms = _CL_NEWARRAY(TCHAR*,totalTerms+2);
+    int32_t** maps = _CL_NEWARRAY(int32_t*,len);
+    int32_t* pos = _CL_NEWARRAY(int32_t,len);
+    for ( int32_t i=0;i<len;i++ ){
+      const int32_t count = values[i]->stringIndex->count;
+      maps[i] = _CL_NEWARRAY(int32_t,cl_max(count,1));
+      maps[i][0] = 0; //no term sorts first in every segment
+      pos[i] = 1;
+    }
+
+    //each segment's lookup is sorted, so repeatedly take the smallest head
+    int32_t t = 0;
+    mterms[t++] = NULL;
+    const TCHAR* last = NULL;
+    for (;;){
+      int32_t min = -1;
+      for ( int32_t i=0;i<len;i++ ){
+        if ( pos[i] >= values[i]->stringIndex->count )
+          continue;
+        if ( min == -1 || _tcscmp(values[i]->stringIndex->lookup[pos[i]],
+              values[min]->stringIndex->lookup[pos[min]]) < 0 )
+          min = i;
+      }
+      if ( min == -1 )
+        break;
+      const TCHAR* text = values[min]->stringIndex->lookup[pos[min]];
+      if ( last == NULL || _tcscmp(text, last) != 0 ){
+        mterms[t++] = STRDUP_TtoT(text);
+        last = text;
+      }
+      maps[min][pos[min]++] = t - 1;
+    }
+    mterms[t] = NULL;
+
+    int32_t docBase = 0;
+    for ( int32_t i=0;i<len;i++ ){
+      const int32_t segMaxDoc = segments[i]->maxDoc();
+      const int32_t* order = values[i]->stringIndex->order;
+      for ( int32_t j=0;j<segMaxDoc;j++ )
+        retArray[docBase+j] = maps[i][order[j]];
+      docBase += segMaxDoc;
+      _CLDELETE_ARRAY(maps[i]);
+    }
+    _CLDELETE_ARRAY(maps);
+    _CLDELETE_ARRAY(pos);
+
+    //same shape as readStringIndex: an empty index has no entries at all
+    FieldCache::StringIndex* value = _CLNEW FieldCache::StringIndex (retArray, mterms, maxDoc > 0 ? t : 0);
+    FieldCacheAuto* fa = _CLNEW FieldCacheAuto(maxDoc,FieldCacheAuto::STRING_INDEX);
+    fa->stringIndex = value;
+    fa->ownContents=true;
+    return fa;
+  }
+
+  FieldCacheAuto* FieldCacheImpl::getSegmentValues (IndexReader* segment, const TCHAR* field, int32_t type){
+    FieldCacheAuto* ret = lookup (segment, field, type);
+    if (ret == NULL) {
+      ret = readDocValues(segment, field, type);
+      if ( ret == NULL ){
+        if ( type == SortField::INT )
+          ret = readInts(segment, field, false);
+        else if ( type == SortField::FLOAT )
+          ret = readFloats(segment, field, false);
+        else
+          ret = readStringIndex(segment, field, false);
+      }
+      store (segment, field, type, ret);
+    }
+    return ret;
+  }
+
+  FieldCacheAuto* FieldCacheImpl::getMergedValues (IndexReader* reader, const TCHAR* field, int32_t type){
+    std::vector<IndexReader*> segments;
+    reader->gatherSubReaders(segments);
+    if ( segments.size() == 1 && segments[0] == reader ){
+      FieldCacheAuto* ret = readDocValues(reader, field, type);
+      if ( ret != NULL )
+        return ret;
+      if ( type == SortField::INT )
+        return readInts(reader, field, true);
+      else if ( type == SortField::FLOAT )
+        return readFloats(reader, field, true);
+      else
+        return readStringIndex(reader, field, true);
+    }
+
+    const int32_t len = (int32_t)segments.size();
+    const int32_t maxDoc = reader->maxDoc();
+    if ( maxDoc > 0 && !hasDocValues(segments, field) )
+      checkHasTerms(reader, field);
+    FieldCacheAuto** values = _CL_NEWARRAY(FieldCacheAuto*,len);
+    for ( int32_t i=0;i<len;i++ )
+      values[i] = getSegmentValues(segments[i], field, type);
+
+    FieldCacheAuto* fa = NULL;
+    if ( type == STRING_INDEX ){
+      fa = mergeStringIndex(segments, values, maxDoc);
+    }else{
+      //the segment arrays are simply laid out one after the other
+      const size_t size = type == SortField::INT ? sizeof(int32_t) : sizeof(float_t);
+      int32_t* intArray = NULL;
+      float_t* floatArray = NULL;
+      uint8_t* retArray;
+      if ( type == SortField::INT ){
+        intArray = _CL_NEWARRAY(int32_t,cl_max(maxDoc,1));
+        retArray = (uint8_t*)intArray;
+      }else{
+        floatArray = _CL_NEWARRAY(float_t,cl_max(maxDoc,1));
+        retArray = (uint8_t*)floatArray;
+      }
+      memset(retArray, 0, cl_max(maxDoc,1) * size);
+      int32_t docBase = 0;
+      for ( int32_t i=0;i<len;i++ ){
+        const int32_t segMaxDoc = segments[i]->maxDoc();
+        const void* segArray = type == SortField::INT ? (void*)values[i]->intArray : (void*)values[i]->floatArray;
+        memcpy(retArray + docBase * size, segArray, segMaxDoc * size);
+        docBase += segMaxDoc;
+      }
+      if ( type == SortField::INT ){
+        fa = _CLNEW FieldCacheAuto(maxDoc,FieldCacheAuto::INT_ARRAY);
+        fa->intArray = intArray;
+      }else{
+        fa = _CLNEW FieldCacheAuto(maxDoc,FieldCacheAuto::FLOAT_ARRAY);
+        fa->floatArray = floatArray;
+      }
+    }
+    _CLDELETE_ARRAY(values);
+    return fa;
+  }
+
+ // inherit javadocs
+ FieldCacheAuto* FieldCacheImpl::getInts (IndexReader* reader, const TCHAR* field) {
+    field = CLStringIntern::intern(field);
+    FieldCacheAuto* ret = lookup (reader, field, SortField::INT);
+    if (ret == NULL) {
+      try{
+        ret = getMergedValues(reader, field, SortField::INT);
+      }catch(...){
+        CLStringIntern::unintern(field);
+        throw;
+      }
+      store (reader, field, SortField::INT, ret);
+    }
+	  CLStringIntern::unintern(field);
+    return ret;
+  }
+
+  // inherit javadocs
+  FieldCacheAuto* FieldCacheImpl::getFloats (IndexReader* reader, const TCHAR* field){
+	field = CLStringIntern::intern(field);
+    FieldCacheAuto* ret = lookup (reader, field, SortField::FLOAT);
+    if (ret == NULL) {
+      try{
+        ret = getMergedValues(reader, field, SortField::FLOAT);
+      }catch(...){
+        CLStringIntern::unintern(field);
+        throw;
+      }
+      store (reader, field, SortField::FLOAT, ret);
+    }
+	CLStringIntern::unintern(field);
+    return ret;
+  }
+
+
+  // inherit javadocs
+  FieldCacheAuto* FieldCacheImpl::getStrings (IndexReader* reader, const TCHAR* field){
+   //todo: this is not really used, i think?
+	field = CLStringIntern::intern(field);
+    FieldCacheAuto* ret = lookup (reader, field, SortField::STRING);
+    if (ret == NULL) {
+	  int32_t retLen = reader->maxDoc();
+      TCHAR** retArray = _CL_NEWARRAY(TCHAR*,retLen+1);
+      memset(retArray,0,sizeof(TCHAR*)*(retLen+1));
+      if (retLen > 0) {
+        TermDocs* termDocs = reader->termDocs();
+
+		    Term* term = _CLNEW Term (field, LUCENE_BLANK_STRING, false);
+        TermEnum* termEnum = reader->terms (term);
+		    _CLDECDELETE(term);
+
+        try {
+          if (termEnum->term(false) == NULL) {
+            _CLTHROWA(CL_ERR_Runtime,"no terms in field "); //todo: extend to + field);
+          }
+          do {
+            Term* term = termEnum->term(false);
+            if (term->field() != field)
+				break;
+            const TCHAR* termval = term->text();
+            termDocs->seek (termEnum);
+            while (termDocs->next()) {
+              retArray[termDocs->doc()] = STRDUP_TtoT(termval); //todo: any better way of doing this???
+            }
+          } while (termEnum->next());
+        } _CLFINALLY(
+		  retArray[retLen]=NULL;
+          termDocs->close();
+          _CLDELETE(termDocs);
+          termEnum->close();
+          _CLDELETE(termEnum);
+        )
+      }
+	    FieldCacheAuto* fa = _CLNEW FieldCacheAuto(retLen,FieldCacheAuto::STRING_ARRAY);
+	    fa->stringArray = retArray;
+	    fa->ownContents=true;
+      store (reader, field, SortField::STRING, fa);
+	    CLStringIntern::unintern(field);
+      return fa;
+    }
+	  CLStringIntern::unintern(field);
+    return ret;
+  }
+
+  // inherit javadocs
+  FieldCacheAuto* FieldCacheImpl::getStringIndex (IndexReader* reader, const TCHAR* field){
+	  field = CLStringIntern::intern(field);
+    FieldCacheAuto* ret = lookup (reader, field, STRING_INDEX);
+    if (ret == NULL) {
+      try{
+        ret = getMergedValues(reader, field, STRING_INDEX);
+      }catch(...){
+        CLStringIntern::unintern(field);
+        throw;
+      }
+      store (reader, field, STRING_INDEX, ret);
+    }
     CLStringIntern::unintern(field);
     return ret;
   }
@@ -471,6 +718,19 @@ FieldCacheImpl::FileEntry::FileEntry (const TCHAR* field, int32_t type) {
   FieldCacheAuto* FieldCacheImpl::getAuto (IndexReader* reader, const TCHAR* field) {
 	  field = CLStringIntern::intern(field);
     FieldCacheAuto* ret = lookup (reader, field, SortField::AUTO);
+    if (ret == NULL) {
+      //doc values know their type, so the terms need not be looked at
+      std::vector<IndexReader*> segments;
+      reader->gatherSubReaders(segments);
+      for ( size_t i=0;i<segments.size() && ret == NULL;i++ ){
+        if ( segments[i]->getNumericDocValues(field) != NULL )
+          ret = getInts (reader, field);
+        else if ( segments[i]->getSortedDocValues(field) != NULL )
+          ret = getStringIndex (reader, field);
+      }
+      if (ret != NULL)
+        store (reader, field, SortField::AUTO, ret);
+    }
     if (ret == NULL) {
 	    Term* term = _CLNEW Term (field, LUCENE_BLANK_STRING, false);
       TermEnum* enumerator = reader->terms (term);
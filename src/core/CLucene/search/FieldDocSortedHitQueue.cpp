@@ -146,6 +146,10 @@ bool FieldDocSortedHitQueue::lessThan (FieldDoc* docA, FieldDoc* docB) {
 			}
 		}
 	}
+	// like FieldSortedHitQueue, so that merged hits are in the order a
+	// searchAfter cursor expects
+	if (c == 0)
+		return docA->scoreDoc.doc > docB->scoreDoc.doc;
 	return c > 0;
 }
 
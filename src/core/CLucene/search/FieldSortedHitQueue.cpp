@@ -203,6 +203,55 @@ ScoreDocComparator* FieldSortedHitQueue::comparatorInt (IndexReader* reader, con
     return doc;
   }
 
+  // compares two sort values the way a comparator of the given type
+  // compares the documents they came from
+  static int32_t compareSortValues (const int32_t type, Comparable* a, Comparable* b) {
+	switch (type) {
+		case SortField::DOCSCORE: {
+			const float_t r1 = static_cast<Compare::Float*>(a)->getValue();
+			const float_t r2 = static_cast<Compare::Float*>(b)->getValue();
+			return r1 > r2 ? -1 : (r1 < r2 ? 1 : 0);
+		}
+		case SortField::DOC:
+		case SortField::INT: {
+			const int32_t i1 = static_cast<Compare::Int32*>(a)->getValue();
+			const int32_t i2 = static_cast<Compare::Int32*>(b)->getValue();
+			return i1 < i2 ? -1 : (i1 > i2 ? 1 : 0);
+		}
+		case SortField::FLOAT: {
+			const float_t f1 = static_cast<Compare::Float*>(a)->getValue();
+			const float_t f2 = static_cast<Compare::Float*>(b)->getValue();
+			return f1 < f2 ? -1 : (f1 > f2 ? 1 : 0);
+		}
+		case SortField::STRING: {
+			const TCHAR* s1 = static_cast<Compare::TChar*>(a)->getValue();
+			const TCHAR* s2 = static_cast<Compare::TChar*>(b)->getValue();
+			// documents without a value sort first, see FieldCache::getStringIndex
+			if (s1 == NULL) return s2 == NULL ? 0 : -1;
+			if (s2 == NULL) return 1;
+			return _tcscmp(s1,s2);
+		}
+		default:
+			return a->compareTo(b);
+	}
+  }
+
+  bool FieldSortedHitQueue::sortsAfter (FieldDoc* doc, const FieldDoc* after) const{
+	int32_t c = 0;
+	for ( int32_t i=0; c==0 && i<comparatorsLen; ++i ) {
+		const int32_t type = fields[i]->getType();
+		Comparable* value = comparators[i]->sortValue(&doc->scoreDoc);
+		c = compareSortValues(type, value, after->fields[i]);
+		if (type != SortField::CUSTOM) // a SortComparator returns its cached values
+			_CLDELETE(value);
+		if (fields[i]->getReverse())
+			c = -c;
+	}
+	if (c == 0)
+		return doc->scoreDoc.doc > after->scoreDoc.doc;
+	return c > 0;
+  }
+
   ScoreDocComparator* FieldSortedHitQueue::lookup (IndexReader* reader, const TCHAR* field, int32_t type, SortComparatorSource* factory) {
     ScoreDocComparator* sdc = NULL;
     FieldCacheImpl::FileEntry* entry = (factory != NULL)
@@ -181,6 +181,16 @@ public:
    */
 	FieldDoc* fillFields (FieldDoc* doc) const;
 
+  /**
+   * Returns whether <code>doc</code> sorts after <code>after</code>, a hit
+   * of an earlier search by the same criteria. The sort values of
+   * <code>doc</code> are compared with the ones stored in
+   * <code>after</code> by {@link #fillFields}, ties are broken by the
+   * document number, like in {@link #lessThan}.
+   * @see Searchable#_searchAfter(Query*,Filter*,const FieldDoc*,int32_t,const Sort*)
+   */
+	bool sortsAfter (FieldDoc* doc, const FieldDoc* after) const;
+
 	void setFields (SortField** fields){
 		this->fields = fields;
 	}
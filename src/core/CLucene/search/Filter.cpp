@@ -0,0 +1,26 @@
+/*------------------------------------------------------------------------------
+* Copyright (C) 2003-2006 Ben van Klinken and the CLucene Team
+*
+* Distributable under the terms of either the Apache License (Version 2.0) or
+* the GNU Lesser General Public License, as specified in the COPYING file.
+------------------------------------------------------------------------------*/
+#include "CLucene/_ApiHeader.h"
+#include "Filter.h"
+#include "DocIdSet.h"
+#include "CLucene/util/BitSet.h"
+
+CL_NS_USE(index)
+CL_NS_USE(util)
+CL_NS_DEF(search)
+
+DocIdSet* Filter::getDocIdSet(IndexReader* reader){
+	return bits(reader);
+}
+
+bool Filter::shouldDeleteDocIdSet(const DocIdSet* set) const{
+	//sets which are not from bits() belong to the caller
+	const BitSet* bitSet = set->asBitSet();
+	return bitSet == NULL || shouldDeleteBitSet(bitSet);
+}
+
+CL_NS_END
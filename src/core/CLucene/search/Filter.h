@@ -9,6 +9,7 @@
 
 CL_CLASS_DEF(util,BitSet)
 CL_CLASS_DEF(index,IndexReader)
+CL_CLASS_DEF(search,DocIdSet)
 
 CL_NS_DEF(search)
   // Abstract base class providing a mechanism to restrict searches to a subset
@@ -35,6 +36,26 @@ CL_NS_DEF(search)
     */
 	virtual bool shouldDeleteBitSet(const CL_NS(util)::BitSet*) const{ return true; }
 
+    /**
+    * Returns the documents which should be permitted in search results, or
+    * NULL if all documents are permitted. Searchers iterate the set and skip
+    * the query scorer to each of its documents, so a filter which only keeps
+    * few documents can return a compact set (like a SortedVIntList) instead
+    * of a BitSet of maxDoc bits.
+    * <p>The default returns {@link #bits}, so filters only implementing
+    * bits keep working. A filter overriding this must override
+    * {@link #shouldDeleteDocIdSet} to match.
+    * @memory see {@link #shouldDeleteDocIdSet}
+    */
+    virtual DocIdSet* getDocIdSet(CL_NS(index)::IndexReader* reader);
+
+    /**
+    * Like {@link #shouldDeleteBitSet}, for the sets returned by
+    * {@link #getDocIdSet}. The default passes BitSets to shouldDeleteBitSet
+    * and returns true for any other set.
+    */
+    virtual bool shouldDeleteDocIdSet(const DocIdSet* set) const;
+
 	//Creates a user-readable version of this query and returns it as as string
 	virtual TCHAR* toString()=0;
   };
@@ -47,13 +47,19 @@ FilteredTermEnum::FilteredTermEnum():currentTerm(NULL),actualEnum(NULL){
 		//Finalize the currentTerm and reset it to NULL
        _CLDECDELETE( currentTerm );
 
+		//True if actualEnum was replaced and is on the next term to compare
+		bool positioned = false;
+
 		//Iterate through the enumeration
         while (currentTerm == NULL) {
             if (endEnum()) 
 				return false;
-            if (actualEnum->next()) {
+            if (positioned || actualEnum->next()) {
+                positioned = false;
                 //Order term not to return reference ownership here. */
                 Term* term = actualEnum->term(false);
+                if (term == NULL)
+                    return false;
 				//Compare the retrieved term
                 if (termCompare(term)){
 					//Matched so finalize the current
@@ -61,6 +67,14 @@ FilteredTermEnum::FilteredTermEnum():currentTerm(NULL),actualEnum(NULL){
 					//Get a reference to the matched term
                     currentTerm = _CL_POINTER(term);
                     return true;
+                }
+				//Skip the terms which can not match if the subclass knows where to continue
+                TermEnum* seeked = seekEnum();
+                if (seeked != NULL){
+                    actualEnum->close();
+                    _CLDELETE(actualEnum);
+                    actualEnum = seeked;
+                    positioned = true;
                 }
             }else 
                 return false;
@@ -95,6 +109,10 @@ FilteredTermEnum::FilteredTermEnum():currentTerm(NULL),actualEnum(NULL){
         _CLDECDELETE(currentTerm);
     }
 
+	TermEnum* FilteredTermEnum::seekEnum(){
+		return NULL;
+	}
+
 	void FilteredTermEnum::setEnum(TermEnum* actualEnum) {
 	//Func - Sets the actual Enumeration
 	//Pre  - actualEnum != NULL
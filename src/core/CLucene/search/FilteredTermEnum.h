@@ -49,6 +49,14 @@ protected:
 
 	void setEnum(CL_NS(index)::TermEnum* actualEnum) ;
 
+	/**
+	* Called after termCompare rejected a term. Returns a new enumeration
+	* positioned on the next term which may match, which replaces the
+	* actual enumeration, or NULL to continue with the next term.
+	* The default returns NULL.
+	*/
+	virtual CL_NS(index)::TermEnum* seekEnum();
+
 private:
 	CL_NS(index)::Term* currentTerm;
 	CL_NS(index)::TermEnum* actualEnum;
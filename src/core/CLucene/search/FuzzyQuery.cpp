@@ -12,6 +12,7 @@
 #include "BooleanQuery.h"
 #include "BooleanClause.h"
 #include "TermQuery.h"
+#include "_TermAutomaton.h"
 
 #include "CLucene/util/StringBuffer.h"
 #include "CLucene/util/PriorityQueue.h"
@@ -30,7 +31,7 @@ CL_NS_DEF(search)
 	FuzzyTermEnum::FuzzyTermEnum(IndexReader* reader, Term* term, float_t minSimilarity, size_t _prefixLength):
 		FilteredTermEnum(),d(NULL),dLen(0),_similarity(0),_endEnum(false),searchTerm(_CL_POINTER(term)),
 		text(NULL),textLen(0),prefix(NULL)/* ISH: was STRDUP_TtoT(LUCENE_BLANK_STRING)*/,prefixLength(0),
-		minimumSimilarity(minSimilarity)
+		minimumSimilarity(minSimilarity),reader(reader),automaton(NULL)
 	{
 		CND_PRECONDITION(term != NULL,"term is NULL");
 
@@ -57,6 +58,12 @@ CL_NS_DEF(search)
 
 		initializeMaxDistances();
 
+		//no term is similar enough if it is further than this from the text.
+		//With more edits nearly every term is accepted, so they are just compared
+		const int32_t maxDistance = calculateMaxDistance(textLen);
+		if ( maxDistance <= MAX_AUTOMATON_DISTANCE )
+			automaton = _CLNEW LevenshteinAutomaton(prefix, prefixLength, text, textLen, maxDistance);
+
 		Term* trm = _CLNEW Term(searchTerm->field(), prefix); // _CLNEW Term(term, prefix); -- not intern'd?
 		setEnum(reader->terms(trm));
 		_CLLDECDELETE(trm);
@@ -105,6 +112,20 @@ CL_NS_DEF(search)
 		_CLDELETE_CARRAY(text);
 
 		_CLDELETE_CARRAY(prefix);
+
+		_CLDELETE(automaton);
+	}
+
+	TermEnum* FuzzyTermEnum::seekEnum() {
+		if (automaton == NULL)
+			return NULL;
+		const TCHAR* seekText = automaton->seekText();
+		if (seekText == NULL)
+			return NULL;
+		Term* t = _CLNEW Term(searchTerm, seekText);
+		TermEnum* ret = reader->terms(t);
+		_CLDECDELETE(t);
+		return ret;
 	}
 
 	bool FuzzyTermEnum::termCompare(Term* term) {
@@ -126,6 +147,13 @@ CL_NS_DEF(search)
 		if ( searchTerm->field() == term->field() &&
 			(prefixLength==0 || _tcsncmp(termText,prefix,prefixLength)==0 )) {
 
+				if (automaton != NULL && !automaton->accept(termText, termTextLen)) {
+					//no greater term with the prefix is similar enough
+					if (automaton->exhausted())
+						_endEnum = true;
+					return false;
+				}
+
 				const TCHAR* target = termText+prefixLength;
 				const size_t targetLen = termTextLen-prefixLength;
 				_similarity = similarity(target, targetLen);
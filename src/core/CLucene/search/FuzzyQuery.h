@@ -11,6 +11,7 @@
 #include "FilteredTermEnum.h"
 
 CL_CLASS_DEF(index,Term)
+CL_CLASS_DEF(search,TermAutomaton)
 
 CL_NS_DEF(search)
 
@@ -102,6 +103,13 @@ private:
 
 	float_t minimumSimilarity;
 	double scale_factor;
+	CL_NS(index)::IndexReader* reader;
+	/** The largest maximum distance for which the terms are run through an automaton */
+	LUCENE_STATIC_CONSTANT(int32_t, MAX_AUTOMATON_DISTANCE = 2);
+	/** Accepts the text after the prefix which is within the largest
+	* maximum distance of the text, so only those terms are compared.
+	* NULL if that distance is greater than MAX_AUTOMATON_DISTANCE */
+	TermAutomaton* automaton;
 	int32_t maxDistances[LUCENE_TYPICAL_LONGEST_WORD_IN_INDEX];
 
 	/******************************
@@ -167,6 +175,9 @@ protected:
 	*/
 	bool termCompare(CL_NS(index)::Term* term) ;
 
+	/** Seeks to the next term which may be similar enough */
+	CL_NS(index)::TermEnum* seekEnum();
+
 	/** Returns the fact if the current term in the enumeration has reached the end */
 	bool endEnum();
 public:
@@ -45,7 +45,8 @@ CL_NS_DEF(search)
 
 	Hits::Hits(Searcher* s, Query* q, Filter* f, const Sort* _sort):
 		query(q), searcher(s), filter(f), sort(_sort) , _length(0), first(NULL), last(NULL),
-			numDocs(0), maxDocs(200), nDeletedHits(0), debugCheckedForDeletions(false)
+			numDocs(0), maxDocs(200), nDeletedHits(0), scoreNorm(1.0f), lastDoc(-1), lastScore(0.0f),
+			debugCheckedForDeletions(false)
 	{
 	//Func - Constructor
 	//Pre  - s contains a valid reference to a searcher s
@@ -115,6 +116,19 @@ CL_NS_DEF(search)
 			_min = hitDocs->size();
 
 		size_t n = _min * 2;				  // double # retrieved
+
+		// as long as no documents were deleted, the hits retrieved so far are
+		// still the top ones, so only the hits ranked after them are searched for
+		if ( sort == NULL && lastDoc >= 0 && nDeletions >= 0 && countDeletions(searcher) == nDeletions ){
+			ScoreDoc after = {lastDoc, lastScore};
+			TopDocs* topDocs = ((Searchable*)searcher)->_searchAfter(query, filter, &after, n - hitDocs->size());
+			_length = topDocs->totalHits + nDeletedHits;
+			debugCheckedForDeletions = false;
+			addHitDocs(topDocs->scoreDocs, 0, topDocs->scoreDocsLength);
+			_CLDELETE(topDocs);
+			return;
+		}
+
 		TopDocs* topDocs = NULL;
 		if ( sort==NULL )
 			topDocs = (TopDocs*)((Searchable*)searcher)->_search(query, filter, n);
@@ -125,7 +139,7 @@ CL_NS_DEF(search)
 		ScoreDoc* scoreDocs = topDocs->scoreDocs;
 		size_t scoreDocsLength = topDocs->scoreDocsLength;
 
-		float_t scoreNorm = 1.0f;
+		scoreNorm = 1.0f;
 
 		//Check that scoreDocs is a valid pointer before using it
 		if (scoreDocs != NULL){
@@ -157,9 +171,7 @@ CL_NS_DEF(search)
 
 			size_t end = scoreDocsLength < _length ? scoreDocsLength : _length;
 			_length += nDeletedHits;
-			for (size_t i = start; i < end; i++) {
-				hitDocs->push_back(_CLNEW HitDoc(scoreDocs[i].score * scoreNorm, scoreDocs[i].doc));
-			}
+			addHitDocs(scoreDocs, start, end);
 
 			nDeletions = nDels2;
 		}
@@ -167,6 +179,16 @@ CL_NS_DEF(search)
 		_CLDELETE(topDocs);
 	}
 
+	void Hits::addHitDocs(const ScoreDoc* scoreDocs, const size_t start, const size_t end){
+		for (size_t i = start; i < end; i++) {
+			hitDocs->push_back(_CLNEW HitDoc(scoreDocs[i].score * scoreNorm, scoreDocs[i].doc));
+		}
+		if ( end > 0 ){ // the cursor of the next search
+			lastDoc = scoreDocs[end-1].doc;
+			lastScore = scoreDocs[end-1].score;
+		}
+	}
+
 	HitDoc* Hits::getHitDoc(const size_t n){
 		if (n >= _lengthAtStart){
 		    TCHAR buf[100];
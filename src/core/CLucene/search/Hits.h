@@ -18,6 +18,7 @@ CL_NS_DEF(search)
 	class Filter;
 	class HitDoc;
 	class Sort;
+	struct ScoreDoc;
 
 	/** A ranked list of documents, used to hold search results.
 	* <p>
@@ -52,6 +53,10 @@ CL_NS_DEF(search)
 		size_t _lengthAtStart;    // this is the number apps usually count on (although deletions can bring it down). 
 		int32_t nDeletedHits;    // # of already collected hits that were meanwhile deleted.
 
+		float_t scoreNorm;        // normalizes the scores of the hits, from the top score
+		int32_t lastDoc;          // the last retrieved hit, or -1 before the first one
+		float_t lastScore;        // its score, not normalized
+
 		bool debugCheckedForDeletions; // for test purposes.
 
 		/**
@@ -59,6 +64,9 @@ CL_NS_DEF(search)
 		* Ensures that the hit numbered <code>_min</code> has been retrieved.
 		*/
 		void getMoreDocs(const size_t _min);
+
+		/** Appends hits <code>start</code> to <code>end</code> of scoreDocs to hitDocs. */
+		void addHitDocs(const ScoreDoc* scoreDocs, const size_t start, const size_t end);
 	    
 		/** Returns the score for the n<sup>th</sup> document in this set. */
 		HitDoc* getHitDoc(const size_t n);
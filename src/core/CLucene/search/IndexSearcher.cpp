@@ -12,12 +12,14 @@
 #include "_HitQueue.h"
 #include "Query.h"
 #include "Filter.h"
+#include "DocIdSet.h"
 #include "_FieldDocSortedHitQueue.h"
 #include "CLucene/store/Directory.h"
 #include "CLucene/document/Document.h"
 #include "CLucene/index/IndexReader.h"
 #include "CLucene/index/Term.h"
 #include "CLucene/util/BitSet.h"
+#include "CLucene/util/ThreadPool.h"
 #include "FieldSortedHitQueue.h"
 #include "Explanation.h"
 
@@ -30,29 +32,48 @@ CL_NS_DEF(search)
 	class SimpleTopDocsCollector:public HitCollector{ 
 	private:
 		float_t minScore;
-		const CL_NS(util)::BitSet* bits;
 		HitQueue* hq;
 		size_t nDocs;
 		int32_t* totalHits;
+		int32_t docBase;
+		Scorer* scorer;
+		const ScoreDoc* after;
 	public:
-		SimpleTopDocsCollector(const CL_NS(util)::BitSet* bs, HitQueue* hitQueue, int32_t* totalhits, size_t ndocs, const float_t ms=-1.0f):
+		SimpleTopDocsCollector(HitQueue* hitQueue, int32_t* totalhits, size_t ndocs, const float_t ms=-1.0f, const int32_t _docBase=0,
+				const ScoreDoc* _after=NULL):
     		minScore(ms),
-    		bits(bs),
     		hq(hitQueue),
     		nDocs(ndocs),
-    		totalHits(totalhits)
+    		totalHits(totalhits),
+    		docBase(_docBase),
+    		scorer(NULL),
+    		after(_after)
     	{
     	}
 		~SimpleTopDocsCollector(){}
+		/** Passes the score needed to enter the full queue on to scorer. */
+		void setScorer(Scorer* scorer){
+			this->scorer = scorer;
+			if ( scorer != NULL && hq->size() >= nDocs )
+				scorer->setMinCompetitiveScore(hq->top().score);
+		}
+		/** Sets the number of the first document of the segment being scored */
+		void setDocBase(const int32_t docBase){
+			this->docBase = docBase;
+		}
 		void collect(const int32_t doc, const float_t score){
-    		if (score > 0.0f &&			  // ignore zeroed buckets
-    			(bits==NULL || bits->get(doc))) {	  // skip docs not in bits
+    		if (score > 0.0f) {			  // ignore zeroed buckets
     			++totalHits[0];
+    			// hits ranked up to the cursor were on an earlier page
+    			if ( after != NULL && (score > after->score || (score == after->score && docBase+doc <= after->doc)) )
+    				return;
     			if (hq->size() < nDocs || (minScore==-1.0f || score >= minScore)) {
-    				ScoreDoc sd = {doc, score};
+    				ScoreDoc sd = {docBase+doc, score};
     				hq->insert(sd);	  // update hit queue
     				if ( minScore != -1.0f )
     					minScore = hq->top().score; // maintain minScore
+    				if ( scorer != NULL && hq->size() >= nDocs )
+    					scorer->setMinCompetitiveScore(hq->top().score);
     			}
     		}
     	}
@@ -60,52 +81,107 @@ CL_NS_DEF(search)
 
 	class SortedTopDocsCollector:public HitCollector{ 
 	private:
-		const CL_NS(util)::BitSet* bits;
 		FieldSortedHitQueue* hq;
 		size_t nDocs;
 		int32_t* totalHits;
+		const FieldDoc* after;
 	public:
-		SortedTopDocsCollector(const CL_NS(util)::BitSet* bs, FieldSortedHitQueue* hitQueue, int32_t* totalhits, size_t _nDocs):
-    		bits(bs),
+		SortedTopDocsCollector(FieldSortedHitQueue* hitQueue, int32_t* totalhits, size_t _nDocs, const FieldDoc* _after=NULL):
     		hq(hitQueue),
     		nDocs(_nDocs),
-    		totalHits(totalhits)
+    		totalHits(totalhits),
+    		after(_after)
     	{
     	}
 		~SortedTopDocsCollector(){
 		}
 		void collect(const int32_t doc, const float_t score){
-    		if (score > 0.0f &&			  // ignore zeroed buckets
-    			(bits==NULL || bits->get(doc))) {	  // skip docs not in bits
+    		if (score > 0.0f) {			  // ignore zeroed buckets
     			++totalHits[0];
     			FieldDoc* fd = _CLNEW FieldDoc(doc, score); //todo: see jlucene way... with fields def???
-    			if ( !hq->insert(fd) )	  // update hit queue
+    			// hits sorted up to the cursor were on an earlier page
+    			if ( (after != NULL && !hq->sortsAfter(fd, after)) || !hq->insert(fd) )	  // update hit queue
     				_CLDELETE(fd);
     		}
     	}
 	};
 
-	class SimpleFilteredCollector: public HitCollector{
-	private:
-		CL_NS(util)::BitSet* bits;
-		HitCollector* results;
+	/**
+	* Collects the documents of the scorer which are also in the filter set.
+	* The scorer and the filter iterator skip ahead to each other's document
+	* in turn, so neither visits the documents the other one excludes.
+	* The filter set may be for a larger reader in which the scorer's reader
+	* starts at docBase.
+	*/
+	static void scoreFiltered(Scorer* scorer, DocIdSetIterator* filterDocIdIterator, HitCollector* results, const int32_t docBase=0){
+		bool more = filterDocIdIterator->skipTo(docBase) &&
+			scorer->skipTo(filterDocIdIterator->doc() - docBase);
+		while (more) {
+			const int32_t filterDocId = filterDocIdIterator->doc() - docBase;
+			if (filterDocId > scorer->doc() && !scorer->skipTo(filterDocId)) {
+				more = false;
+			} else {
+				const int32_t scorerDocId = scorer->doc();
+				if (scorerDocId == filterDocId) { // permitted by filter
+					results->collect(scorerDocId, scorer->score());
+					more = filterDocIdIterator->next();
+				} else {
+					more = filterDocIdIterator->skipTo(scorerDocId + docBase);
+				}
+			}
+		}
+	}
+
+	/** Scores the documents of scorer permitted by filterSet, or all of them if it is NULL */
+	static void scoreAll(Scorer* scorer, const DocIdSet* filterSet, HitCollector* results, const int32_t docBase=0){
+		if ( filterSet == NULL ){
+			scorer->score(results);
+			return;
+		}
+		DocIdSetIterator* filterDocIdIterator = filterSet->iterator();
+		try{
+			scoreFiltered(scorer, filterDocIdIterator, results, docBase);
+		}_CLFINALLY(
+			_CLDELETE(filterDocIdIterator);
+		)
+	}
+
+	/** Scores one segment of a parallel top docs search into its own HitQueue */
+	class SegmentSearchTask: public ThreadPool::Task{
 	public:
-		SimpleFilteredCollector(CL_NS(util)::BitSet* bs, HitCollector* collector):
-            bits(bs),
-            results(collector)
-        {
-        }
-		~SimpleFilteredCollector(){
+		Weight* weight;
+		IndexReader* reader;
+		int32_t docBase;
+		const DocIdSet* filterSet;
+		int32_t nDocs;
+		const ScoreDoc* after;
+
+		HitQueue* hq;
+		int32_t totalHits;
+
+		SegmentSearchTask():
+			weight(NULL), reader(NULL), docBase(0), filterSet(NULL), nDocs(0), after(NULL),
+			hq(NULL), totalHits(0)
+		{
+		}
+		~SegmentSearchTask(){
+			_CLDELETE(hq);
+		}
+		void run(){
+			Scorer* scorer = weight->scorer(reader);
+			if ( scorer == NULL )
+				return;
+			hq = _CLNEW HitQueue(nDocs);
+			SimpleTopDocsCollector hitCol(hq,&totalHits,nDocs,0.0f,docBase,after);
+			hitCol.setScorer(scorer);
+			try{
+				scoreAll(scorer, filterSet, &hitCol, docBase);
+			}_CLFINALLY(
+				_CLDELETE(scorer);
+			)
 		}
-	protected:
-		void collect(const int32_t doc, const float_t score){
-            if (bits->get(doc)) {		  // skip docs not in bits
-                results->collect(doc, score);
-            }
-        }
 	};
 
-
   IndexSearcher::IndexSearcher(const char* path){
   //Func - Constructor
   //       Creates a searcher searching the index in the named directory.  */
@@ -116,6 +192,7 @@ CL_NS_DEF(search)
 
       reader = IndexReader::open(path);
       readerOwner = true;
+      pool = NULL;
   }
   
   IndexSearcher::IndexSearcher(CL_NS(store)::Directory* directory){
@@ -128,6 +205,7 @@ CL_NS_DEF(search)
 
       reader = IndexReader::open(directory);
       readerOwner = true;
+      pool = NULL;
   }
 
   IndexSearcher::IndexSearcher(IndexReader* r){
@@ -138,6 +216,7 @@ CL_NS_DEF(search)
 
       reader      = r;
       readerOwner = false;
+      pool = NULL;
   }
 
   IndexSearcher::~IndexSearcher(){
@@ -210,8 +289,12 @@ CL_NS_DEF(search)
       return reader->maxDoc();
   }
 
-  //todo: find out why we are passing Query* and not Weight*, as Weight is being extracted anyway from Query*
   TopDocs* IndexSearcher::_search(Query* query, Filter* filter, const int32_t nDocs){
+      return _searchAfter(query, filter, NULL, nDocs);
+  }
+
+  //todo: find out why we are passing Query* and not Weight*, as Weight is being extracted anyway from Query*
+  TopDocs* IndexSearcher::_searchAfter(Query* query, Filter* filter, const ScoreDoc* after, const int32_t nDocs){
   //Func -
   //Pre  - reader != NULL
   //Post -
@@ -220,16 +303,22 @@ CL_NS_DEF(search)
       CND_PRECONDITION(query != NULL, "query is NULL");
 
       Weight* weight = query->weight(this);
-      Scorer* scorer = weight->scorer(reader);
-      if (scorer == NULL) {
-        Query* wq = weight->getQuery();
-        if (wq != query)
-          _CLLDELETE(wq);
-        _CLLDELETE(weight);
-          return _CLNEW TopDocs(0, NULL, 0);
+      if ( pool != NULL ){
+        TopDocs* ret = _searchSegments(weight, filter, after, nDocs);
+        if ( ret != NULL ){
+          Query* wq = weight->getQuery();
+          if ( query != wq ) //query was re-written
+            _CLLDELETE(wq);
+          _CLLDELETE(weight);
+          return ret;
+        }
       }
+      //score each segment with its own scorer, so that the scorers read the
+      //norms of their segment rather than the ones of the whole index
+      std::vector<IndexReader*> subReaders;
+      reader->gatherSubReaders(subReaders);
 
-      BitSet* bits = filter != NULL ? filter->bits(reader) : NULL;
+      DocIdSet* filterSet = filter != NULL ? filter->getDocIdSet(reader) : NULL;
       HitQueue* hq = _CLNEW HitQueue(nDocs);
 
 		  //Check hq has been allocated properly
@@ -238,9 +327,21 @@ CL_NS_DEF(search)
 		  int32_t* totalHits = _CL_NEWARRAY(int32_t,1);
       totalHits[0] = 0;
 
-      SimpleTopDocsCollector hitCol(bits,hq,totalHits,nDocs,0.0f);
-      scorer->score( &hitCol );
-      _CLDELETE(scorer);
+      SimpleTopDocsCollector hitCol(hq,totalHits,nDocs,0.0f,0,after);
+      int32_t docBase = 0;
+      for ( size_t i=0;i<subReaders.size();i++ ){
+        Scorer* scorer = weight->scorer(subReaders[i]);
+        if ( scorer != NULL ){
+          hitCol.setDocBase(docBase);
+          hitCol.setScorer(scorer);
+          try{
+            scoreAll(scorer, filterSet, &hitCol, docBase);
+          }_CLFINALLY(
+            _CLDELETE(scorer);
+          )
+        }
+        docBase += subReaders[i]->maxDoc();
+      }
 
       int32_t scoreDocsLength = hq->size();
 
@@ -252,8 +353,8 @@ CL_NS_DEF(search)
       int32_t totalHitsInt = totalHits[0];
 
       _CLDELETE(hq);
-		  if ( bits != NULL && filter->shouldDeleteBitSet(bits) )
-				_CLDELETE(bits);
+		  if ( filterSet != NULL && filter->shouldDeleteDocIdSet(filterSet) )
+				_CLDELETE(filterSet);
 	    _CLDELETE_ARRAY(totalHits);
 		  Query* wq = weight->getQuery();
 		  if ( query != wq ) //query was re-written
@@ -263,9 +364,75 @@ CL_NS_DEF(search)
       return _CLNEW TopDocs(totalHitsInt, scoreDocs, scoreDocsLength);
   }
 
+  TopDocs* IndexSearcher::_searchSegments(Weight* weight, Filter* filter, const ScoreDoc* after, const int32_t nDocs){
+  //Func - Scores each segment in a task of the pool and merges the per segment hit queues
+  //Pre  - pool != NULL
+  //Post - Returns NULL if the index has less than two segments
+
+      std::vector<IndexReader*> subReaders;
+      reader->gatherSubReaders(subReaders);
+      const int32_t len = (int32_t)subReaders.size();
+      if ( len < 2 )
+        return NULL;
+
+      //the filter is applied to the whole index, the tasks offset their docs
+      DocIdSet* filterSet = filter != NULL ? filter->getDocIdSet(reader) : NULL;
+
+      SegmentSearchTask* tasks = new SegmentSearchTask[len];
+      ThreadPool::Task** run = _CL_NEWARRAY(ThreadPool::Task*, len);
+      int32_t docBase = 0;
+      for ( int32_t i=0;i<len;i++ ){
+        tasks[i].weight = weight;
+        tasks[i].reader = subReaders[i];
+        tasks[i].docBase = docBase;
+        tasks[i].filterSet = filterSet;
+        tasks[i].nDocs = nDocs;
+        tasks[i].after = after;
+        run[i] = &tasks[i];
+        docBase += subReaders[i]->maxDoc();
+      }
+      try{
+        pool->invokeAll(run, len);
+      }_CLFINALLY(
+        _CLDELETE_LARRAY(run);
+        if ( filterSet != NULL && filter->shouldDeleteDocIdSet(filterSet) )
+          _CLDELETE(filterSet);
+      )
+
+      HitQueue* hq = NULL;
+      int32_t totalHits = 0;
+      try{
+        hq = _CLNEW HitQueue(nDocs);
+        for ( int32_t i=0;i<len;i++ ){
+          totalHits += tasks[i].totalHits;
+          HitQueue* segmentQueue = tasks[i].hq;
+          while ( segmentQueue != NULL && segmentQueue->size() > 0 ){
+            ScoreDoc sd = segmentQueue->pop();
+            hq->insert(sd);
+          }
+        }
+      }_CLFINALLY(
+        delete[] tasks;
+      )
+
+      int32_t scoreDocsLength = hq->size();
+      ScoreDoc* scoreDocs = new ScoreDoc[scoreDocsLength];
+      for (int32_t i = scoreDocsLength-1; i >= 0; --i)	  // put docs in array
+        scoreDocs[i] = hq->pop();
+      _CLDELETE(hq);
+
+      return _CLNEW TopDocs(totalHits, scoreDocs, scoreDocsLength);
+  }
+
   // inherit javadoc
   TopFieldDocs* IndexSearcher::_search(Query* query, Filter* filter, const int32_t nDocs,
          const Sort* sort) {
+      return _searchAfter(query, filter, NULL, nDocs, sort);
+  }
+
+  // inherit javadoc
+  TopFieldDocs* IndexSearcher::_searchAfter(Query* query, Filter* filter, const FieldDoc* after,
+         const int32_t nDocs, const Sort* sort) {
              
       CND_PRECONDITION(reader != NULL, "reader is NULL");
       CND_PRECONDITION(query != NULL, "query is NULL");
@@ -276,13 +443,13 @@ CL_NS_DEF(search)
 		return _CLNEW TopFieldDocs(0, NULL, 0, NULL );
 	}
 
-    BitSet* bits = filter != NULL ? filter->bits(reader) : NULL;
+    DocIdSet* filterSet = filter != NULL ? filter->getDocIdSet(reader) : NULL;
     FieldSortedHitQueue hq(reader, sort->getSort(), nDocs);
     int32_t* totalHits = _CL_NEWARRAY(int32_t,1);
 	totalHits[0]=0;
     
-	SortedTopDocsCollector hitCol(bits,&hq,totalHits,nDocs);
-	scorer->score(&hitCol);
+	SortedTopDocsCollector hitCol(&hq,totalHits,nDocs,after);
+	scoreAll(scorer, filterSet, &hitCol);
     _CLLDELETE(scorer);
 
 	int32_t hqLen = hq.size();
@@ -299,8 +466,8 @@ CL_NS_DEF(search)
     SortField** hqFields = hq.getFields();
 	hq.setFields(NULL); //move ownership of memory over to TopFieldDocs
     int32_t totalHits0 = totalHits[0];
-	if ( bits != NULL && filter->shouldDeleteBitSet(bits) )
-		_CLLDELETE(bits);
+	if ( filterSet != NULL && filter->shouldDeleteDocIdSet(filterSet) )
+		_CLLDELETE(filterSet);
     _CLDELETE_LARRAY(totalHits);
     return _CLNEW TopFieldDocs(totalHits0, fieldDocs, hqLen, hqFields );
   }
@@ -318,32 +485,23 @@ CL_NS_DEF(search)
       CND_PRECONDITION(reader != NULL, "reader is NULL");
       CND_PRECONDITION(query != NULL, "query is NULL");
 
-      BitSet* bits = NULL;
-      SimpleFilteredCollector* fc = NULL; 
-
-      if (filter != NULL){
-          bits = filter->bits(reader);
-          fc = _CLNEW SimpleFilteredCollector(bits, results);
-       }
+      DocIdSet* filterSet = NULL;
+      if (filter != NULL)
+          filterSet = filter->getDocIdSet(reader);
 
       Weight* weight = query->weight(this);
       Scorer* scorer = weight->scorer(reader);
       if (scorer != NULL) {
-		  if (fc == NULL){
-              scorer->score(results);
-		  }else{
-              scorer->score((HitCollector*)fc);
-		  }
+          scoreAll(scorer, filterSet, results);
           _CLDELETE(scorer); 
       }
 
-    _CLLDELETE(fc);
 	Query* wq = weight->getQuery();
 	if (wq != query) // query was rewritten
 		_CLLDELETE(wq);
 	_CLLDELETE(weight);
-	if ( bits != NULL && filter->shouldDeleteBitSet(bits) )
-		_CLLDELETE(bits);
+	if ( filterSet != NULL && filter->shouldDeleteDocIdSet(filterSet) )
+		_CLLDELETE(filterSet);
   }
 
   Query* IndexSearcher::rewrite(Query* original) {
@@ -375,6 +533,13 @@ CL_NS_DEF(search)
 		return reader;
 	}
 
+	void IndexSearcher::setThreadPool(ThreadPool* pool){
+		this->pool = pool;
+	}
+	ThreadPool* IndexSearcher::getThreadPool(){
+		return pool;
+	}
+
 	const char* IndexSearcher::getClassName(){
 		return "IndexSearcher";
 	}
@@ -14,12 +14,15 @@ CL_CLASS_DEF(document,Document)
 CL_CLASS_DEF(index,Term)
 CL_CLASS_DEF(search,TopDocs)
 CL_CLASS_DEF(search,TopFieldDocs)
+CL_CLASS_DEF(search,FieldDoc)
 CL_CLASS_DEF(search,Query)
 CL_CLASS_DEF(search,Filter)
 CL_CLASS_DEF(search,Sort)
 CL_CLASS_DEF(search,HitCollector)
 CL_CLASS_DEF(search,Explanation)
+CL_CLASS_DEF(search,Weight)
 CL_CLASS_DEF(index,IndexReader)
+CL_CLASS_DEF(util,ThreadPool)
 //#include "CLucene/index/IndexReader.h"
 //#include "CLucene/util/BitSet.h"
 //#include "HitQueue.h"
@@ -34,6 +37,9 @@ CL_NS_DEF(search)
 class CLUCENE_EXPORT IndexSearcher:public Searcher{
 	CL_NS(index)::IndexReader* reader;
 	bool readerOwner;
+	CL_NS(util)::ThreadPool* pool;
+
+	TopDocs* _searchSegments(Weight* weight, Filter* filter, const ScoreDoc* after, const int32_t nDocs);
 
 public:
 	/** Creates a searcher searching the index in the named directory.
@@ -71,11 +77,27 @@ public:
 
 	TopDocs* _search(Query* query, Filter* filter, const int32_t nDocs);
 	TopFieldDocs* _search(Query* query, Filter* filter, const int32_t nDocs, const Sort* sort);
+	TopDocs* _searchAfter(Query* query, Filter* filter, const ScoreDoc* after, const int32_t nDocs);
+	TopFieldDocs* _searchAfter(Query* query, Filter* filter, const FieldDoc* after, const int32_t nDocs, const Sort* sort);
 
 	void _search(Query* query, Filter* filter, HitCollector* results);
 
 	CL_NS(index)::IndexReader* getReader();
 
+	/**
+	* Sets a pool used to score the segments of the index in parallel.
+	* Top docs searches (see {@link #_search(Query*,Filter*,int32_t)}) then
+	* score each segment in its own task, collect into a HitQueue per
+	* segment and merge the queues, so a single large index uses more than
+	* one core per query. Sorted and HitCollector searches are not affected.
+	* Set to NULL (the default) to score the segments one after the other in
+	* the calling thread, into a single HitQueue.
+	* @memory the pool is not deleted
+	*/
+	void setThreadPool(CL_NS(util)::ThreadPool* pool);
+	/** Returns the pool set by {@link #setThreadPool}, or NULL */
+	CL_NS(util)::ThreadPool* getThreadPool();
+
 	Query* rewrite(Query* original);
 	void explain(Query* query, int32_t doc, Explanation* ret);
 
@@ -45,6 +45,7 @@ CL_NS_DEF(search)
       _maxDoc += searchables[i]->maxDoc();		  // compute maxDocs
     }
     starts[searchablesLen] = _maxDoc;
+    searchables[searchablesLen] = NULL;
   }
 
   MultiSearcher::~MultiSearcher() {
@@ -58,6 +59,9 @@ CL_NS_DEF(search)
 	int32_t MultiSearcher::getLength() {
 		return searchablesLen;
 	}
+	Searchable** MultiSearcher::getSearchables() {
+		return searchables;
+	}
 
   // inherit javadoc
   void MultiSearcher::close() {
@@ -120,13 +124,22 @@ CL_NS_DEF(search)
   }
 
   TopDocs* MultiSearcher::_search(Query* query, Filter* filter, const int32_t nDocs) {
+    return _searchAfter(query, filter, NULL, nDocs);
+  }
+
+  TopDocs* MultiSearcher::_searchAfter(Query* query, Filter* filter, const ScoreDoc* after, const int32_t nDocs) {
     HitQueue* hq = _CLNEW HitQueue(nDocs);
     int32_t totalHits = 0;
 	TopDocs* docs;
 	int32_t j;
 	ScoreDoc* scoreDocs;
+	ScoreDoc subAfter;
     for (int32_t i = 0; i < searchablesLen; i++) {  // search each searcher
-		docs = searchables[i]->_search(query, filter, nDocs);
+		if ( after != NULL ){
+			subAfter.doc = after->doc - starts[i]; // the cursor in the numbers of the searcher
+			subAfter.score = after->score;
+		}
+		docs = searchables[i]->_searchAfter(query, filter, after != NULL ? &subAfter : NULL, nDocs);
 		totalHits += docs->totalHits;		  // update totalHits
 		scoreDocs = docs->scoreDocs;
 		for ( j = 0; j <docs->scoreDocsLength; ++j) { // merge scoreDocs int_to hq
@@ -181,14 +194,31 @@ CL_NS_DEF(search)
   }
 
   TopFieldDocs* MultiSearcher::_search (Query* query, Filter* filter, const int32_t n, const Sort* sort){
+    return _searchAfter(query, filter, NULL, n, sort);
+  }
+
+  TopFieldDocs* MultiSearcher::_searchAfter (Query* query, Filter* filter, const FieldDoc* after, const int32_t n, const Sort* sort){
     FieldDocSortedHitQueue* hq = NULL;
     int32_t totalHits = 0;
 	TopFieldDocs* docs;
 	int32_t j;
 	FieldDoc** fieldDocs;
 
+	// the cursor in the numbers of each searcher, borrowing the sort values of after
+	FieldDoc* subAfter = after != NULL ? _CLNEW FieldDoc(after->scoreDoc.doc, after->scoreDoc.score, after->fields) : NULL;
 	for (int32_t i = 0; i < searchablesLen; ++i) { // search each searcher
-		docs = searchables[i]->_search (query, filter, n, sort);
+		if ( subAfter != NULL )
+			subAfter->scoreDoc.doc = after->scoreDoc.doc - starts[i];
+		try{
+			docs = searchables[i]->_searchAfter (query, filter, subAfter, n, sort);
+		}catch(CLuceneError&){
+			if ( subAfter != NULL ){
+				subAfter->fields = NULL;
+				_CLDELETE(subAfter);
+			}
+			_CLDELETE(hq);
+			throw;
+		}
 		if (hq == NULL){
 			hq = _CLNEW FieldDocSortedHitQueue (docs->fields, n);
 			docs->fields = NULL; //hit queue takes fields memory
@@ -206,6 +236,10 @@ CL_NS_DEF(search)
 
 	  _CLDELETE(docs);
     }
+	if ( subAfter != NULL ){
+		subAfter->fields = NULL;
+		_CLDELETE(subAfter);
+	}
 
     int32_t hqlen = hq->size();
 	fieldDocs = _CL_NEWARRAY(FieldDoc*,hqlen);
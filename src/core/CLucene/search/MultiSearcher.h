@@ -29,6 +29,8 @@ CL_NS_DEF(search)
 	protected:
 		int32_t* getStarts();
 		int32_t getLength();
+		/** Returns the searchables, NULL terminated. */
+		Searchable** getSearchables();
   public:
       /** Creates a searcher which searches <i>Searchables</i>. */
       MultiSearcher(Searchable** searchables);
@@ -56,6 +58,13 @@ CL_NS_DEF(search)
       TopDocs* _search(Query* query, Filter* filter, const int32_t nDocs) ;
       
       TopFieldDocs* _search (Query* query, Filter* filter, const int32_t n, const Sort* sort);
+
+      /** Searches each searchable after the cursor, moved into the document
+       * numbers of the searchable, and merges the results like {@link #_search}.
+       */
+      TopDocs* _searchAfter(Query* query, Filter* filter, const ScoreDoc* after, const int32_t nDocs);
+
+      TopFieldDocs* _searchAfter(Query* query, Filter* filter, const FieldDoc* after, const int32_t n, const Sort* sort);
      
       /** Lower-level search API.
        *
@@ -0,0 +1,260 @@
+/*------------------------------------------------------------------------------
+* Copyright (C) 2003-2006 Ben van Klinken and the CLucene Team
+*
+* Distributable under the terms of either the Apache License (Version 2.0) or
+* the GNU Lesser General Public License, as specified in the COPYING file.
+------------------------------------------------------------------------------*/
+#include "CLucene/_ApiHeader.h"
+#include "CLucene/index/Term.h"
+#include "CLucene/index/Terms.h"
+#include "CLucene/index/IndexReader.h"
+#include "CLucene/util/BitSet.h"
+#include "CLucene/util/StringBuffer.h"
+#include "CLucene/util/Misc.h"
+#include "NumericRangeFilter.h"
+
+CL_NS_DEF(search)
+CL_NS_USE(index)
+CL_NS_USE(util)
+
+/**
+* Sets the documents of every term of each sub range, enumerating the
+* terms from the lowest one of the sub range.
+*/
+class NumericRangeBitsBuilder: public NumericUtils::RangeBuilder {
+	const TCHAR* field;
+	IndexReader* reader;
+	TermDocs* termDocs;
+	BitSet* bts;
+public:
+	NumericRangeBitsBuilder( const TCHAR* field, IndexReader* reader, TermDocs* termDocs, BitSet* bts ):
+		field(field), reader(reader), termDocs(termDocs), bts(bts)
+	{
+	}
+
+	void addRange( const TCHAR* minPrefixCoded, const TCHAR* maxPrefixCoded ){
+		Term* t = _CLNEW Term( field, minPrefixCoded, false );
+		TermEnum* enumerator = reader->terms( t );
+		_CLDECDELETE( t );
+		try{
+			do{
+				Term* term = enumerator->term( false );
+				if ( term == NULL || _tcscmp(term->field(), field) != 0 || _tcscmp(term->text(), maxPrefixCoded) > 0 )
+					break;
+				termDocs->seek( enumerator );
+				while ( termDocs->next() )
+					bts->set( termDocs->doc() );
+			}while( enumerator->next() );
+		}_CLFINALLY(
+			enumerator->close();
+			_CLDELETE( enumerator );
+		)
+	}
+};
+
+NumericRangeFilter::NumericRangeFilter( const TCHAR* _field, const int32_t _precisionStep, const int32_t _valSize,
+	const int64_t _minBound, const int64_t _maxBound,
+	const TCHAR* _lowerVal, const TCHAR* _upperVal, const bool _includeLower, const bool _includeUpper ):
+	field( STRDUP_TtoT(_field) ), precisionStep( _precisionStep ), valSize( _valSize ),
+	minBound( _minBound ), maxBound( _maxBound ),
+	lowerVal( _lowerVal ? STRDUP_TtoT(_lowerVal) : NULL ), upperVal( _upperVal ? STRDUP_TtoT(_upperVal) : NULL ),
+	includeLower( _includeLower ), includeUpper( _includeUpper )
+{
+}
+
+NumericRangeFilter::NumericRangeFilter( const NumericRangeFilter& copy ):
+	field( STRDUP_TtoT(copy.field) ), precisionStep( copy.precisionStep ), valSize( copy.valSize ),
+	minBound( copy.minBound ), maxBound( copy.maxBound ),
+	lowerVal( copy.lowerVal ? STRDUP_TtoT(copy.lowerVal) : NULL ),
+	upperVal( copy.upperVal ? STRDUP_TtoT(copy.upperVal) : NULL ),
+	includeLower( copy.includeLower ), includeUpper( copy.includeUpper )
+{
+}
+
+NumericRangeFilter::~NumericRangeFilter()
+{
+	_CLDELETE_LCARRAY( field );
+	_CLDELETE_LCARRAY( lowerVal );
+	_CLDELETE_LCARRAY( upperVal );
+}
+
+NumericRangeFilter* NumericRangeFilter::newRange( const TCHAR* _field, const int32_t _precisionStep, const int32_t _valSize,
+	const int64_t* min, const int64_t* max, const bool minInclusive, const bool maxInclusive,
+	const TCHAR* _lowerVal, const TCHAR* _upperVal )
+{
+	if ( _precisionStep < 1 )
+		_CLTHROWA( CL_ERR_IllegalArgument, "precisionStep must be >=1" );
+
+	const int64_t typeMin = _valSize == 64 ? LUCENE_INT64_MIN_SHOULDBE : (int64_t)(-LUCENE_INT32_MAX_SHOULDBE - 1);
+	const int64_t typeMax = _valSize == 64 ? LUCENE_INT64_MAX_SHOULDBE : (int64_t)LUCENE_INT32_MAX_SHOULDBE;
+
+	// make both bounds inclusive, an open end takes the extreme value of the type
+	int64_t lower = typeMin, upper = typeMax;
+	bool empty = false;
+	if ( min != NULL ){
+		lower = *min;
+		if ( !minInclusive ){
+			if ( lower == typeMax )
+				empty = true;
+			else
+				lower++;
+		}
+	}
+	if ( max != NULL ){
+		upper = *max;
+		if ( !maxInclusive ){
+			if ( upper == typeMin )
+				empty = true;
+			else
+				upper--;
+		}
+	}
+	if ( empty ){
+		lower = typeMax;
+		upper = typeMin;
+	}
+
+	return _CLNEW NumericRangeFilter( _field, _precisionStep, _valSize, lower, upper,
+		min ? _lowerVal : NULL, max ? _upperVal : NULL, minInclusive && min != NULL, maxInclusive && max != NULL );
+}
+
+NumericRangeFilter* NumericRangeFilter::newInt64Range( const TCHAR* _field, const int32_t _precisionStep,
+	const int64_t* min, const int64_t* max, const bool minInclusive, const bool maxInclusive )
+{
+	TCHAR lowerBuf[24], upperBuf[24];
+	if ( min ) _i64tot( *min, lowerBuf, 10 );
+	if ( max ) _i64tot( *max, upperBuf, 10 );
+	return newRange( _field, _precisionStep, 64, min, max, minInclusive, maxInclusive, lowerBuf, upperBuf );
+}
+NumericRangeFilter* NumericRangeFilter::newInt64Range( const TCHAR* _field,
+	const int64_t* min, const int64_t* max, const bool minInclusive, const bool maxInclusive )
+{
+	return newInt64Range( _field, NumericUtils::PRECISION_STEP_DEFAULT, min, max, minInclusive, maxInclusive );
+}
+
+NumericRangeFilter* NumericRangeFilter::newInt32Range( const TCHAR* _field, const int32_t _precisionStep,
+	const int32_t* min, const int32_t* max, const bool minInclusive, const bool maxInclusive )
+{
+	TCHAR lowerBuf[24], upperBuf[24];
+	int64_t lower = 0, upper = 0;
+	if ( min ){ lower = *min; _i64tot( lower, lowerBuf, 10 ); }
+	if ( max ){ upper = *max; _i64tot( upper, upperBuf, 10 ); }
+	return newRange( _field, _precisionStep, 32, min ? &lower : NULL, max ? &upper : NULL,
+		minInclusive, maxInclusive, lowerBuf, upperBuf );
+}
+NumericRangeFilter* NumericRangeFilter::newInt32Range( const TCHAR* _field,
+	const int32_t* min, const int32_t* max, const bool minInclusive, const bool maxInclusive )
+{
+	return newInt32Range( _field, NumericUtils::PRECISION_STEP_DEFAULT, min, max, minInclusive, maxInclusive );
+}
+
+NumericRangeFilter* NumericRangeFilter::newDoubleRange( const TCHAR* _field, const int32_t _precisionStep,
+	const double* min, const double* max, const bool minInclusive, const bool maxInclusive )
+{
+	char abuf[32];
+	TCHAR lowerBuf[32], upperBuf[32];
+	int64_t lower = 0, upper = 0;
+	if ( min ){
+		lower = NumericUtils::doubleToSortableInt64( *min );
+		_snprintf( abuf, 32, "%.17g", *min );
+		STRCPY_AtoT( lowerBuf, abuf, 32 );
+	}
+	if ( max ){
+		upper = NumericUtils::doubleToSortableInt64( *max );
+		_snprintf( abuf, 32, "%.17g", *max );
+		STRCPY_AtoT( upperBuf, abuf, 32 );
+	}
+	return newRange( _field, _precisionStep, 64, min ? &lower : NULL, max ? &upper : NULL,
+		minInclusive, maxInclusive, lowerBuf, upperBuf );
+}
+NumericRangeFilter* NumericRangeFilter::newDoubleRange( const TCHAR* _field,
+	const double* min, const double* max, const bool minInclusive, const bool maxInclusive )
+{
+	return newDoubleRange( _field, NumericUtils::PRECISION_STEP_DEFAULT, min, max, minInclusive, maxInclusive );
+}
+
+NumericRangeFilter* NumericRangeFilter::newFloatRange( const TCHAR* _field, const int32_t _precisionStep,
+	const float* min, const float* max, const bool minInclusive, const bool maxInclusive )
+{
+	char abuf[32];
+	TCHAR lowerBuf[32], upperBuf[32];
+	int64_t lower = 0, upper = 0;
+	if ( min ){
+		lower = NumericUtils::floatToSortableInt32( *min );
+		_snprintf( abuf, 32, "%.9g", (double)*min );
+		STRCPY_AtoT( lowerBuf, abuf, 32 );
+	}
+	if ( max ){
+		upper = NumericUtils::floatToSortableInt32( *max );
+		_snprintf( abuf, 32, "%.9g", (double)*max );
+		STRCPY_AtoT( upperBuf, abuf, 32 );
+	}
+	return newRange( _field, _precisionStep, 32, min ? &lower : NULL, max ? &upper : NULL,
+		minInclusive, maxInclusive, lowerBuf, upperBuf );
+}
+NumericRangeFilter* NumericRangeFilter::newFloatRange( const TCHAR* _field,
+	const float* min, const float* max, const bool minInclusive, const bool maxInclusive )
+{
+	return newFloatRange( _field, NumericUtils::PRECISION_STEP_DEFAULT, min, max, minInclusive, maxInclusive );
+}
+
+BitSet* NumericRangeFilter::bits( IndexReader* reader )
+{
+	BitSet* bts = _CLNEW BitSet( reader->maxDoc() );
+	if ( minBound > maxBound )
+		return bts;
+
+	TermDocs* termDocs = reader->termDocs();
+	try{
+		try{
+			NumericRangeBitsBuilder builder( field, reader, termDocs, bts );
+			if ( valSize == 64 )
+				NumericUtils::splitInt64Range( &builder, precisionStep, minBound, maxBound );
+			else
+				NumericUtils::splitInt32Range( &builder, precisionStep, (int32_t)minBound, (int32_t)maxBound );
+		}catch(...){
+			_CLDELETE( bts );
+			throw;
+		}
+	}_CLFINALLY(
+		termDocs->close();
+		_CLDELETE( termDocs );
+	)
+	return bts;
+}
+
+TCHAR* NumericRangeFilter::toString()
+{
+	StringBuffer buffer(30);
+	buffer.append( field );
+	buffer.appendChar( _T(':') );
+	buffer.appendChar( includeLower ? _T('[') : _T('{') );
+	buffer.append( lowerVal != NULL ? lowerVal : _T("*") );
+	buffer.append( _T(" TO ") );
+	buffer.append( upperVal != NULL ? upperVal : _T("*") );
+	buffer.appendChar( includeUpper ? _T(']') : _T('}') );
+	return buffer.giveBuffer();
+}
+
+Filter* NumericRangeFilter::clone() const {
+	return _CLNEW NumericRangeFilter( *this );
+}
+
+bool NumericRangeFilter::equals( const NumericRangeFilter* other ) const {
+	if ( this == other ) return true;
+	return _tcscmp( field, other->field ) == 0
+		&& precisionStep == other->precisionStep
+		&& valSize == other->valSize
+		&& minBound == other->minBound
+		&& maxBound == other->maxBound;
+}
+
+size_t NumericRangeFilter::hashCode() const {
+	size_t h = Misc::thashCode( field ) ^ ( precisionStep * 0x5a695a69 );
+	h ^= (size_t)( minBound ^ ( minBound >> 32 ) );
+	h ^= (h << 17) | (h >> 16);  // mix, so that equal bounds don't cancel out
+	h ^= (size_t)( maxBound ^ ( maxBound >> 32 ) );
+	return h;
+}
+
+CL_NS_END
@@ -0,0 +1,120 @@
+/*------------------------------------------------------------------------------
+* Copyright (C) 2003-2006 Ben van Klinken and the CLucene Team
+*
+* Distributable under the terms of either the Apache License (Version 2.0) or
+* the GNU Lesser General Public License, as specified in the COPYING file.
+------------------------------------------------------------------------------*/
+#ifndef _lucene_search_NumericRangeFilter_
+#define _lucene_search_NumericRangeFilter_
+
+#include "Filter.h"
+#include "CLucene/util/NumericUtils.h"
+
+CL_NS_DEF(search)
+
+/**
+* A Filter that restricts search results to a range of the values of a
+* {@link lucene::document::NumericField}.
+*
+* <p>Unlike {@link RangeFilter}, which visits every term in the range, the
+* range is split into the terms of each precision which cover it (see
+* {@link lucene::util::NumericUtils}), so only a few dozen terms are visited
+* however many distinct values the range holds.
+*
+* <p>The filter is made with one of the static factories, which must be
+* given the type and precisionStep the field was indexed with. A NULL
+* bound leaves that end of the range open.
+*
+* <pre>
+*   int64_t lower = 1000;
+*   Filter* f = NumericRangeFilter::newInt64Range(_T("size"), &lower, NULL, true, true);
+* </pre>
+*/
+class CLUCENE_EXPORT NumericRangeFilter: public Filter
+{
+private:
+	TCHAR* field;
+	int32_t precisionStep;
+	int32_t valSize;
+	// the inclusive bounds as sortable integers, minBound > maxBound if nothing matches
+	int64_t minBound;
+	int64_t maxBound;
+	// the bounds as given, for toString, NULL if open
+	TCHAR* lowerVal;
+	TCHAR* upperVal;
+	bool includeLower;
+	bool includeUpper;
+
+	NumericRangeFilter( const TCHAR* field, const int32_t precisionStep, const int32_t valSize,
+		const int64_t minBound, const int64_t maxBound,
+		const TCHAR* lowerVal, const TCHAR* upperVal, const bool includeLower, const bool includeUpper );
+
+	static NumericRangeFilter* newRange( const TCHAR* field, const int32_t precisionStep, const int32_t valSize,
+		const int64_t* min, const int64_t* max, const bool minInclusive, const bool maxInclusive,
+		const TCHAR* lowerVal, const TCHAR* upperVal );
+
+public:
+	virtual ~NumericRangeFilter();
+
+	/** Matches the 64 bit integers of field from min to max */
+	static NumericRangeFilter* newInt64Range( const TCHAR* field, const int32_t precisionStep,
+		const int64_t* min, const int64_t* max, const bool minInclusive, const bool maxInclusive );
+	/** Matches the 64 bit integers of field from min to max, with the default precisionStep */
+	static NumericRangeFilter* newInt64Range( const TCHAR* field,
+		const int64_t* min, const int64_t* max, const bool minInclusive, const bool maxInclusive );
+
+	/** Matches the 32 bit integers of field from min to max */
+	static NumericRangeFilter* newInt32Range( const TCHAR* field, const int32_t precisionStep,
+		const int32_t* min, const int32_t* max, const bool minInclusive, const bool maxInclusive );
+	/** Matches the 32 bit integers of field from min to max, with the default precisionStep */
+	static NumericRangeFilter* newInt32Range( const TCHAR* field,
+		const int32_t* min, const int32_t* max, const bool minInclusive, const bool maxInclusive );
+
+	/** Matches the doubles of field from min to max */
+	static NumericRangeFilter* newDoubleRange( const TCHAR* field, const int32_t precisionStep,
+		const double* min, const double* max, const bool minInclusive, const bool maxInclusive );
+	/** Matches the doubles of field from min to max, with the default precisionStep */
+	static NumericRangeFilter* newDoubleRange( const TCHAR* field,
+		const double* min, const double* max, const bool minInclusive, const bool maxInclusive );
+
+	/** Matches the floats of field from min to max */
+	static NumericRangeFilter* newFloatRange( const TCHAR* field, const int32_t precisionStep,
+		const float* min, const float* max, const bool minInclusive, const bool maxInclusive );
+	/** Matches the floats of field from min to max, with the default precisionStep */
+	static NumericRangeFilter* newFloatRange( const TCHAR* field,
+		const float* min, const float* max, const bool minInclusive, const bool maxInclusive );
+
+	/** Returns the field name of this filter */
+	const TCHAR* getField() const { return field; }
+	/** Returns the precision step of this filter */
+	int32_t getPrecisionStep() const { return precisionStep; }
+	/** Returns the lower bound as text, NULL if open ended */
+	const TCHAR* getLowerVal() const { return lowerVal; }
+	/** Returns the upper bound as text, NULL if open ended */
+	const TCHAR* getUpperVal() const { return upperVal; }
+	/** Returns <code>true</code> if the lower endpoint is inclusive */
+	bool includesLower() const { return includeLower; }
+	/** Returns <code>true</code> if the upper endpoint is inclusive */
+	bool includesUpper() const { return includeUpper; }
+
+	/**
+	* Returns a BitSet with true for documents which should be
+	* permitted in search results, and false for those that should
+	* not.
+	*/
+	CL_NS(util)::BitSet* bits( CL_NS(index)::IndexReader* reader );
+
+	Filter* clone() const;
+
+	TCHAR* toString();
+
+	/** Returns true if other matches the same range of the same field */
+	bool equals( const NumericRangeFilter* other ) const;
+	size_t hashCode() const;
+
+protected:
+	NumericRangeFilter( const NumericRangeFilter& copy );
+};
+
+CL_NS_END
+#endif
@@ -0,0 +1,113 @@
+/*------------------------------------------------------------------------------
+* Copyright (C) 2003-2006 Ben van Klinken and the CLucene Team
+*
+* Distributable under the terms of either the Apache License (Version 2.0) or
+* the GNU Lesser General Public License, as specified in the COPYING file.
+------------------------------------------------------------------------------*/
+#include "CLucene/_ApiHeader.h"
+#include "NumericRangeQuery.h"
+
+#include "ConstantScoreQuery.h"
+#include "Similarity.h"
+#include "CLucene/util/StringBuffer.h"
+
+CL_NS_USE(index)
+CL_NS_USE(util)
+CL_NS_DEF(search)
+
+NumericRangeQuery::NumericRangeQuery( NumericRangeFilter* _filter ):
+	filter( _filter )
+{
+}
+
+NumericRangeQuery::NumericRangeQuery( const NumericRangeQuery& copy ):
+	Query( copy ),
+	filter( static_cast<NumericRangeFilter*>(copy.filter->clone()) )
+{
+}
+
+NumericRangeQuery::~NumericRangeQuery(){
+	_CLDELETE( filter );
+}
+
+NumericRangeQuery* NumericRangeQuery::newInt64Range( const TCHAR* field, const int32_t precisionStep,
+	const int64_t* min, const int64_t* max, const bool minInclusive, const bool maxInclusive )
+{
+	return _CLNEW NumericRangeQuery( NumericRangeFilter::newInt64Range( field, precisionStep, min, max, minInclusive, maxInclusive ) );
+}
+NumericRangeQuery* NumericRangeQuery::newInt64Range( const TCHAR* field,
+	const int64_t* min, const int64_t* max, const bool minInclusive, const bool maxInclusive )
+{
+	return _CLNEW NumericRangeQuery( NumericRangeFilter::newInt64Range( field, min, max, minInclusive, maxInclusive ) );
+}
+NumericRangeQuery* NumericRangeQuery::newInt32Range( const TCHAR* field, const int32_t precisionStep,
+	const int32_t* min, const int32_t* max, const bool minInclusive, const bool maxInclusive )
+{
+	return _CLNEW NumericRangeQuery( NumericRangeFilter::newInt32Range( field, precisionStep, min, max, minInclusive, maxInclusive ) );
+}
+NumericRangeQuery* NumericRangeQuery::newInt32Range( const TCHAR* field,
+	const int32_t* min, const int32_t* max, const bool minInclusive, const bool maxInclusive )
+{
+	return _CLNEW NumericRangeQuery( NumericRangeFilter::newInt32Range( field, min, max, minInclusive, maxInclusive ) );
+}
+NumericRangeQuery* NumericRangeQuery::newDoubleRange( const TCHAR* field, const int32_t precisionStep,
+	const double* min, const double* max, const bool minInclusive, const bool maxInclusive )
+{
+	return _CLNEW NumericRangeQuery( NumericRangeFilter::newDoubleRange( field, precisionStep, min, max, minInclusive, maxInclusive ) );
+}
+NumericRangeQuery* NumericRangeQuery::newDoubleRange( const TCHAR* field,
+	const double* min, const double* max, const bool minInclusive, const bool maxInclusive )
+{
+	return _CLNEW NumericRangeQuery( NumericRangeFilter::newDoubleRange( field, min, max, minInclusive, maxInclusive ) );
+}
+NumericRangeQuery* NumericRangeQuery::newFloatRange( const TCHAR* field, const int32_t precisionStep,
+	const float* min, const float* max, const bool minInclusive, const bool maxInclusive )
+{
+	return _CLNEW NumericRangeQuery( NumericRangeFilter::newFloatRange( field, precisionStep, min, max, minInclusive, maxInclusive ) );
+}
+NumericRangeQuery* NumericRangeQuery::newFloatRange( const TCHAR* field,
+	const float* min, const float* max, const bool minInclusive, const bool maxInclusive )
+{
+	return _CLNEW NumericRangeQuery( NumericRangeFilter::newFloatRange( field, min, max, minInclusive, maxInclusive ) );
+}
+
+Query* NumericRangeQuery::rewrite(IndexReader* /*reader*/) {
+	Query* q = _CLNEW ConstantScoreQuery( filter->clone() );
+	q->setBoost( getBoost() );
+	return q;
+}
+
+TCHAR* NumericRangeQuery::toString(const TCHAR* field) const
+{
+	StringBuffer buffer(30);
+	if ( field == NULL || _tcscmp(filter->getField(), field) != 0 )
+	{
+		buffer.append( filter->getField() );
+		buffer.appendChar( _T(':') );
+	}
+	buffer.appendChar( filter->includesLower() ? _T('[') : _T('{') );
+	buffer.append( filter->getLowerVal() != NULL ? filter->getLowerVal() : _T("*") );
+	buffer.append( _T(" TO ") );
+	buffer.append( filter->getUpperVal() != NULL ? filter->getUpperVal() : _T("*") );
+	buffer.appendChar( filter->includesUpper() ? _T(']') : _T('}') );
+	buffer.appendBoost( getBoost() );
+	return buffer.giveBuffer();
+}
+
+bool NumericRangeQuery::equals(Query* o) const {
+	if (this == o) return true;
+	if (!(o->instanceOf(NumericRangeQuery::getClassName()))) return false;
+	NumericRangeQuery* other = (NumericRangeQuery*) o;
+	return filter->equals( other->filter ) && this->getBoost() == other->getBoost();
+}
+
+size_t NumericRangeQuery::hashCode() const {
+	return filter->hashCode() ^ Similarity::floatToByte( getBoost() );
+}
+
+const char* NumericRangeQuery::getObjectName() const { return getClassName(); }
+Query* NumericRangeQuery::clone() const{
+	return _CLNEW NumericRangeQuery(*this);
+}
+
+CL_NS_END
@@ -0,0 +1,89 @@
+/*------------------------------------------------------------------------------
+* Copyright (C) 2003-2006 Ben van Klinken and the CLucene Team
+*
+* Distributable under the terms of either the Apache License (Version 2.0) or
+* the GNU Lesser General Public License, as specified in the COPYING file.
+------------------------------------------------------------------------------*/
+#ifndef _lucene_search_NumericRangeQuery_
+#define _lucene_search_NumericRangeQuery_
+
+#include "Query.h"
+#include "NumericRangeFilter.h"
+
+CL_NS_DEF(search)
+
+/**
+* A query that matches the documents with a value of a
+* {@link lucene::document::NumericField} in a range, with a constant score
+* equal to its boost. It rewrites to a {@link ConstantScoreQuery} of a
+* {@link NumericRangeFilter}, so it visits only a few dozen terms and never
+* runs into the clause limit of {@link RangeQuery}.
+*
+* <p>The query is made with one of the static factories, which must be
+* given the type and precisionStep the field was indexed with. A NULL
+* bound leaves that end of the range open.
+*/
+class CLUCENE_EXPORT NumericRangeQuery : public Query
+{
+private:
+	NumericRangeFilter* filter;
+
+public:
+	/**
+	* Creates a query matching the documents of filter.
+	* @memory this object consumes _filter
+	*/
+	NumericRangeQuery( NumericRangeFilter* _filter );
+	virtual ~NumericRangeQuery();
+
+	/** Matches the 64 bit integers of field from min to max */
+	static NumericRangeQuery* newInt64Range( const TCHAR* field, const int32_t precisionStep,
+		const int64_t* min, const int64_t* max, const bool minInclusive, const bool maxInclusive );
+	/** Matches the 64 bit integers of field from min to max, with the default precisionStep */
+	static NumericRangeQuery* newInt64Range( const TCHAR* field,
+		const int64_t* min, const int64_t* max, const bool minInclusive, const bool maxInclusive );
+
+	/** Matches the 32 bit integers of field from min to max */
+	static NumericRangeQuery* newInt32Range( const TCHAR* field, const int32_t precisionStep,
+		const int32_t* min, const int32_t* max, const bool minInclusive, const bool maxInclusive );
+	/** Matches the 32 bit integers of field from min to max, with the default precisionStep */
+	static NumericRangeQuery* newInt32Range( const TCHAR* field,
+		const int32_t* min, const int32_t* max, const bool minInclusive, const bool maxInclusive );
+
+	/** Matches the doubles of field from min to max */
+	static NumericRangeQuery* newDoubleRange( const TCHAR* field, const int32_t precisionStep,
+		const double* min, const double* max, const bool minInclusive, const bool maxInclusive );
+	/** Matches the doubles of field from min to max, with the default precisionStep */
+	static NumericRangeQuery* newDoubleRange( const TCHAR* field,
+		const double* min, const double* max, const bool minInclusive, const bool maxInclusive );
+
+	/** Matches the floats of field from min to max */
+	static NumericRangeQuery* newFloatRange( const TCHAR* field, const int32_t precisionStep,
+		const float* min, const float* max, const bool minInclusive, const bool maxInclusive );
+	/** Matches the floats of field from min to max, with the default precisionStep */
+	static NumericRangeQuery* newFloatRange( const TCHAR* field,
+		const float* min, const float* max, const bool minInclusive, const bool maxInclusive );
+
+	/** Returns the filter of this query */
+	const NumericRangeFilter* getFilter() const { return filter; }
+
+	Query* rewrite(CL_NS(index)::IndexReader* reader);
+
+	/** Prints a user-readable version of this query. */
+	TCHAR* toString(const TCHAR* field) const;
+
+	/** Returns true if <code>o</code> is equal to this. */
+	bool equals(Query* o) const;
+
+	/** Returns a hash code value for this object.*/
+	size_t hashCode() const;
+
+	const char* getObjectName() const;
+	static const char* getClassName(){ return "NumericRangeQuery"; }
+	Query* clone() const;
+protected:
+	NumericRangeQuery( const NumericRangeQuery& copy );
+};
+
+CL_NS_END
+#endif
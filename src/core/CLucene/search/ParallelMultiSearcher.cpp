@@ -0,0 +1,201 @@
+/*------------------------------------------------------------------------------
+* Copyright (C) 2003-2006 Ben van Klinken and the CLucene Team
+*
+* Distributable under the terms of either the Apache License (Version 2.0) or
+* the GNU Lesser General Public License, as specified in the COPYING file.
+------------------------------------------------------------------------------*/
+#include "CLucene/_ApiHeader.h"
+#include "ParallelMultiSearcher.h"
+#include "SearchHeader.h"
+#include "_HitQueue.h"
+#include "_FieldDocSortedHitQueue.h"
+#include "CLucene/util/ThreadPool.h"
+
+CL_NS_USE(util)
+CL_NS_DEF(search)
+
+	/** Runs one of the sub searches of a ParallelMultiSearcher */
+	class ParallelSearchTask: public ThreadPool::Task{
+	public:
+		Searchable* searchable;
+		Query* query;
+		Filter* filter;
+		int32_t nDocs;
+		const Sort* sort;
+		// the cursor in the numbers of the searchable, if any
+		bool hasAfter;
+		ScoreDoc after;
+		FieldDoc* fieldAfter; // borrows the sort values of the caller's cursor
+
+		TopDocs* docs;
+		TopFieldDocs* fieldDocs;
+
+		ParallelSearchTask():
+			searchable(NULL), query(NULL), filter(NULL), nDocs(0), sort(NULL),
+			hasAfter(false), fieldAfter(NULL), docs(NULL), fieldDocs(NULL)
+		{
+		}
+		~ParallelSearchTask(){
+			_CLDELETE(docs);
+			_CLDELETE(fieldDocs);
+			if ( fieldAfter != NULL ){
+				fieldAfter->fields = NULL;
+				_CLDELETE(fieldAfter);
+			}
+		}
+		void run(){
+			if ( sort == NULL )
+				docs = searchable->_searchAfter(query, filter, hasAfter ? &after : NULL, nDocs);
+			else
+				fieldDocs = searchable->_searchAfter(query, filter, fieldAfter, nDocs, sort);
+		}
+	};
+
+	ParallelMultiSearcher::ParallelMultiSearcher(Searchable** searchables, ThreadPool* pool):
+		MultiSearcher(searchables),
+		pool(pool),
+		ownPool(false)
+	{
+		if ( this->pool == NULL ){
+			this->pool = _CLNEW ThreadPool(getLength() > 1 ? getLength()-1 : 0);
+			ownPool = true;
+		}
+	}
+	ParallelMultiSearcher::~ParallelMultiSearcher(){
+		if ( ownPool )
+			_CLDELETE(pool);
+	}
+
+	const char* ParallelMultiSearcher::getClassName(){
+		return "ParallelMultiSearcher";
+	}
+	const char* ParallelMultiSearcher::getObjectName() const{
+		return getClassName();
+	}
+
+	//runs the tasks, which are deleted on failure
+	static void runSearchTasks(ThreadPool* pool, ParallelSearchTask* tasks, int32_t len){
+		ThreadPool::Task** run = _CL_NEWARRAY(ThreadPool::Task*, len);
+		for ( int32_t i=0;i<len;i++ )
+			run[i] = &tasks[i];
+		try{
+			pool->invokeAll(run, len);
+		}catch(CLuceneError&){
+			_CLDELETE_LARRAY(run);
+			delete[] tasks;
+			throw;
+		}
+		_CLDELETE_LARRAY(run);
+	}
+
+	TopDocs* ParallelMultiSearcher::_search(Query* query, Filter* filter, const int32_t nDocs){
+		return _searchAfter(query, filter, NULL, nDocs);
+	}
+
+	TopDocs* ParallelMultiSearcher::_searchAfter(Query* query, Filter* filter, const ScoreDoc* after, const int32_t nDocs){
+		const int32_t len = getLength();
+		Searchable** searchables = getSearchables();
+		int32_t* starts = getStarts();
+
+		ParallelSearchTask* tasks = new ParallelSearchTask[len];
+		for ( int32_t i=0;i<len;i++ ){
+			tasks[i].searchable = searchables[i];
+			tasks[i].query = query;
+			tasks[i].filter = filter;
+			tasks[i].nDocs = nDocs;
+			if ( after != NULL ){
+				tasks[i].hasAfter = true;
+				tasks[i].after.doc = after->doc - starts[i];
+				tasks[i].after.score = after->score;
+			}
+		}
+		runSearchTasks(pool, tasks, len);
+
+		HitQueue* hq = _CLNEW HitQueue(nDocs);
+		int32_t totalHits = 0;
+		for ( int32_t i=0;i<len;i++ ){ // merge in searcher order, like MultiSearcher
+			TopDocs* docs = tasks[i].docs;
+			totalHits += docs->totalHits;
+			ScoreDoc* scoreDocs = docs->scoreDocs;
+			for ( int32_t j=0;j<docs->scoreDocsLength;++j ){
+				scoreDocs[j].doc += starts[i];
+				if ( !hq->insert(scoreDocs[j]) )
+					break; // no more scores > minScore
+			}
+		}
+		delete[] tasks;
+
+		int32_t scoreDocsLen = hq->size();
+		ScoreDoc* scoreDocs = new ScoreDoc[scoreDocsLen];
+		for ( int32_t i=scoreDocsLen-1;i>=0;--i )
+			scoreDocs[i] = hq->pop();
+		_CLDELETE(hq);
+
+		return _CLNEW TopDocs(totalHits, scoreDocs, scoreDocsLen);
+	}
+
+	TopFieldDocs* ParallelMultiSearcher::_search(Query* query, Filter* filter, const int32_t n, const Sort* sort){
+		return _searchAfter(query, filter, NULL, n, sort);
+	}
+
+	TopFieldDocs* ParallelMultiSearcher::_searchAfter(Query* query, Filter* filter, const FieldDoc* after, const int32_t n, const Sort* sort){
+		const int32_t len = getLength();
+		Searchable** searchables = getSearchables();
+		int32_t* starts = getStarts();
+
+		ParallelSearchTask* tasks = new ParallelSearchTask[len];
+		for ( int32_t i=0;i<len;i++ ){
+			tasks[i].searchable = searchables[i];
+			tasks[i].query = query;
+			tasks[i].filter = filter;
+			tasks[i].nDocs = n;
+			tasks[i].sort = sort;
+			if ( after != NULL )
+				tasks[i].fieldAfter = _CLNEW FieldDoc(after->scoreDoc.doc - starts[i], after->scoreDoc.score, after->fields);
+		}
+		runSearchTasks(pool, tasks, len);
+
+		FieldDocSortedHitQueue* hq = NULL;
+		int32_t totalHits = 0;
+		for ( int32_t i=0;i<len;i++ ){
+			TopFieldDocs* docs = tasks[i].fieldDocs;
+			totalHits += docs->totalHits;
+			if ( docs->fields == NULL )
+				continue; // nothing matched in this searchable
+			if ( hq == NULL ){
+				hq = _CLNEW FieldDocSortedHitQueue(docs->fields, n);
+				docs->fields = NULL; //hit queue takes fields memory
+			}
+
+			FieldDoc** fieldDocs = docs->fieldDocs;
+			int32_t j;
+			for ( j=0;j<docs->scoreDocsLength;++j ){
+				fieldDocs[j]->scoreDoc.doc += starts[i];
+				if ( !hq->insert(fieldDocs[j]) )
+					break; // no more scores > minScore
+			}
+			for ( int32_t x=0;x<j;++x )
+				fieldDocs[x] = NULL; //move ownership of FieldDoc to the hitqueue
+		}
+		delete[] tasks;
+
+		if ( hq == NULL )
+			return _CLNEW TopFieldDocs(totalHits, _CL_NEWARRAY(FieldDoc*,1), 0, NULL);
+
+		int32_t hqlen = hq->size();
+		FieldDoc** fieldDocs = _CL_NEWARRAY(FieldDoc*,hqlen);
+		for ( int32_t j=hqlen-1;j>=0;j-- )
+			fieldDocs[j] = hq->pop();
+
+		SortField** hqFields = hq->getFields();
+		hq->setFields(NULL); //move ownership of memory over to TopFieldDocs
+		_CLDELETE(hq);
+
+		return _CLNEW TopFieldDocs(totalHits, fieldDocs, hqlen, hqFields);
+	}
+
+	void ParallelMultiSearcher::_search(Query* query, Filter* filter, HitCollector* results){
+		MultiSearcher::_search(query, filter, results);
+	}
+
+CL_NS_END
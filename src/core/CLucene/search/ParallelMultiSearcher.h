@@ -0,0 +1,67 @@
+/*------------------------------------------------------------------------------
+* Copyright (C) 2003-2006 Ben van Klinken and the CLucene Team
+*
+* Distributable under the terms of either the Apache License (Version 2.0) or
+* the GNU Lesser General Public License, as specified in the COPYING file.
+------------------------------------------------------------------------------*/
+#ifndef _lucene_search_ParallelMultiSearcher_
+#define _lucene_search_ParallelMultiSearcher_
+
+#include "MultiSearcher.h"
+CL_CLASS_DEF(util,ThreadPool)
+
+CL_NS_DEF(search)
+
+	/** Implements parallel search over a set of <code>Searchables</code>.
+	*
+	* <p>Each searchable is searched by a task of a thread pool, so the
+	* latency of a query is that of the slowest searchable rather than the
+	* sum of all of them. The results are merged the same way as by
+	* {@link MultiSearcher}.
+	*
+	* <p>Only the top docs searches are parallel. Searches with a
+	* HitCollector run sequentially, since collectors are not expected to
+	* be thread safe.
+	*/
+	class CLUCENE_EXPORT ParallelMultiSearcher: public MultiSearcher {
+	private:
+		CL_NS(util)::ThreadPool* pool;
+		bool ownPool;
+	public:
+		/**
+		* Creates a searcher which searches <i>searchables</i> in parallel.
+		* @param pool the pool running the searches. If NULL, the searcher
+		*   starts its own pool, with one thread less than there are
+		*   searchables (the searching thread does one of the searches).
+		* @memory the pool is not deleted
+		*/
+		ParallelMultiSearcher(Searchable** searchables, CL_NS(util)::ThreadPool* pool = NULL);
+		~ParallelMultiSearcher();
+
+		/**
+		* Searches each searchable in its own task and merges the results
+		* with a HitQueue.
+		*/
+		TopDocs* _search(Query* query, Filter* filter, const int32_t nDocs);
+
+		/**
+		* Searches each searchable in its own task and merges the results
+		* with a FieldDocSortedHitQueue.
+		*/
+		TopFieldDocs* _search(Query* query, Filter* filter, const int32_t n, const Sort* sort);
+
+		/** Pages like {@link MultiSearcher#_searchAfter}, with a task per searchable. */
+		TopDocs* _searchAfter(Query* query, Filter* filter, const ScoreDoc* after, const int32_t nDocs);
+
+		/** Pages like {@link MultiSearcher#_searchAfter}, with a task per searchable. */
+		TopFieldDocs* _searchAfter(Query* query, Filter* filter, const FieldDoc* after, const int32_t n, const Sort* sort);
+
+		/** Sequential, see {@link MultiSearcher#_search(Query*,Filter*,HitCollector*)}. */
+		void _search(Query* query, Filter* filter, HitCollector* results);
+
+		static const char* getClassName();
+		const char* getObjectName() const;
+	};
+
+CL_NS_END
+#endif
@@ -9,6 +9,7 @@
 #include "IndexSearcher.h"
 #include "CLucene/index/IndexReader.h"
 #include "CLucene/util/BitSet.h"
+#include "CLucene/util/SortedVIntList.h"
 #include "SearchHeader.h"
 #include "Query.h"
 
@@ -29,6 +30,60 @@ public:
 };
 
 
+/** Collects the hits into a sorted list while they are few and come in
+* order, and into a BitSet otherwise */
+class QFDocIdSetCollector: public HitCollector{
+	int32_t maxDoc;
+	int32_t maxLength;
+	int32_t* docs;
+	int32_t length;
+	int32_t capacity;
+public:
+	CL_NS(util)::BitSet* bits;
+
+	QFDocIdSetCollector(int32_t maxDoc):
+		maxDoc(maxDoc),
+		maxLength(maxDoc / 32),
+		docs(NULL),
+		length(0),
+		capacity(0),
+		bits(NULL)
+	{
+	}
+	~QFDocIdSetCollector(){
+		_CLDELETE_LARRAY(docs);
+	}
+	void toBits(){
+		bits = _CLNEW BitSet(maxDoc);
+		for ( int32_t i=0;i<length;i++ )
+			bits->set(docs[i]);
+		_CLDELETE_ARRAY(docs);
+		length = 0;
+	}
+	void collect(const int32_t doc, const float_t /*score*/){
+		if ( bits == NULL && (length == maxLength || (length > 0 && doc <= docs[length-1])) )
+			toBits();
+		if ( bits != NULL ){
+			bits->set(doc);
+			return;
+		}
+		if ( length == capacity ){
+			capacity = cl_min(cl_max(capacity * 2, 64), maxLength);
+			int32_t* tmp = _CL_NEWARRAY(int32_t, capacity);
+			if ( length > 0 )
+				memcpy(tmp, docs, length * sizeof(int32_t));
+			_CLDELETE_LARRAY(docs);
+			docs = tmp;
+		}
+		docs[length++] = doc;
+	}
+	DocIdSet* getDocIdSet(){
+		if ( bits != NULL )
+			return bits;
+		return _CLNEW SortedVIntList(docs, length);
+	}
+};
+
 QueryFilter::QueryFilter( const Query* query )
 {
 	this->query = query->clone();
@@ -85,4 +140,12 @@ BitSet* QueryFilter::bits( IndexReader* reader )
 }
 
 
+DocIdSet* QueryFilter::getDocIdSet( IndexReader* reader )
+{
+	IndexSearcher s(reader);
+	QFDocIdSetCollector hc(reader->maxDoc());
+	s._search(query, NULL, &hc);
+	return hc.getDocIdSet();
+}
+
 CL_NS_END
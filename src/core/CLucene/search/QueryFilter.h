@@ -30,6 +30,12 @@ public:
 	~QueryFilter();
 	
 	CL_NS(util)::BitSet* bits( CL_NS(index)::IndexReader* reader );
+
+	/** Returns the documents matching the query. If they are few (less
+	* than 1/32 of the documents) they are returned as a SortedVIntList,
+	* otherwise as a BitSet. */
+	DocIdSet* getDocIdSet( CL_NS(index)::IndexReader* reader );
+	bool shouldDeleteDocIdSet( const DocIdSet* /*set*/ ) const{ return true; }
 	
 	Filter *clone() const;
 	
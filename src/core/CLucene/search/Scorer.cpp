@@ -34,6 +34,9 @@ bool Scorer::score( HitCollector* results, const int32_t maxDoc ) {
 	}
 	return true;
 }
+void Scorer::setMinCompetitiveScore(float_t /*minScore*/){
+}
+
 bool Scorer::sort(const Scorer* elem1, const Scorer* elem2){
 	return elem1->doc() < elem2->doc();
 }
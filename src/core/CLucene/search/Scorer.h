@@ -118,6 +118,13 @@ public:
 	*/
 	virtual bool skipTo(int32_t target) = 0;
 
+	/** Expert: Tells the scorer that from now on only documents scoring higher
+	* than minScore are collected, so that it may skip the documents which can
+	* not score that high. Scorers which can not skip ignore this.
+	* @see Searcher#setDynamicPruning
+	*/
+	virtual void setMinCompetitiveScore(float_t minScore);
+
 	/** Returns an explanation of the score for a document.
 	* <br>When this method is used, the {@link #next()}, {@link #skipTo(int)} and
 	* {@link #score(HitCollector)} methods should not be used.
@@ -176,6 +176,7 @@ TopDocs::~TopDocs(){
 
 Searcher::Searcher(){
 	similarity = Similarity::getDefault();
+	dynamicPruning = false;
 }
 Searcher::~Searcher(){
 }
@@ -208,6 +209,14 @@ Similarity* Searcher::getSimilarity(){
 	return this->similarity;
 }
 
+void Searcher::setDynamicPruning(bool dynamicPruning){
+	this->dynamicPruning = dynamicPruning;
+}
+
+bool Searcher::getDynamicPruning() const{
+	return this->dynamicPruning;
+}
+
 const char* Searcher::getClassName(){
 	return "Searcher";
 }
@@ -27,7 +27,7 @@ CL_NS_DEF(search)
 	class Hits;
 	class Sort;
 	class FieldDoc;
-	class TopFieldDocs;
+	class SortField;
    
    /** Expert: Returned by low-level search implementations.
 	* @see TopDocs */
@@ -63,6 +63,29 @@ CL_NS_DEF(search)
 		//float_t maxScore;
 	};
 
+	/**
+	* Expert: Returned by low-level sorted search implementations.
+	*
+	* @see Searchable#search(Query,Filter,int32_t,Sort)
+	*/
+	class CLUCENE_EXPORT TopFieldDocs: public TopDocs {
+	public:
+		/// The fields which were used to sort results by.
+		SortField** fields;
+
+		FieldDoc** fieldDocs;
+
+	   /** Creates one of these objects.
+	   * @param totalHits  Total number of hits for the query.
+	   * @param fieldDocs  The top hits for the query.
+	   * @param scoreDocs  The top hits for the query.
+	   * @param scoreDocsLen  Length of fieldDocs and scoreDocs
+	   * @param fields     The sort criteria used to find the top hits.
+	   */
+	  TopFieldDocs (int32_t totalHits, FieldDoc** fieldDocs, int32_t scoreDocsLen, SortField** fields);
+		~TopFieldDocs();
+	};
+
     /** Lower-level search API.
     * <br>HitCollectors are primarily meant to be used to implement queries,
     * sorting and filtering.
@@ -29,6 +29,8 @@ CL_NS_DEF(search)
 	class Similarity;
 	class TopFieldDocs;
 	class Sort;
+	class FieldDoc;
+	struct ScoreDoc;
 	
 
    /** The interface for search implementations.
@@ -113,6 +115,29 @@ CL_NS_DEF(search)
       * Searcher#search(Query,Filter,Sort)} instead.
       */
 	  	virtual TopFieldDocs* _search(Query* query, Filter* filter, const int32_t n, const Sort* sort) = 0;
+
+      /** Expert: Low-level paging implementation.  Finds the top <code>n</code>
+      * hits for <code>query</code> which rank after <code>after</code>,
+      * applying <code>filter</code> if non-null.  Only hits after the cursor
+      * enter the HitQueue, so each page costs the same however deep it is.
+      *
+      * <p>Pass the last ScoreDoc of the previous page, unchanged, to get the
+      * next one, or NULL to get the first page.  {@link TopDocs#totalHits}
+      * counts all the hits of the query, not only the ones after the cursor.
+      */
+      virtual TopDocs* _searchAfter(Query* query, Filter* filter, const ScoreDoc* after, const int32_t n) = 0;
+
+      /** Expert: Low-level paging implementation with arbitrary sorting.
+      * Finds the top <code>n</code> hits for <code>query</code> which sort
+      * after <code>after</code> by the criteria in <code>sort</code>,
+      * applying <code>filter</code> if non-null.
+      *
+      * <p>Pass the last FieldDoc of the previous page, unchanged and with its
+      * {@link FieldDoc#fields}, to get the next one, or NULL to get the first
+      * page.  The previous page must have been found by this searcher with
+      * the same <code>sort</code>.
+      */
+      virtual TopFieldDocs* _searchAfter(Query* query, Filter* filter, const FieldDoc* after, const int32_t n, const Sort* sort) = 0;
    };
 
 
@@ -124,6 +149,7 @@ CL_NS_DEF(search)
 	private:
 		/** The Similarity implementation used by this searcher. */
 		Similarity* similarity;
+		bool dynamicPruning;
     public:
 		Searcher();
 		virtual ~Searcher();
@@ -172,6 +198,24 @@ CL_NS_DEF(search)
 		*/
 		Similarity* getSimilarity();
 
+		/** Expert: Set whether top docs searches may skip the documents which
+		* can not make it into the top hits. Disjunctions of term queries are
+		* then scored by a WANDScorer, which uses upper bounds of the term
+		* scores to skip documents. The top hits and their scores stay the
+		* same, but {@link TopDocs#totalHits} (and so {@link Hits#length})
+		* only counts the documents which were scored, a lower bound of the
+		* number of matches.
+		*
+		* <p>The bounds assume that {@link Similarity#tf} does not decrease with
+		* the frequency, which holds for {@link DefaultSimilarity}. Off by default.
+		*/
+		void setDynamicPruning(bool dynamicPruning);
+
+		/** Expert: Returns whether dynamic pruning is enabled.
+		* @see #setDynamicPruning
+		*/
+		bool getDynamicPruning() const;
+
 		virtual const char* getObjectName() const;
 		static const char* getClassName();
 
@@ -0,0 +1,366 @@
+/*------------------------------------------------------------------------------
+* Copyright (C) 2003-2006 Ben van Klinken and the CLucene Team
+*
+* Distributable under the terms of either the Apache License (Version 2.0) or
+* the GNU Lesser General Public License, as specified in the COPYING file.
+------------------------------------------------------------------------------*/
+#include "CLucene/_ApiHeader.h"
+#include "_TermAutomaton.h"
+
+CL_NS_DEF(search)
+
+//the greatest character value which term texts are ordered by
+#define TERMAUTOMATON_MAXCHAR (sizeof(TCHAR)==1 ? (uint32_t)0xFF : (uint32_t)0x7FFFFFFF)
+
+TermAutomaton::TermAutomaton(const TCHAR* prefix, int32_t _prefixLen, int32_t _stateWords):
+	stateWords(_stateWords),
+	prefixLen(_prefixLen),
+	rows(NULL),
+	lastText(NULL),
+	capacity(0),
+	validRows(0),
+	targetLen(0),
+	hasTarget(false),
+	_exhausted(false),
+	skipped(0)
+{
+	targetCapacity = prefixLen + 16;
+	target = _CL_NEWARRAY(TCHAR, targetCapacity);
+	memcpy(target, prefix, sizeof(TCHAR) * prefixLen);
+	target[prefixLen] = 0;
+}
+
+TermAutomaton::~TermAutomaton(){
+	_CLDELETE_LARRAY(rows);
+	_CLDELETE_LARRAY(lastText);
+	_CLDELETE_LARRAY(target);
+}
+
+uint32_t TermAutomaton::charValue(TCHAR c){
+	if ( sizeof(TCHAR) == 1 )
+		return (uint8_t)c;
+	return (uint32_t)c;
+}
+
+void TermAutomaton::shiftOr(const uint64_t* in, uint64_t* out, int32_t words){
+	uint64_t carry = 0;
+	for ( int32_t w=0;w<words;++w ){
+		out[w] |= (in[w] << 1) | carry;
+		carry = in[w] >> 63;
+	}
+}
+
+uint64_t* TermAutomaton::row(int32_t i) const{
+	return rows + (size_t)i * stateWords;
+}
+
+bool TermAutomaton::isEmpty(const uint64_t* states) const{
+	for ( int32_t w=0;w<stateWords;++w ){
+		if ( states[w] != 0 )
+			return false;
+	}
+	return true;
+}
+
+bool TermAutomaton::accept(const TCHAR* text, int32_t textLen){
+	text += prefixLen;
+	textLen -= prefixLen;
+
+	if ( hasTarget ){
+		//terms before the target are rejected without running the automaton
+		int32_t len = cl_min(textLen, targetLen);
+		const TCHAR* t = target + prefixLen;
+		int32_t i = 0;
+		while ( i < len && text[i] == t[i] )
+			++i;
+		if ( i < len ? charValue(text[i]) < charValue(t[i]) : textLen < targetLen ){
+			++skipped;
+			return false;
+		}
+		hasTarget = false;
+	}
+
+	int32_t live = run(text, textLen);
+	if ( live == textLen && isAccept(row(textLen)) )
+		return true;
+
+	findTarget(text, textLen, live);
+	return false;
+}
+
+int32_t TermAutomaton::run(const TCHAR* text, int32_t len){
+	if ( len + 1 > capacity ){
+		//keep the rows which can still be reused
+		capacity = cl_max(len + 1, capacity * 2);
+		uint64_t* newRows = _CL_NEWARRAY(uint64_t, (size_t)capacity * stateWords);
+		TCHAR* newLastText = _CL_NEWARRAY(TCHAR, capacity);
+		if ( validRows > 0 ){
+			memcpy(newRows, rows, sizeof(uint64_t) * validRows * stateWords);
+			memcpy(newLastText, lastText, sizeof(TCHAR) * (validRows - 1));
+		}
+		_CLDELETE_LARRAY(rows);
+		_CLDELETE_LARRAY(lastText);
+		rows = newRows;
+		lastText = newLastText;
+	}
+	if ( validRows == 0 ){
+		memset(row(0), 0, sizeof(uint64_t) * stateWords);
+		initial(row(0));
+		validRows = 1;
+	}
+
+	//reuse the states of the prefix shared with the last text
+	int32_t i = 0;
+	while ( i < validRows - 1 && i < len && lastText[i] == text[i] )
+		++i;
+	validRows = i + 1;
+	if ( i > 0 && isEmpty(row(i)) )
+		return i - 1;
+
+	for ( ;i<len;++i ){
+		uint64_t* to = row(i + 1);
+		memset(to, 0, sizeof(uint64_t) * stateWords);
+		step(row(i), charValue(text[i]), to);
+		lastText[i] = text[i];
+		validRows = i + 2;
+		if ( isEmpty(to) )
+			return i;
+	}
+	return len;
+}
+
+void TermAutomaton::findTarget(const TCHAR* text, int32_t len, int32_t live){
+	skipped = 0;
+
+	//the texts which extend text come first, then those which differ at
+	//the last live position and then those which differ before it
+	int32_t pos = live;
+	uint32_t c = live == len ? 1 : charValue(text[live]) + 1;
+	uint32_t label;
+	for (;;){
+		label = ( c != 0 && c <= TERMAUTOMATON_MAXCHAR ) ? minLabel(row(pos), c) : 0;
+		if ( label != 0 )
+			break;
+		if ( pos == 0 ){
+			_exhausted = true;
+			return;
+		}
+		--pos;
+		c = charValue(text[pos]) + 1;
+	}
+
+	if ( prefixLen + pos + 2 > targetCapacity ){
+		targetCapacity = cl_max(prefixLen + pos + 2, targetCapacity * 2);
+		TCHAR* newTarget = _CL_NEWARRAY(TCHAR, targetCapacity);
+		memcpy(newTarget, target, sizeof(TCHAR) * prefixLen);
+		_CLDELETE_LARRAY(target);
+		target = newTarget;
+	}
+	memcpy(target + prefixLen, text, sizeof(TCHAR) * pos);
+	target[prefixLen + pos] = (TCHAR)label;
+	target[prefixLen + pos + 1] = 0;
+	targetLen = pos + 1;
+	hasTarget = true;
+}
+
+bool TermAutomaton::exhausted() const{
+	return _exhausted;
+}
+
+const TCHAR* TermAutomaton::seekText(){
+	if ( !hasTarget || skipped < SEEK_INTERVAL )
+		return NULL;
+	skipped = 0;
+	return target;
+}
+
+
+WildcardAutomaton::WildcardAutomaton(const TCHAR* prefix, int32_t prefixLen, const TCHAR* _pattern, int32_t _patternLen):
+	TermAutomaton(prefix, prefixLen, _patternLen / 64 + 1),
+	patternLen(_patternLen)
+{
+	pattern = _CL_NEWARRAY(TCHAR, patternLen + 1);
+	memcpy(pattern, _pattern, sizeof(TCHAR) * patternLen);
+	pattern[patternLen] = 0;
+
+	anyChar = _CL_NEWARRAY(uint64_t, stateWords);
+	anyString = _CL_NEWARRAY(uint64_t, stateWords);
+	eq = _CL_NEWARRAY(uint64_t, stateWords);
+	memset(anyChar, 0, sizeof(uint64_t) * stateWords);
+	memset(anyString, 0, sizeof(uint64_t) * stateWords);
+	for ( int32_t p=0;p<patternLen;++p ){
+		const uint64_t bit = (uint64_t)1 << (p & 63);
+		if ( pattern[p] == LUCENE_WILDCARDTERMENUM_WILDCARD_STRING ){
+			anyString[p >> 6] |= bit;
+			anyChar[p >> 6] |= bit;
+		}else if ( pattern[p] == LUCENE_WILDCARDTERMENUM_WILDCARD_CHAR )
+			anyChar[p >> 6] |= bit;
+	}
+}
+WildcardAutomaton::~WildcardAutomaton(){
+	_CLDELETE_CARRAY(pattern);
+	_CLDELETE_ARRAY(anyChar);
+	_CLDELETE_ARRAY(anyString);
+	_CLDELETE_ARRAY(eq);
+}
+
+void WildcardAutomaton::match(uint32_t c){
+	memset(eq, 0, sizeof(uint64_t) * stateWords);
+	for ( int32_t p=0;p<patternLen;++p ){
+		if ( charValue(pattern[p]) == c )
+			eq[p >> 6] |= (uint64_t)1 << (p & 63);
+	}
+	for ( int32_t w=0;w<stateWords;++w )
+		eq[w] &= ~anyChar[w];
+}
+
+void WildcardAutomaton::closure(uint64_t* states) const{
+	//a * may match nothing, so the position after it is reached too
+	bool changed;
+	do{
+		changed = false;
+		uint64_t carry = 0;
+		for ( int32_t w=0;w<stateWords;++w ){
+			const uint64_t stars = states[w] & anyString[w];
+			const uint64_t add = ((stars << 1) | carry) & ~states[w];
+			carry = stars >> 63;
+			if ( add != 0 ){
+				states[w] |= add;
+				changed = true;
+			}
+		}
+	}while ( changed );
+}
+
+void WildcardAutomaton::initial(uint64_t* states) const{
+	states[0] = 1;
+	closure(states);
+}
+
+void WildcardAutomaton::step(const uint64_t* states, uint32_t c, uint64_t* to){
+	match(c);
+	uint64_t carry = 0;
+	for ( int32_t w=0;w<stateWords;++w ){
+		//a ? or an equal literal moves to the next position, a * stays
+		const uint64_t next = states[w] & ((anyChar[w] & ~anyString[w]) | eq[w]);
+		to[w] |= (next << 1) | carry | (states[w] & anyString[w]);
+		carry = next >> 63;
+	}
+	closure(to);
+}
+
+bool WildcardAutomaton::isAccept(const uint64_t* states) const{
+	return ((states[patternLen >> 6] >> (patternLen & 63)) & 1) != 0;
+}
+
+uint32_t WildcardAutomaton::minLabel(const uint64_t* states, uint32_t c) const{
+	for ( int32_t w=0;w<stateWords;++w ){
+		if ( states[w] & anyChar[w] )
+			return c;
+	}
+	uint32_t ret = 0;
+	for ( int32_t p=0;p<patternLen;++p ){
+		if ( ((states[p >> 6] >> (p & 63)) & 1) == 0 )
+			continue;
+		uint32_t v = charValue(pattern[p]);
+		if ( v >= c && (ret == 0 || v < ret) )
+			ret = v;
+	}
+	return ret;
+}
+
+
+LevenshteinAutomaton::LevenshteinAutomaton(const TCHAR* prefix, int32_t prefixLen, const TCHAR* _text, int32_t _textLen, int32_t _maxDistance):
+	TermAutomaton(prefix, prefixLen, (_textLen / 64 + 1) * (_maxDistance + 1)),
+	textLen(_textLen),
+	maxDistance(_maxDistance),
+	levelWords(_textLen / 64 + 1)
+{
+	text = _CL_NEWARRAY(TCHAR, textLen + 1);
+	memcpy(text, _text, sizeof(TCHAR) * textLen);
+	text[textLen] = 0;
+
+	//the states of a level are 0 to textLen
+	const int32_t lastBits = textLen + 1 - (levelWords - 1) * 64;
+	lastMask = lastBits == 64 ? ~(uint64_t)0 : (((uint64_t)1 << lastBits) - 1);
+	eq = _CL_NEWARRAY(uint64_t, levelWords);
+}
+LevenshteinAutomaton::~LevenshteinAutomaton(){
+	_CLDELETE_CARRAY(text);
+	_CLDELETE_ARRAY(eq);
+}
+
+void LevenshteinAutomaton::match(uint32_t c){
+	memset(eq, 0, sizeof(uint64_t) * levelWords);
+	for ( int32_t i=0;i<textLen;++i ){
+		if ( charValue(text[i]) == c )
+			eq[i >> 6] |= (uint64_t)1 << (i & 63);
+	}
+}
+
+void LevenshteinAutomaton::closure(uint64_t* states) const{
+	//deleting a character of the text moves to the next position with one more edit
+	for ( int32_t e=0;e<maxDistance;++e ){
+		uint64_t* next = states + (e + 1) * levelWords;
+		shiftOr(states + e * levelWords, next, levelWords);
+		next[levelWords - 1] &= lastMask;
+	}
+}
+
+void LevenshteinAutomaton::initial(uint64_t* states) const{
+	states[0] = 1;
+	closure(states);
+}
+
+void LevenshteinAutomaton::step(const uint64_t* states, uint32_t c, uint64_t* to){
+	match(c);
+	for ( int32_t e=0;e<=maxDistance;++e ){
+		const uint64_t* from = states + e * levelWords;
+		uint64_t* dest = to + e * levelWords;
+
+		//an equal character moves to the next position
+		uint64_t carry = 0;
+		for ( int32_t w=0;w<levelWords;++w ){
+			const uint64_t next = from[w] & eq[w];
+			dest[w] |= (next << 1) | carry;
+			carry = next >> 63;
+		}
+		if ( e > 0 ){
+			//an inserted character stays at the position, a substituted one moves to the next
+			const uint64_t* prev = states + (e - 1) * levelWords;
+			for ( int32_t w=0;w<levelWords;++w )
+				dest[w] |= prev[w];
+			shiftOr(prev, dest, levelWords);
+			dest[levelWords - 1] &= lastMask;
+		}
+	}
+	closure(to);
+}
+
+bool LevenshteinAutomaton::isAccept(const uint64_t* states) const{
+	for ( int32_t e=0;e<=maxDistance;++e ){
+		if ( (states[e * levelWords + (textLen >> 6)] >> (textLen & 63)) & 1 )
+			return true;
+	}
+	return false;
+}
+
+uint32_t LevenshteinAutomaton::minLabel(const uint64_t* states, uint32_t c) const{
+	//any character can be inserted or substituted while edits are left
+	for ( int32_t w=0;w<maxDistance * levelWords;++w ){
+		if ( states[w] != 0 )
+			return c;
+	}
+	uint32_t ret = 0;
+	const uint64_t* last = states + maxDistance * levelWords;
+	for ( int32_t i=0;i<textLen;++i ){
+		if ( ((last[i >> 6] >> (i & 63)) & 1) == 0 )
+			continue;
+		uint32_t v = charValue(text[i]);
+		if ( v >= c && (ret == 0 || v < ret) )
+			ret = v;
+	}
+	return ret;
+}
+
+CL_NS_END
@@ -0,0 +1,189 @@
+/*------------------------------------------------------------------------------
+* Copyright (C) 2003-2006 Ben van Klinken and the CLucene Team
+*
+* Distributable under the terms of either the Apache License (Version 2.0) or
+* the GNU Lesser General Public License, as specified in the COPYING file.
+------------------------------------------------------------------------------*/
+#include "CLucene/_ApiHeader.h"
+#include "Scorer.h"
+#include "Similarity.h"
+#include "Explanation.h"
+#include "CLucene/util/StringBuffer.h"
+
+#include "_WANDScorer.h"
+
+CL_NS_DEF(search)
+
+WANDScorer::WANDScorer(Similarity* similarity, Scorer** subScorers, const float_t* _maxScores,
+	const int32_t count, const int32_t _maxCoord):
+	Scorer(similarity),
+	scorers(NULL),
+	maxScores(NULL),
+	nrScorers(count),
+	coordFactors(NULL),
+	maxCoordFactor(0.0f),
+	maxCoord(_maxCoord),
+	minCompetitiveScore(0.0f),
+	currentDoc(-1),
+	initialized(false)
+{
+	if ( count <= 1 ) {
+		_CLTHROWA(CL_ERR_IllegalArgument,"There must be at least 2 subScorers");
+	}
+	scorers = _CL_NEWARRAY(Scorer*,count);
+	maxScores = _CL_NEWARRAY(float_t,count);
+	for ( int32_t i=0;i<count;i++ ){
+		scorers[i] = subScorers[i];
+		maxScores[i] = _maxScores[i];
+	}
+
+	coordFactors = _CL_NEWARRAY(float_t,maxCoord+1);
+	coordFactors[0] = 0.0f;
+	for ( int32_t i=1;i<=maxCoord;i++ ){
+		coordFactors[i] = similarity->coord(i, maxCoord);
+		if ( coordFactors[i] > maxCoordFactor )
+			maxCoordFactor = coordFactors[i];
+	}
+}
+
+WANDScorer::~WANDScorer(){
+	for ( int32_t i=0;i<nrScorers;i++ )
+		_CLDELETE(scorers[i]);
+	_CLDELETE_LARRAY(scorers);
+	_CLDELETE_LARRAY(maxScores);
+	_CLDELETE_LARRAY(coordFactors);
+}
+
+void WANDScorer::removeScorer(int32_t i){
+	_CLDELETE(scorers[i]);
+	nrScorers--;
+	scorers[i] = scorers[nrScorers];
+	maxScores[i] = maxScores[nrScorers];
+	scorers[nrScorers] = NULL;
+}
+
+void WANDScorer::sortScorers(){
+	//insertion sort: there are few scorers, and only the advanced ones are out of order
+	for ( int32_t i=1;i<nrScorers;i++ ){
+		Scorer* s = scorers[i];
+		float_t m = maxScores[i];
+		const int32_t d = s->doc();
+		int32_t j = i-1;
+		while ( j >= 0 && scorers[j]->doc() > d ){
+			scorers[j+1] = scorers[j];
+			maxScores[j+1] = maxScores[j];
+			j--;
+		}
+		scorers[j+1] = s;
+		maxScores[j+1] = m;
+	}
+}
+
+void WANDScorer::init(){
+	initialized = true;
+	for ( int32_t i=nrScorers-1;i>=0;i-- ){
+		if ( !scorers[i]->next() )
+			removeScorer(i);
+	}
+}
+
+bool WANDScorer::findNext(){
+	while ( true ){
+		sortScorers();
+
+		//find the pivot
+		int32_t pivot = -1;
+		float_t bound = 0.0f;
+		for ( int32_t i=0;i<nrScorers;i++ ){
+			bound += maxScores[i];
+			if ( bound * maxCoordFactor >= minCompetitiveScore ){
+				pivot = i;
+				break;
+			}
+		}
+		if ( pivot == -1 ){
+			//even all scorers together can not be competitive any more
+			currentDoc = LUCENE_INT32_MAX_SHOULDBE;
+			return false;
+		}
+
+		const int32_t pivotDoc = scorers[pivot]->doc();
+		if ( scorers[0]->doc() == pivotDoc ){
+			currentDoc = pivotDoc;
+			return true;
+		}
+
+		//the docs before the pivot doc can not be competitive
+		for ( int32_t i=pivot-1;i>=0;i-- ){
+			if ( scorers[i]->doc() < pivotDoc && !scorers[i]->skipTo(pivotDoc) )
+				removeScorer(i);
+		}
+	}
+}
+
+bool WANDScorer::next(){
+	if ( !initialized ){
+		init();
+	}else{
+		for ( int32_t i=nrScorers-1;i>=0;i-- ){
+			if ( scorers[i]->doc() == currentDoc && !scorers[i]->next() )
+				removeScorer(i);
+		}
+	}
+	return findNext();
+}
+
+bool WANDScorer::skipTo(int32_t target){
+	if ( !initialized ){
+		init();
+	}
+	for ( int32_t i=nrScorers-1;i>=0;i-- ){
+		if ( scorers[i]->doc() < target && !scorers[i]->skipTo(target) )
+			removeScorer(i);
+	}
+	return findNext();
+}
+
+float_t WANDScorer::score(){
+	float_t sum = 0.0f;
+	int32_t nrMatchers = 0;
+	for ( int32_t i=0;i<nrScorers && scorers[i]->doc()==currentDoc;i++ ){
+		sum += scorers[i]->score();
+		nrMatchers++;
+	}
+	return sum * coordFactors[nrMatchers];
+}
+
+void WANDScorer::setMinCompetitiveScore(float_t minScore){
+	minCompetitiveScore = minScore;
+}
+
+Explanation* WANDScorer::explain(int32_t doc){
+	Explanation* res = _CLNEW Explanation();
+	float_t sumScore = 0.0f;
+	int32_t nrMatches = 0;
+	for ( int32_t i=0;i<nrScorers;i++ ){
+		Explanation* es = scorers[i]->explain(doc);
+		if (es->getValue() > 0.0f) { // indicates match
+			sumScore += es->getValue();
+			nrMatches++;
+		}
+		res->addDetail(es);
+	}
+
+	CL_NS(util)::StringBuffer buf(50);
+	buf.append(_T("sum of "));
+	buf.appendInt(nrMatches);
+	buf.append(_T(" of "));
+	buf.appendInt(maxCoord);
+	buf.append(_T(" times coord:"));
+	res->setValue(sumScore * coordFactors[nrMatches]);
+	res->setDescription(buf.getBuffer());
+	return res;
+}
+
+TCHAR* WANDScorer::toString(){
+	return stringDuplicate(_T("WANDScorer"));
+}
+
+CL_NS_END
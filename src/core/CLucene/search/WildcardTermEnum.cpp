@@ -8,6 +8,7 @@
 #include "WildcardTermEnum.h"
 #include "CLucene/index/Term.h"
 #include "CLucene/index/IndexReader.h"
+#include "_TermAutomaton.h"
 
 CL_NS_USE(index)
 CL_NS_DEF(search)
@@ -15,9 +16,13 @@ CL_NS_DEF(search)
     bool WildcardTermEnum::termCompare(Term* term) {
         if ( term!=NULL && __term->field() == term->field() ) {
             const TCHAR* searchText = term->text();
-            const TCHAR* patternText = __term->text();
 			if ( _tcsncmp( searchText, pre, preLen ) == 0 ){
-               return wildcardEquals(patternText+preLen, __term->textLength()-preLen, 0, searchText, term->textLength(), preLen);
+               if ( automaton->accept(searchText, term->textLength()) )
+                   return true;
+               //no greater term can match
+               if ( automaton->exhausted() )
+                   _endEnum = true;
+               return false;
 			}
         }
         _endEnum = true;
@@ -29,7 +34,9 @@ CL_NS_DEF(search)
 	    FilteredTermEnum(),
 		__term(_CL_POINTER(term)),
 		fieldMatch(false),
-		_endEnum(false)
+		_endEnum(false),
+		reader(reader),
+		automaton(NULL)
     {
        
 		pre = stringDuplicate(term->text());
@@ -47,6 +54,8 @@ CL_NS_DEF(search)
 		CND_PRECONDITION(preLen<term->textLength(), "preLen >= term->textLength()");
 		pre[preLen]=0; //trim end
 
+		automaton = _CLNEW WildcardAutomaton(pre, preLen, term->text()+preLen, term->textLength()-preLen);
+
 		Term* t = _CLNEW Term(__term, pre);
 		setEnum( reader->terms(t) );
 		_CLDECDELETE(t);
@@ -61,8 +70,19 @@ CL_NS_DEF(search)
          __term = NULL;
 
          _CLDELETE_CARRAY( pre );
+         _CLDELETE( automaton );
        }
     }
+
+    TermEnum* WildcardTermEnum::seekEnum() {
+        const TCHAR* text = automaton->seekText();
+        if ( text == NULL )
+            return NULL;
+        Term* t = _CLNEW Term(__term, text);
+        TermEnum* ret = reader->terms(t);
+        _CLDECDELETE(t);
+        return ret;
+    }
     WildcardTermEnum::~WildcardTermEnum() {
       close();
     }
@@ -10,6 +10,7 @@
 //#include "CLucene/index/IndexReader.h"
 CL_CLASS_DEF(index,Term)
 CL_CLASS_DEF(index,IndexReader)
+CL_CLASS_DEF(search,TermAutomaton)
 //#include "CLucene/index/Terms.h"
 #include "FilteredTermEnum.h"
 
@@ -28,6 +29,9 @@ CL_NS_DEF(search)
         int32_t preLen;
         bool fieldMatch;
         bool _endEnum;
+        CL_NS(index)::IndexReader* reader;
+        /** Accepts the text after pre which matches the pattern */
+        TermAutomaton* automaton;
 
         /********************************************
         * const TCHAR* equality with support for wildcards
@@ -36,6 +40,9 @@ CL_NS_DEF(search)
         protected:
         bool termCompare(CL_NS(index)::Term* term) ;
 
+        /** Seeks to the next term which may match the pattern */
+        CL_NS(index)::TermEnum* seekEnum();
+
         public:
 
         /**
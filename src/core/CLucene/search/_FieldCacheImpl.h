@@ -70,7 +70,8 @@ public:
     FieldCacheImpl();
     virtual ~FieldCacheImpl();
 private:
-  /** The internal cache. Maps FileEntry to array of interpreted term values. **/
+  /** The internal cache. Maps FileEntry to array of interpreted term values.
+  * INT, FLOAT and STRING_INDEX values are also kept per segment reader. **/
   //todo: make indexreader remove itself from here when the reader is shut
   fieldcacheCacheType* cache;
   
@@ -85,6 +86,16 @@ private:
 
   /** Put a custom object into the cache. */
   void store (CL_NS(index)::IndexReader* reader, const TCHAR* field, SortComparatorSource* comparer, FieldCacheAuto* value);
+
+  /** Returns the INT, FLOAT or STRING_INDEX values of a single segment,
+  * reading and caching them if needed. The cache entry belongs to the
+  * segment reader, so it survives a reopen which keeps the segment. */
+  FieldCacheAuto* getSegmentValues (CL_NS(index)::IndexReader* segment, const TCHAR* field, int32_t type);
+
+  /** Reads the values of reader. If reader consists of several segments
+  * the values of each segment are cached separately and the result is
+  * assembled from them, with each segment's documents at its docBase. */
+  FieldCacheAuto* getMergedValues (CL_NS(index)::IndexReader* reader, const TCHAR* field, int32_t type);
   
 public:
 
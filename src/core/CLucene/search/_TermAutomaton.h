@@ -0,0 +1,142 @@
+/*------------------------------------------------------------------------------
+* Copyright (C) 2003-2006 Ben van Klinken and the CLucene Team
+*
+* Distributable under the terms of either the Apache License (Version 2.0) or
+* the GNU Lesser General Public License, as specified in the COPYING file.
+------------------------------------------------------------------------------*/
+#ifndef _lucene_search_TermAutomaton_
+#define _lucene_search_TermAutomaton_
+
+CL_NS_DEF(search)
+
+/**
+* A non deterministic automaton over the text of terms which share a fixed
+* prefix. It is used by term enumerations to skip the terms of the
+* dictionary which can not be accepted.
+* <p>When a text is rejected the automaton also finds the smallest greater
+* text which it may accept: the text is walked to the first character which
+* leaves no live state, and the next greater character which has a
+* transition is taken there, or at an earlier position if there is none.
+* The terms before that text are rejected without running the automaton,
+* and once SEEK_INTERVAL of them were stepped over, seekText() returns the
+* text so that the enumeration can seek to it instead.
+* <p>A set of states is a bit set of stateWords 64 bit words, which the
+* subclasses update a word at a time. The sets after every character of the
+* last text are kept, so a text which shares a prefix with its predecessor,
+* as the sorted terms of the dictionary do, only runs the automaton on the
+* characters after it.
+*/
+class TermAutomaton: LUCENE_BASE{
+public:
+	/** The number of terms stepped over before seeking to the next candidate */
+	LUCENE_STATIC_CONSTANT(int32_t, SEEK_INTERVAL = 64);
+
+	virtual ~TermAutomaton();
+
+	/** Returns true if the automaton accepts text, which starts with the prefix.
+	* The texts must be passed in increasing order. */
+	bool accept(const TCHAR* text, int32_t textLen);
+
+	/** Returns true if no text greater than the last rejected one can be accepted */
+	bool exhausted() const;
+
+	/** Returns the smallest text, including the prefix, which may be accepted if
+	* the enumeration should seek to it rather than step to it, or NULL */
+	const TCHAR* seekText();
+
+protected:
+	/** @param prefix the prefix shared by all texts, which is not run
+	* @param stateWords the number of words of a set of states */
+	TermAutomaton(const TCHAR* prefix, int32_t prefixLen, int32_t stateWords);
+
+	const int32_t stateWords;
+
+	/** Sets the states of the empty text in the zeroed states */
+	virtual void initial(uint64_t* states) const = 0;
+	/** Sets the states reached with c from states in the zeroed to */
+	virtual void step(const uint64_t* states, uint32_t c, uint64_t* to) = 0;
+	/** Returns true if states contains a final state */
+	virtual bool isAccept(const uint64_t* states) const = 0;
+	/** Returns the smallest character not less than c which has a transition
+	* from states, or 0 if there is none */
+	virtual uint32_t minLabel(const uint64_t* states, uint32_t c) const = 0;
+
+	/** Ors in into out shifted by one bit, so that state i of in sets state i+1 of out */
+	static void shiftOr(const uint64_t* in, uint64_t* out, int32_t words);
+
+	/** Returns the value of c in the order of term texts */
+	static uint32_t charValue(TCHAR c);
+
+private:
+	int32_t prefixLen;
+
+	uint64_t* rows;         ///the states after each character of lastText
+	TCHAR* lastText;
+	int32_t capacity;       ///the number of characters lastText and rows have room for
+	int32_t validRows;
+
+	TCHAR* target;          ///the prefix followed by the next text which may be accepted
+	int32_t targetCapacity;
+	int32_t targetLen;      ///the length of target after the prefix
+	bool hasTarget;
+	bool _exhausted;
+	int32_t skipped;
+
+	uint64_t* row(int32_t i) const;
+	bool isEmpty(const uint64_t* states) const;
+	/** Returns the number of characters of text after which there are live states */
+	int32_t run(const TCHAR* text, int32_t len);
+	/** Sets target to the smallest text greater than text which may be accepted */
+	void findTarget(const TCHAR* text, int32_t len, int32_t live);
+};
+
+/** Accepts the texts which match a pattern of <code>?</code> and <code>*</code>
+* wildcards. */
+class WildcardAutomaton: public TermAutomaton{
+public:
+	/** @param pattern the pattern of the text after the prefix */
+	WildcardAutomaton(const TCHAR* prefix, int32_t prefixLen, const TCHAR* pattern, int32_t patternLen);
+	~WildcardAutomaton();
+protected:
+	void initial(uint64_t* states) const;
+	void step(const uint64_t* states, uint32_t c, uint64_t* to);
+	bool isAccept(const uint64_t* states) const;
+	uint32_t minLabel(const uint64_t* states, uint32_t c) const;
+private:
+	TCHAR* pattern;
+	int32_t patternLen;
+	uint64_t* anyChar;      ///the positions of ? and *
+	uint64_t* anyString;    ///the positions of *
+	uint64_t* eq;           ///the positions of the literals which equal the character of step
+	/** Sets eq to the positions of the literals of pattern which equal c */
+	void match(uint32_t c);
+	void closure(uint64_t* states) const;
+};
+
+/** Accepts the texts within a Levenshtein distance of maxDistance of a text.
+* Bit i of the words of level e is the state reached after the first i
+* characters of the text have been matched with e edits. */
+class LevenshteinAutomaton: public TermAutomaton{
+public:
+	/** @param text the text after the prefix */
+	LevenshteinAutomaton(const TCHAR* prefix, int32_t prefixLen, const TCHAR* text, int32_t textLen, int32_t maxDistance);
+	~LevenshteinAutomaton();
+protected:
+	void initial(uint64_t* states) const;
+	void step(const uint64_t* states, uint32_t c, uint64_t* to);
+	bool isAccept(const uint64_t* states) const;
+	uint32_t minLabel(const uint64_t* states, uint32_t c) const;
+private:
+	TCHAR* text;
+	int32_t textLen;
+	int32_t maxDistance;
+	int32_t levelWords;     ///the number of words of each level
+	uint64_t lastMask;      ///the valid bits of the last word of a level
+	uint64_t* eq;           ///the positions of the characters which equal the character of step
+	/** Sets eq to the positions of the characters of text which equal c */
+	void match(uint32_t c);
+	void closure(uint64_t* states) const;
+};
+
+CL_NS_END
+#endif
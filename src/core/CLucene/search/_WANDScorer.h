@@ -0,0 +1,75 @@
+/*------------------------------------------------------------------------------
+* Copyright (C) 2003-2006 Ben van Klinken and the CLucene Team
+*
+* Distributable under the terms of either the Apache License (Version 2.0) or
+* the GNU Lesser General Public License, as specified in the COPYING file.
+------------------------------------------------------------------------------*/
+#ifndef _lucene_search_WANDScorer_
+#define _lucene_search_WANDScorer_
+
+#include "Scorer.h"
+
+CL_NS_DEF(search)
+
+/** A Scorer for disjunctions of optional clauses which skips the documents
+* that can not score above the minimal competitive score (the WAND algorithm,
+* "weak and").
+* <p>Every subscorer has an upper bound of the score it may contribute. The
+* subscorers are kept ordered by their current doc(); the first doc at which
+* the summed bounds of the scorers up to and including it reach the minimal
+* competitive score is the pivot. Documents before the pivot can not be
+* competitive, so the scorers before it are skipped to the pivot.
+* <p>Until {@link #setMinCompetitiveScore} is called this matches the same
+* documents with the same scores as a BooleanScorer2 over the same optional
+* subscorers.
+*/
+class WANDScorer : public Scorer {
+private:
+	/** The subscorers, those before <code>nrScorers</code> are not exhausted
+	* and after the first next() or skipTo() are ordered by doc(). */
+	Scorer** scorers;
+	/** The score bound of each subscorer, in the same order as scorers. */
+	float_t* maxScores;
+	int32_t nrScorers;
+
+	/** coord factor for each number of matchers, and the maximum of them. */
+	float_t* coordFactors;
+	float_t maxCoordFactor;
+	int32_t maxCoord;
+
+	float_t minCompetitiveScore;
+	int32_t currentDoc;
+	bool initialized;
+
+	/** Removes the scorer at index i, the order of the others is restored by sortScorers(). */
+	void removeScorer(int32_t i);
+	void sortScorers();
+	/** Advances the subscorers until a possibly competitive doc is found. */
+	bool findNext();
+	void init();
+
+public:
+	/** Construct a <code>WANDScorer</code>.
+	* @param similarity the similarity of the boolean query, used for coord.
+	* @param subScorers the scorers of the optional clauses. At least 2.
+	* @param maxScores an upper bound of the score of each subscorer.
+	* @param count the number of subscorers.
+	* @param maxCoord the number of clauses which could have matched, like
+	*   for BooleanScorer2.
+	* @memory takes ownership of the subscorers, maxScores is copied.
+	*/
+	WANDScorer(Similarity* similarity, Scorer** subScorers, const float_t* maxScores,
+		const int32_t count, const int32_t maxCoord);
+	virtual ~WANDScorer();
+
+	bool next();
+	int32_t doc() const { return currentDoc; }
+	float_t score();
+	bool skipTo(int32_t target);
+	void setMinCompetitiveScore(float_t minScore);
+	Explanation* explain(int32_t doc);
+	TCHAR* toString();
+};
+
+CL_NS_END
+#endif
@@ -24,15 +24,14 @@
 #include <assert.h>
 
 #include "FSDirectory.h"
+#include "MMapDirectory.h"
 #include "LockFactory.h"
 #include "CLucene/index/IndexReader.h"
 #include "CLucene/index/IndexWriter.h"
 #include "CLucene/util/Misc.h"
 #include "CLucene/util/_MD5Digester.h"
 
-#ifdef LUCENE_FS_MMAP
-    #include "_MMap.h"
-#endif
+#include "_MMap.h"
 
 CL_NS_DEF(store)
 CL_NS_USE(util)
@@ -67,16 +66,18 @@ CL_NS_USE(util)
 		};
 		SharedHandle* handle;
 		int64_t _pos;
-		FSIndexInput(SharedHandle* handle, int32_t __bufferSize):
+		bool positional; //read with pread at _pos, without touching the shared file pointer
+		FSIndexInput(SharedHandle* handle, int32_t __bufferSize, bool positional):
 			BufferedIndexInput(__bufferSize)
 		{
 			this->_pos = 0;
 			this->handle = handle;
+			this->positional = positional;
 		};
 	protected:
 		FSIndexInput(const FSIndexInput& clone);
 	public:
-		static bool open(const char* path, IndexInput*& ret, CLuceneError& error, int32_t bufferSize=-1);
+		static bool open(const char* path, IndexInput*& ret, CLuceneError& error, int32_t bufferSize=-1, bool positional=false);
 		~FSIndexInput();
 
 		IndexInput* clone() const;
@@ -111,7 +112,7 @@ CL_NS_USE(util)
 		int64_t length() const;
 	};
 
-	bool FSDirectory::FSIndexInput::open(const char* path, IndexInput*& ret, CLuceneError& error, int32_t __bufferSize )    {
+	bool FSDirectory::FSIndexInput::open(const char* path, IndexInput*& ret, CLuceneError& error, int32_t __bufferSize, bool positional )    {
 	//Func - Constructor.
 	//       Opens the file named path
 	//Pre  - path != NULL
@@ -134,7 +135,10 @@ CL_NS_USE(util)
 	  		error.set( CL_ERR_IO,"fileStat error" );
 		  else{
 			  handle->_fpos = 0;
-			  ret = _CLNEW FSIndexInput(handle, __bufferSize);
+#ifndef _CL_HAVE_FUNCTION_PREAD
+			  positional = false;
+#endif
+			  ret = _CLNEW FSIndexInput(handle, __bufferSize, positional);
 			  return true;
 		  }
 	  }else{
@@ -163,9 +167,17 @@ CL_NS_USE(util)
 	  if ( other.handle == NULL )
 		  _CLTHROWA(CL_ERR_NullPointer, "other handle is null");
 
+	  positional = other.positional;
+	  if ( positional ){
+		  //the clone has its own position, nothing shared needs locking
+		  handle = _CL_POINTER(other.handle);
+		  _pos = other._pos;
+		  return;
+	  }
+
 	  SCOPED_LOCK_MUTEX(*other.handle->SHARED_LOCK)
 	  handle = _CL_POINTER(other.handle);
-	  _pos = other.handle->_fpos; //note where we are currently...
+	  _pos = other._pos; //the file position of other, the shared handle may be anywhere
   }
 
   FSDirectory::FSIndexInput::SharedHandle::SharedHandle(const char* path){
@@ -240,6 +252,29 @@ CL_NS_USE(util)
 void FSDirectory::FSIndexInput::readInternal(uint8_t* b, const int32_t len) {
 	CND_PRECONDITION(handle!=NULL,"shared file handle has closed");
 	CND_PRECONDITION(handle->fhandle>=0,"file is not open");
+
+#ifdef _CL_HAVE_FUNCTION_PREAD
+	if ( positional ){
+		//positional read: no shared file pointer, so no lock is needed
+		int32_t done = 0;
+		while ( done < len ){
+			ssize_t r = ::pread(handle->fhandle, b + done, len - done, _pos + done);
+			if ( r == 0 ){
+				_CLTHROWA(CL_ERR_IO, "read past EOF");
+			}
+			if ( r == -1 ){
+				if ( errno == EINTR )
+					continue;
+				_CLTHROWA(CL_ERR_IO, "read error");
+			}
+			done += (int32_t)r;
+		}
+		bufferLength = len;
+		_pos += len;
+		return;
+	}
+#endif
+
 	SCOPED_LOCK_MUTEX(*handle->SHARED_LOCK)
 
 	if ( handle->_fpos != _pos ){
@@ -362,6 +397,7 @@ void FSDirectory::FSIndexInput::readInternal(uint8_t* b, const int32_t len) {
    Directory(),
    refCount(0),
    useMMap(LUCENE_USE_MMAP),
+   usePositionalRead(LUCENE_USE_POSITIONAL_READ),
    filemode(_S_IWRITE | _S_IREAD) //default to user (only) writable index
   {
     this->lockFactory = NULL;
@@ -433,6 +469,8 @@ void FSDirectory::FSIndexInput::readInternal(uint8_t* b, const int32_t len) {
   }
   void FSDirectory::setUseMMap(bool value){ useMMap = value; }
   bool FSDirectory::getUseMMap() const{ return useMMap; }
+  void FSDirectory::setUsePositionalRead(bool value){ usePositionalRead = value; }
+  bool FSDirectory::getUsePositionalRead() const{ return usePositionalRead; }
   const char* FSDirectory::getClassName(){
     return "FSDirectory";
   }
@@ -472,7 +510,15 @@ void FSDirectory::FSIndexInput::readInternal(uint8_t* b, const int32_t len) {
     return dir;
   }
   //static
-  FSDirectory* FSDirectory::getDirectory(const char* _file, LockFactory* lockFactory){
+  FSDirectory* FSDirectory::getDirectory(const char* file, LockFactory* lockFactory){
+    return getDirectory(file, lockFactory, newInstance, getClassName());
+  }
+  FSDirectory* FSDirectory::newInstance(){
+    return _CLNEW FSDirectory();
+  }
+  //static
+  FSDirectory* FSDirectory::getDirectory(const char* _file, LockFactory* lockFactory,
+      FSDirectory* (*newInstance)(), const char* className){
     FSDirectory* dir = NULL;
 	{
 		if ( !_file || !*_file )
@@ -505,10 +551,17 @@ void FSDirectory::FSIndexInput::readInternal(uint8_t* b, const int32_t len) {
 		SCOPED_LOCK_MUTEX(DIRECTORIES_LOCK)
 		dir = DIRECTORIES.get(file);
 		if ( dir == NULL  ){
-			dir = _CLNEW FSDirectory();
+			dir = newInstance();
       dir->init(file,lockFactory);
 			DIRECTORIES.put( dir->directory.c_str(), dir);
 		} else {
+			if ( strcmp(dir->getObjectName(), className) != 0 ) {
+				string err = "Directory was previously opened as ";
+				err += dir->getObjectName();
+				err += ", close it before opening it as ";
+				err += className;
+				_CLTHROWA(CL_ERR_IO, err.c_str() );
+			}
 			if ( lockFactory != NULL && lockFactory != dir->getLockFactory() ) {
 				_CLTHROWA(CL_ERR_IO,"Directory was previously created with a different LockFactory instance, please pass NULL as the lockFactory instance and use setLockFactory to change it");
 			}
@@ -565,16 +618,17 @@ void FSDirectory::FSIndexInput::readInternal(uint8_t* b, const int32_t len) {
       return buf.st_size;
   }
 
-  IndexInput* FSDirectory::openMMapFile(const char* name, int32_t bufferSize){
-#ifdef LUCENE_FS_MMAP
+  IndexInput* FSDirectory::openMMapFile(const char* name, int32_t /*bufferSize*/){
+#ifdef _CL_HAVE_MMAP_INPUT
     char fl[CL_MAX_DIR];
     priv_getFN(fl, name);
-	if ( Misc::file_Size(fl) < LUCENE_INT32_MAX_SHOULDBE ) //todo: would this be bigger on 64bit systems?. i suppose it would be...test first
-		return _CLNEW MMapIndexInput( fl );
-	else
-		return _CLNEW FSIndexInput( fl, bufferSize );
+    IndexInput* ret = NULL;
+    CLuceneError err;
+    if ( !MMapIndexInput::open( fl, ret, err, MMapDirectory::DEFAULT_MAX_CHUNK_SIZE, MMapDirectory::ADVICE_NORMAL ) )
+      throw err;
+    return ret;
 #else
-	_CLTHROWA(CL_ERR_Runtime,"MMap not enabled at compilation");
+	_CLTHROWA(CL_ERR_Runtime,"MMap is not available on this platform");
 #endif
   }
 
@@ -583,15 +637,13 @@ void FSDirectory::FSIndexInput::readInternal(uint8_t* b, const int32_t len) {
 	CND_PRECONDITION(directory[0]!=0,"directory is not open")
     char fl[CL_MAX_DIR];
     priv_getFN(fl, name);
-#ifdef LUCENE_FS_MMAP
-	//todo: do some tests here... like if the file
-	//is >2gb, then some system cannot mmap the file
-	//also some file systems mmap will fail?? could detect here too
-	if ( useMMap && Misc::file_Size(fl) < LUCENE_INT32_MAX_SHOULDBE ) //todo: would this be bigger on 64bit systems?. i suppose it would be...test first
-		return MMapIndexInput( fl, ret, error, bufferSize );
+#ifdef _CL_HAVE_MMAP_INPUT
+	//big files are mapped in chunks, so there is no need for a size limit here
+	if ( useMMap )
+		return MMapIndexInput::open( fl, ret, error, MMapDirectory::DEFAULT_MAX_CHUNK_SIZE, MMapDirectory::ADVICE_NORMAL );
 	else
 #endif
-	return FSIndexInput::open( fl, ret, error, bufferSize );
+	return FSIndexInput::open( fl, ret, error, bufferSize, usePositionalRead );
   }
 
   void FSDirectory::close(){
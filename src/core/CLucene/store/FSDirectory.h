@@ -39,11 +39,21 @@ CL_CLASS_DEF(util,StringBuffer)
 	protected:
     FSDirectory();
 		void init(const char* path, LockFactory* lockFactory=NULL);
+
+		/**
+		* Returns the cached directory instance for the named location. If
+		* there is none yet, one is created with newInstance and initialised.
+		* Throws an error if the cached instance is not of class className.
+		*/
+		static FSDirectory* getDirectory(const char* file, LockFactory* lockFactory,
+			FSDirectory* (*newInstance)(), const char* className);
 	private:
     std::string directory;
 		int refCount;
 		void create();
 
+		static FSDirectory* newInstance();
+
 		static const char* LOCK_DIR;
 		static const char* getLockDir();
 		char* getLockPrefix() const;
@@ -51,6 +61,7 @@ CL_CLASS_DEF(util,StringBuffer)
 
 		void priv_getFN(char* buffer, const char* name) const;
 		bool useMMap;
+		bool usePositionalRead;
 
 	protected:
 		/// Removes an existing file in the directory.
@@ -136,6 +147,19 @@ CL_CLASS_DEF(util,StringBuffer)
 	  */
 	  bool getUseMMap() const;
 
+	  /**
+	  * Sets whether inputs opened from now on use positional reads (pread).
+	  * In this mode every clone of an input keeps its own file position and
+	  * reads without locking the file handle shared by the clones, so that
+	  * concurrent searches on the same segment files do not serialize.
+	  * On platforms without pread the setting has no effect.
+	  */
+	  void setUsePositionalRead(bool value);
+	  /**
+	  * Gets whether the directory is using positional reads for inputstreams.
+	  */
+	  bool getUsePositionalRead() const;
+
 	  std::string toString() const;
 
 		static const char* getClassName();
@@ -40,6 +40,19 @@ CL_NS_USE(util)
     return i;
   }
 
+  const uint8_t* IndexInput::peekBuffer(int32_t& len){
+    len = 0;
+    return NULL;
+  }
+
+  void IndexInput::consumeBuffer(const int32_t len){
+    seek(getFilePointer() + len);
+  }
+
+  IndexInput* IndexInput::mapBytes(const int64_t /*pos*/, const int64_t /*len*/, const uint8_t*& /*bytes*/){
+    return NULL;
+  }
+
   int64_t IndexInput::readLong() {
     int64_t i = ((int64_t)readInt() << 32);
     return (i | ((int64_t)readInt() & 0xFFFFFFFFL));
@@ -69,6 +82,23 @@ CL_NS_USE(util)
 	}
 }
 
+  int32_t IndexInput::readCharsUTF8( uint8_t* buffer, const int32_t len) {
+    uint8_t* p = buffer;
+    for (int32_t i = 0; i < len; ++i) {
+      const uint8_t b = readByte();
+      *p++ = b;
+      if ((b & 0x80) == 0) {
+        // Do Nothing.
+      } else if ((b & 0xE0) != 0xE0) {
+        *p++ = readByte();
+      } else {
+        *p++ = readByte();
+        *p++ = readByte();
+      }
+    }
+    return (int32_t)(p - buffer);
+  }
+
 	#ifdef _UCS2
   int32_t IndexInput::readString(char* buffer, const int32_t maxLength){
   	TCHAR* buf = _CL_NEWARRAY(TCHAR,maxLength);
@@ -229,6 +259,19 @@ BufferedIndexInput::BufferedIndexInput(int32_t _bufferSize):
     return bufferStart + bufferPosition;
   }
 
+  const uint8_t* BufferedIndexInput::peekBuffer(int32_t& len){
+    if ( buffer == NULL ){
+      len = 0;
+      return NULL;
+    }
+    len = bufferLength - bufferPosition;
+    return buffer + bufferPosition;
+  }
+
+  void BufferedIndexInput::consumeBuffer(const int32_t len){
+    bufferPosition += len;
+  }
+
   void BufferedIndexInput::seek(const int64_t pos) {
     if ( pos < 0 )
       _CLTHROWA(CL_ERR_IO, "IO Argument Error. Value must be a positive value.");
@@ -106,6 +106,13 @@ CL_NS_DEF(store)
 		*/
 		void readChars( TCHAR* buffer, const int32_t start, const int32_t len);
 
+		/** Reads len characters written by IndexOutput#writeChars without
+		* decoding them: their UTF-8 bytes are copied into buffer, which must
+		* have room for 3*len bytes.
+		* @return the number of bytes copied
+		*/
+		int32_t readCharsUTF8( uint8_t* buffer, const int32_t len);
+
 		void skipChars( const int32_t count);
 
 		/** Closes the stream to futher operations. */
@@ -125,6 +132,31 @@ CL_NS_DEF(store)
 		/** The number of bytes in the file. */
 		virtual int64_t length() const = 0;
 
+		/**
+		* Gives direct access to the bytes which are already in memory at the
+		* current position, so that hot loops can decode them without a
+		* virtual call per byte. The bytes read from the window must be
+		* skipped with {@link #consumeBuffer}. The window may be empty even
+		* if there are bytes left, readers then fall back to readByte.
+		* @param len is set to the number of bytes in the window
+		* @return the window, or NULL if the input has no buffer
+		*/
+		virtual const uint8_t* peekBuffer(int32_t& len);
+
+		/** Skips len bytes of the window returned by {@link #peekBuffer}. */
+		virtual void consumeBuffer(const int32_t len);
+
+		/**
+		* Expert: gives direct access to len bytes of the file starting at
+		* pos, if they are held in memory which does not change with reads
+		* and seeks, such as a memory mapping. The bytes stay valid until the
+		* returned input is closed, even if this input is closed before.
+		* @param bytes is set to the bytes
+		* @return an input keeping the bytes valid, which the caller owns, or
+		* NULL if the bytes are not available like that (the default)
+		*/
+		virtual IndexInput* mapBytes(const int64_t pos, const int64_t len, const uint8_t*& bytes);
+
 		virtual const char* getDirectoryType() const = 0;
 		virtual const char* getObjectName() const = 0;
 	};
@@ -174,6 +206,9 @@ CL_NS_DEF(store)
 
 		void setBufferSize( int32_t newSize );
 
+		const uint8_t* peekBuffer(int32_t& len);
+		void consumeBuffer(const int32_t len);
+
 		const char* getObjectName();
 		static const char* getClassName();
 
@@ -0,0 +1,115 @@
+/*------------------------------------------------------------------------------
+* Copyright (C) 2003-2006 Ben van Klinken and the CLucene Team
+*
+* Distributable under the terms of either the Apache License (Version 2.0) or
+* the GNU Lesser General Public License, as specified in the COPYING file.
+------------------------------------------------------------------------------*/
+#include "CLucene/_ApiHeader.h"
+#include "MMapDirectory.h"
+#include "_MMap.h"
+#include <map>
+
+CL_NS_DEF(store)
+CL_NS_USE(util)
+
+	int64_t MMapDirectory::DEFAULT_MAX_CHUNK_SIZE = sizeof(void*) >= 8 ? _ILONGLONG(1) << 30 : _ILONGLONG(1) << 28;
+
+	class MMapDirectory::Internal: LUCENE_BASE{
+	public:
+		typedef std::map<std::string, Advice> AdviceMap;
+		AdviceMap advice;
+		Advice mergeAdvice;
+		DEFINE_MUTEX(THIS_LOCK)
+
+		Internal():
+			mergeAdvice(ADVICE_SEQUENTIAL)
+		{
+			//term dictionary and postings are read at random places
+			advice["tis"] = ADVICE_RANDOM;
+			advice["frq"] = ADVICE_RANDOM;
+			advice["prx"] = ADVICE_RANDOM;
+			//term index and norms are read completely when a reader is opened
+			advice["tii"] = ADVICE_WILLNEED;
+			advice["nrm"] = ADVICE_WILLNEED;
+		}
+	};
+
+	MMapDirectory::MMapDirectory():
+		FSDirectory(),
+		_internal(_CLNEW Internal),
+		maxChunkSize(DEFAULT_MAX_CHUNK_SIZE)
+	{
+	}
+	MMapDirectory::~MMapDirectory(){
+		_CLDELETE(_internal);
+	}
+
+	FSDirectory* MMapDirectory::newInstance(){
+		return _CLNEW MMapDirectory();
+	}
+
+	MMapDirectory* MMapDirectory::getDirectory(const char* file, LockFactory* lockFactory){
+		return (MMapDirectory*)FSDirectory::getDirectory(file, lockFactory, newInstance, getClassName());
+	}
+
+	void MMapDirectory::setMaxChunkSize(int64_t size){
+		if ( size < (1<<16) )
+			_CLTHROWA(CL_ERR_IllegalArgument, "maxChunkSize must be at least 64KB");
+		int64_t power = 1<<16;
+		while ( (power << 1) <= size )
+			power <<= 1;
+		maxChunkSize = power;
+	}
+	int64_t MMapDirectory::getMaxChunkSize() const{
+		return maxChunkSize;
+	}
+
+	void MMapDirectory::setAdvice(const char* extension, Advice advice){
+		SCOPED_LOCK_MUTEX(_internal->THIS_LOCK)
+		_internal->advice[extension] = advice;
+	}
+	MMapDirectory::Advice MMapDirectory::getAdvice(const char* extension) const{
+		SCOPED_LOCK_MUTEX(_internal->THIS_LOCK)
+		Internal::AdviceMap::const_iterator itr = _internal->advice.find(extension);
+		if ( itr == _internal->advice.end() )
+			return ADVICE_NORMAL;
+		return itr->second;
+	}
+	void MMapDirectory::setMergeAdvice(Advice advice){
+		_internal->mergeAdvice = advice;
+	}
+	MMapDirectory::Advice MMapDirectory::getMergeAdvice() const{
+		return _internal->mergeAdvice;
+	}
+
+	bool MMapDirectory::openInput(const char* name, IndexInput*& ret, CLuceneError& error, int32_t bufferSize){
+#ifdef _CL_HAVE_MMAP_INPUT
+		CND_PRECONDITION(getDirName()[0]!=0,"directory is not open")
+		char fl[CL_MAX_DIR];
+		_snprintf(fl,CL_MAX_DIR,"%s%s%s",getDirName(),PATH_DELIMITERA,name);
+
+		Advice advice;
+		if ( bufferSize > BufferedIndexInput::BUFFER_SIZE ){
+			//merges open their inputs with a bigger buffer and read them through
+			advice = getMergeAdvice();
+		}else{
+			const char* ext = strrchr(name, '.');
+			advice = getAdvice(ext == NULL ? "" : ext+1);
+		}
+		return MMapIndexInput::open(fl, ret, error, maxChunkSize, advice);
+#else
+		return FSDirectory::openInput(name, ret, error, bufferSize);
+#endif
+	}
+
+	std::string MMapDirectory::toString() const{
+		return std::string("MMapDirectory@") + getDirName();
+	}
+	const char* MMapDirectory::getClassName(){
+		return "MMapDirectory";
+	}
+	const char* MMapDirectory::getObjectName() const{
+		return getClassName();
+	}
+
+CL_NS_END
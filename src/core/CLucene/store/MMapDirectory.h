@@ -0,0 +1,102 @@
+/*------------------------------------------------------------------------------
+* Copyright (C) 2003-2006 Ben van Klinken and the CLucene Team
+*
+* Distributable under the terms of either the Apache License (Version 2.0) or
+* the GNU Lesser General Public License, as specified in the COPYING file.
+------------------------------------------------------------------------------*/
+#ifndef _lucene_store_MMapDirectory_
+#define _lucene_store_MMapDirectory_
+
+#include "FSDirectory.h"
+
+CL_NS_DEF(store)
+
+   /**
+   * File-based {@link Directory} implementation that reads files through
+   * memory mapping instead of read calls.
+   *
+   * <p>Files are mapped in chunks of at most {@link #getMaxChunkSize} bytes,
+   * so files bigger than the address space available for a single mapping
+   * (for instance files over 2GB on 32 bit systems) can still be read.
+   * Clones of an input share the mappings of the input they were cloned from,
+   * so cloning does not make any system call.
+   *
+   * <p>Every mapping is given an access pattern hint (madvise) chosen by the
+   * file extension, see {@link #setAdvice}. By default the term dictionary
+   * and postings are read randomly, the term index and norms are preloaded
+   * and inputs opened for merging (opened with a read buffer bigger than the
+   * default) are read sequentially.
+   *
+   * <p>Writing is done the same way as {@link FSDirectory}. If memory mapping
+   * is not available on the platform, files are read as FSDirectory does.
+   *
+   * @see FSDirectory
+   */
+	class CLUCENE_EXPORT MMapDirectory:public FSDirectory{
+	public:
+		/** Access pattern hints given for the mapped files. */
+		enum Advice{
+			/** no particular access pattern */
+			ADVICE_NORMAL=0,
+			/** pages are accessed in random order, no read-ahead */
+			ADVICE_RANDOM=1,
+			/** pages are accessed in order, aggressive read-ahead */
+			ADVICE_SEQUENTIAL=2,
+			/** pages will be needed, start loading them now */
+			ADVICE_WILLNEED=3
+		};
+
+		/** The default maximum chunk size: 1GB on 64 bit systems and 256MB otherwise. */
+		static int64_t DEFAULT_MAX_CHUNK_SIZE;
+	private:
+		class Internal;
+		Internal* _internal;
+		int64_t maxChunkSize;
+		static FSDirectory* newInstance();
+	protected:
+		MMapDirectory();
+	public:
+		~MMapDirectory();
+
+		/**
+		* Returns the directory instance for the named location.
+		*
+		* Directories are cached, for a given canonical path the same instance
+		* is returned. A path which was already opened as a plain FSDirectory
+		* cannot be opened as an MMapDirectory until it has been closed.
+		* @see FSDirectory#getDirectory
+		*/
+		static MMapDirectory* getDirectory(const char* file, LockFactory* lockFactory=NULL);
+
+		/// Returns a stream reading an existing file.
+		bool openInput(const char* name, IndexInput*& ret, CLuceneError& err, int32_t bufferSize=-1);
+
+		/**
+		* Sets the maximum size of a single mapping. The value is rounded down to
+		* a power of two and must be at least 64KB. Only affects inputs opened
+		* after the call.
+		*/
+		void setMaxChunkSize(int64_t maxChunkSize);
+		/** Gets the maximum size of a single mapping. */
+		int64_t getMaxChunkSize() const;
+
+		/**
+		* Sets the access pattern hint for files with the given extension (without
+		* the dot, for instance "frq"). Only affects inputs opened after the call.
+		*/
+		void setAdvice(const char* extension, Advice advice);
+		/** Gets the access pattern hint used for files with the given extension. */
+		Advice getAdvice(const char* extension) const;
+
+		/** Sets the hint used for inputs opened for merging. Defaults to ADVICE_SEQUENTIAL */
+		void setMergeAdvice(Advice advice);
+		/** Gets the hint used for inputs opened for merging */
+		Advice getMergeAdvice() const;
+
+		std::string toString() const;
+
+		static const char* getClassName();
+		const char* getObjectName() const;
+	};
+CL_NS_END
+#endif
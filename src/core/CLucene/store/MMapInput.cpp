@@ -5,10 +5,10 @@
 * the GNU Lesser General Public License, as specified in the COPYING file.
 ------------------------------------------------------------------------------*/
 #include "CLucene/_ApiHeader.h"
-#if defined(LUCENE_FS_MMAP)
-
-#include "FSDirectory.h"
 #include "_MMap.h"
+#if defined(_CL_HAVE_MMAP_INPUT)
+
+#include "MMapDirectory.h"
 #include "CLucene/util/Misc.h"
 
 #include <fcntl.h>
@@ -30,6 +30,7 @@
 #ifdef _CL_HAVE_WINERROR_H
 	#include <winerror.h>
 #endif
+#include <errno.h>
 
 #if defined(_CL_HAVE_FUNCTION_MAPVIEWOFFILE)
     typedef int HANDLE;
@@ -84,155 +85,310 @@
 CL_NS_DEF(store)
 CL_NS_USE(util)
 
+    /** The mappings of a file, shared by an input and its clones. The file
+    * is unmapped when the last of them is closed */
     class MMapIndexInput::Internal: LUCENE_BASE{
 	public:
-		uint8_t* data;
-		int64_t pos;
 #if defined(_CL_HAVE_FUNCTION_MAPVIEWOFFILE)
 		HANDLE mmaphandle;
 		HANDLE fhandle;
-#elif defined(_CL_HAVE_FUNCTION_MMAP)
-		int fhandle;
 #else
-        #error no mmap implementation set
+		int fhandle;
 #endif
-		bool isClone;
-		int64_t _length;
-		
+		uint8_t** chunks;
+		int32_t numChunks;
+		int32_t chunkSizePower;
+		int64_t length;
+		_LUCENE_ATOMIC_INT refCount;
+
 		Internal():
-    		data(NULL),
-    		pos(0),
-    		isClone(false),
-    		_length(0)
+			chunks(NULL),
+			numChunks(0),
+			chunkSizePower(0),
+			length(0)
     	{
+#if defined(_CL_HAVE_FUNCTION_MAPVIEWOFFILE)
+			mmaphandle = NULL;
+			fhandle = NULL;
+#else
+			fhandle = -1;
+#endif
+			_LUCENE_ATOMIC_INT_SET(refCount, 1);
     	}
         ~Internal(){
+		for ( int32_t i=0;i<numChunks && chunks[i]!=NULL;i++ ){
+#if defined(_CL_HAVE_FUNCTION_MAPVIEWOFFILE)
+			if ( ! UnmapViewOfFile(chunks[i]) ){
+				CND_PRECONDITION( false, "UnmapViewOfFile(data) failed"); //todo: change to rich error
+			}
+#else
+			int64_t len = length - ((int64_t)i << chunkSizePower);
+			if ( len > (_ILONGLONG(1) << chunkSizePower) )
+				len = _ILONGLONG(1) << chunkSizePower;
+			::munmap(chunks[i], (size_t)len);
+#endif
+		}
+		_CLDELETE_ARRAY(chunks);
+
+#if defined(_CL_HAVE_FUNCTION_MAPVIEWOFFILE)
+		if ( mmaphandle != NULL ){
+			if ( ! CloseHandle(mmaphandle) ){
+				CND_PRECONDITION( false, "CloseHandle(mmaphandle) failed");
+			}
+		}
+		if ( fhandle != NULL ){
+			if ( !CloseHandle(fhandle) ){
+				CND_PRECONDITION( false, "CloseHandle(fhandle) failed");
+			}
+		}
+#else
+		if ( fhandle >= 0 )
+			::close(fhandle);
+#endif
         }
     };
 
-	MMapIndexInput::MMapIndexInput(const char* path):
-	    _internal(_CLNEW Internal)
+#if !defined(_CL_HAVE_FUNCTION_MAPVIEWOFFILE) && defined(_CL_HAVE_FUNCTION_MADVISE)
+	static int toMAdvice(int32_t advice){
+		switch(advice){
+		case MMapDirectory::ADVICE_RANDOM:
+			return MADV_RANDOM;
+		case MMapDirectory::ADVICE_SEQUENTIAL:
+			return MADV_SEQUENTIAL;
+		case MMapDirectory::ADVICE_WILLNEED:
+			return MADV_WILLNEED;
+		default:
+			return MADV_NORMAL;
+		}
+	}
+#endif
+
+	MMapIndexInput::MMapIndexInput():
+		_internal(NULL),
+		chunks(NULL),
+		numChunks(0),
+		chunkSizePower(0),
+		_length(0),
+		curChunk(0),
+		cur(NULL),
+		curEnd(NULL)
 	{
-	//Func - Constructor.
-	//       Opens the file named path
-	//Pre  - path != NULL
-	//Post - if the file could not be opened  an exception is thrown.
+	}
+
+	bool MMapIndexInput::open(const char* path, IndexInput*& ret, CLuceneError& error, int64_t maxChunkSize, int32_t advice){
+	//Func - Opens the file named path and maps it in chunks of at most maxChunkSize bytes
+	//Pre  - path != NULL, maxChunkSize is a power of two
+	//Post - if the file could not be opened or mapped, error is set and false is returned
 
 	  CND_PRECONDITION(path != NULL, "path is NULL");
+	  CND_PRECONDITION(maxChunkSize > 0 && (maxChunkSize & (maxChunkSize-1)) == 0, "maxChunkSize is not a power of two");
+
+	  MMapIndexInput* input = _CLNEW MMapIndexInput();
+	  input->_internal = _CLNEW Internal;
+	  while ( (_ILONGLONG(1) << input->chunkSizePower) < maxChunkSize )
+		  input->chunkSizePower++;
 
 #if defined(_CL_HAVE_FUNCTION_MAPVIEWOFFILE)
-	  _internal->mmaphandle = NULL;
-	  _internal->fhandle = CreateFileA(path,GENERIC_READ,FILE_SHARE_READ, 0,OPEN_EXISTING,0,0);
-	  
+	  input->_internal->fhandle = CreateFileA(path,GENERIC_READ,FILE_SHARE_READ, 0,OPEN_EXISTING,0,0);
+
 	  //Check if a valid fhandle was retrieved
-	  if (_internal->fhandle < 0){
+	  if (input->_internal->fhandle < 0){
 		_cl_dword_t err = GetLastError();
         if ( err == ERROR_FILE_NOT_FOUND )
-		    _CLTHROWA(CL_ERR_IO, "File does not exist");
+		    error.set(CL_ERR_IO, "File does not exist");
         else if ( err == ERROR_ACCESS_DENIED )
-            _CLTHROWA(ERROR_ACCESS_DENIED, "File Access denied");
+            error.set(CL_ERR_IO, "File Access denied");
         else if ( err == ERROR_TOO_MANY_OPEN_FILES )
-            _CLTHROWA(CL_ERR_IO, "Too many open files");
+            error.set(CL_ERR_IO, "Too many open files");
 		else
-			_CLTHROWA(CL_ERR_IO, "File IO Error");
+			error.set(CL_ERR_IO, "File IO Error");
+		input->_internal->fhandle = NULL;
+		_CLDELETE(input);
+		return false;
 	  }
 
-	  _cl_dword_t dummy=0;
-	  _internal->_length = GetFileSize(_internal->fhandle, &dummy);
-
-	  if ( _internal->_length > 0 ){
-			_internal->mmaphandle = CreateFileMappingA(_internal->fhandle,NULL,PAGE_READONLY,0,0,NULL);
-			if ( _internal->mmaphandle != NULL ){
-				void* address = MapViewOfFile(_internal->mmaphandle,FILE_MAP_READ,0,0,0);
-				if ( address != NULL ){
-					_internal->data = (uint8_t*)address;
-					return; //SUCCESS!
-				}
-			}
-			
-			//failure:
-			int errnum = GetLastError(); 
-			
-			CloseHandle(_internal->mmaphandle);
-	
-			char* lpMsgBuf=strerror(errnum);
-			size_t len = strlen(lpMsgBuf)+80;
-			char* errstr = _CL_NEWARRAY(char, len); 
-			cl_sprintf(errstr, "MMapIndexInput::MMapIndexInput failed with error %d: %s", len, errnum, lpMsgBuf); 
-	
-			_CLTHROWA_DEL(CL_ERR_IO,errstr);
-	  }
+	  _cl_dword_t high=0;
+	  _cl_dword_t low = GetFileSize(input->_internal->fhandle, &high);
+	  input->_length = ((int64_t)high << 32) | low;
 
+	  if ( input->_length > 0 ){
+		input->_internal->mmaphandle = CreateFileMappingA(input->_internal->fhandle,NULL,PAGE_READONLY,0,0,NULL);
+		if ( input->_internal->mmaphandle == NULL ){
+			error.set(CL_ERR_IO, "CreateFileMapping failed");
+			_CLDELETE(input);
+			return false;
+		}
+	  }
 #else //_CL_HAVE_FUNCTION_MAPVIEWOFFILE
-	 _internal->fhandle = ::open (path, O_RDONLY);
-  	 if (_internal->fhandle < 0){
-		_CLTHROWA(CL_ERR_IO,strerror(errno));	
-  	 }else{
-		// stat it
-		struct stat sb;
-		if (::fstat (_internal->fhandle, &sb)){
-			_CLTHROWA(CL_ERR_IO,strerror(errno));
-		}else{
-			// get length from stat
-			_internal->_length = sb.st_size;
-			
-			// mmap the file
-			void* address = ::mmap(0, _internal->_length, PROT_READ, MAP_SHARED, _internal->fhandle, 0);
-			if (address == MAP_FAILED){
-				_CLTHROWA(CL_ERR_IO,strerror(errno));
-			}else{
-				_internal->data = (uint8_t*)address;
-			}
+	  input->_internal->fhandle = ::open (path, O_RDONLY);
+	  if (input->_internal->fhandle < 0){
+		int err = errno;
+		if ( err == ENOENT )
+			error.set(CL_ERR_IO, "File does not exist");
+		else if ( err == EACCES )
+			error.set(CL_ERR_IO, "File Access denied");
+		else if ( err == EMFILE )
+			error.set(CL_ERR_IO, "Too many open files");
+		else
+			error.set(CL_ERR_IO, "Could not open file");
+		_CLDELETE(input);
+		return false;
+	  }
+	  input->_length = fileSize(input->_internal->fhandle);
+	  if ( input->_length < 0 ){
+		error.set(CL_ERR_IO, "fileStat error");
+		_CLDELETE(input);
+		return false;
+	  }
+#endif
+
+	  const int64_t chunkSize = _ILONGLONG(1) << input->chunkSizePower;
+	  input->numChunks = (int32_t)((input->_length + chunkSize - 1) >> input->chunkSizePower);
+	  if ( input->numChunks > 0 ){
+		input->chunks = _CL_NEWARRAY(uint8_t*, input->numChunks);
+		memset(input->chunks, 0, input->numChunks * sizeof(uint8_t*));
+	  }
+	  input->_internal->chunks = input->chunks;
+	  input->_internal->numChunks = input->numChunks;
+	  input->_internal->chunkSizePower = input->chunkSizePower;
+	  input->_internal->length = input->_length;
+
+	  for ( int32_t i=0;i<input->numChunks;i++ ){
+		int64_t offset = (int64_t)i << input->chunkSizePower;
+		int64_t len = input->_length - offset;
+		if ( len > chunkSize )
+			len = chunkSize;
+#if defined(_CL_HAVE_FUNCTION_MAPVIEWOFFILE)
+		void* address = MapViewOfFile(input->_internal->mmaphandle,FILE_MAP_READ,
+			(_cl_dword_t)(offset >> 32), (_cl_dword_t)(offset & 0xFFFFFFFF), (_cl_dword_t)len);
+		if ( address == NULL ){
+			error.set(CL_ERR_IO, "MapViewOfFile failed");
+			_CLDELETE(input);
+			return false;
 		}
-  	 }
+#else
+		void* address = ::mmap(0, (size_t)len, PROT_READ, MAP_SHARED, input->_internal->fhandle, (off_t)offset);
+		if ( address == MAP_FAILED ){
+			error.set(CL_ERR_IO, strerror(errno));
+			_CLDELETE(input);
+			return false;
+		}
+	#ifdef _CL_HAVE_FUNCTION_MADVISE
+		if ( advice != MMapDirectory::ADVICE_NORMAL )
+			::madvise(address, (size_t)len, toMAdvice(advice)); //only a hint, failure is not an error
+	#endif
 #endif
+		input->chunks[i] = (uint8_t*)address;
+	  }
+
+	  input->setChunk(0);
+	  ret = input;
+	  return true;
   }
 
-  MMapIndexInput::MMapIndexInput(const MMapIndexInput& clone): IndexInput(clone){
+  MMapIndexInput::MMapIndexInput(const MMapIndexInput& clone):
+	IndexInput(clone),
+	_internal(clone._internal),
+	chunks(clone.chunks),
+	numChunks(clone.numChunks),
+	chunkSizePower(clone.chunkSizePower),
+	_length(clone._length),
+	curChunk(clone.curChunk),
+	cur(clone.cur),
+	curEnd(clone.curEnd)
+  {
   //Func - Constructor
-  //       Uses clone for its initialization
-  //Pre  - clone is a valide instance of FSIndexInput
+  //       Uses clone for its initialization. Shares the mapped chunks of clone,
+  //       so that no system call is needed.
+  //Pre  - clone is a valid instance of MMapIndexInput
   //Post - The instance has been created and initialized by clone
-        _internal = _CLNEW Internal;
-        
-#if defined(_CL_HAVE_FUNCTION_MAPVIEWOFFILE)
-	  _internal->mmaphandle = NULL;
-	  _internal->fhandle = NULL;
-#endif
-
-	  _internal->data = clone._internal->data;
-	  _internal->pos = clone._internal->pos;
+	if ( _internal != NULL )
+		_LUCENE_ATOMIC_INC(&_internal->refCount);
+  }
 
-	  //clone the file length
-	  _internal->_length  = clone._internal->_length;
-	  //Keep in mind that this instance is a clone
-	  _internal->isClone = true;
+  void MMapIndexInput::setChunk(int32_t chunk){
+	curChunk = chunk;
+	if ( numChunks == 0 ){
+		cur = curEnd = NULL;
+		return;
+	}
+	cur = chunks[chunk];
+	if ( chunk < numChunks-1 )
+		curEnd = cur + (_ILONGLONG(1) << chunkSizePower);
+	else
+		curEnd = cur + (_length - ((int64_t)chunk << chunkSizePower));
   }
 
-  uint8_t MMapIndexInput::readByte(){
-	  return *(_internal->data+(_internal->pos++));
+  void MMapIndexInput::nextChunk(){
+	if ( curChunk+1 >= numChunks )
+		_CLTHROWA(CL_ERR_IO, "read past EOF");
+	setChunk(curChunk+1);
   }
 
   void MMapIndexInput::readBytes(uint8_t* b, const int32_t len){
-	memcpy(b, _internal->data+_internal->pos, len);
-	_internal->pos+=len;
+	int64_t remaining = len;
+	while ( remaining > 0 ){
+		int64_t available = curEnd - cur;
+		if ( remaining <= available ){
+			memcpy(b, cur, (size_t)remaining);
+			cur += remaining;
+			return;
+		}
+		if ( available > 0 ){
+			memcpy(b, cur, (size_t)available);
+			b += available;
+			remaining -= available;
+			cur = curEnd;
+		}
+		nextChunk();
+	}
   }
   int32_t MMapIndexInput::readVInt(){
-	  uint8_t b = *(_internal->data+(_internal->pos++));
-	  int32_t i = b & 0x7F;
-	  for (int shift = 7; (b & 0x80) != 0; shift += 7) {
-	    b = *(_internal->data+(_internal->pos++));
-	    i |= (b & 0x7F) << shift;
-	  }
-	  return i;
+	if ( curEnd - cur < 5 )
+		return IndexInput::readVInt(); //may cross a chunk boundary
+
+	uint8_t b = *cur++;
+	int32_t i = b & 0x7F;
+	for (int shift = 7; (b & 0x80) != 0; shift += 7) {
+		b = *cur++;
+		i |= (b & 0x7F) << shift;
+	}
+	return i;
   }
   int64_t MMapIndexInput::getFilePointer() const{
-	return _internal->pos;
+	if ( numChunks == 0 )
+		return 0;
+	return ((int64_t)curChunk << chunkSizePower) + (cur - chunks[curChunk]);
+  }
+  const uint8_t* MMapIndexInput::peekBuffer(int32_t& len){
+	const int64_t available = curEnd - cur;
+	len = available > LUCENE_INT32_MAX_SHOULDBE ? LUCENE_INT32_MAX_SHOULDBE : (int32_t)available;
+	return cur;
+  }
+  void MMapIndexInput::consumeBuffer(const int32_t len){
+	cur += len;
   }
   void MMapIndexInput::seek(const int64_t pos){
-	  this->_internal->pos=pos;
+	if ( pos < 0 )
+		_CLTHROWA(CL_ERR_IO, "IO Argument Error. Value must be a positive value.");
+	if ( pos > _length )
+		_CLTHROWA(CL_ERR_IO, "seek past EOF");
+	if ( numChunks == 0 )
+		return;
+
+	int32_t chunk = (int32_t)(pos >> chunkSizePower);
+	if ( chunk >= numChunks ){
+		//pos is the end of a file whose length is a multiple of the chunk size
+		setChunk(numChunks-1);
+		cur = curEnd;
+	}else{
+		setChunk(chunk);
+		cur += pos & ((_ILONGLONG(1) << chunkSizePower) - 1);
+	}
   }
-  int64_t MMapIndexInput::length() const{ return _internal->_length; }
+  int64_t MMapIndexInput::length() const{ return _length; }
+
+  const char* MMapIndexInput::getDirectoryType() const{ return MMapDirectory::getClassName(); }
 
   MMapIndexInput::~MMapIndexInput(){
   //Func - Destructor
@@ -247,37 +403,28 @@ CL_NS_USE(util)
   {
     return _CLNEW MMapIndexInput(*this);
   }
+  IndexInput* MMapIndexInput::mapBytes(const int64_t pos, const int64_t len, const uint8_t*& bytes){
+	if ( _internal == NULL || pos < 0 || len <= 0 || pos + len > _length )
+		return NULL;
+	const int32_t chunk = (int32_t)(pos >> chunkSizePower);
+	const int64_t offset = pos & ((_ILONGLONG(1) << chunkSizePower) - 1);
+	if ( offset + len > (_ILONGLONG(1) << chunkSizePower) )
+		return NULL; //crosses a chunk boundary
+	bytes = chunks[chunk] + offset;
+	return clone();
+  }
   void MMapIndexInput::close()  {
-	if ( !_internal->isClone ){
-#if defined(_CL_HAVE_FUNCTION_MAPVIEWOFFILE)
-		if ( _internal->data != NULL ){
-			if ( ! UnmapViewOfFile(_internal->data) ){
-				CND_PRECONDITION( false, "UnmapViewOfFile(data) failed"); //todo: change to rich error
-			}
-		}
-
-		if ( _internal->mmaphandle != NULL ){
-			if ( ! CloseHandle(_internal->mmaphandle) ){
-				CND_PRECONDITION( false, "CloseHandle(mmaphandle) failed");
-			}
-		}
-		if ( _internal->fhandle != NULL ){
-			if ( !CloseHandle(_internal->fhandle) ){
-				CND_PRECONDITION( false, "CloseHandle(fhandle) failed");
-			}
-		}
-		_internal->mmaphandle = NULL;
-		_internal->fhandle = NULL;
-#else
-		if ( _internal->data != NULL )
-	  		::munmap(_internal->data, _internal->_length);
-	  	if ( _internal->fhandle > 0 )
-	  		::close(_internal->fhandle);
-	  	_internal->fhandle = 0;
-#endif
+	if ( _internal != NULL ){
+		//the mappings are unmapped with the last input using them
+		if ( _LUCENE_ATOMIC_DEC(&_internal->refCount) == 0 )
+			_CLDELETE(_internal);
+		_internal = NULL;
 	}
-	_internal->data = NULL;
-	_internal->pos = 0;
+	chunks = NULL;
+	numChunks = 0;
+	_length = 0;
+	curChunk = 0;
+	cur = curEnd = NULL;
   }
 
 
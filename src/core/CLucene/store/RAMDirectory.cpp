@@ -164,6 +164,22 @@ CL_NS_DEF(store)
     }
   }
 
+  void RAMOutputStream::writeTo(uint8_t* bytes){
+    flush();
+    const int64_t end = file->getLength();
+    int64_t pos = 0;
+    int32_t p = 0;
+    while (pos < end) {
+      int32_t length = BUFFER_SIZE;
+      int64_t nextPos = pos + length;
+      if (nextPos > end) {                        // at the last buffer
+        length = (int32_t)(end - pos);
+      }
+      memcpy(bytes + pos, file->getBuffer(p++), length);
+      pos = nextPos;
+    }
+  }
+
   void RAMOutputStream::reset(){
 	seek((int64_t)0);
     file->setLength((int64_t)0);
@@ -341,6 +357,19 @@ CL_NS_DEF(store)
 	  bufferPosition = (int32_t)(pos % BUFFER_SIZE);
   }
 
+  const uint8_t* RAMInputStream::peekBuffer(int32_t& len){
+	  if ( currentBuffer == NULL ){
+		  len = 0;
+		  return NULL;
+	  }
+	  len = bufferLength - bufferPosition;
+	  return currentBuffer + bufferPosition;
+  }
+
+  void RAMInputStream::consumeBuffer(const int32_t len){
+	  bufferPosition += len;
+  }
+
   void RAMInputStream::close() {
   }
 
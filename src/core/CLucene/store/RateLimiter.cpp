@@ -0,0 +1,151 @@
+/*------------------------------------------------------------------------------
+* Copyright (C) 2003-2006 Ben van Klinken and the CLucene Team
+*
+* Distributable under the terms of either the Apache License (Version 2.0) or
+* the GNU Lesser General Public License, as specified in the COPYING file.
+------------------------------------------------------------------------------*/
+#include "CLucene/_ApiHeader.h"
+#include "_RateLimiter.h"
+#include "CLucene/util/Misc.h"
+
+CL_NS_DEF(store)
+CL_NS_USE(util)
+
+  RateLimiter::RateLimiter(double mbPerSec):
+    mbPerSec(0),
+    msPerByte(0),
+    lastMs((double)Misc::currentTimeMillis())
+  {
+    setMbPerSec(mbPerSec);
+  }
+  RateLimiter::~RateLimiter(){
+  }
+
+  void RateLimiter::setMbPerSec(double mbPerSec){
+    SCOPED_LOCK_MUTEX(THIS_LOCK)
+    this->mbPerSec = mbPerSec;
+    this->msPerByte = mbPerSec > 0 ? 1000.0 / (mbPerSec * 1024 * 1024) : 0;
+  }
+  double RateLimiter::getMbPerSec() const{
+    return mbPerSec;
+  }
+
+  int64_t RateLimiter::pause(int64_t bytes){
+    double targetMs;
+    const double now = (double)Misc::currentTimeMillis();
+    {
+      SCOPED_LOCK_MUTEX(THIS_LOCK)
+      if ( msPerByte == 0 )
+        return 0;
+      //the bytes of all writers are queued one after the other, so that
+      //concurrent writers share the rate
+      lastMs += bytes * msPerByte;
+      if ( lastMs < now )
+        lastMs = now;
+      targetMs = lastMs;
+    }
+    const int64_t pauseMs = (int64_t)(targetMs - now);
+    if ( pauseMs > 0 )
+      _LUCENE_SLEEP((int)pauseMs);
+    return pauseMs > 0 ? pauseMs : 0;
+  }
+
+
+  RateLimitedIndexOutput::RateLimitedIndexOutput(IndexOutput* delegate, RateLimiter* rateLimiter):
+    delegate(delegate),
+    rateLimiter(rateLimiter),
+    bytesSincePause(0)
+  {
+  }
+  RateLimitedIndexOutput::~RateLimitedIndexOutput(){
+    _CLDELETE(delegate);
+  }
+  void RateLimitedIndexOutput::writeByte(const uint8_t b){
+    delegate->writeByte(b);
+    bytesSincePause++;
+    checkRate();
+  }
+  void RateLimitedIndexOutput::writeBytes(const uint8_t* b, const int32_t length){
+    delegate->writeBytes(b, length);
+    bytesSincePause += length;
+    checkRate();
+  }
+  void RateLimitedIndexOutput::close(){
+    delegate->close();
+    //account for the tail, small files would otherwise never pause
+    if ( bytesSincePause > 0 ){
+      rateLimiter->pause(bytesSincePause);
+      bytesSincePause = 0;
+    }
+  }
+  int64_t RateLimitedIndexOutput::getFilePointer() const{
+    return delegate->getFilePointer();
+  }
+  void RateLimitedIndexOutput::seek(const int64_t pos){
+    delegate->seek(pos);
+  }
+  int64_t RateLimitedIndexOutput::length() const{
+    return delegate->length();
+  }
+  void RateLimitedIndexOutput::flush(){
+    delegate->flush();
+  }
+
+
+  RateLimitedDirectory::RateLimitedDirectory(Directory* delegate, RateLimiter* rateLimiter):
+    Directory(),
+    delegate(delegate),
+    rateLimiter(rateLimiter)
+  {
+  }
+  RateLimitedDirectory::~RateLimitedDirectory(){
+  }
+  bool RateLimitedDirectory::doDeleteFile(const char* name){
+    return delegate->deleteFile(name, false);
+  }
+  bool RateLimitedDirectory::list(std::vector<std::string>* names) const{
+    return delegate->list(names);
+  }
+  bool RateLimitedDirectory::fileExists(const char* name) const{
+    return delegate->fileExists(name);
+  }
+  int64_t RateLimitedDirectory::fileModified(const char* name) const{
+    return delegate->fileModified(name);
+  }
+  int64_t RateLimitedDirectory::fileLength(const char* name) const{
+    return delegate->fileLength(name);
+  }
+  bool RateLimitedDirectory::openInput(const char* name, IndexInput*& ret, CLuceneError& error, int32_t bufferSize){
+    return delegate->openInput(name, ret, error, bufferSize);
+  }
+  void RateLimitedDirectory::touchFile(const char* name){
+    delegate->touchFile(name);
+  }
+  void RateLimitedDirectory::renameFile(const char* from, const char* to){
+    delegate->renameFile(from, to);
+  }
+  IndexOutput* RateLimitedDirectory::createOutput(const char* name){
+    return _CLNEW RateLimitedIndexOutput(delegate->createOutput(name), rateLimiter);
+  }
+  LuceneLock* RateLimitedDirectory::makeLock(const char* name){
+    return delegate->makeLock(name);
+  }
+  void RateLimitedDirectory::clearLock(const char* name){
+    delegate->clearLock(name);
+  }
+  void RateLimitedDirectory::close(){
+  }
+  std::string RateLimitedDirectory::toString() const{
+    return delegate->toString();
+  }
+  std::string RateLimitedDirectory::getLockID(){
+    return delegate->getLockID();
+  }
+  const char* RateLimitedDirectory::getClassName(){
+    return "RateLimitedDirectory";
+  }
+  const char* RateLimitedDirectory::getObjectName() const{
+    return getClassName();
+  }
+
+CL_NS_END
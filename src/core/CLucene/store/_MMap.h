@@ -1,7 +1,7 @@
 /*------------------------------------------------------------------------------
 * Copyright (C) 2003-2006 Ben van Klinken and the CLucene Team
-* 
-* Distributable under the terms of either the Apache License (Version 2.0) or 
+*
+* Distributable under the terms of either the Apache License (Version 2.0) or
 * the GNU Lesser General Public License, as specified in the COPYING file.
 ------------------------------------------------------------------------------*/
 #ifndef _lucene_store_MMap_
@@ -9,28 +9,66 @@
 
 #include "IndexInput.h"
 
+#if defined(_CL_HAVE_FUNCTION_MMAP) || defined(_CL_HAVE_FUNCTION_MAPVIEWOFFILE)
+	#define _CL_HAVE_MMAP_INPUT
+#endif
+
+#ifdef _CL_HAVE_MMAP_INPUT
 CL_NS_DEF(store)
 
+	/**
+	* An IndexInput reading a memory mapped file. The file is mapped in chunks
+	* of a power of two size, so that big files do not need one big contiguous
+	* mapping. Clones share the chunks of the original input, which are
+	* unmapped once the input and all its clones are closed.
+	*/
 	class MMapIndexInput: public IndexInput{
 		class Internal;
-		Internal* _internal;
+		Internal* _internal; //the shared mappings, NULL once closed
+
+		uint8_t** chunks;
+		int32_t numChunks;
+		int32_t chunkSizePower;
+		int64_t _length;
+
+		int32_t curChunk;
+		const uint8_t* cur;
+		const uint8_t* curEnd;
+
+		void setChunk(int32_t chunk);
+		void nextChunk();
 
 		MMapIndexInput(const MMapIndexInput& clone);
+		MMapIndexInput();
 	public:
-		MMapIndexInput(const char* path);
+		/**
+		* Opens and maps the file named path.
+		* @param maxChunkSize the maximum size of a mapping, must be a power of two
+		* @param advice one of the MMapDirectory::Advice values
+		*/
+		static bool open(const char* path, IndexInput*& ret, CLuceneError& error, int64_t maxChunkSize, int32_t advice);
 		~MMapIndexInput();
 		IndexInput* clone() const;
 
-		inline uint8_t readByte();
+		inline uint8_t readByte(){
+			if ( cur == curEnd )
+				nextChunk();
+			return *cur++;
+		}
 		int32_t readVInt();
 		void readBytes(uint8_t* b, const int32_t len);
 		void close();
 		int64_t getFilePointer() const;
 		void seek(const int64_t pos);
 		int64_t length() const;
+		const uint8_t* peekBuffer(int32_t& len);
+		void consumeBuffer(const int32_t len);
+		IndexInput* mapBytes(const int64_t pos, const int64_t len, const uint8_t*& bytes);
 
-		const char* getObjectName(){ return MMapIndexInput::getClassName(); }
-		static const char* getClassName(){ return "MMapIndexInput"; }			
+		const char* getDirectoryType() const;
+		const char* getObjectName() const{ return MMapIndexInput::getClassName(); }
+		static const char* getClassName(){ return "MMapIndexInput"; }
 	};
 CL_NS_END
 #endif
+#endif
@@ -98,6 +98,8 @@ CL_NS_DEF(store)
     void reset();
     /** Copy the current contents of this buffer to the named output. */
     void writeTo(IndexOutput* output);
+    /** Copy the current contents of this buffer to bytes, which must hold length() bytes. */
+    void writeTo(uint8_t* bytes);
         
   	void writeByte(const uint8_t b);
   	void writeBytes(const uint8_t* b, const int32_t len);
@@ -148,6 +150,8 @@ CL_NS_DEF(store)
 		int64_t getFilePointer() const;
 		
 		void seek(const int64_t pos);
+		const uint8_t* peekBuffer(int32_t& len);
+		void consumeBuffer(const int32_t len);
 		const char* getDirectoryType() const;
 		const char* getObjectName() const;
 		static const char* getClassName();
@@ -0,0 +1,108 @@
+/*------------------------------------------------------------------------------
+* Copyright (C) 2003-2006 Ben van Klinken and the CLucene Team
+*
+* Distributable under the terms of either the Apache License (Version 2.0) or
+* the GNU Lesser General Public License, as specified in the COPYING file.
+------------------------------------------------------------------------------*/
+#ifndef _lucene_store_RateLimiter_
+#define _lucene_store_RateLimiter_
+
+#include "Directory.h"
+#include "IndexOutput.h"
+
+CL_NS_DEF(store)
+
+  /**
+  * Limits the rate at which bytes are written by one or more threads.
+  * Writers report the bytes they wrote with {@link #pause}, which sleeps
+  * as long as needed to keep the total rate under the configured limit.
+  */
+  class RateLimiter: LUCENE_BASE{
+  private:
+    double mbPerSec;
+    double msPerByte;
+    double lastMs; //time at which the bytes reported so far are allowed to be written
+    DEFINE_MUTEX(THIS_LOCK)
+  public:
+    /** @param mbPerSec the maximum rate in MB per second, 0 disables the limit */
+    RateLimiter(double mbPerSec);
+    ~RateLimiter();
+
+    void setMbPerSec(double mbPerSec);
+    double getMbPerSec() const;
+
+    /**
+    * Records that bytes were written and sleeps until writing them is
+    * within the rate limit.
+    * @return the number of milliseconds slept
+    */
+    int64_t pause(int64_t bytes);
+  };
+
+  /**
+  * Wraps an IndexOutput, pausing on the given RateLimiter every few
+  * kilobytes written.
+  * @memory the wrapped output is owned by this output
+  */
+  class RateLimitedIndexOutput: public IndexOutput{
+  private:
+    IndexOutput* delegate;
+    RateLimiter* rateLimiter;
+    int32_t bytesSincePause;
+
+    inline void checkRate(){
+      if ( bytesSincePause >= MIN_PAUSE_BYTES ){
+        rateLimiter->pause(bytesSincePause);
+        bytesSincePause = 0;
+      }
+    }
+  public:
+    LUCENE_STATIC_CONSTANT(int32_t, MIN_PAUSE_BYTES=8192);
+
+    RateLimitedIndexOutput(IndexOutput* delegate, RateLimiter* rateLimiter);
+    ~RateLimitedIndexOutput();
+
+    void writeByte(const uint8_t b);
+    void writeBytes(const uint8_t* b, const int32_t length);
+    void close();
+    int64_t getFilePointer() const;
+    void seek(const int64_t pos);
+    int64_t length() const;
+    void flush();
+  };
+
+  /**
+  * A Directory that forwards everything to another directory, but rate
+  * limits the outputs it creates. Used to throttle merges.
+  * @memory the wrapped directory is not owned
+  */
+  class RateLimitedDirectory: public Directory{
+  private:
+    Directory* delegate;
+    RateLimiter* rateLimiter;
+  protected:
+    bool doDeleteFile(const char* name);
+  public:
+    RateLimitedDirectory(Directory* delegate, RateLimiter* rateLimiter);
+    ~RateLimitedDirectory();
+
+    bool list(std::vector<std::string>* names) const;
+    bool fileExists(const char* name) const;
+    int64_t fileModified(const char* name) const;
+    int64_t fileLength(const char* name) const;
+    bool openInput(const char* name, IndexInput*& ret, CLuceneError& error, int32_t bufferSize = -1);
+    void touchFile(const char* name);
+    void renameFile(const char* from, const char* to);
+    IndexOutput* createOutput(const char* name);
+    LuceneLock* makeLock(const char* name);
+    void clearLock(const char* name);
+    void close();
+    std::string toString() const;
+    std::string getLockID();
+
+    static const char* getClassName();
+    const char* getObjectName() const;
+  };
+
+CL_NS_END
+#endif
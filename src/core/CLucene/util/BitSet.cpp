@@ -14,40 +14,85 @@ CL_NS_USE(store)
 CL_NS_DEF(util)
 
 
-const uint8_t BitSet::BYTE_COUNTS[256] = {
-    0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4,
-    1, 2, 2, 3, 2, 3, 3, 4, 2, 3, 3, 4, 3, 4, 4, 5,
-    1, 2, 2, 3, 2, 3, 3, 4, 2, 3, 3, 4, 3, 4, 4, 5,
-    2, 3, 3, 4, 3, 4, 4, 5, 3, 4, 4, 5, 4, 5, 5, 6,
-    1, 2, 2, 3, 2, 3, 3, 4, 2, 3, 3, 4, 3, 4, 4, 5,
-    2, 3, 3, 4, 3, 4, 4, 5, 3, 4, 4, 5, 4, 5, 5, 6,
-    2, 3, 3, 4, 3, 4, 4, 5, 3, 4, 4, 5, 4, 5, 5, 6,
-    3, 4, 4, 5, 4, 5, 5, 6, 4, 5, 5, 6, 5, 6, 6, 7,
-    1, 2, 2, 3, 2, 3, 3, 4, 2, 3, 3, 4, 3, 4, 4, 5,
-    2, 3, 3, 4, 3, 4, 4, 5, 3, 4, 4, 5, 4, 5, 5, 6,
-    2, 3, 3, 4, 3, 4, 4, 5, 3, 4, 4, 5, 4, 5, 5, 6,
-    3, 4, 4, 5, 4, 5, 5, 6, 4, 5, 5, 6, 5, 6, 6, 7,
-    2, 3, 3, 4, 3, 4, 4, 5, 3, 4, 4, 5, 4, 5, 5, 6,
-    3, 4, 4, 5, 4, 5, 5, 6, 4, 5, 5, 6, 5, 6, 6, 7,
-    3, 4, 4, 5, 4, 5, 5, 6, 4, 5, 5, 6, 5, 6, 6, 7,
-    4, 5, 5, 6, 5, 6, 6, 7, 5, 6, 6, 7, 6, 7, 7, 8};
+//number of one bits in a word
+static inline int32_t bitCount(uint64_t w){
+#if defined(__GNUC__)
+	return __builtin_popcountll(w);
+#else
+	w = w - ((w >> 1) & 0x5555555555555555ULL);
+	w = (w & 0x3333333333333333ULL) + ((w >> 2) & 0x3333333333333333ULL);
+	w = (w + (w >> 4)) & 0x0F0F0F0F0F0F0F0FULL;
+	return (int32_t)((w * 0x0101010101010101ULL) >> 56);
+#endif
+}
+
+//index of the lowest one bit of a non zero word
+static inline int32_t trailingZeros(uint64_t w){
+#if defined(__GNUC__)
+	return __builtin_ctzll(w);
+#else
+	return bitCount((w & (0-w)) - 1);
+#endif
+}
+
+class BitSetIterator: public CL_NS(search)::DocIdSetIterator {
+	const BitSet* bits;
+	int32_t _doc;
+public:
+	BitSetIterator(const BitSet* bits):
+		bits(bits),
+		_doc(-1)
+	{
+	}
+	int32_t doc() const{
+		return _doc;
+	}
+	bool next(){
+		return skipTo(_doc+1);
+	}
+	bool skipTo(int32_t target){
+		if ( target <= _doc )
+			target = _doc+1;
+		_doc = bits->nextSetBit(target);
+		if ( _doc == -1 ){
+			_doc = LUCENE_INT32_MAX_SHOULDBE;
+			return false;
+		}
+		return true;
+	}
+};
+
+int32_t BitSet::numWords(int32_t size){
+	return (size >> 6) + 1;
+}
+uint8_t BitSet::getByte(int32_t i) const{
+	return (uint8_t)(bits[i >> 3] >> ((i & 7) << 3));
+}
+void BitSet::setByte(int32_t i, uint8_t b){
+	const int32_t shift = (i & 7) << 3;
+	bits[i >> 3] = (bits[i >> 3] & ~(((uint64_t)0xFF) << shift)) | (((uint64_t)b) << shift);
+}
+void BitSet::clearTail(){
+	bits[_size >> 6] &= (((uint64_t)1) << (_size & 63)) - 1;
+}
 
 BitSet::BitSet( const BitSet& copy ) :
+	CL_NS(search)::DocIdSet(),
 	_size( copy._size ),
 	_count(-1)
 {
-	int32_t len = (_size >> 3) + 1;
-	bits = _CL_NEWARRAY(uint8_t, len);
-	memcpy( bits, copy.bits, len );
+	int32_t len = numWords(_size);
+	bits = _CL_NEWARRAY(uint64_t, len);
+	memcpy( bits, copy.bits, len * sizeof(uint64_t) );
 }
 
 BitSet::BitSet ( int32_t size ):
   _size(size),
   _count(-1)
 {
-	int32_t len = (_size >> 3) + 1;
-	bits = _CL_NEWARRAY(uint8_t, len);
-	memset(bits,0,len);
+	int32_t len = numWords(_size);
+	bits = _CL_NEWARRAY(uint64_t, len);
+	memset(bits,0,len * sizeof(uint64_t));
 }
 
 BitSet::BitSet(CL_NS(store)::Directory* d, const char* name)
@@ -93,9 +138,50 @@ void BitSet::set(const int32_t bit, bool val){
 	_count = -1;
 
 	if (val)
-		bits[bit >> 3] |= 1 << (bit & 7);
+		bits[bit >> 6] |= ((uint64_t)1) << (bit & 63);
 	else
-		bits[bit >> 3] &= ~(1 << (bit & 7));
+		bits[bit >> 6] &= ~(((uint64_t)1) << (bit & 63));
+}
+
+void BitSet::andBits(const BitSet* other){
+	const int32_t len = numWords(_size);
+	const int32_t common = cl_min(len, numWords(other->_size));
+	for ( int32_t i=0;i<common;i++ )
+		bits[i] &= other->bits[i];
+	for ( int32_t i=common;i<len;i++ )
+		bits[i] = 0;
+	_count = -1;
+}
+void BitSet::orBits(const BitSet* other){
+	const int32_t common = cl_min(numWords(_size), numWords(other->_size));
+	for ( int32_t i=0;i<common;i++ )
+		bits[i] |= other->bits[i];
+	clearTail();
+	_count = -1;
+}
+void BitSet::andNotBits(const BitSet* other){
+	const int32_t common = cl_min(numWords(_size), numWords(other->_size));
+	for ( int32_t i=0;i<common;i++ )
+		bits[i] &= ~other->bits[i];
+	_count = -1;
+}
+void BitSet::xorBits(const BitSet* other){
+	const int32_t common = cl_min(numWords(_size), numWords(other->_size));
+	for ( int32_t i=0;i<common;i++ )
+		bits[i] ^= other->bits[i];
+	clearTail();
+	_count = -1;
+}
+void BitSet::flip(){
+	const int32_t len = numWords(_size);
+	for ( int32_t i=0;i<len;i++ )
+		bits[i] = ~bits[i];
+	clearTail();
+	_count = -1;
+}
+void BitSet::clear(){
+	memset(bits, 0, numWords(_size) * sizeof(uint64_t));
+	_count = 0;
 }
 
 int32_t BitSet::size() const {
@@ -106,9 +192,9 @@ int32_t BitSet::count(){
     if (_count == -1) {
 
       int32_t c = 0;
-      int32_t end = (_size >> 3) + 1;
+      int32_t end = numWords(_size);
       for (int32_t i = 0; i < end; i++)
-        c += BYTE_COUNTS[bits[i]];	  // sum bits per uint8_t
+        c += bitCount(bits[i]);	  // sum bits per word
       _count = c;
     }
     return _count;
@@ -116,25 +202,42 @@ int32_t BitSet::count(){
 BitSet* BitSet::clone() const {
 	return _CLNEW BitSet( *this );
 }
+CL_NS(search)::DocIdSetIterator* BitSet::iterator() const {
+	return _CLNEW BitSetIterator(this);
+}
 
   /** Read as a bit set */
   void BitSet::readBits(IndexInput* input) {
     _count = input->readInt();        // read count
-    bits = _CL_NEWARRAY(uint8_t,(_size >> 3) + 1);      // allocate bits
-    input->readBytes(bits, (_size >> 3) + 1);   // read bits
+    const int32_t len = numWords(_size);
+    bits = _CL_NEWARRAY(uint64_t, len);      // allocate bits
+    memset(bits, 0, len * sizeof(uint64_t));
+    uint8_t buf[512];
+    const int32_t nbytes = (_size >> 3) + 1;
+    for (int32_t i = 0; i < nbytes; ) {       // read bits
+      const int32_t chunk = cl_min((int32_t)sizeof(buf), nbytes - i);
+      input->readBytes(buf, chunk);
+      for (int32_t j = 0; j < chunk; j++)
+        bits[(i+j) >> 3] |= ((uint64_t)buf[j]) << (((i+j) & 7) << 3);
+      i += chunk;
+    }
+    clearTail();
   }
 
   /** read as a d-gaps list */
   void BitSet::readDgaps(IndexInput* input) {
     _size = input->readInt();       // (re)read size
     _count = input->readInt();        // read count
-    bits = _CL_NEWARRAY(uint8_t,(_size >> 3) + 1);     // allocate bits
+    const int32_t len = numWords(_size);
+    bits = _CL_NEWARRAY(uint64_t, len);     // allocate bits
+    memset(bits, 0, len * sizeof(uint64_t));
     int32_t last=0;
     int32_t n = count();
     while (n>0) {
       last += input->readVInt();
-      bits[last] = input->readByte();
-      n -= BYTE_COUNTS[bits[last] & 0xFF];
+      uint8_t b = input->readByte();
+      setByte(last, b);
+      n -= bitCount(b);
     }
   }
 
@@ -142,7 +245,15 @@ BitSet* BitSet::clone() const {
    void BitSet::writeBits(IndexOutput* output) {
     output->writeInt(size());       // write size
     output->writeInt(count());        // write count
-    output->writeBytes(bits, (_size >> 3) + 1);   // write bits
+    uint8_t buf[512];
+    const int32_t nbytes = (_size >> 3) + 1;
+    for (int32_t i = 0; i < nbytes; ) {       // write bits
+      const int32_t chunk = cl_min((int32_t)sizeof(buf), nbytes - i);
+      for (int32_t j = 0; j < chunk; j++)
+        buf[j] = getByte(i+j);
+      output->writeBytes(buf, chunk);
+      i += chunk;
+    }
   }
 
   /** Write as a d-gaps list */
@@ -154,11 +265,16 @@ BitSet* BitSet::clone() const {
     int32_t n = count();
     int32_t m = (_size >> 3) + 1;
     for (int32_t i=0; i<m && n>0; i++) {
-      if (bits[i]!=0) {
+      if (bits[i >> 3] == 0) {
+        i |= 7; // skip the rest of an empty word
+        continue;
+      }
+      uint8_t b = getByte(i);
+      if (b!=0) {
         output->writeVInt(i-last);
-        output->writeByte(bits[i]);
+        output->writeByte(b);
         last = i;
-        n -= BYTE_COUNTS[bits[i] & 0xFF];
+        n -= bitCount(b);
       }
     }
   }
@@ -180,6 +296,28 @@ BitSet* BitSet::clone() const {
     return                            factor * (4 + (8+40)*count()) < size();
   }
 
+  bool BitSet::anySet(int32_t fromIndex, int32_t toIndex) const {
+      if (fromIndex < 0 || toIndex >= _size)
+          _CLTHROWA(CL_ERR_IndexOutOfBounds, "bit out of range");
+      if (fromIndex > toIndex)
+          return false;
+
+      const int32_t first = fromIndex >> 6;
+      const int32_t last = toIndex >> 6;
+      const uint64_t firstMask = ~((uint64_t)0) << (fromIndex & 63);
+      const uint64_t lastMask = ~((uint64_t)0) >> (63 - (toIndex & 63));
+      if (first == last)
+          return (bits[first] & firstMask & lastMask) != 0;
+
+      if ((bits[first] & firstMask) != 0 || (bits[last] & lastMask) != 0)
+          return true;
+      for (int32_t i = first + 1; i < last; ++i) {
+          if (bits[i] != 0)
+              return true;
+      }
+      return false;
+  }
+
   int32_t BitSet::nextSetBit(int32_t fromIndex) const {
       if (fromIndex < 0)
           _CLTHROWT(CL_ERR_IndexOutOfBounds, _T("fromIndex < 0"));
@@ -187,12 +325,16 @@ BitSet* BitSet::clone() const {
       if (fromIndex >= _size)
           return -1;
 
-      while (true) {
-          if ((bits[fromIndex >> 3] & (1 << (fromIndex & 7))) != 0)
-              return fromIndex;
-          if (++fromIndex == _size)
+      // the bits at and beyond _size are always clear
+      int32_t i = fromIndex >> 6;
+      uint64_t word = bits[i] & (~((uint64_t)0) << (fromIndex & 63));
+      const int32_t len = numWords(_size);
+      while (word == 0) {
+          if (++i == len)
               return -1;
+          word = bits[i];
       }
+      return (i << 6) + trailingZeros(word);
   }
 
 CL_NS_END
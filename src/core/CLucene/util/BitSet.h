@@ -7,6 +7,7 @@
 #ifndef _lucene_util_BitSet_
 #define _lucene_util_BitSet_
 
+#include "CLucene/search/DocIdSet.h"
 
 CL_CLASS_DEF(store,Directory)
 CL_CLASS_DEF(store,IndexInput)
@@ -22,12 +23,24 @@ CL_NS_DEF(util)
   <li>optimized read from and write to disk;</li>
   <li>inlinable get() method;</li>
   <li>store and load, as bit set or d-gaps, depending on sparseness;</li> 
+  <li>word-wise set operations, for combining filters.</li>
   </ul>
+  The bits are held in 64 bit words, so counting, scanning and combining
+  handle 64 documents per step. The file format is byte oriented and does
+  not depend on the word size or byte order.
   */
-class CLUCENE_EXPORT BitSet:LUCENE_BASE {
+class CLUCENE_EXPORT BitSet: public CL_NS(search)::DocIdSet {
 	int32_t _size;
 	int32_t _count;
-	uint8_t *bits;
+	uint64_t *bits;
+
+  /** Number of words for a bit set of the given size. The bytes of the
+   file format, (size/8)+1 of them, always fit in these words. */
+  static int32_t numWords(int32_t size);
+  uint8_t getByte(int32_t i) const;
+  void setByte(int32_t i, uint8_t b);
+  /** Clears the bits at and beyond _size in the last word */
+  void clearTail();
 
   void readBits(CL_NS(store)::IndexInput* input);
   /** read as a d-gaps list */
@@ -38,7 +51,6 @@ class CLUCENE_EXPORT BitSet:LUCENE_BASE {
   void writeDgaps(CL_NS(store)::IndexOutput* output);
   /** Indicates if the bit vector is sparse and should be saved as a d-gaps list, or dense, and should be saved as a bit set. */
   bool isSparse();
-  static const uint8_t BYTE_COUNTS[256];
 protected:
 	BitSet( const BitSet& copy );
 
@@ -52,12 +64,11 @@ public:
 	~BitSet();
 	
 	///get the value of the specified bit
-	///get the value of the specified bit
     inline bool get(const int32_t bit) const{
         if (bit >= _size) {
             _CLTHROWA(CL_ERR_IndexOutOfBounds, "bit out of range");
         }
-        return (bits[bit >> 3] & (1 << (bit & 7))) != 0;
+        return (bits[bit >> 6] & (((uint64_t)1) << (bit & 63))) != 0;
     }
 
     /**
@@ -80,9 +91,30 @@ public:
     *
     */
     int32_t nextSetBit(int32_t fromIndex) const;
+
+    /**
+    * Returns true if any bit from fromIndex to toIndex (both inclusive)
+    * is set. Whole words are tested at once, so this is cheaper than
+    * calling get for every bit of a dense range.
+    */
+    bool anySet(int32_t fromIndex, int32_t toIndex) const;
 	
 	///set the value of the specified bit
 	void set(const int32_t bit, bool val=true);
+
+	/** Keeps only the bits which are also set in other. Bits beyond
+	* the size of other are cleared. */
+	void andBits(const BitSet* other);
+	/** Sets the bits which are set in other, up to the size of this set. */
+	void orBits(const BitSet* other);
+	/** Clears the bits which are set in other. */
+	void andNotBits(const BitSet* other);
+	/** Flips the bits which are set in other, up to the size of this set. */
+	void xorBits(const BitSet* other);
+	/** Flips every bit of the set. */
+	void flip();
+	/** Clears every bit of the set. */
+	void clear();
 	
 	///returns the size of the bitset
 	int32_t size() const;
@@ -92,6 +124,10 @@ public:
 	///	recomputation is done for repeated calls. 
 	int32_t count();
 	BitSet *clone() const;
+
+	/** Iterates over the set bits, see {@link #nextSetBit}. */
+	CL_NS(search)::DocIdSetIterator* iterator() const;
+	const BitSet* asBitSet() const{ return this; }
 };
 typedef BitSet BitVector; //Lucene now calls the BitSet a BitVector...
 
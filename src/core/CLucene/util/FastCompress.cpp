@@ -0,0 +1,157 @@
+/*------------------------------------------------------------------------------
+* Copyright (C) 2003-2006 Ben van Klinken and the CLucene Team
+*
+* Distributable under the terms of either the Apache License (Version 2.0) or
+* the GNU Lesser General Public License, as specified in the COPYING file.
+------------------------------------------------------------------------------*/
+#include "CLucene/_ApiHeader.h"
+#include "_FastCompress.h"
+
+CL_NS_DEF(util)
+
+static const int32_t LZ_MIN_MATCH = 4;
+static const int32_t LZ_MAX_OFFSET = 0xFFFF;
+// the format ends with at least this many literals...
+static const int32_t LZ_LAST_LITERALS = 5;
+// ...so no match may start this close to the end
+static const int32_t LZ_MATCH_LIMIT = 12;
+static const int32_t LZ_HASH_LOG = 12;
+static const int32_t LZ_RUN_MASK = 15;
+
+static inline uint32_t lzRead32(const uint8_t* p){
+	uint32_t v;
+	memcpy(&v, p, sizeof(v));
+	return v;
+}
+static inline int32_t lzHash(const uint32_t v){
+	return (int32_t)((v * 2654435761U) >> (32 - LZ_HASH_LOG));
+}
+static inline uint8_t* lzWriteLength(uint8_t* op, int32_t len){
+	for (; len >= 255; len -= 255)
+		*op++ = 255;
+	*op++ = (uint8_t)len;
+	return op;
+}
+static inline uint8_t* lzWriteSequence(uint8_t* op, const uint8_t* literals, const int32_t literalLength,
+	const int32_t offset, const int32_t matchLength)
+{
+	uint8_t* token = op++;
+	*token = (uint8_t)((literalLength < LZ_RUN_MASK ? literalLength : LZ_RUN_MASK) << 4);
+	if (literalLength >= LZ_RUN_MASK)
+		op = lzWriteLength(op, literalLength - LZ_RUN_MASK);
+	memcpy(op, literals, literalLength);
+	op += literalLength;
+	if (matchLength == 0) //the last sequence has no match
+		return op;
+
+	*op++ = (uint8_t)offset;
+	*op++ = (uint8_t)(offset >> 8);
+	const int32_t ml = matchLength - LZ_MIN_MATCH;
+	*token |= (uint8_t)(ml < LZ_RUN_MASK ? ml : LZ_RUN_MASK);
+	if (ml >= LZ_RUN_MASK)
+		op = lzWriteLength(op, ml - LZ_RUN_MASK);
+	return op;
+}
+static inline int32_t lzReadLength(const uint8_t*& ip, const uint8_t* end, int32_t len, const int32_t max){
+	uint8_t b;
+	do{
+		if (ip >= end)
+			_CLTHROWA(CL_ERR_CorruptIndex, "compressed block is truncated");
+		b = *ip++;
+		len += b;
+		if (len > max)
+			_CLTHROWA(CL_ERR_CorruptIndex, "compressed block is longer than expected");
+	}while (b == 255);
+	return len;
+}
+
+int32_t FastCompress::maxCompressedLength(const int32_t len){
+	return len + len / 255 + 16;
+}
+
+int32_t FastCompress::compress(const uint8_t* src, const int32_t len, uint8_t* dest){
+	uint8_t* op = dest;
+	int32_t anchor = 0;
+
+	if (len > LZ_MATCH_LIMIT){
+		int32_t table[1 << LZ_HASH_LOG];
+		memset(table, 0xFF, sizeof(table));
+
+		const int32_t matchLimit = len - LZ_MATCH_LIMIT;
+		int32_t ip = 0;
+		int32_t misses = 0;
+		while (ip < matchLimit){
+			const uint32_t seq = lzRead32(src + ip);
+			const int32_t h = lzHash(seq);
+			const int32_t ref = table[h];
+			table[h] = ip;
+			if (ref < 0 || ip - ref > LZ_MAX_OFFSET || lzRead32(src + ref) != seq){
+				// step faster over data which doesn't compress
+				ip += 1 + (misses++ >> 6);
+				continue;
+			}
+			misses = 0;
+
+			int32_t matchLength = LZ_MIN_MATCH;
+			const int32_t maxLength = len - LZ_LAST_LITERALS - ip;
+			while (matchLength < maxLength && src[ref + matchLength] == src[ip + matchLength])
+				matchLength++;
+
+			op = lzWriteSequence(op, src + anchor, ip - anchor, ip - ref, matchLength);
+			ip += matchLength;
+			anchor = ip;
+		}
+	}
+
+	return (int32_t)(lzWriteSequence(op, src + anchor, len - anchor, 0, 0) - dest);
+}
+
+void FastCompress::decompress(const uint8_t* src, const int32_t srcLen, uint8_t* dest, const int32_t destLen){
+	const uint8_t* ip = src;
+	const uint8_t* end = src + srcLen;
+	int32_t op = 0;
+
+	while (ip < end){
+		const uint8_t token = *ip++;
+
+		int32_t literalLength = token >> 4;
+		if (literalLength == LZ_RUN_MASK)
+			literalLength = lzReadLength(ip, end, literalLength, destLen);
+		if (literalLength > end - ip || literalLength > destLen - op)
+			_CLTHROWA(CL_ERR_CorruptIndex, "compressed block is longer than expected");
+		memcpy(dest + op, ip, literalLength);
+		ip += literalLength;
+		op += literalLength;
+		if (ip == end) //the last sequence has no match
+			break;
+
+		if (end - ip < 2)
+			_CLTHROWA(CL_ERR_CorruptIndex, "compressed block is truncated");
+		const int32_t offset = ip[0] | (ip[1] << 8);
+		ip += 2;
+		if (offset == 0 || offset > op)
+			_CLTHROWA(CL_ERR_CorruptIndex, "compressed block has an invalid offset");
+
+		int32_t matchLength = token & LZ_RUN_MASK;
+		if (matchLength == LZ_RUN_MASK)
+			matchLength = lzReadLength(ip, end, matchLength, destLen);
+		matchLength += LZ_MIN_MATCH;
+		if (matchLength > destLen - op)
+			_CLTHROWA(CL_ERR_CorruptIndex, "compressed block is longer than expected");
+
+		uint8_t* match = dest + op - offset;
+		if (offset >= matchLength){
+			memcpy(dest + op, match, matchLength);
+		}else{
+			// the match overlaps the bytes it produces
+			for (int32_t i = 0; i < matchLength; i++)
+				dest[op + i] = match[i];
+		}
+		op += matchLength;
+	}
+
+	if (op != destLen)
+		_CLTHROWA(CL_ERR_CorruptIndex, "compressed block is shorter than expected");
+}
+
+CL_NS_END
@@ -0,0 +1,187 @@
+/*------------------------------------------------------------------------------
+* Copyright (C) 2003-2006 Ben van Klinken and the CLucene Team
+*
+* Distributable under the terms of either the Apache License (Version 2.0) or
+* the GNU Lesser General Public License, as specified in the COPYING file.
+------------------------------------------------------------------------------*/
+#include "CLucene/_ApiHeader.h"
+#include "NumericUtils.h"
+
+CL_NS_DEF(util)
+
+// the 7 bits of a character are stored plus one, so that no character is 0
+#define NUMERIC_CHAR_OFFSET 1
+
+NumericUtils::RangeBuilder::~RangeBuilder(){
+}
+
+int32_t NumericUtils::int64ToPrefixCoded(const int64_t val, const int32_t shift, TCHAR* buffer){
+	if ( shift > 63 || shift < 0 )
+		_CLTHROWA(CL_ERR_IllegalArgument, "Illegal shift value, must be 0..63");
+	int32_t nChars = (63 - shift) / 7 + 1;
+	const int32_t len = nChars + 1;
+	buffer[0] = (TCHAR)(SHIFT_START_INT64 + shift);
+	uint64_t sortableBits = ((uint64_t)val) ^ ((uint64_t)1 << 63);
+	sortableBits >>= shift;
+	while ( nChars >= 1 ){
+		buffer[nChars--] = (TCHAR)((sortableBits & 0x7f) + NUMERIC_CHAR_OFFSET);
+		sortableBits >>= 7;
+	}
+	buffer[len] = 0;
+	return len;
+}
+
+int32_t NumericUtils::int32ToPrefixCoded(const int32_t val, const int32_t shift, TCHAR* buffer){
+	if ( shift > 31 || shift < 0 )
+		_CLTHROWA(CL_ERR_IllegalArgument, "Illegal shift value, must be 0..31");
+	int32_t nChars = (31 - shift) / 7 + 1;
+	const int32_t len = nChars + 1;
+	buffer[0] = (TCHAR)(SHIFT_START_INT32 + shift);
+	uint32_t sortableBits = ((uint32_t)val) ^ 0x80000000U;
+	sortableBits >>= shift;
+	while ( nChars >= 1 ){
+		buffer[nChars--] = (TCHAR)((sortableBits & 0x7f) + NUMERIC_CHAR_OFFSET);
+		sortableBits >>= 7;
+	}
+	buffer[len] = 0;
+	return len;
+}
+
+int64_t NumericUtils::prefixCodedToInt64(const TCHAR* prefixCoded){
+	const int32_t shift = (int32_t)prefixCoded[0] - SHIFT_START_INT64;
+	if ( shift > 63 || shift < 0 )
+		_CLTHROWA(CL_ERR_NumberFormat, "Invalid shift value in prefixCoded string (is encoded value really an INT64?)");
+	uint64_t sortableBits = 0;
+	for ( const TCHAR* p = prefixCoded + 1; *p != 0; p++ ){
+		const int32_t ch = (int32_t)*p - NUMERIC_CHAR_OFFSET;
+		if ( ch > 0x7f || ch < 0 )
+			_CLTHROWA(CL_ERR_NumberFormat, "Invalid prefixCoded numerical value representation (char is out of range)");
+		sortableBits = (sortableBits << 7) | (uint64_t)ch;
+	}
+	return (int64_t)((sortableBits << shift) ^ ((uint64_t)1 << 63));
+}
+
+int32_t NumericUtils::prefixCodedToInt32(const TCHAR* prefixCoded){
+	const int32_t shift = (int32_t)prefixCoded[0] - SHIFT_START_INT32;
+	if ( shift > 31 || shift < 0 )
+		_CLTHROWA(CL_ERR_NumberFormat, "Invalid shift value in prefixCoded string (is encoded value really an INT32?)");
+	uint32_t sortableBits = 0;
+	for ( const TCHAR* p = prefixCoded + 1; *p != 0; p++ ){
+		const int32_t ch = (int32_t)*p - NUMERIC_CHAR_OFFSET;
+		if ( ch > 0x7f || ch < 0 )
+			_CLTHROWA(CL_ERR_NumberFormat, "Invalid prefixCoded numerical value representation (char is out of range)");
+		sortableBits = (sortableBits << 7) | (uint32_t)ch;
+	}
+	return (int32_t)((sortableBits << shift) ^ 0x80000000U);
+}
+
+int32_t NumericUtils::getPrefixCodedShift(const TCHAR* prefixCoded){
+	const int32_t c = (int32_t)prefixCoded[0];
+	if ( c >= SHIFT_START_INT32 )
+		return c - SHIFT_START_INT32;
+	return c - SHIFT_START_INT64;
+}
+
+int64_t NumericUtils::doubleToSortableInt64(const double val){
+	int64_t f;
+	memcpy(&f, &val, sizeof(f));
+	// negative values sort in reverse, so flip all but their sign bit
+	if ( f < 0 )
+		f ^= LUCENE_INT64_MAX_SHOULDBE;
+	return f;
+}
+
+double NumericUtils::sortableInt64ToDouble(int64_t val){
+	if ( val < 0 )
+		val ^= LUCENE_INT64_MAX_SHOULDBE;
+	double d;
+	memcpy(&d, &val, sizeof(d));
+	return d;
+}
+
+int32_t NumericUtils::floatToSortableInt32(const float val){
+	int32_t f;
+	memcpy(&f, &val, sizeof(f));
+	if ( f < 0 )
+		f ^= 0x7fffffff;
+	return f;
+}
+
+float NumericUtils::sortableInt32ToFloat(int32_t val){
+	if ( val < 0 )
+		val ^= 0x7fffffff;
+	float f;
+	memcpy(&f, &val, sizeof(f));
+	return f;
+}
+
+void NumericUtils::splitInt64Range(RangeBuilder* builder, const int32_t precisionStep,
+	const int64_t minBound, const int64_t maxBound)
+{
+	splitRange(builder, 64, precisionStep, minBound, maxBound);
+}
+
+void NumericUtils::splitInt32Range(RangeBuilder* builder, const int32_t precisionStep,
+	const int32_t minBound, const int32_t maxBound)
+{
+	splitRange(builder, 32, precisionStep, minBound, maxBound);
+}
+
+void NumericUtils::splitRange(RangeBuilder* builder, const int32_t valSize, const int32_t precisionStep,
+	int64_t minBound, int64_t maxBound)
+{
+	if ( precisionStep < 1 )
+		_CLTHROWA(CL_ERR_IllegalArgument, "precisionStep must be >=1");
+	if ( minBound > maxBound )
+		return;
+	for ( int32_t shift = 0; ; shift += precisionStep ){
+		if ( shift + precisionStep >= valSize ){
+			// this is the lowest precision, it takes the rest of the range
+			addRange(builder, valSize, minBound, maxBound, shift);
+			break;
+		}
+		// the bounds are moved to the next precision with unsigned arithmetic, so that
+		// an overflow wraps (and is detected below) instead of being undefined
+		const uint64_t diff = (uint64_t)1 << (shift + precisionStep);
+		const int64_t mask = (int64_t)((((uint64_t)1 << precisionStep) - 1) << shift);
+		const bool hasLower = (minBound & mask) != 0;
+		const bool hasUpper = (maxBound & mask) != mask;
+		const int64_t nextMinBound = (hasLower ? (int64_t)((uint64_t)minBound + diff) : minBound) & ~mask;
+		const int64_t nextMaxBound = (hasUpper ? (int64_t)((uint64_t)maxBound - diff) : maxBound) & ~mask;
+		const bool lowerWrapped = nextMinBound < minBound;
+		const bool upperWrapped = nextMaxBound > maxBound;
+
+		if ( nextMinBound > nextMaxBound || lowerWrapped || upperWrapped ){
+			// the next precision can not cover anything, so this one takes the rest of the range
+			addRange(builder, valSize, minBound, maxBound, shift);
+			break;
+		}
+
+		if ( hasLower )
+			addRange(builder, valSize, minBound, minBound | mask, shift);
+		if ( hasUpper )
+			addRange(builder, valSize, maxBound & ~mask, maxBound, shift);
+
+		minBound = nextMinBound;
+		maxBound = nextMaxBound;
+	}
+}
+
+void NumericUtils::addRange(RangeBuilder* builder, const int32_t valSize,
+	const int64_t minBound, int64_t maxBound, const int32_t shift)
+{
+	// the removed bits of the upper bound are all set, the terms ignore them anyway
+	maxBound |= (int64_t)(((uint64_t)1 << shift) - 1);
+	TCHAR minBuffer[BUF_SIZE_INT64];
+	TCHAR maxBuffer[BUF_SIZE_INT64];
+	if ( valSize == 64 ){
+		int64ToPrefixCoded(minBound, shift, minBuffer);
+		int64ToPrefixCoded(maxBound, shift, maxBuffer);
+	}else{
+		int32ToPrefixCoded((int32_t)minBound, shift, minBuffer);
+		int32ToPrefixCoded((int32_t)maxBound, shift, maxBuffer);
+	}
+	builder->addRange(minBuffer, maxBuffer);
+}
+
+CL_NS_END
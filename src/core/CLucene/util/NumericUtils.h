@@ -0,0 +1,132 @@
+/*------------------------------------------------------------------------------
+* Copyright (C) 2003-2006 Ben van Klinken and the CLucene Team
+*
+* Distributable under the terms of either the Apache License (Version 2.0) or
+* the GNU Lesser General Public License, as specified in the COPYING file.
+------------------------------------------------------------------------------*/
+#ifndef _lucene_util_NumericUtils_
+#define _lucene_util_NumericUtils_
+
+CL_NS_DEF(util)
+
+/**
+* Converts numeric values to and from the terms which
+* {@link lucene::document::NumericField} indexes and
+* {@link lucene::search::NumericRangeQuery} searches for.
+*
+* <p>A value is indexed as one term per precision: the full value, then the
+* value with its lowest <code>precisionStep</code> bits removed, then with
+* 2*precisionStep bits removed, and so on. A range query can then cover the
+* inner part of a range with a few low precision terms, and only needs full
+* precision terms at its edges, so it visits at most a few dozen terms
+* however many distinct values the range holds.
+*
+* <p>Each term starts with a character encoding the number of removed bits
+* (the shift) and the type, followed by the remaining bits, 7 bits per
+* character. The sign bit is flipped so that the terms of a precision sort
+* in the order of their values. Characters are never 0, so that the terms
+* are valid C strings.
+*
+* <p>Floating point values are first converted to integers of the same
+* ordering with {@link #doubleToSortableInt64} and {@link #floatToSortableInt32}.
+*/
+class CLUCENE_EXPORT NumericUtils {
+public:
+	/**
+	* The default precision step of {@link lucene::document::NumericField},
+	* {@link lucene::analysis::NumericTokenStream} and the numeric ranges.
+	*/
+	LUCENE_STATIC_CONSTANT(int32_t, PRECISION_STEP_DEFAULT = 4);
+
+	/** Added to the shift in the first character of a 64 bit term */
+	LUCENE_STATIC_CONSTANT(TCHAR, SHIFT_START_INT64 = 0x20);
+	/** Added to the shift in the first character of a 32 bit term */
+	LUCENE_STATIC_CONSTANT(TCHAR, SHIFT_START_INT32 = 0x60);
+
+	/** The size of a buffer for any 64 bit term, including the terminating 0 */
+	LUCENE_STATIC_CONSTANT(int32_t, BUF_SIZE_INT64 = 63/7 + 3);
+	/** The size of a buffer for any 32 bit term, including the terminating 0 */
+	LUCENE_STATIC_CONSTANT(int32_t, BUF_SIZE_INT32 = 31/7 + 3);
+
+	/**
+	* Writes the term of val with its lowest shift bits removed to buffer.
+	* @param buffer must hold BUF_SIZE_INT64 characters
+	* @return the length of the term
+	* @throws CL_ERR_IllegalArgument if shift is not in 0..63
+	*/
+	static int32_t int64ToPrefixCoded(const int64_t val, const int32_t shift, TCHAR* buffer);
+
+	/**
+	* Writes the term of val with its lowest shift bits removed to buffer.
+	* @param buffer must hold BUF_SIZE_INT32 characters
+	* @return the length of the term
+	* @throws CL_ERR_IllegalArgument if shift is not in 0..31
+	*/
+	static int32_t int32ToPrefixCoded(const int32_t val, const int32_t shift, TCHAR* buffer);
+
+	/**
+	* Returns the value of a 64 bit term, with the removed bits as 0.
+	* @throws CL_ERR_NumberFormat if prefixCoded is not a 64 bit term
+	*/
+	static int64_t prefixCodedToInt64(const TCHAR* prefixCoded);
+
+	/**
+	* Returns the value of a 32 bit term, with the removed bits as 0.
+	* @throws CL_ERR_NumberFormat if prefixCoded is not a 32 bit term
+	*/
+	static int32_t prefixCodedToInt32(const TCHAR* prefixCoded);
+
+	/**
+	* Returns the shift of a term written by int64ToPrefixCoded or
+	* int32ToPrefixCoded. Full precision terms have a shift of 0.
+	*/
+	static int32_t getPrefixCodedShift(const TCHAR* prefixCoded);
+
+	/**
+	* Converts a double to an int64_t which sorts in the same order. NaN
+	* sorts above positive infinity.
+	*/
+	static int64_t doubleToSortableInt64(const double val);
+	/** Converts a value of doubleToSortableInt64 back to the double */
+	static double sortableInt64ToDouble(const int64_t val);
+
+	/**
+	* Converts a float to an int32_t which sorts in the same order. NaN
+	* sorts above positive infinity.
+	*/
+	static int32_t floatToSortableInt32(const float val);
+	/** Converts a value of floatToSortableInt32 back to the float */
+	static float sortableInt32ToFloat(const int32_t val);
+
+	/**
+	* Receives the sub ranges of {@link #splitInt64Range}. Each sub range
+	* is given as its lowest and highest term, both inclusive.
+	*/
+	class CLUCENE_EXPORT RangeBuilder {
+	public:
+		virtual ~RangeBuilder();
+		virtual void addRange(const TCHAR* minPrefixCoded, const TCHAR* maxPrefixCoded) = 0;
+	};
+
+	/**
+	* Splits the 64 bit range minBound..maxBound, both inclusive, into the
+	* terms of the precisions of precisionStep which cover it, and passes
+	* each run of consecutive terms to builder.
+	* @throws CL_ERR_IllegalArgument if precisionStep is less than 1
+	*/
+	static void splitInt64Range(RangeBuilder* builder, const int32_t precisionStep,
+		const int64_t minBound, const int64_t maxBound);
+
+	/** Like {@link #splitInt64Range}, for 32 bit values. */
+	static void splitInt32Range(RangeBuilder* builder, const int32_t precisionStep,
+		const int32_t minBound, const int32_t maxBound);
+
+private:
+	static void splitRange(RangeBuilder* builder, const int32_t valSize, const int32_t precisionStep,
+		int64_t minBound, int64_t maxBound);
+	static void addRange(RangeBuilder* builder, const int32_t valSize,
+		const int64_t minBound, int64_t maxBound, const int32_t shift);
+};
+
+CL_NS_END
+#endif
@@ -0,0 +1,148 @@
+/*------------------------------------------------------------------------------
+* Copyright (C) 2003-2006 Ben van Klinken and the CLucene Team
+*
+* Distributable under the terms of either the Apache License (Version 2.0) or
+* the GNU Lesser General Public License, as specified in the COPYING file.
+------------------------------------------------------------------------------*/
+#include "CLucene/_ApiHeader.h"
+#include "SortedVIntList.h"
+#include "BitSet.h"
+
+CL_NS_USE(search)
+CL_NS_DEF(util)
+
+	class SortedVIntListIterator: public DocIdSetIterator {
+		const uint8_t* bytes;
+		int32_t bytePos;
+		int32_t lastBytePos;
+		int32_t lastInt;
+	public:
+		SortedVIntListIterator(const uint8_t* bytes, int32_t lastBytePos):
+			bytes(bytes),
+			bytePos(0),
+			lastBytePos(lastBytePos),
+			lastInt(-1)
+		{
+		}
+		int32_t doc() const{
+			return lastInt;
+		}
+		bool next(){
+			if ( bytePos >= lastBytePos ){
+				lastInt = LUCENE_INT32_MAX_SHOULDBE;
+				return false;
+			}
+			uint8_t b = bytes[bytePos++];
+			int32_t delta = b & 0x7F;
+			for ( int32_t shift = 7; (b & 0x80) != 0; shift += 7 ){
+				b = bytes[bytePos++];
+				delta |= (b & 0x7F) << shift;
+			}
+			lastInt = (lastInt == -1 ? 0 : lastInt) + delta;
+			return true;
+		}
+		bool skipTo(int32_t target){
+			while ( next() ){
+				if ( lastInt >= target )
+					return true;
+			}
+			return false;
+		}
+	};
+
+	SortedVIntList::SortedVIntList(const int32_t* sortedInts, int32_t len):
+		_size(0),
+		bytes(NULL),
+		capacity(0),
+		lastBytePos(0)
+	{
+		init(len * 2);
+		int32_t lastInt = 0;
+		for ( int32_t i=0;i<len;i++ )
+			addInt(sortedInts[i], lastInt);
+		done();
+	}
+
+	SortedVIntList::SortedVIntList(const BitSet* bits):
+		_size(0),
+		bytes(NULL),
+		capacity(0),
+		lastBytePos(0)
+	{
+		init(128);
+		int32_t lastInt = 0;
+		for ( int32_t i = bits->nextSetBit(0); i >= 0; i = bits->nextSetBit(i+1) )
+			addInt(i, lastInt);
+		done();
+	}
+
+	SortedVIntList::SortedVIntList(DocIdSetIterator* docIdSetIterator):
+		_size(0),
+		bytes(NULL),
+		capacity(0),
+		lastBytePos(0)
+	{
+		init(128);
+		int32_t lastInt = 0;
+		while ( docIdSetIterator->next() )
+			addInt(docIdSetIterator->doc(), lastInt);
+		done();
+	}
+
+	SortedVIntList::~SortedVIntList(){
+		_CLDELETE_LARRAY(bytes);
+	}
+
+	void SortedVIntList::init(int32_t initialCapacity){
+		capacity = cl_max(initialCapacity, 16);
+		bytes = _CL_NEWARRAY(uint8_t, capacity);
+		lastBytePos = 0;
+	}
+
+	void SortedVIntList::addInt(int32_t nextInt, int32_t& lastInt){
+		int32_t diff = nextInt - lastInt;
+		if ( diff < 0 || (_size > 0 && diff == 0) ){
+			_CLDELETE_LARRAY(bytes); //only called while constructing
+			_CLTHROWA(CL_ERR_IllegalArgument, "Input not sorted or first element negative.");
+		}
+
+		if ( lastBytePos + 5 > capacity ){ //a vint takes at most 5 bytes
+			capacity *= 2;
+			uint8_t* tmp = _CL_NEWARRAY(uint8_t, capacity);
+			memcpy(tmp, bytes, lastBytePos);
+			_CLDELETE_LARRAY(bytes);
+			bytes = tmp;
+		}
+		while ( (diff & ~0x7F) != 0 ){
+			bytes[lastBytePos++] = (uint8_t)((diff & 0x7F) | 0x80);
+			diff = ((uint32_t)diff) >> 7;
+		}
+		bytes[lastBytePos++] = (uint8_t)diff;
+		_size++;
+		lastInt = nextInt;
+	}
+
+	void SortedVIntList::done(){
+		//give back the unused part of the buffer, the list is read only from now on
+		if ( capacity > lastBytePos + (lastBytePos >> 3) ){
+			capacity = cl_max(lastBytePos, 1);
+			uint8_t* tmp = _CL_NEWARRAY(uint8_t, capacity);
+			memcpy(tmp, bytes, lastBytePos);
+			_CLDELETE_LARRAY(bytes);
+			bytes = tmp;
+		}
+	}
+
+	int32_t SortedVIntList::size() const{
+		return _size;
+	}
+
+	int32_t SortedVIntList::getByteSize() const{
+		return lastBytePos;
+	}
+
+	DocIdSetIterator* SortedVIntList::iterator() const{
+		return _CLNEW SortedVIntListIterator(bytes, lastBytePos);
+	}
+
+CL_NS_END
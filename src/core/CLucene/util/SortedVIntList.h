@@ -0,0 +1,64 @@
+/*------------------------------------------------------------------------------
+* Copyright (C) 2003-2006 Ben van Klinken and the CLucene Team
+*
+* Distributable under the terms of either the Apache License (Version 2.0) or
+* the GNU Lesser General Public License, as specified in the COPYING file.
+------------------------------------------------------------------------------*/
+#ifndef _lucene_util_SortedVIntList_
+#define _lucene_util_SortedVIntList_
+
+#include "CLucene/search/DocIdSet.h"
+
+CL_NS_DEF(util)
+class BitSet;
+
+/**
+* Stores and iterates on sorted integers in compressed form in RAM.
+* <p>The code for compressing the differences between ascending integers was
+* borrowed from {@link CL_NS(store)::IndexInput} and
+* {@link CL_NS(store)::IndexOutput}.
+* <p>For a set holding few of the documents of an index this takes a small
+* fraction of the memory of a BitSet of maxDoc bits: a document costs one or
+* two bytes instead of maxDoc/count bits.
+*/
+class CLUCENE_EXPORT SortedVIntList: public CL_NS(search)::DocIdSet {
+private:
+	int32_t _size;
+	uint8_t* bytes;
+	int32_t capacity;
+	int32_t lastBytePos;
+
+	void init(int32_t initialCapacity);
+	void addInt(int32_t nextInt, int32_t& lastInt);
+	void done();
+public:
+	/**
+	* Create a SortedVIntList from an array of integers.
+	* @param sortedInts an array of sorted non negative integers.
+	* @param len the number of integers to be used from the array.
+	*/
+	SortedVIntList(const int32_t* sortedInts, int32_t len);
+
+	/** Create a SortedVIntList from the set bits of a BitSet. */
+	SortedVIntList(const BitSet* bits);
+
+	/**
+	* Create a SortedVIntList from the documents of an iterator.
+	* @memory the iterator is not deleted
+	*/
+	SortedVIntList(CL_NS(search)::DocIdSetIterator* docIdSetIterator);
+
+	virtual ~SortedVIntList();
+
+	/** Returns the number of integers in this list. */
+	int32_t size() const;
+
+	/** Returns the size of the byte array storing the compressed sorted integers. */
+	int32_t getByteSize() const;
+
+	/** Returns an iterator over the integers of this list. */
+	CL_NS(search)::DocIdSetIterator* iterator() const;
+};
+
+CL_NS_END
+#endif
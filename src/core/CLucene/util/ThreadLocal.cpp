@@ -10,7 +10,6 @@
 #include "CLucene/LuceneThreads.h"
 #include "_ThreadLocal.h"
 #include "CLucene/config/_threads.h"
-#include <assert.h>
 
 CL_NS_DEF ( util )
 
@@ -20,12 +19,39 @@ CL_NS_DEF ( util )
 *
 * The class->thread data mapping is stored in the _ThreadLocal class.
 * The thread->datas mapping is in ThreadData.
+*
+* get() is called on every term lookup, so each thread also keeps a small cache of its values,
+* found through native thread local storage, which get() reads without taking any lock.
+* Only the thread itself reads and writes its cache. The cache is keyed by a serial number
+* which every ThreadLocal gets when it is created, rather than by its address, so that an entry
+* left behind by a deleted ThreadLocal can never be taken for one of a new ThreadLocal.
+* The values are still owned by the ThreadLocal, which deletes them when it is destroyed.
 */
 
+class ThreadLocalCache
+{
+public:
+	LUCENE_STATIC_CONSTANT(int32_t, SIZE = 64);
+	struct Entry{
+		int32_t serial;
+		void* value;
+	};
+	Entry entries[SIZE];
+
+	ThreadLocalCache(){
+		memset(entries, 0, sizeof(entries));
+	}
+	//serial numbers are handed out in order, so the most recent ThreadLocals don't collide
+	Entry& entry(const int32_t serial){
+		return entries[serial & (SIZE-1)];
+	}
+};
 
 //predefine for the shared code...
 #if defined(_CL_HAVE_WIN32_THREADS)
-	#define INIT_THREAD(ret) ret=true
+	static __declspec(thread) ThreadLocalCache* threadLocalCache = NULL;
+	#define GET_THREAD_CACHE() threadLocalCache
+	#define SET_THREAD_CACHE(cache) threadLocalCache = cache
     extern "C"{
 
         //todo: move this to StdHeader and make it usable by other functions...
@@ -42,20 +68,27 @@ CL_NS_DEF ( util )
 #elif defined(_CL_HAVE_PTHREAD)
     pthread_key_t pthread_threadlocal_key;
     pthread_once_t pthread_threadlocal_key_once = PTHREAD_ONCE_INIT;
-    #define INIT_THREAD(ret) \
-	pthread_once(&pthread_threadlocal_key_once, pthread_threadlocal_make_key); \
-	if (pthread_getspecific(pthread_threadlocal_key) == NULL) { pthread_setspecific(pthread_threadlocal_key, (void*)1); } \
-	ret = true;
 
-    //the function that is called when the thread shutsdown
-    void pthread_threadlocal_destructor(void* /*_holder*/){
+    //the function that is called when the thread shutsdown. The key has
+    //already been cleared, so the cache is deleted here
+    void pthread_threadlocal_destructor(void* cache){
         _ThreadLocal::UnregisterCurrentThread();
+        ThreadLocalCache* threadCache = (ThreadLocalCache*)cache;
+        _CLDELETE(threadCache);
     }
     //the key initialiser function
     void pthread_threadlocal_make_key()
     {
 		(void) pthread_key_create(&pthread_threadlocal_key, &pthread_threadlocal_destructor);
     }
+	#define GET_THREAD_CACHE() \
+		(pthread_once(&pthread_threadlocal_key_once, pthread_threadlocal_make_key), \
+		(ThreadLocalCache*)pthread_getspecific(pthread_threadlocal_key))
+	#define SET_THREAD_CACHE(cache) pthread_setspecific(pthread_threadlocal_key, cache)
+#else
+	static ThreadLocalCache* threadLocalCache = NULL;
+	#define GET_THREAD_CACHE() threadLocalCache
+	#define SET_THREAD_CACHE(cache) threadLocalCache = cache
 #endif
 
 class _ThreadLocal;
@@ -84,6 +117,9 @@ static ThreadDataType*  threadData = NULL;
 	static _LUCENE_THREADMUTEX *threadData_LOCK = NULL;
 #endif
 
+//the last serial number given to a ThreadLocal
+static _LUCENE_ATOMIC_INT threadLocalSerial;
+
 
 class _ThreadLocal::Internal
 {
@@ -95,9 +131,11 @@ class _ThreadLocal::Internal
 		LocalsType locals;
 		DEFINE_MUTEX ( locals_LOCK )
 		AbstractDeletor* _deletor;
+		const int32_t serial;
 
 		Internal ( AbstractDeletor* _deletor ) :
-			locals ( false,false )
+			locals ( false,false ),
+			serial ( _LUCENE_ATOMIC_INC ( &threadLocalSerial ) )
 		{
 			this->_deletor = _deletor;
 		}
@@ -134,12 +172,36 @@ _ThreadLocal::~_ThreadLocal()
 
 void* _ThreadLocal::get()
 {
-	SCOPED_LOCK_MUTEX(_internal->locals_LOCK)
-	return _internal->locals.get ( _LUCENE_CURRTHREADID );
+	ThreadLocalCache* cache = GET_THREAD_CACHE();
+	if ( cache != NULL ){
+		ThreadLocalCache::Entry& entry = cache->entry ( _internal->serial );
+		if ( entry.serial == _internal->serial )
+			return entry.value;
+	}
+
+	//not cached yet, or pushed out by another ThreadLocal
+	void* val;
+	{
+		SCOPED_LOCK_MUTEX(_internal->locals_LOCK)
+		val = _internal->locals.get ( _LUCENE_CURRTHREADID );
+	}
+	if ( cache != NULL ){
+		ThreadLocalCache::Entry& entry = cache->entry ( _internal->serial );
+		entry.serial = _internal->serial;
+		entry.value = val;
+	}
+	return val;
 }
 
 void _ThreadLocal::setNull()
 {
+	ThreadLocalCache* cache = GET_THREAD_CACHE();
+	if ( cache != NULL ){
+		ThreadLocalCache::Entry& entry = cache->entry ( _internal->serial );
+		if ( entry.serial == _internal->serial )
+			entry.value = NULL;
+	}
+
 	//just delete this thread from the locals list
 	_LUCENE_THREADID_TYPE id = _LUCENE_CURRTHREADID;
 	SCOPED_LOCK_MUTEX(_internal->locals_LOCK)
@@ -159,9 +221,11 @@ void _ThreadLocal::set ( void* t )
 		return;
 	}
 	//make sure we have a threadlocal context (for cleanup)
-	bool ret;
-	INIT_THREAD(ret);
-	assert(ret);
+	ThreadLocalCache* cache = GET_THREAD_CACHE();
+	if ( cache == NULL ){
+		cache = _CLNEW ThreadLocalCache;
+		SET_THREAD_CACHE(cache);
+	}
 
 	_LUCENE_THREADID_TYPE id = _LUCENE_CURRTHREADID;
 
@@ -200,20 +264,29 @@ void _ThreadLocal::set ( void* t )
 			_internal->locals.put ( id, t );
 	}
 
+	ThreadLocalCache::Entry& entry = cache->entry ( _internal->serial );
+	entry.serial = _internal->serial;
+	entry.value = t;
 }
 
 void _ThreadLocal::UnregisterCurrentThread()
 {
-	if ( threadData == NULL )
-		return;
-	_LUCENE_THREADID_TYPE id = _LUCENE_CURRTHREADID;
-	SCOPED_LOCK_MUTEX ( *threadData_LOCK );
+	if ( threadData != NULL ){
+		_LUCENE_THREADID_TYPE id = _LUCENE_CURRTHREADID;
+		SCOPED_LOCK_MUTEX ( *threadData_LOCK );
 
-	ThreadDataType::iterator itr = threadData->find(id);
-	if ( itr != threadData->end() ){
-		ThreadLocals* threadLocals = itr->second;
-		threadLocals->UnregisterThread();
-		threadData->removeitr(itr);
+		ThreadDataType::iterator itr = threadData->find(id);
+		if ( itr != threadData->end() ){
+			ThreadLocals* threadLocals = itr->second;
+			threadLocals->UnregisterThread();
+			threadData->removeitr(itr);
+		}
+	}
+
+	ThreadLocalCache* cache = GET_THREAD_CACHE();
+	if ( cache != NULL ){
+		SET_THREAD_CACHE(NULL);
+		_CLDELETE(cache);
 	}
 }
 
@@ -235,6 +308,12 @@ void _ThreadLocal::RemoveThreadLocal( _ThreadLocal * tl )
 
 void _ThreadLocal::_shutdown()
 {
+	//only the cache of this thread can be reached here, the others go when their threads end
+	ThreadLocalCache* cache = GET_THREAD_CACHE();
+	if ( cache != NULL ){
+		SET_THREAD_CACHE(NULL);
+		_CLDELETE(cache);
+	}
 #ifndef _CL_DISABLE_MULTITHREADING
 	_CLDELETE(threadData_LOCK);
 #endif
@@ -0,0 +1,151 @@
+/*------------------------------------------------------------------------------
+* Copyright (C) 2003-2006 Ben van Klinken and the CLucene Team
+*
+* Distributable under the terms of either the Apache License (Version 2.0) or
+* the GNU Lesser General Public License, as specified in the COPYING file.
+------------------------------------------------------------------------------*/
+#include "CLucene/_ApiHeader.h"
+#include "ThreadPool.h"
+#include <list>
+#include <vector>
+
+CL_NS_DEF(util)
+
+	//the tasks of one invokeAll call
+	struct ThreadPoolBatch{
+		int32_t remaining;
+	};
+
+	class ThreadPool::Internal{
+	public:
+		DEFINE_MUTEX(THIS_LOCK)
+		DEFINE_CONDITION(THIS_WAIT_CONDITION)
+
+		typedef std::list< std::pair<Task*, ThreadPoolBatch*> > QueueType;
+		QueueType queue;
+		std::vector<_LUCENE_THREADID_TYPE> threads;
+		bool stopping;
+
+		Internal():
+			stopping(false)
+		{
+		}
+	};
+
+	ThreadPool::Task::Task():
+		failed(false)
+	{
+	}
+	ThreadPool::Task::~Task(){
+	}
+
+	ThreadPool::ThreadPool(int32_t numThreads):
+		_internal(_CLNEW Internal),
+		numThreads(0)
+	{
+#ifndef _CL_DISABLE_MULTITHREADING
+		for ( int32_t i=0;i<numThreads;i++ )
+			_internal->threads.push_back(_LUCENE_THREAD_CREATE(&workerThread, this));
+		this->numThreads = numThreads;
+#endif
+	}
+
+	ThreadPool::~ThreadPool(){
+		{
+			SCOPED_LOCK_MUTEX(_internal->THIS_LOCK)
+			_internal->stopping = true;
+			CONDITION_NOTIFYALL(_internal->THIS_WAIT_CONDITION)
+		}
+		for ( size_t i=0;i<_internal->threads.size();i++ )
+			_LUCENE_THREAD_JOIN(_internal->threads[i]);
+		_CLDELETE(_internal);
+	}
+
+	int32_t ThreadPool::getNumThreads() const{
+		return numThreads;
+	}
+
+	_LUCENE_THREAD_FUNC(ThreadPool::workerThread, arg){
+		((ThreadPool*)arg)->runWorker();
+		_LUCENE_THREAD_FUNC_RETURN(0);
+	}
+
+	void ThreadPool::runWorker(){
+		while ( true ){
+			{
+				SCOPED_LOCK_MUTEX(_internal->THIS_LOCK)
+				while ( _internal->queue.empty() && !_internal->stopping )
+					CONDITION_WAIT(_internal->THIS_LOCK, _internal->THIS_WAIT_CONDITION)
+				if ( _internal->queue.empty() )
+					return; //stopping
+			}
+			runNextTask();
+		}
+	}
+
+	bool ThreadPool::runNextTask(){
+		Task* task;
+		ThreadPoolBatch* batch;
+		{
+			SCOPED_LOCK_MUTEX(_internal->THIS_LOCK)
+			if ( _internal->queue.empty() )
+				return false;
+			task = _internal->queue.front().first;
+			batch = _internal->queue.front().second;
+			_internal->queue.pop_front();
+		}
+
+		try{
+			task->run();
+		}catch(CLuceneError& err){
+			task->failed = true;
+			task->error.set(err.number(), err.what());
+		}catch(...){
+			task->failed = true;
+			task->error.set(CL_ERR_Runtime, "unknown error in thread pool task");
+		}
+
+		{
+			SCOPED_LOCK_MUTEX(_internal->THIS_LOCK)
+			batch->remaining--;
+			CONDITION_NOTIFYALL(_internal->THIS_WAIT_CONDITION)
+		}
+		return true;
+	}
+
+	void ThreadPool::invokeAll(Task** tasks, int32_t count){
+		ThreadPoolBatch batch;
+		batch.remaining = count;
+		{
+			SCOPED_LOCK_MUTEX(_internal->THIS_LOCK)
+			for ( int32_t i=0;i<count;i++ ){
+				tasks[i]->failed = false;
+				_internal->queue.push_back(std::pair<Task*, ThreadPoolBatch*>(tasks[i], &batch));
+			}
+			CONDITION_NOTIFYALL(_internal->THIS_WAIT_CONDITION)
+		}
+
+		//help with the queued work instead of just waiting. The caller may
+		//run tasks of other batches too, which is fine since every task
+		//counts down its own batch.
+		while ( true ){
+			{
+				SCOPED_LOCK_MUTEX(_internal->THIS_LOCK)
+				if ( batch.remaining == 0 )
+					break;
+				if ( _internal->queue.empty() ){
+					while ( batch.remaining > 0 )
+						CONDITION_WAIT(_internal->THIS_LOCK, _internal->THIS_WAIT_CONDITION)
+					break;
+				}
+			}
+			runNextTask();
+		}
+
+		for ( int32_t i=0;i<count;i++ ){
+			if ( tasks[i]->failed )
+				throw CLuceneError(tasks[i]->error);
+		}
+	}
+
+CL_NS_END
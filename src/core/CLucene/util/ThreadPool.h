@@ -0,0 +1,63 @@
+/*------------------------------------------------------------------------------
+* Copyright (C) 2003-2006 Ben van Klinken and the CLucene Team
+*
+* Distributable under the terms of either the Apache License (Version 2.0) or
+* the GNU Lesser General Public License, as specified in the COPYING file.
+------------------------------------------------------------------------------*/
+#ifndef _lucene_util_ThreadPool_
+#define _lucene_util_ThreadPool_
+
+#include "CLucene/LuceneThreads.h"
+
+CL_NS_DEF(util)
+
+/**
+* A fixed set of worker threads which run tasks handed to {@link #invokeAll}.
+* The threads are started once and reused, so fanning work out does not pay
+* for thread creation on every call.
+*
+* <p>The thread calling invokeAll runs queued tasks too while it waits, so
+* a pool may be shared by several callers, and a pool without threads (or a
+* build without threading support) simply runs the tasks in the caller.
+*/
+class CLUCENE_EXPORT ThreadPool: LUCENE_BASE{
+public:
+	/** A unit of work. Errors thrown by run are reported by invokeAll. */
+	class CLUCENE_EXPORT Task: LUCENE_BASE{
+	public:
+		Task();
+		virtual ~Task();
+		virtual void run() = 0;
+
+		/** Set when run threw an error. */
+		bool failed;
+		CLuceneError error;
+	};
+private:
+	class Internal;
+	Internal* _internal;
+	int32_t numThreads;
+
+	static _LUCENE_THREAD_FUNC(workerThread, arg);
+	void runWorker();
+	bool runNextTask();
+public:
+	/** Starts numThreads worker threads. */
+	ThreadPool(int32_t numThreads);
+	/** Stops and joins the worker threads. Must not be called while tasks are running. */
+	~ThreadPool();
+
+	/** Returns the number of worker threads. */
+	int32_t getNumThreads() const;
+
+	/**
+	* Runs all the tasks and returns once every one of them is done. If any
+	* task threw an error, the first one (in array order) is rethrown after
+	* all tasks are done.
+	* @memory the tasks are not deleted
+	*/
+	void invokeAll(Task** tasks, int32_t count);
+};
+
+CL_NS_END
+#endif
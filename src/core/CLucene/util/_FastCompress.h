@@ -0,0 +1,39 @@
+/*------------------------------------------------------------------------------
+* Copyright (C) 2003-2006 Ben van Klinken and the CLucene Team
+*
+* Distributable under the terms of either the Apache License (Version 2.0) or
+* the GNU Lesser General Public License, as specified in the COPYING file.
+------------------------------------------------------------------------------*/
+#ifndef _lucene_util_FastCompress_H
+#define _lucene_util_FastCompress_H
+
+CL_NS_DEF(util)
+/**
+* A fast LZ77 compressor, using the block format of LZ4: each sequence is
+* a token holding the literal and match lengths, the literals, and a two
+* byte offset back to the match. It trades ratio for speed, decompressing
+* at memory speed, which suits data that is read back much more often than
+* it is written, such as blocks of stored fields.
+*/
+class FastCompress{
+public:
+	/** The largest number of bytes compress can produce for len bytes */
+	static int32_t maxCompressedLength(const int32_t len);
+
+	/**
+	* Compresses len bytes of src into dest.
+	* @param dest must hold maxCompressedLength(len) bytes
+	* @return the number of compressed bytes
+	*/
+	static int32_t compress(const uint8_t* src, const int32_t len, uint8_t* dest);
+
+	/**
+	* Decompresses srcLen bytes of src into exactly destLen bytes of dest.
+	* @throws CL_ERR_CorruptIndex if src is not a valid compressed block of
+	* destLen bytes
+	*/
+	static void decompress(const uint8_t* src, const int32_t srcLen, uint8_t* dest, const int32_t destLen);
+};
+
+CL_NS_END
+#endif
@@ -7,6 +7,13 @@
 #ifndef _LuceneThreads_h
 #define  _LuceneThreads_h
 
+//only the pthread build without the gcc atomics keeps
+//its reference counts in a std::atomic (see below)
+#if !defined(_CL_DISABLE_MULTITHREADING) && !defined(_LUCENE_DONTIMPLEMENT_THREADMUTEX) && \
+    defined(_CL_HAVE_PTHREAD) && defined(_CL_HAVE_STD_ATOMIC) && \
+    !defined(_CL_HAVE_GCC_ATOMIC_BUILTINS) && !defined(_CL_HAVE_GCC_ATOMIC_FUNCTIONS)
+	#include <atomic>
+#endif
 
 CL_NS_DEF(util)
 class CLuceneThreadIdCompare;
@@ -70,10 +77,25 @@ class CLuceneThreadIdCompare;
         		void NotifyAll();
 					};
 
-          #ifdef _CL_HAVE_GCC_ATOMIC_FUNCTIONS
+          #if defined(_CL_HAVE_GCC_ATOMIC_BUILTINS) || defined(_CL_HAVE_GCC_ATOMIC_FUNCTIONS)
             #define _LUCENE_ATOMIC_INT uint32_t
             #define _LUCENE_ATOMIC_INT_SET(x,v) x=v
             #define _LUCENE_ATOMIC_INT_GET(x) x
+          #elif defined(_CL_HAVE_STD_ATOMIC)
+            class CLUCENE_SHARED_EXPORT __LUCENE_ATOMIC_INT{
+            public:
+              std::atomic<int32_t> value;
+              __LUCENE_ATOMIC_INT(): value(0){}
+              //a copy gets the value, the same as a plain integer would
+              __LUCENE_ATOMIC_INT(const __LUCENE_ATOMIC_INT& clone): value(clone.value.load()){}
+              __LUCENE_ATOMIC_INT& operator=(const __LUCENE_ATOMIC_INT& clone){
+                value.store(clone.value.load());
+                return *this;
+              }
+            };
+            #define _LUCENE_ATOMIC_INT  CL_NS(util)::__LUCENE_ATOMIC_INT
+            #define _LUCENE_ATOMIC_INT_SET(x,v) x.value=v
+            #define _LUCENE_ATOMIC_INT_GET(x) x.value
           #else
             class CLUCENE_SHARED_EXPORT __LUCENE_ATOMIC_INT{
             public:
@@ -91,8 +113,21 @@ class CLuceneThreadIdCompare;
             static int32_t atomic_decrement(_LUCENE_ATOMIC_INT* theInteger);
           };
 
-          #define _LUCENE_ATOMIC_INC(theInteger) CL_NS(util)::atomic_threads::atomic_increment(theInteger)
-          #define _LUCENE_ATOMIC_DEC(theInteger) CL_NS(util)::atomic_threads::atomic_decrement(theInteger)
+          //reference counts are changed inline wherever the compiler can. Taking a reference needs
+          //no ordering, but dropping one must make the object's writes visible to whoever deletes it.
+          #if defined(_CL_HAVE_GCC_ATOMIC_BUILTINS)
+            #define _LUCENE_ATOMIC_INC(theInteger) ((int32_t)__atomic_add_fetch(theInteger, 1, __ATOMIC_RELAXED))
+            #define _LUCENE_ATOMIC_DEC(theInteger) ((int32_t)__atomic_sub_fetch(theInteger, 1, __ATOMIC_ACQ_REL))
+          #elif defined(_CL_HAVE_GCC_ATOMIC_FUNCTIONS)
+            #define _LUCENE_ATOMIC_INC(theInteger) ((int32_t)__sync_add_and_fetch(theInteger, 1))
+            #define _LUCENE_ATOMIC_DEC(theInteger) ((int32_t)__sync_sub_and_fetch(theInteger, 1))
+          #elif defined(_CL_HAVE_STD_ATOMIC)
+            #define _LUCENE_ATOMIC_INC(theInteger) ((theInteger)->value.fetch_add(1, std::memory_order_relaxed) + 1)
+            #define _LUCENE_ATOMIC_DEC(theInteger) ((theInteger)->value.fetch_sub(1, std::memory_order_acq_rel) - 1)
+          #else
+            #define _LUCENE_ATOMIC_INC(theInteger) CL_NS(util)::atomic_threads::atomic_increment(theInteger)
+            #define _LUCENE_ATOMIC_DEC(theInteger) CL_NS(util)::atomic_threads::atomic_decrement(theInteger)
+          #endif
 
     	#elif defined(_CL_HAVE_WIN32_THREADS)
         	#define _LUCENE_THREADID_TYPE uint64_t
@@ -69,6 +69,12 @@ ${SYMBOL__T}
 /* Define if we have gcc atomic functions */
 #cmakedefine _CL_HAVE_GCC_ATOMIC_FUNCTIONS 1
 
+/* Define if we have the gcc atomic builtins which take a memory order */
+#cmakedefine _CL_HAVE_GCC_ATOMIC_BUILTINS 1
+
+/* Define if we have std::atomic */
+#cmakedefine _CL_HAVE_STD_ATOMIC 1
+
 /* Define what eval method is required for float_t to be defined (for GCC). */
 #cmakedefine _FLT_EVAL_METHOD  ${_FLT_EVAL_METHOD} 
 
@@ -184,17 +184,18 @@ CL_NS_DEF(util)
         return pthread_self();
     }
       
+    //_LUCENE_ATOMIC_INC and _LUCENE_ATOMIC_DEC only call these when there are no compiler atomics
     int32_t atomic_threads::atomic_increment(_LUCENE_ATOMIC_INT *theInteger){
-      #ifdef _CL_HAVE_GCC_ATOMIC_FUNCTIONS
-        return __sync_add_and_fetch(theInteger, 1);
+      #if defined(_CL_HAVE_GCC_ATOMIC_BUILTINS) || defined(_CL_HAVE_GCC_ATOMIC_FUNCTIONS) || defined(_CL_HAVE_STD_ATOMIC)
+        return _LUCENE_ATOMIC_INC(theInteger);
       #else
         SCOPED_LOCK_MUTEX(theInteger->THIS_LOCK)
         return ++theInteger->value;
       #endif
     }
     int32_t atomic_threads::atomic_decrement(_LUCENE_ATOMIC_INT *theInteger){
-      #ifdef _CL_HAVE_GCC_ATOMIC_FUNCTIONS
-        return __sync_sub_and_fetch(theInteger, 1);
+      #if defined(_CL_HAVE_GCC_ATOMIC_BUILTINS) || defined(_CL_HAVE_GCC_ATOMIC_FUNCTIONS) || defined(_CL_HAVE_STD_ATOMIC)
+        return _LUCENE_ATOMIC_DEC(theInteger);
       #else
         SCOPED_LOCK_MUTEX(theInteger->THIS_LOCK)
         return --theInteger->value;
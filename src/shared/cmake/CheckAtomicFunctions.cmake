@@ -23,3 +23,34 @@ int main()
 " ${result} )
 
 ENDMACRO ( CHECK_HAVE_GCC_ATOMIC_FUNCTIONS result )
+
+MACRO ( CHECK_HAVE_GCC_ATOMIC_BUILTINS result )
+
+# the __atomic builtins take a memory order, unlike the __sync ones which are always a full barrier
+CHECK_CXX_SOURCE_RUNS("
+#include <cstdlib>
+int main()
+{
+   unsigned value = 0;
+   __atomic_add_fetch(&value, 1, __ATOMIC_RELAXED);
+   if (__atomic_sub_fetch(&value, 1, __ATOMIC_ACQ_REL) != 0)
+      return EXIT_FAILURE;
+   return EXIT_SUCCESS;
+}
+" ${result} )
+
+ENDMACRO ( CHECK_HAVE_GCC_ATOMIC_BUILTINS result )
+
+MACRO ( CHECK_HAVE_STD_ATOMIC result )
+
+CHECK_CXX_SOURCE_COMPILES("
+#include <atomic>
+int main()
+{
+   std::atomic<int> value(0);
+   value.fetch_add(1, std::memory_order_relaxed);
+   return value.fetch_sub(1, std::memory_order_acq_rel) - 1;
+}
+" ${result} )
+
+ENDMACRO ( CHECK_HAVE_STD_ATOMIC result )
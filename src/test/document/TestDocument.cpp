@@ -286,6 +286,136 @@ public:
   }
 
 
+  static int64_t _blockFilesLength(Directory* dir, const char* ext){
+    std::vector<std::string> files;
+    dir->list(files);
+    int64_t length = 0;
+    const size_t extLen = strlen(ext);
+    for (size_t i = 0; i < files.size(); i++){
+      if (files[i].length() > extLen && files[i].compare(files[i].length() - extLen, extLen, ext) == 0)
+        length += dir->fileLength(files[i].c_str());
+    }
+    return length;
+  }
+
+  //every 50th document is larger than a whole block and does not compress well
+  static void _blockBody(int32_t docNum, TCHAR* buf, size_t bufLen){
+    const TCHAR* words = _T("the quick brown fox jumps over the lazy dog ");
+    const size_t wordsLen = _tcslen(words);
+    size_t len = docNum % 50 == 49 ? 20000 : 100 + (docNum * 37) % 400;
+    if ( len >= bufLen )
+      len = bufLen - 1;
+    uint32_t seed = docNum;
+    _i64tot(docNum, buf, 10);
+    for ( size_t i = _tcslen(buf); i < len; i++ ){
+      if ( docNum % 50 == 49 ){
+        seed = seed * 1103515245 + 12345;
+        buf[i] = _T('a') + (seed >> 16) % 26;
+      }else
+        buf[i] = words[i % wordsLen];
+    }
+    buf[len] = 0;
+  }
+
+  static void _indexBlockDocs(Directory* dir, int32_t compression, int32_t first, int32_t count, bool create){
+    WhitespaceAnalyzer an;
+    IndexWriter writer(dir, &an, create);
+    writer.setStoredFieldsCompression(compression);
+    writer.setUseCompoundFile(false);
+    writer.setMaxBufferedDocs(40);
+    writer.setMergeFactor(3);
+
+    TCHAR id[20];
+    TCHAR* body = _CL_NEWARRAY(TCHAR, 20001);
+    for ( int32_t i = first; i < first + count; i++ ){
+      Document doc;
+      _i64tot(i, id, 10);
+      _blockBody(i, body, 20001);
+      doc.add(*_CLNEW Field(_T("id"), id, Field::STORE_YES | Field::INDEX_UNTOKENIZED));
+      doc.add(*_CLNEW Field(_T("body"), body, Field::STORE_YES | Field::INDEX_TOKENIZED));
+
+      ValueArray<uint8_t> bin(16);
+      for ( size_t j = 0; j < bin.length; j++ )
+        bin[j] = (uint8_t)(i * j);
+      doc.add(*_CLNEW Field(_T("bin"), &bin, Field::STORE_YES | Field::INDEX_NO, true));
+      if ( i % 7 == 0 )
+        doc.add(*_CLNEW Field(_T("zip"), body, Field::STORE_COMPRESS | Field::INDEX_NO));
+      writer.addDocument(&doc);
+    }
+    _CLDELETE_ARRAY(body);
+    //appending to an index merges the old and the new segments together
+    if ( create )
+      writer.optimize(3);
+    else
+      writer.optimize();
+    writer.close();
+  }
+
+  static void _checkBlockDocs(CuTest* tc, Directory* dir, int32_t numDocs){
+    IndexReader* reader = IndexReader::open(dir);
+    CuAssertIntEquals(tc, _T("numDocs"), numDocs, reader->numDocs());
+
+    MapFieldSelector lazyBody;
+    lazyBody.add(_T("id"), FieldSelector::LOAD);
+    lazyBody.add(_T("body"), FieldSelector::LAZY_LOAD);
+
+    TCHAR id[20];
+    TCHAR* body = _CL_NEWARRAY(TCHAR, 20001);
+    //visit the documents out of order, so that blocks are not read sequentially
+    for ( int32_t k = 0; k < numDocs; k++ ){
+      const int32_t i = (int32_t)(((int64_t)k * 7919) % numDocs);
+      _i64tot(i, id, 10);
+      _blockBody(i, body, 20001);
+
+      Document doc;
+      reader->document(i, doc);
+      CuAssertStrEquals(tc, _T("check id"), id, doc.get(_T("id")));
+      CuAssertStrEquals(tc, _T("check body"), body, doc.get(_T("body")));
+      const ValueArray<uint8_t>* bin = doc.getField(_T("bin"))->binaryValue();
+      CuAssertIntEquals(tc, _T("check binary length"), 16, bin->length);
+      for ( size_t j = 0; j < bin->length; j++ )
+        CuAssertIntEquals(tc, _T("check binary value"), (uint8_t)(i * j), (*bin)[j]);
+      if ( i % 7 == 0 )
+        CuAssertStrEquals(tc, _T("check compressed field"), body, doc.get(_T("zip")));
+      else
+        CLUCENE_ASSERT(doc.getField(_T("zip")) == NULL);
+
+      if ( k % 10 == 0 ){
+        Document lazyDoc;
+        reader->document(i, lazyDoc, &lazyBody);
+        CLUCENE_ASSERT(lazyDoc.getFields()->size() == 2);
+        CuAssertStrEquals(tc, _T("check lazy id"), id, lazyDoc.get(_T("id")));
+        CuAssertStrEquals(tc, _T("check lazy body"), body, lazyDoc.get(_T("body")));
+      }
+    }
+    _CLDELETE_ARRAY(body);
+    reader->close();
+    _CLDELETE(reader);
+  }
+
+  void TestBlockCompressedDocuments(CuTest *tc){
+    const int32_t codecs[] = { IndexWriter::STORED_FIELDS_FAST, IndexWriter::STORED_FIELDS_DEFLATE };
+    for ( int32_t c = 0; c < 2; c++ ){
+      RAMDirectory dir;
+      RAMDirectory plainDir;
+      _indexBlockDocs(&plainDir, IndexWriter::STORED_FIELDS_UNCOMPRESSED, 0, 300, true);
+      _indexBlockDocs(&dir, codecs[c], 0, 300, true);
+      CLUCENE_ASSERT(_blockFilesLength(&dir, ".fdt") < _blockFilesLength(&plainDir, ".fdt") * 3 / 4);
+      _checkBlockDocs(tc, &dir, 300);
+
+      //merging copies documents between the block and the plain formats
+      _indexBlockDocs(&dir, IndexWriter::STORED_FIELDS_UNCOMPRESSED, 300, 100, false);
+      _checkBlockDocs(tc, &dir, 400);
+      _indexBlockDocs(&dir, codecs[c], 400, 100, false);
+      _checkBlockDocs(tc, &dir, 500);
+
+      dir.close();
+      plainDir.close();
+      _CL_DECREF(&dir);
+      _CL_DECREF(&plainDir);
+    }
+  }
+
 
 CuSuite *testdocument(void)
 {
@@ -295,6 +425,7 @@ CuSuite *testdocument(void)
   SUITE_ADD_TEST(suite, TestBinaryDocument);
   SUITE_ADD_TEST(suite, TestLazyCompressedDocument);
   SUITE_ADD_TEST(suite, TestLazyBinaryDocument);
+  SUITE_ADD_TEST(suite, TestBlockCompressedDocuments);
 	SUITE_ADD_TEST(suite, TestFieldSelectors);
 	SUITE_ADD_TEST(suite, TestFields);
 	//SUITE_ADD_TEST(suite, TestDateTools);
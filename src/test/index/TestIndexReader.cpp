@@ -9,6 +9,7 @@
 #include "CLucene/index/_SegmentHeader.h"
 #include "CLucene/index/_MultiSegmentReader.h"
 #include "CLucene/index/MultiReader.h"
+#include "CLucene/store/MMapDirectory.h"
 
 typedef IndexReader* (*TestIRModifyIndex)(CuTest* tc, IndexReader* reader, int modify);
 DEFINE_MUTEX(createReaderMutex)
@@ -298,11 +299,233 @@ void testMultiReaderReopen(CuTest *tc){
   //_CLDELETE(index2B);
 }
 
+//compares the bulk TermDocs::read with next() for a dense and a sparse term
+void _testTermDocsRead(CuTest* tc, Directory* dir, bool compound){
+  WhitespaceAnalyzer analyzer;
+  IndexWriter* w = _CLNEW IndexWriter(dir, &analyzer, true);
+  w->setUseCompoundFile(compound);
+  Document doc;
+  StringBuffer sb;
+  for (int32_t i = 0; i < 2000; i++) {
+    sb.clear();
+    for (int32_t j = 0; j <= i % 3; j++)
+      sb.append(_T("all "));
+    if (i % 97 == 0)
+      sb.append(_T("rare"));
+    doc.clear();
+    doc.add(*_CLNEW Field(_T("content"), sb.getBuffer(), Field::STORE_NO | Field::INDEX_TOKENIZED));
+    w->addDocument(&doc);
+  }
+  w->optimize();
+  w->close();
+  _CLDELETE(w);
+
+  IndexReader* reader = IndexReader::open(dir);
+  for (int32_t i = 100; i < 400; i += 5)
+    reader->deleteDocument(i); //dense deletions
+  reader->deleteDocument(1455);
+
+  const TCHAR* terms[] = { _T("all"), _T("rare"), NULL };
+  const int32_t batchSizes[] = { 1, 7, 32 };
+  for (int32_t t = 0; terms[t] != NULL; t++) {
+    Term* term = _CLNEW Term(_T("content"), terms[t]);
+    for (int32_t b = 0; b < 3; b++) {
+      TermDocs* expected = reader->termDocs(term);
+      TermDocs* actual = reader->termDocs(term);
+      int32_t docs[32];
+      int32_t freqs[32];
+      int32_t total = 0;
+      int32_t n;
+      while ((n = actual->read(docs, freqs, batchSizes[b])) > 0) {
+        for (int32_t i = 0; i < n; i++) {
+          CLUCENE_ASSERT(expected->next());
+          CLUCENE_ASSERT(docs[i] == expected->doc());
+          CLUCENE_ASSERT(freqs[i] == expected->freq());
+          CLUCENE_ASSERT(!reader->isDeleted(docs[i]));
+        }
+        total += n;
+      }
+      CLUCENE_ASSERT(!expected->next());
+      CLUCENE_ASSERT(total > 0);
+      _CLDELETE(expected);
+      _CLDELETE(actual);
+    }
+    _CLDECDELETE(term);
+  }
+  reader->close();
+  _CLDELETE(reader);
+}
+
+void testTermDocsRead(CuTest *tc){
+  RAMDirectory ram;
+  _testTermDocsRead(tc, &ram, true);
+
+  char fsdir[CL_MAX_PATH];
+  _snprintf(fsdir, CL_MAX_PATH, "%s/%s", cl_tempDir, "test.termdocsread");
+  FSDirectory* fs = FSDirectory::getDirectory(fsdir);
+  _testTermDocsRead(tc, fs, false);
+  fs->close();
+  _CLDECDELETE(fs);
+
+  _snprintf(fsdir, CL_MAX_PATH, "%s/%s", cl_tempDir, "test.termdocsreadmmap");
+  MMapDirectory* mmap = MMapDirectory::getDirectory(fsdir);
+  _testTermDocsRead(tc, mmap, false);
+  mmap->close();
+  _CLDECDELETE(mmap);
+}
+
+//looks up every term of an index with a small term index interval, so
+//most lookups go through the packed term index
+void _testTermInfosIndex(CuTest* tc, Directory* dir, int32_t indexDivisor){
+  IndexReader* reader = IndexReader::open(dir);
+  if ( indexDivisor > 1 )
+    reader->setTermInfosIndexDivisor(indexDivisor);
+
+  std::vector<Term*> terms;
+  std::vector<int32_t> docFreqs;
+  TermEnum* te = reader->terms();
+  while (te->next()) {
+    terms.push_back(te->term());
+    docFreqs.push_back(te->docFreq());
+  }
+  _CLDELETE(te);
+  CLUCENE_ASSERT(terms.size() > 500);
+
+  StringBuffer sb;
+  for (int32_t i = (int32_t)terms.size() - 1; i >= 0; i--) {
+    assertEquals(docFreqs[i], reader->docFreq(terms[i]));
+    te = reader->terms(terms[i]);
+    CLUCENE_ASSERT(te->term(false) != NULL && te->term(false)->equals(terms[i]));
+    _CLDELETE(te);
+
+    //a text which sorts right after the term is positioned on the next term
+    sb.clear();
+    sb.append(terms[i]->text());
+    sb.appendChar('!');
+    Term* probe = _CLNEW Term(terms[i]->field(), sb.getBuffer());
+    assertEquals(0, reader->docFreq(probe));
+    te = reader->terms(probe);
+    if ( i + 1 < (int32_t)terms.size() )
+      CLUCENE_ASSERT(te->term(false) != NULL && te->term(false)->equals(terms[i+1]));
+    else
+      CLUCENE_ASSERT(te->term(false) == NULL);
+    _CLDELETE(te);
+    _CLDECDELETE(probe);
+  }
+
+  //a field which is not in the index, between two which are
+  Term* probe = _CLNEW Term(_T("aa"), _T("x"));
+  te = reader->terms(probe);
+  CLUCENE_ASSERT(te->term(false) != NULL && _tcscmp(te->term(false)->field(), _T("b")) == 0);
+  _CLDELETE(te);
+  _CLDECDELETE(probe);
+
+  for (size_t i = 0; i < terms.size(); i++)
+    _CLDECDELETE(terms[i]);
+  reader->close();
+  _CLDELETE(reader);
+}
+
+void testTermInfosIndex(CuTest *tc){
+  RAMDirectory dir;
+  WhitespaceAnalyzer analyzer;
+  IndexWriter* w = _CLNEW IndexWriter(&dir, &analyzer, true);
+  w->setTermIndexInterval(4);
+  Document doc;
+  TCHAR buf[100];
+  //field b is numbered before a, so field numbers do not sort like the names
+  const TCHAR* fields[] = { _T("b"), _T("a"), _T("c") };
+  const TCHAR endings[] = { 0xE9, 0x4E2D, 'z' };
+  for (int32_t i = 0; i < 300; i++) {
+    doc.clear();
+    for (int32_t f = 0; f < 3; f++) {
+      _sntprintf(buf, 100, _T("w%d"), (i * (f + 3)) % 257);
+      size_t len = _tcslen(buf);
+      buf[len++] = endings[i % 3];
+      if ( i % 50 == 0 ) { //long enough to not be encoded on the stack
+        for (int32_t j = 0; j < 60; j++)
+          buf[len++] = 'a' + (j + f) % 26;
+      }
+      buf[len] = 0;
+      doc.add(*_CLNEW Field(fields[f], buf, Field::STORE_NO | Field::INDEX_UNTOKENIZED));
+    }
+    w->addDocument(&doc);
+  }
+  w->optimize();
+  w->close();
+  _CLDELETE(w);
+
+  _testTermInfosIndex(tc, &dir, 1);
+  _testTermInfosIndex(tc, &dir, 3);
+}
+
+//terms whose characters take 1, 2 and 3 bytes in the Term Infos File, with
+//the default term index interval, so lookups scan over many of them
+void testTermScanUTF8(CuTest *tc){
+  RAMDirectory dir;
+  WhitespaceAnalyzer analyzer;
+  IndexWriter* w = _CLNEW IndexWriter(&dir, &analyzer, true);
+  Document doc;
+  TCHAR buf[20];
+  const TCHAR chars[] = { 0x41, 0x7F, 0x80, 0xE9, 0x7FF, 0x800, 0x4E2D, 0xFFFD };
+  const int32_t numChars = sizeof(chars) / sizeof(TCHAR);
+  for (int32_t i = 0; i < 600; i++) {
+    doc.clear();
+    buf[0] = 'p';
+    buf[1] = chars[i % numChars];
+    buf[2] = chars[(i / numChars) % numChars];
+    _sntprintf(buf + 3, 17, _T("%d"), i / (numChars * numChars));
+    doc.add(*_CLNEW Field(_T("f"), buf, Field::STORE_NO | Field::INDEX_UNTOKENIZED));
+    w->addDocument(&doc);
+  }
+  w->optimize();
+  w->close();
+  _CLDELETE(w);
+
+  IndexReader* reader = IndexReader::open(&dir);
+  std::vector<Term*> terms;
+  TermEnum* te = reader->terms();
+  while (te->next()) {
+    if ( terms.size() > 0 )
+      CLUCENE_ASSERT(terms.back()->compareTo(te->term(false)) < 0);
+    terms.push_back(te->term());
+  }
+  _CLDELETE(te);
+  assertEquals(600, (int32_t)terms.size());
+
+  //in order, so that the cached enumerator scans forward from term to term
+  StringBuffer sb;
+  for (size_t i = 0; i < terms.size(); i++) {
+    assertEquals(1, reader->docFreq(terms[i]));
+
+    sb.clear();
+    sb.append(terms[i]->text());
+    sb.appendChar(0x7F);
+    Term* probe = _CLNEW Term(terms[i]->field(), sb.getBuffer());
+    assertEquals(0, reader->docFreq(probe));
+    te = reader->terms(probe);
+    if ( i + 1 < terms.size() )
+      CLUCENE_ASSERT(te->term(false) != NULL && te->term(false)->equals(terms[i+1]));
+    else
+      CLUCENE_ASSERT(te->term(false) == NULL);
+    _CLDELETE(te);
+    _CLDECDELETE(probe);
+  }
+
+  for (size_t i = 0; i < terms.size(); i++)
+    _CLDECDELETE(terms[i]);
+  reader->close();
+  _CLDELETE(reader);
+}
+
 CuSuite *testindexreader(void)
 {
 	CuSuite *suite = CuSuiteNew(_T("CLucene IndexReader Test"));
   SUITE_ADD_TEST(suite, testIndexReaderReopen);
   SUITE_ADD_TEST(suite, testMultiReaderReopen);
+  SUITE_ADD_TEST(suite, testTermDocsRead);
+  SUITE_ADD_TEST(suite, testTermInfosIndex);
+  SUITE_ADD_TEST(suite, testTermScanUTF8);
 
   return suite;
 }
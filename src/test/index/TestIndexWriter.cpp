@@ -6,6 +6,8 @@
 ------------------------------------------------------------------------------*/
 #include "test.h"
 #include <CLucene/search/MatchAllDocsQuery.h>
+#include <CLucene/index/MergeScheduler.h>
+#include <CLucene/util/ThreadPool.h>
 #include <stdio.h>
 
 //checks if a merged index finds phrases correctly
@@ -643,6 +645,482 @@ void testMergeIndex(CuTest* tc) {
   _CLLDELETE( dir );
 }
 
+//indexes docs with a small buffer so that many merges are run by cms
+void _testConcurrentMerges(CuTest* tc, ConcurrentMergeScheduler* cms, const char* dirName){
+    char fsdir[CL_MAX_PATH];
+    _snprintf(fsdir, CL_MAX_PATH, "%s/%s",cl_tempDir, dirName);
+    WhitespaceAnalyzer a;
+    Directory* dir = FSDirectory::getDirectory(fsdir);
+
+    IndexWriter* writer = _CLNEW IndexWriter(dir, &a, true);
+    writer->setMergeScheduler(cms);
+    writer->setMaxBufferedDocs(2);
+    writer->setMergeFactor(3);
+
+    const int32_t numDocs = 300;
+    for (int32_t i = 0; i < numDocs; i++){
+        Document doc;
+        doc.add(*_CLNEW Field(_T("content"), i % 2 == 0 ? _T("aaa even") : _T("aaa odd"),
+            Field::STORE_YES | Field::INDEX_TOKENIZED));
+        writer->addDocument(&doc);
+    }
+    writer->optimize();
+    CLUCENE_ASSERT(cms->mergeThreadCount() <= cms->getMaxThreadCount());
+    writer->close();
+    CLUCENE_ASSERT(!cms->anyUnhandledExceptions());
+    CLUCENE_ASSERT(cms->mergeThreadCount() == 0);
+    _CLLDELETE(writer); //also deletes cms
+
+    IndexReader* reader = IndexReader::open(dir);
+    CLUCENE_ASSERT(reader->numDocs() == numDocs);
+    Term* t = _CLNEW Term(_T("content"), _T("even"));
+    CLUCENE_ASSERT(reader->docFreq(t) == numDocs / 2);
+    _CLDECDELETE(t);
+    t = _CLNEW Term(_T("content"), _T("aaa"));
+    CLUCENE_ASSERT(reader->docFreq(t) == numDocs);
+    _CLDECDELETE(t);
+    reader->close();
+    _CLLDELETE(reader);
+
+    dir->close();
+    _CLDECDELETE(dir);
+}
+
+void testConcurrentMergeScheduler(CuTest* tc){
+    ConcurrentMergeScheduler* cms = _CLNEW ConcurrentMergeScheduler();
+    cms->setMaxThreadCount(2);
+    cms->setMaxMergeCount(2);
+    CLUCENE_ASSERT(cms->getMaxMergeCount() == 2);
+    try{
+        cms->setMaxMergeCount(1);
+        CuFail(tc, _T("maxMergeCount below maxThreadCount should throw"));
+    }catch(CLuceneError& e){
+        CLUCENE_ASSERT(e.number() == CL_ERR_IllegalArgument);
+    }
+    _testConcurrentMerges(tc, cms, "test.cms");
+}
+
+void testConcurrentMergeSchedulerThrottled(CuTest* tc){
+    ConcurrentMergeScheduler* cms = _CLNEW ConcurrentMergeScheduler();
+    cms->setMaxMergeWriteMBPerSec(20);
+    CLUCENE_ASSERT(cms->getMaxMergeWriteMBPerSec() == 20);
+    _testConcurrentMerges(tc, cms, "test.cmsthrottled");
+}
+
+//indexes the same documents into dir in several segments, with some deleted
+void _indexForMergeThreadPool(Directory* dir, ThreadPool* pool){
+    WhitespaceAnalyzer a;
+    IndexWriter writer(dir, &a, true);
+    writer.setMergeThreadPool(pool);
+    writer.setMaxBufferedDocs(7);
+    writer.setMergeFactor(4);
+    TCHAR buf[80];
+    for (int32_t i = 0; i < 200; i++){
+        Document doc;
+        _sntprintf(buf, 80, _T("w%d w%d w%d common"), i % 13, i % 5, i % 13);
+        doc.add(*_CLNEW Field(_T("content"), buf, Field::STORE_YES | Field::INDEX_TOKENIZED | Field::TERMVECTOR_WITH_POSITIONS_OFFSETS));
+        _sntprintf(buf, 80, _T("%d"), i);
+        doc.add(*_CLNEW Field(_T("id"), buf, Field::STORE_YES | Field::INDEX_UNTOKENIZED));
+        Field* boosted = _CLNEW Field(_T("title"), _T("title"), Field::STORE_NO | Field::INDEX_TOKENIZED);
+        boosted->setBoost(1.0f + (i % 4));
+        doc.add(*boosted);
+        writer.addDocument(&doc);
+        if (i % 50 == 49){
+            _sntprintf(buf, 80, _T("%d"), i - 10);
+            Term* t = _CLNEW Term(_T("id"), buf);
+            writer.deleteDocuments(t);
+            _CLDECDELETE(t);
+        }
+    }
+    writer.optimize();
+    writer.close();
+}
+
+//merges with the phases of each merge on a pool and checks the index equals a serially merged one
+void testMergeThreadPool(CuTest* tc){
+    RAMDirectory serialDir;
+    RAMDirectory parallelDir;
+    ThreadPool pool(2);
+    _indexForMergeThreadPool(&serialDir, NULL);
+    _indexForMergeThreadPool(&parallelDir, &pool);
+
+    IndexReader* serial = IndexReader::open(&serialDir);
+    IndexReader* parallel = IndexReader::open(&parallelDir);
+    CLUCENE_ASSERT(parallel->numDocs() == 196);
+    CLUCENE_ASSERT(parallel->maxDoc() == serial->maxDoc());
+
+    //stored fields, norms and term vectors
+    const int32_t maxDoc = serial->maxDoc();
+    for (int32_t i = 0; i < maxDoc; i++){
+        Document d1, d2;
+        serial->document(i, d1);
+        parallel->document(i, d2);
+        assertTrue(_tcscmp(d1.get(_T("content")), d2.get(_T("content"))) == 0);
+        assertTrue(_tcscmp(d1.get(_T("id")), d2.get(_T("id"))) == 0);
+
+        TermFreqVector* v1 = serial->getTermFreqVector(i, _T("content"));
+        TermFreqVector* v2 = parallel->getTermFreqVector(i, _T("content"));
+        assertTrue(v1 != NULL && v2 != NULL);
+        assertTrue(v1->size() == v2->size());
+        for (int32_t j = 0; j < v1->size(); j++){
+            assertTrue(_tcscmp(v1->getTerms()->values[j], v2->getTerms()->values[j]) == 0);
+            assertTrue(v1->getTermFrequencies()->values[j] == v2->getTermFrequencies()->values[j]);
+        }
+        _CLLDELETE(v1);
+        _CLLDELETE(v2);
+    }
+    assertTrue(memcmp(serial->norms(_T("title")), parallel->norms(_T("title")), maxDoc) == 0);
+
+    //terms and postings
+    TermEnum* e1 = serial->terms();
+    TermEnum* e2 = parallel->terms();
+    TermPositions* p1 = serial->termPositions();
+    TermPositions* p2 = parallel->termPositions();
+    int32_t numTerms = 0;
+    while (e1->next()){
+        assertTrue(e2->next());
+        assertTrue(e1->term(false)->equals(e2->term(false)));
+        assertTrue(e1->docFreq() == e2->docFreq());
+        p1->seek(e1);
+        p2->seek(e2);
+        while (p1->next()){
+            assertTrue(p2->next());
+            assertTrue(p1->doc() == p2->doc());
+            assertTrue(p1->freq() == p2->freq());
+            for (int32_t j = 0; j < p1->freq(); j++)
+                assertTrue(p1->nextPosition() == p2->nextPosition());
+        }
+        assertTrue(!p2->next());
+        numTerms++;
+    }
+    assertTrue(!e2->next());
+    assertTrue(numTerms > 200);
+    p1->close(); _CLLDELETE(p1);
+    p2->close(); _CLLDELETE(p2);
+    e1->close(); _CLLDELETE(e1);
+    e2->close(); _CLLDELETE(e2);
+
+    serial->close(); _CLLDELETE(serial);
+    parallel->close(); _CLLDELETE(parallel);
+}
+
+//adds docs with ids from start to end to writer
+void _addNRTDocs(IndexWriter* writer, int32_t start, int32_t end){
+    TCHAR buf[20];
+    for (int32_t i = start; i < end; i++){
+        Document doc;
+        _sntprintf(buf, 20, _T("%d"), i);
+        doc.add(*_CLNEW Field(_T("id"), buf, Field::STORE_YES | Field::INDEX_UNTOKENIZED));
+        doc.add(*_CLNEW Field(_T("content"), i % 2 == 0 ? _T("aaa even") : _T("aaa odd"),
+            Field::STORE_YES | Field::INDEX_TOKENIZED));
+        writer->addDocument(&doc);
+    }
+}
+
+//checks that every document of reader can be read and returns the number of them
+int32_t _checkNRTDocs(CuTest* tc, IndexReader* reader){
+    int32_t count = 0;
+    for (int32_t i = 0; i < reader->maxDoc(); i++){
+        if (reader->isDeleted(i))
+            continue;
+        Document doc;
+        reader->document(i, doc);
+        CLUCENE_ASSERT(doc.get(_T("id")) != NULL && doc.get(_T("content")) != NULL);
+        count++;
+    }
+    Term* t = _CLNEW Term(_T("content"), _T("aaa"));
+    CLUCENE_ASSERT(reader->docFreq(t) >= count);
+    _CLDECDELETE(t);
+    return count;
+}
+
+void testNRTReader(CuTest* tc){
+    RAMDirectory dir;
+    WhitespaceAnalyzer a;
+    IndexWriter* writer = _CLNEW IndexWriter(&dir, false, &a, true);
+    writer->setMergeScheduler(_CLNEW SerialMergeScheduler());
+    writer->setMaxBufferedDocs(10);
+    writer->setMergeFactor(10);
+    _addNRTDocs(writer, 0, 25);
+
+    //sees the uncommitted documents, including the buffered ones
+    IndexReader* reader = writer->getReader();
+    CLUCENE_ASSERT(reader->numDocs() == 25);
+    CLUCENE_ASSERT(_checkNRTDocs(tc, reader) == 25);
+    CLUCENE_ASSERT(reader->isCurrent());
+    CLUCENE_ASSERT(reader->reopen() == reader);
+    IndexReader* committed = IndexReader::open(&dir);
+    CLUCENE_ASSERT(committed->numDocs() == 0);
+    committed->close();
+    _CLLDELETE(committed);
+
+    //sees deletes and new documents once reopened
+    _addNRTDocs(writer, 25, 40);
+    Term* t = _CLNEW Term(_T("id"), _T("3"));
+    writer->deleteDocuments(t);
+    _CLDECDELETE(t);
+    CLUCENE_ASSERT(!reader->isCurrent());
+    IndexReader* reopened = reader->reopen();
+    CLUCENE_ASSERT(reopened != reader);
+    CLUCENE_ASSERT(reopened->numDocs() == 39);
+    CLUCENE_ASSERT(reader->numDocs() == 25);
+    reader->close();
+    _CLLDELETE(reader);
+    reader = reopened;
+
+    //the files of the reader's segments are kept while they are merged away
+    writer->optimize();
+    CLUCENE_ASSERT(_checkNRTDocs(tc, reader) == 39);
+    reopened = reader->reopen();
+    CLUCENE_ASSERT(reopened != reader);
+    CLUCENE_ASSERT(reopened->getSubReaders() == NULL || reopened->getSubReaders()->length == 1);
+    CLUCENE_ASSERT(_checkNRTDocs(tc, reopened) == 39);
+    reader->close();
+    _CLLDELETE(reader);
+    reader = reopened;
+
+    //the reader outlives the writer
+    writer->close();
+    _CLLDELETE(writer);
+    CLUCENE_ASSERT(_checkNRTDocs(tc, reader) == 39);
+    reader->close();
+    _CLLDELETE(reader);
+
+    reader = IndexReader::open(&dir);
+    CLUCENE_ASSERT(reader->numDocs() == 39);
+    reader->close();
+    _CLLDELETE(reader);
+}
+
+//updates the same documents over and over, so that the deletes are applied
+//with the pooled readers while merges read from them
+void testPooledReaders(CuTest* tc){
+    for (int32_t pass = 0; pass < 2; pass++){
+        RAMDirectory dir;
+        WhitespaceAnalyzer a;
+        IndexWriter* writer = _CLNEW IndexWriter(&dir, pass == 0, &a, true);
+        writer->setMaxBufferedDocs(5);
+        writer->setMergeFactor(3);
+        TCHAR buf[20];
+        for (int32_t i = 0; i < 300; i++){
+            Document doc;
+            _sntprintf(buf, 20, _T("%d"), i % 20);
+            doc.add(*_CLNEW Field(_T("id"), buf, Field::STORE_YES | Field::INDEX_UNTOKENIZED));
+            doc.add(*_CLNEW Field(_T("content"), _T("aaa"), Field::STORE_YES | Field::INDEX_TOKENIZED));
+            Term* t = _CLNEW Term(_T("id"), buf);
+            writer->updateDocument(t, &doc);
+            _CLDECDELETE(t);
+        }
+        writer->close();
+        _CLLDELETE(writer);
+
+        IndexReader* reader = IndexReader::open(&dir);
+        CLUCENE_ASSERT(reader->numDocs() == 20);
+        CLUCENE_ASSERT(_checkNRTDocs(tc, reader) == 20);
+        for (int32_t i = 0; i < 20; i++){
+            _sntprintf(buf, 20, _T("%d"), i);
+            Term* t = _CLNEW Term(_T("id"), buf);
+            TermDocs* td = reader->termDocs(t);
+            int32_t count = 0;
+            while (td->next())
+                count++;
+            CLUCENE_ASSERT(count == 1);
+            _CLDELETE(td);
+            _CLDECDELETE(t);
+        }
+        reader->close();
+        _CLLDELETE(reader);
+    }
+}
+
+//indexes many distinct terms with a small RAM buffer, so that the
+//postings are freed and allocated again while balancing the RAM
+void testSmallRAMBuffer(CuTest* tc){
+    RAMDirectory dir;
+    WhitespaceAnalyzer a;
+    IndexWriter* writer = _CLNEW IndexWriter(&dir, &a, true);
+    writer->setRAMBufferSizeMB(0.1f);
+    StringBuffer content;
+    TCHAR buf[20];
+    for (int32_t i = 0; i < 500; i++){
+        content.clear();
+        for (int32_t j = 0; j < 50; j++){
+            _sntprintf(buf, 20, _T("t%d "), i * 50 + j);
+            content.append(buf);
+        }
+        content.append(_T("common"));
+        Document doc;
+        doc.add(*_CLNEW Field(_T("content"), content.getBuffer(), Field::STORE_NO | Field::INDEX_TOKENIZED));
+        writer->addDocument(&doc);
+    }
+    // Few distinct terms but long postings: the postings freed by the
+    // last flush have to make room for more byte blocks
+    for (int32_t i = 0; i < 100; i++){
+        content.clear();
+        for (int32_t j = 0; j < 500; j++){
+            _sntprintf(buf, 20, _T("c%d "), j % 10);
+            content.append(buf);
+        }
+        content.append(_T("common"));
+        Document doc;
+        doc.add(*_CLNEW Field(_T("content"), content.getBuffer(), Field::STORE_NO | Field::INDEX_TOKENIZED));
+        writer->addDocument(&doc);
+    }
+    writer->close();
+    _CLLDELETE(writer);
+
+    IndexReader* reader = IndexReader::open(&dir);
+    CLUCENE_ASSERT(reader->numDocs() == 600);
+    Term* t = _CLNEW Term(_T("content"), _T("common"));
+    CLUCENE_ASSERT(reader->docFreq(t) == 600);
+    _CLDECDELETE(t);
+    t = _CLNEW Term(_T("content"), _T("c9"));
+    CLUCENE_ASSERT(reader->docFreq(t) == 100);
+    _CLDECDELETE(t);
+    t = _CLNEW Term(_T("content"), _T("t24999"));
+    CLUCENE_ASSERT(reader->docFreq(t) == 1);
+    _CLDECDELETE(t);
+    reader->close();
+    _CLLDELETE(reader);
+}
+
+static int64_t _filesLength(Directory* dir, const char* ext){
+    std::vector<std::string> files;
+    dir->list(files);
+    int64_t length = 0;
+    const size_t extLen = strlen(ext);
+    for (size_t i = 0; i < files.size(); i++){
+        if (files[i].length() > extLen && files[i].compare(files[i].length() - extLen, extLen, ext) == 0)
+            length += dir->fileLength(files[i].c_str());
+    }
+    return length;
+}
+
+static void _indexOmitTf(Directory* dir, bool omitTf){
+    WhitespaceAnalyzer a;
+    IndexWriter* writer = _CLNEW IndexWriter(dir, &a, true);
+    writer->setUseCompoundFile(false);
+    writer->setMaxBufferedDocs(7);
+    writer->setMergeFactor(2);
+    for (int32_t i = 0; i < 60; i++){
+        Document doc;
+        Field* f = _CLNEW Field(_T("tf"), _T("aaa aaa aaa bbb"), Field::STORE_YES | Field::INDEX_TOKENIZED);
+        doc.add(*f);
+        f = _CLNEW Field(_T("notf"), _T("aaa aaa aaa bbb"), Field::STORE_YES | Field::INDEX_TOKENIZED);
+        f->setOmitTf(omitTf);
+        doc.add(*f);
+        // omitted only for the second half of the docs
+        f = _CLNEW Field(_T("mixed"), _T("aaa aaa ccc"), Field::STORE_NO | Field::INDEX_TOKENIZED);
+        f->setOmitTf(omitTf && i >= 30);
+        doc.add(*f);
+        writer->addDocument(&doc);
+    }
+    writer->optimize();
+    writer->close();
+    _CLLDELETE(writer);
+}
+
+void testOmitTf(CuTest* tc){
+    RAMDirectory plainDir;
+    _indexOmitTf(&plainDir, false);
+    RAMDirectory dir;
+    _indexOmitTf(&dir, true);
+
+    // two fields lose their positions and freqs
+    CLUCENE_ASSERT(_filesLength(&dir, ".prx") < _filesLength(&plainDir, ".prx"));
+    CLUCENE_ASSERT(_filesLength(&dir, ".frq") < _filesLength(&plainDir, ".frq"));
+
+    IndexReader* reader = IndexReader::open(&dir);
+    CLUCENE_ASSERT(reader->numDocs() == 60);
+
+    // the flag is persisted in the field infos, and once omitted stays omitted
+    StringArrayWithDeletor names;
+    reader->getFieldNames(IndexReader::OMIT_TF, names);
+    assertEquals(2, (int32_t)names.size());
+    bool hasNotf = false, hasMixed = false;
+    for (StringArrayWithDeletor::iterator itr = names.begin(); itr != names.end(); itr++){
+        if (_tcscmp(*itr, _T("notf")) == 0) hasNotf = true;
+        if (_tcscmp(*itr, _T("mixed")) == 0) hasMixed = true;
+    }
+    CLUCENE_ASSERT(hasNotf && hasMixed);
+
+    Document doc;
+    CLUCENE_ASSERT(reader->document(0, doc));
+    CLUCENE_ASSERT(doc.getField(_T("notf"))->getOmitTf());
+    CLUCENE_ASSERT(!doc.getField(_T("tf"))->getOmitTf());
+
+    Term* t = _CLNEW Term(_T("notf"), _T("aaa"));
+    assertEquals(60, reader->docFreq(t));
+    TermDocs* td = reader->termDocs(t);
+    int32_t count = 0;
+    while (td->next()){
+        assertEquals(count, td->doc());
+        assertEquals(1, td->freq());
+        count++;
+    }
+    assertEquals(60, count);
+    td->seek(t);
+    CLUCENE_ASSERT(td->skipTo(45));
+    assertEquals(45, td->doc());
+    assertEquals(1, td->freq());
+    int32_t docs[32];
+    int32_t freqs[32];
+    td->seek(t);
+    count = 0;
+    int32_t n;
+    while ((n = td->read(docs, freqs, 32)) > 0){
+        for (int32_t i = 0; i < n; i++){
+            assertEquals(count, docs[i]);
+            assertEquals(1, freqs[i]);
+            count++;
+        }
+    }
+    assertEquals(60, count);
+    td->close();
+    _CLLDELETE(td);
+
+    TermPositions* tp = reader->termPositions(t);
+    CLUCENE_ASSERT(tp->next());
+    assertEquals(1, tp->freq());
+    assertEquals(0, tp->nextPosition());
+    tp->close();
+    _CLLDELETE(tp);
+    _CLDECDELETE(t);
+
+    // the field stored normally keeps its freqs and positions
+    t = _CLNEW Term(_T("tf"), _T("bbb"));
+    tp = reader->termPositions(t);
+    CLUCENE_ASSERT(tp->skipTo(50));
+    assertEquals(50, tp->doc());
+    assertEquals(1, tp->freq());
+    assertEquals(3, tp->nextPosition());
+    tp->close();
+    _CLLDELETE(tp);
+    _CLDECDELETE(t);
+
+    t = _CLNEW Term(_T("mixed"), _T("aaa"));
+    td = reader->termDocs(t);
+    CLUCENE_ASSERT(td->skipTo(10));
+    assertEquals(1, td->freq());
+    td->close();
+    _CLLDELETE(td);
+    _CLDECDELETE(t);
+
+    // scoring still works, with every doc matching once
+    IndexSearcher searcher(reader);
+    t = _CLNEW Term(_T("notf"), _T("aaa"));
+    TermQuery* q = _CLNEW TermQuery(t);
+    _CLDECDELETE(t);
+    TopDocs* top = searcher._search(q, NULL, 10);
+    assertEquals(60, top->totalHits);
+    _CLLDELETE(top);
+    _CLLDELETE(q);
+    searcher.close();
+
+    reader->close();
+    _CLLDELETE(reader);
+}
+
 CuSuite *testindexwriter(void)
 {
     CuSuite *suite = CuSuiteNew(_T("CLucene IndexWriter Test"));
@@ -660,6 +1138,13 @@ CuSuite *testindexwriter(void)
     SUITE_ADD_TEST(suite, testExceptionFromTokenStream);
     SUITE_ADD_TEST(suite, testDeleteDocument);
     SUITE_ADD_TEST(suite, testMergeIndex);
+    SUITE_ADD_TEST(suite, testConcurrentMergeScheduler);
+    SUITE_ADD_TEST(suite, testConcurrentMergeSchedulerThrottled);
+    SUITE_ADD_TEST(suite, testMergeThreadPool);
+    SUITE_ADD_TEST(suite, testNRTReader);
+    SUITE_ADD_TEST(suite, testPooledReaders);
+    SUITE_ADD_TEST(suite, testSmallRAMBuffer);
+    SUITE_ADD_TEST(suite, testOmitTf);
 
     return suite;
 }
@@ -149,12 +149,83 @@ void testFSThreading(CuTest *tc){
   _CLDECDELETE(directory);
 }
 
+#define TERM_LOOKUP_DOCS 500
+#define TERM_LOOKUP_THREADS 4
+bool termLookupFailed = false;
+_LUCENE_THREAD_FUNC(termLookupTest, _reader){
+  IndexReader* shared = (IndexReader*)_reader;
+  TCHAR buf[10];
+  uint32_t seed = (uint32_t)(size_t)&buf;
+  try {
+    for ( int iter=0; iter<50 && !termLookupFailed; iter++ ){
+      //readers opened and closed on this thread create and destroy their
+      //thread locals while the other threads use the shared reader's
+      IndexReader* own = IndexReader::open(shared->directory());
+      for ( int i=0; i<200; i++ ){
+        seed = seed * 1103515245 + 12345;
+        int32_t id = (seed >> 8) % TERM_LOOKUP_DOCS;
+        _i64tot(id, buf, 10);
+        Term t(_T("id"), buf);
+        IndexReader* r = (i % 2) == 0 ? shared : own;
+        if ( r->docFreq(&t) != 1 ){
+          fprintf(stderr, "err 5: docFreq of %d != 1\n", id);
+          termLookupFailed = true;
+        }
+        TermDocs* td = r->termDocs(&t);
+        if ( !td->next() || td->doc() != id ){
+          fprintf(stderr, "err 6: wrong document for %d\n", id);
+          termLookupFailed = true;
+        }
+        td->close();
+        _CLDELETE(td);
+      }
+      own->close();
+      _CLDELETE(own);
+    }
+  } catch (CLuceneError& e) {
+    fprintf(stderr, "err 7: #%d: %s\n", e.number(), e.what());
+    termLookupFailed = true;
+  }
+  _LUCENE_THREAD_FUNC_RETURN(0);
+}
+
+/*
+  Look up terms in one reader from several threads, each of which must
+  get its own term enumeration back from the reader's thread locals.
+ */
+void testConcurrentTermLookups(CuTest *tc){
+  RAMDirectory directory;
+  WhitespaceAnalyzer analyzer;
+  IndexWriter writer(&directory, &analyzer, true);
+  TCHAR buf[10];
+  for ( int i=0; i<TERM_LOOKUP_DOCS; i++ ){
+    Document d;
+    _i64tot(i, buf, 10);
+    d.add(*_CLNEW Field(_T("id"), buf, Field::STORE_NO | Field::INDEX_UNTOKENIZED));
+    writer.addDocument(&d);
+  }
+  writer.close();
+
+  IndexReader* reader = IndexReader::open(&directory);
+  _LUCENE_THREADID_TYPE threads[TERM_LOOKUP_THREADS];
+  for ( int i=0; i<TERM_LOOKUP_THREADS; i++ )
+    threads[i] = _LUCENE_THREAD_CREATE(&termLookupTest, reader);
+  for ( int i=0; i<TERM_LOOKUP_THREADS; i++ )
+    _LUCENE_THREAD_JOIN(threads[i]);
+  reader->close();
+  _CLDELETE(reader);
+  directory.close();
+
+  CuAssert(tc, _T("wrong term lookup in one of the threads\n"), !termLookupFailed);
+}
+
 CuSuite *testatomicupdates(void)
 {
   srand ( (unsigned int)Misc::currentTimeMillis() );
   CuSuite *suite = CuSuiteNew(_T("CLucene Atomic Updates Test"));
   SUITE_ADD_TEST(suite, testRAMThreading);
   SUITE_ADD_TEST(suite, testFSThreading);
+  SUITE_ADD_TEST(suite, testConcurrentTermLookups);
 
   return suite;
 }
@@ -0,0 +1,281 @@
+/*------------------------------------------------------------------------------
+* Copyright (C) 2003-2006 Ben van Klinken and the CLucene Team
+*
+* Distributable under the terms of either the Apache License (Version 2.0) or
+* the GNU Lesser General Public License, as specified in the COPYING file.
+------------------------------------------------------------------------------*/
+#include "test.h"
+
+#include "CLucene/util/NumericUtils.h"
+#include "CLucene/search/NumericRangeQuery.h"
+#include "CLucene/search/MatchAllDocsQuery.h"
+
+#define NUMERIC_TEST_DOCS 1000
+
+// a fixed sequence of pseudo random numbers, so that failures can be repeated
+static uint64_t _numericRandomState = 12345;
+static int64_t _numericRandom(){
+    _numericRandomState = _numericRandomState * _ILONGLONG(6364136223846793005) + _ILONGLONG(1442695040888963407);
+    return (int64_t)_numericRandomState;
+}
+
+static int32_t _numericInt32Value(int32_t i){ return i * 7 - 3000; }
+static int64_t _numericInt64Value(int32_t i){ return (int64_t)(i - NUMERIC_TEST_DOCS/2) * _ILONGLONG(1000000007); }
+static double _numericDoubleValue(int32_t i){ return i * 0.25 - 100.0; }
+
+class _NumericCollectRanges: public NumericUtils::RangeBuilder{
+public:
+    std::vector<std::tstring> mins;
+    std::vector<std::tstring> maxs;
+    void addRange(const TCHAR* minPrefixCoded, const TCHAR* maxPrefixCoded){
+        mins.push_back(minPrefixCoded);
+        maxs.push_back(maxPrefixCoded);
+    }
+    // true if one of the ranges holds the term of val at the precision of that range
+    bool covers(int64_t val){
+        TCHAR buf[NumericUtils::BUF_SIZE_INT64];
+        for ( size_t i=0;i<mins.size();i++ ){
+            NumericUtils::int64ToPrefixCoded(val, NumericUtils::getPrefixCodedShift(mins[i].c_str()), buf);
+            if ( _tcscmp(buf, mins[i].c_str()) >= 0 && _tcscmp(buf, maxs[i].c_str()) <= 0 )
+                return true;
+        }
+        return false;
+    }
+};
+
+void testPrefixCoded(CuTest *tc){
+    TCHAR buf[NumericUtils::BUF_SIZE_INT64];
+    TCHAR last[NumericUtils::BUF_SIZE_INT64];
+    const int64_t int64s[] = { LUCENE_INT64_MIN_SHOULDBE, LUCENE_INT64_MIN_SHOULDBE+1, -100000, -1, 0, 1, 63, 64,
+        100000, LUCENE_INT64_MAX_SHOULDBE-1, LUCENE_INT64_MAX_SHOULDBE };
+    const int32_t int64Count = sizeof(int64s)/sizeof(int64s[0]);
+
+    for ( int32_t shift=0;shift<64;shift++ ){
+        for ( int32_t i=0;i<int64Count;i++ ){
+            int32_t len = NumericUtils::int64ToPrefixCoded(int64s[i], shift, buf);
+            CuAssertIntEquals(tc, _T("term length"), (int32_t)_tcslen(buf), len);
+            CuAssertIntEquals(tc, _T("shift"), shift, NumericUtils::getPrefixCodedShift(buf));
+            const int64_t expected = shift == 0 ? int64s[i] : (int64_t)((uint64_t)int64s[i] & ~((((uint64_t)1) << shift) - 1));
+            CLUCENE_ASSERT(NumericUtils::prefixCodedToInt64(buf) == expected);
+            // the terms of a precision sort like their values
+            if ( shift == 0 && i > 0 )
+                CLUCENE_ASSERT(_tcscmp(last, buf) < 0);
+            _tcscpy(last, buf);
+        }
+    }
+
+    const int32_t int32s[] = { (int32_t)0x80000000, -100000, -1, 0, 1, 100000, 0x7fffffff };
+    const int32_t int32Count = sizeof(int32s)/sizeof(int32s[0]);
+    for ( int32_t shift=0;shift<32;shift++ ){
+        for ( int32_t i=0;i<int32Count;i++ ){
+            NumericUtils::int32ToPrefixCoded(int32s[i], shift, buf);
+            CuAssertIntEquals(tc, _T("shift"), shift, NumericUtils::getPrefixCodedShift(buf));
+            const int32_t expected = (int32_t)((uint32_t)int32s[i] & ~((((uint64_t)1) << shift) - 1));
+            CuAssertIntEquals(tc, _T("int32 round trip"), expected, NumericUtils::prefixCodedToInt32(buf));
+            if ( shift == 0 && i > 0 )
+                CLUCENE_ASSERT(_tcscmp(last, buf) < 0);
+            _tcscpy(last, buf);
+        }
+    }
+
+    // a 32 bit term is not a 64 bit one
+    NumericUtils::int32ToPrefixCoded(1, 0, buf);
+    try{
+        NumericUtils::prefixCodedToInt64(buf);
+        CuFail(tc, _T("expected a number format error"));
+    }catch(CLuceneError& err){
+        CuAssertIntEquals(tc, _T("error number"), CL_ERR_NumberFormat, err.number());
+    }
+}
+
+void testSortableFloats(CuTest *tc){
+    const double inf = HUGE_VAL;
+    const double doubles[] = { -inf, -1e300, -1.5, -1e-300, 0.0, 1e-300, 1.5, 1e300, inf };
+    const int32_t count = sizeof(doubles)/sizeof(doubles[0]);
+    for ( int32_t i=0;i<count;i++ ){
+        const int64_t sortable = NumericUtils::doubleToSortableInt64(doubles[i]);
+        CLUCENE_ASSERT(NumericUtils::sortableInt64ToDouble(sortable) == doubles[i]);
+        if ( i > 0 )
+            CLUCENE_ASSERT(NumericUtils::doubleToSortableInt64(doubles[i-1]) < sortable);
+
+        const float f = (float)doubles[i];
+        const int32_t sortableFloat = NumericUtils::floatToSortableInt32(f);
+        CLUCENE_ASSERT(NumericUtils::sortableInt32ToFloat(sortableFloat) == f);
+        if ( i > 0 )
+            CLUCENE_ASSERT(NumericUtils::floatToSortableInt32((float)doubles[i-1]) <= sortableFloat);
+    }
+}
+
+void testSplitRange(CuTest *tc){
+    const int32_t precisionSteps[] = { 1, 4, 8, 64 };
+    for ( int32_t p=0;p<4;p++ ){
+        for ( int32_t i=0;i<50;i++ ){
+            int64_t lower = _numericRandom(), upper = _numericRandom();
+            if ( i % 5 == 0 ) // also small ranges
+                upper = lower + (_numericRandom() & 0xffff);
+            if ( lower > upper ){ int64_t t = lower; lower = upper; upper = t; }
+
+            _NumericCollectRanges ranges;
+            NumericUtils::splitInt64Range(&ranges, precisionSteps[p], lower, upper);
+            // at most two runs of terms per precision
+            CLUCENE_ASSERT((int32_t)ranges.mins.size() <= 2 * (64 / precisionSteps[p] + 1));
+
+            CLUCENE_ASSERT(ranges.covers(lower));
+            CLUCENE_ASSERT(ranges.covers(upper));
+            if ( lower != LUCENE_INT64_MIN_SHOULDBE )
+                CLUCENE_ASSERT(!ranges.covers(lower-1));
+            if ( upper != LUCENE_INT64_MAX_SHOULDBE )
+                CLUCENE_ASSERT(!ranges.covers(upper+1));
+            for ( int32_t j=0;j<20;j++ ){
+                const int64_t v = _numericRandom();
+                CLUCENE_ASSERT(ranges.covers(v) == (v >= lower && v <= upper));
+            }
+        }
+    }
+
+    // the whole range is a single term of the lowest precision
+    _NumericCollectRanges all;
+    NumericUtils::splitInt64Range(&all, 4, LUCENE_INT64_MIN_SHOULDBE, LUCENE_INT64_MAX_SHOULDBE);
+    CuAssertIntEquals(tc, _T("ranges of the full range"), 1, (int32_t)all.mins.size());
+
+    _NumericCollectRanges none;
+    NumericUtils::splitInt64Range(&none, 4, 10, 9);
+    CuAssertIntEquals(tc, _T("ranges of an empty range"), 0, (int32_t)none.mins.size());
+}
+
+static Directory* _numericIndex(){
+    RAMDirectory* dir = _CLNEW RAMDirectory();
+    WhitespaceAnalyzer analyzer;
+    IndexWriter* writer = _CLNEW IndexWriter(dir, &analyzer, true);
+    writer->setMaxBufferedDocs(100);
+    for ( int32_t i=0;i<NUMERIC_TEST_DOCS;i++ ){
+        Document doc;
+        doc.add(*(_CLNEW NumericField(_T("int32"), Field::STORE_YES))->setInt32Value(_numericInt32Value(i)));
+        doc.add(*(_CLNEW NumericField(_T("int64"), Field::STORE_NO, 6))->setInt64Value(_numericInt64Value(i)));
+        doc.add(*(_CLNEW NumericField(_T("double"), Field::STORE_YES))->setDoubleValue(_numericDoubleValue(i)));
+        doc.add(*(_CLNEW NumericField(_T("float"), Field::STORE_NO, 2))->setFloatValue((float)_numericDoubleValue(i)));
+        writer->addDocument(&doc);
+    }
+    writer->close();
+    _CLLDELETE(writer);
+    return dir;
+}
+
+static int32_t _numericCount(IndexSearcher* searcher, Query* q){
+    Hits* hits = searcher->search(q);
+    int32_t ret = (int32_t)hits->length();
+    _CLLDELETE(hits);
+    _CLLDELETE(q);
+    return ret;
+}
+
+void testNumericRangeSearch(CuTest *tc){
+    Directory* dir = _numericIndex();
+    IndexSearcher searcher(dir);
+
+    for ( int32_t i=0;i<40;i++ ){
+        int32_t a = (int32_t)((uint64_t)_numericRandom() % NUMERIC_TEST_DOCS);
+        int32_t b = (int32_t)((uint64_t)_numericRandom() % NUMERIC_TEST_DOCS);
+        if ( a > b ){ int32_t t = a; a = b; b = t; }
+        const bool minInclusive = (i & 1) != 0, maxInclusive = (i & 2) != 0;
+        // the values grow with the document number, so count the document numbers in the range
+        int32_t expectedCount = 0;
+        for ( int32_t d=0;d<NUMERIC_TEST_DOCS;d++ ){
+            if ( (minInclusive ? d >= a : d > a) && (maxInclusive ? d <= b : d < b) )
+                expectedCount++;
+        }
+
+        int32_t lower32 = _numericInt32Value(a), upper32 = _numericInt32Value(b);
+        CuAssertIntEquals(tc, _T("int32 range"), expectedCount,
+            _numericCount(&searcher, NumericRangeQuery::newInt32Range(_T("int32"), &lower32, &upper32, minInclusive, maxInclusive)));
+
+        int64_t lower64 = _numericInt64Value(a), upper64 = _numericInt64Value(b);
+        CuAssertIntEquals(tc, _T("int64 range"), expectedCount,
+            _numericCount(&searcher, NumericRangeQuery::newInt64Range(_T("int64"), 6, &lower64, &upper64, minInclusive, maxInclusive)));
+
+        double lowerD = _numericDoubleValue(a), upperD = _numericDoubleValue(b);
+        CuAssertIntEquals(tc, _T("double range"), expectedCount,
+            _numericCount(&searcher, NumericRangeQuery::newDoubleRange(_T("double"), &lowerD, &upperD, minInclusive, maxInclusive)));
+
+        float lowerF = (float)lowerD, upperF = (float)upperD;
+        CuAssertIntEquals(tc, _T("float range"), expectedCount,
+            _numericCount(&searcher, NumericRangeQuery::newFloatRange(_T("float"), 2, &lowerF, &upperF, minInclusive, maxInclusive)));
+
+        // open ends
+        CuAssertIntEquals(tc, _T("open lower end"), b + (maxInclusive ? 1 : 0),
+            _numericCount(&searcher, NumericRangeQuery::newInt32Range(_T("int32"), NULL, &upper32, true, maxInclusive)));
+        CuAssertIntEquals(tc, _T("open upper end"), NUMERIC_TEST_DOCS - a - (minInclusive ? 0 : 1),
+            _numericCount(&searcher, NumericRangeQuery::newDoubleRange(_T("double"), &lowerD, NULL, minInclusive, true)));
+    }
+
+    // values between the indexed ones
+    double lowerD = -99.9, upperD = -99.1;
+    CuAssertIntEquals(tc, _T("range between values"), 3,
+        _numericCount(&searcher, NumericRangeQuery::newDoubleRange(_T("double"), &lowerD, &upperD, true, true)));
+    CuAssertIntEquals(tc, _T("all values"), NUMERIC_TEST_DOCS,
+        _numericCount(&searcher, NumericRangeQuery::newInt64Range(_T("int64"), 6, NULL, NULL, true, true)));
+    int32_t v = 4;
+    CuAssertIntEquals(tc, _T("empty range"), 0,
+        _numericCount(&searcher, NumericRangeQuery::newInt32Range(_T("int32"), &v, &v, true, false)));
+
+    // the filter matches the same documents
+    int32_t lower32 = _numericInt32Value(10), upper32 = _numericInt32Value(19);
+    Filter* filter = NumericRangeFilter::newInt32Range(_T("int32"), &lower32, &upper32, true, true);
+    Query* all = _CLNEW MatchAllDocsQuery();
+    Hits* hits = searcher.search(all, filter);
+    CuAssertIntEquals(tc, _T("filter hits"), 10, (int32_t)hits->length());
+    for ( size_t i=0;i<hits->length();i++ ){
+        Document& doc = hits->doc(i);
+        const int32_t val = (int32_t)_ttoi(doc.get(_T("int32")));
+        CLUCENE_ASSERT(val >= lower32 && val <= upper32);
+        CLUCENE_ASSERT(_tcstod(doc.get(_T("double")), NULL) == _numericDoubleValue((val + 3000) / 7));
+    }
+    _CLLDELETE(hits);
+    _CLLDELETE(all);
+    _CLLDELETE(filter);
+
+    searcher.close();
+    dir->close();
+    _CLLDECDELETE(dir);
+}
+
+void testNumericRangeQueryEquals(CuTest *tc){
+    int32_t lower = 1, upper = 10, upper2 = 11;
+    Query* q1 = NumericRangeQuery::newInt32Range(_T("f"), &lower, &upper, true, true);
+    Query* q2 = NumericRangeQuery::newInt32Range(_T("f"), &lower, &upper2, true, false);
+    Query* q3 = NumericRangeQuery::newInt32Range(_T("f"), &lower, &upper, true, false);
+    Query* q4 = q1->clone();
+
+    // the same range of values, however it is written
+    CLUCENE_ASSERT(q1->equals(q2));
+    CLUCENE_ASSERT(q1->hashCode() == q2->hashCode());
+    CLUCENE_ASSERT(!q1->equals(q3));
+    CLUCENE_ASSERT(q1->equals(q4));
+
+    TCHAR* str = q3->toString(_T("f"));
+    CuAssertStrEquals(tc, _T("toString"), _T("[1 TO 10}"), str);
+    _CLDELETE_LCARRAY(str);
+    str = q1->toString(_T("g"));
+    CuAssertStrEquals(tc, _T("toString"), _T("f:[1 TO 10]"), str);
+    _CLDELETE_LCARRAY(str);
+
+    _CLLDELETE(q1);
+    _CLLDELETE(q2);
+    _CLLDELETE(q3);
+    _CLLDELETE(q4);
+}
+
+CuSuite *testNumericRangeQuery(void)
+{
+    CuSuite *suite = CuSuiteNew(_T("CLucene NumericRangeQuery Test"));
+
+    SUITE_ADD_TEST(suite, testPrefixCoded);
+    SUITE_ADD_TEST(suite, testSortableFloats);
+    SUITE_ADD_TEST(suite, testSplitRange);
+    SUITE_ADD_TEST(suite, testNumericRangeSearch);
+    SUITE_ADD_TEST(suite, testNumericRangeQueryEquals);
+
+    return suite;
+}
+
+// EOF
@@ -330,6 +330,113 @@ void testFuzzyQuery(CuTest *tc){
 	searcher.close();
 	ram.close();
 }
+
+/** The similarity FuzzyTermEnum requires of terms, computed by a full edit distance matrix */
+static bool isFuzzySimilar(const TCHAR* text, size_t n, const TCHAR* target, size_t m, size_t prefixLen, float_t minSimilarity){
+	float_t similarity;
+	if ( n == 0 )
+		similarity = prefixLen == 0 ? 0.0f : 1.0f - ((float_t) m / prefixLen);
+	else if ( m == 0 )
+		similarity = prefixLen == 0 ? 0.0f : 1.0f - ((float_t) n / prefixLen);
+	else{
+		std::vector<size_t> d((n + 1) * (m + 1));
+		for ( size_t i=0;i<=n;i++ )
+			d[i] = i;
+		for ( size_t j=0;j<=m;j++ )
+			d[j * (n + 1)] = j;
+		for ( size_t j=1;j<=m;j++ ){
+			for ( size_t i=1;i<=n;i++ ){
+				size_t cost = text[i-1] == target[j-1] ? 0 : 1;
+				size_t v = d[(j-1) * (n + 1) + i-1] + cost;
+				v = std::min(v, d[(j-1) * (n + 1) + i] + 1);
+				v = std::min(v, d[j * (n + 1) + i-1] + 1);
+				d[j * (n + 1) + i] = v;
+			}
+		}
+		similarity = 1.0f - ((float_t) d[m * (n + 1) + n] / (float_t) (prefixLen + std::min(n, m)));
+	}
+	return similarity > minSimilarity;
+}
+
+/** Compares the terms of FuzzyTermEnum with those of a scan of all terms,
+* on enough terms that the enumeration seeks across segments */
+void testFuzzyTermEnum(CuTest *tc){
+	RAMDirectory directory;
+	WhitespaceAnalyzer analyzer;
+	const TCHAR* alphabet = _T("abcd");
+	uint32_t seed = 7;
+	TCHAR word[10];
+	for ( int32_t seg=0;seg<3;seg++ ){
+		IndexWriter writer(&directory, &analyzer, seg==0);
+		for ( int32_t i=0;i<40;i++ ){
+			StringBuffer text;
+			for ( int32_t j=0;j<25;j++ ){
+				seed = seed * 1103515245 + 12345;
+				int32_t len = 1 + (seed >> 16) % 8;
+				for ( int32_t k=0;k<len;k++ ){
+					seed = seed * 1103515245 + 12345;
+					word[k] = alphabet[(seed >> 16) % 4];
+				}
+				word[len] = 0;
+				text.append(word);
+				text.appendChar(' ');
+			}
+			Document doc;
+			doc.add(*_CLNEW Field(_T("field"), text.getBuffer(), Field::STORE_NO | Field::INDEX_TOKENIZED));
+			writer.addDocument(&doc);
+		}
+		writer.close();
+	}
+
+	IndexReader* reader = IndexReader::open(&directory);
+	const TCHAR* texts[] = { _T("abcab"), _T("dcba"), _T("aab"), _T("bbbbbb"), _T("cadbcadb"), _T("d"), NULL };
+	const float_t minSimilarities[] = { 0.25f, 0.5f, 0.75f };
+	for ( int32_t i=0;texts[i]!=NULL;i++ ){
+		for ( int32_t s=0;s<3;s++ ){
+			for ( size_t prefixLen=0;prefixLen<3;prefixLen++ ){
+				const TCHAR* queryText = texts[i];
+				size_t queryLen = _tcslen(queryText);
+				size_t realPrefixLen = std::min(prefixLen, queryLen);
+				Term* term = _CLNEW Term(_T("field"), queryText);
+
+				//all terms which are similar enough, in order
+				std::vector<std::tstring> expected;
+				TermEnum* all = reader->terms();
+				while ( all->next() ){
+					Term* t = all->term(false);
+					if ( _tcscmp(t->field(), _T("field")) == 0 &&
+							t->textLength() >= realPrefixLen &&
+							_tcsncmp(t->text(), queryText, realPrefixLen) == 0 &&
+							isFuzzySimilar(queryText + realPrefixLen, queryLen - realPrefixLen,
+								t->text() + realPrefixLen, t->textLength() - realPrefixLen,
+								realPrefixLen, minSimilarities[s]) )
+						expected.push_back(t->text());
+				}
+				all->close();
+				_CLDELETE(all);
+
+				FuzzyTermEnum terms(reader, term, minSimilarities[s], prefixLen);
+				size_t count = 0;
+				do {
+					Term* t = terms.term(false);
+					if ( t == NULL )
+						break;
+					CLUCENE_ASSERT(count < expected.size());
+					assertEquals(0, _tcscmp(expected[count].c_str(), t->text()));
+					count++;
+				} while ( terms.next() );
+				CLUCENE_ASSERT(count == expected.size());
+				terms.close();
+
+				_CLDECDELETE(term);
+			}
+		}
+	}
+
+	reader->close();
+	_CLDELETE(reader);
+	directory.close();
+}
 #else
 	void _NO_FUZZY_QUERY(CuTest *tc){
 		CuNotImpl(tc,_T("Fuzzy"));
@@ -373,6 +480,7 @@ CuSuite *testqueries(void)
 	SUITE_ADD_TEST(suite, testMultiPhraseQuery);
 	#ifndef NO_FUZZY_QUERY
 		SUITE_ADD_TEST(suite, testFuzzyQuery);
+		SUITE_ADD_TEST(suite, testFuzzyTermEnum);
 	#else
 		SUITE_ADD_TEST(suite, _NO_FUZZY_QUERY);
 	#endif
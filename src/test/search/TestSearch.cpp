@@ -9,6 +9,12 @@
 #include <stdio.h>
 
 #include "CLucene/search/MultiPhraseQuery.h"
+#include "CLucene/search/QueryFilter.h"
+#include "CLucene/search/ChainedFilter.h"
+#include "CLucene/search/CachingWrapperFilter.h"
+#include "CLucene/search/ConstantScoreQuery.h"
+#include "CLucene/util/ThreadPool.h"
+#include "CLucene/util/SortedVIntList.h"
 
 	SimpleAnalyzer a;
 	StandardAnalyzer aStd;
@@ -394,6 +400,431 @@ void testSrchManyHits(CuTest *tc) {
 	searcher.close();
 }
 
+void _testSrchParallelSegmentsQuery(CuTest *tc, IndexSearcher* serial, IndexSearcher* parallel, Query* query, Filter* filter){
+	TopDocs* expected = serial->_search(query, filter, 20);
+	TopDocs* actual = parallel->_search(query, filter, 20);
+	CLUCENE_ASSERT(expected->totalHits > 0);
+	CLUCENE_ASSERT(actual->totalHits == expected->totalHits);
+	CLUCENE_ASSERT(actual->scoreDocsLength == expected->scoreDocsLength);
+	for ( int32_t i=0;i<expected->scoreDocsLength;i++ ){
+		CLUCENE_ASSERT(actual->scoreDocs[i].doc == expected->scoreDocs[i].doc);
+		CLUCENE_ASSERT(actual->scoreDocs[i].score == expected->scoreDocs[i].score);
+	}
+	_CLDELETE(expected);
+	_CLDELETE(actual);
+}
+
+void testSrchParallelSegments(CuTest *tc) {
+	SimpleAnalyzer analyzer;
+	RAMDirectory ram;
+	IndexWriter writer( &ram, &analyzer, true);
+	writer.setMaxBufferedDocs(10);
+	writer.setMergeFactor(100); //keep the segments apart
+
+	const TCHAR* docs[] = { _T("a b c d e"),
+		_T("a b c d e a b c d e"),
+		_T("a b c d e f g h i j"),
+		_T("a c e"),
+		_T("e c a"),
+		_T("a c e a c e"),
+		_T("a c e a b c")
+	};
+	for (int j = 0; j < 145; j++) {
+		Document* d = _CLNEW Document();
+		d->add(*_CLNEW Field(_T("contents"),docs[(j*3)%7],Field::STORE_YES | Field::INDEX_TOKENIZED));
+		writer.addDocument(d);
+		_CLDELETE(d);
+	}
+	writer.close();
+
+	IndexSearcher serial(&ram);
+	IndexSearcher parallel(&ram);
+	ThreadPool pool(2);
+	parallel.setThreadPool(&pool);
+
+	Term* t = _CLNEW Term(_T("contents"), _T("b"));
+	TermQuery termQuery(t);
+	_CLDECDELETE(t);
+	_testSrchParallelSegmentsQuery(tc, &serial, &parallel, &termQuery, NULL);
+
+	BooleanQuery boolQuery;
+	t = _CLNEW Term(_T("contents"), _T("a"));
+	boolQuery.add(_CLNEW TermQuery(t),true,false, false);
+	_CLDECDELETE(t);
+	t = _CLNEW Term(_T("contents"), _T("f"));
+	boolQuery.add(_CLNEW TermQuery(t),true,false, false);
+	_CLDECDELETE(t);
+	_testSrchParallelSegmentsQuery(tc, &serial, &parallel, &boolQuery, NULL);
+
+	//the filter bits are for the whole index, the segments must offset their docs
+	t = _CLNEW Term(_T("contents"), _T("d"));
+	QueryFilter filter(_CLNEW TermQuery(t), true);
+	_CLDECDELETE(t);
+	_testSrchParallelSegmentsQuery(tc, &serial, &parallel, &boolQuery, &filter);
+
+	serial.close();
+	parallel.close();
+}
+
+static bool _scoresClose(float_t a, float_t b){
+	return a - b < 0.00001f && b - a < 0.00001f;
+}
+
+//returns the number of docs the pruning searcher scored
+int32_t _testSrchDynamicPruningQuery(CuTest *tc, IndexSearcher* exhaustive, IndexSearcher* pruning, Query* query, int32_t nDocs){
+	TopDocs* expected = exhaustive->_search(query, NULL, nDocs);
+	TopDocs* actual = pruning->_search(query, NULL, nDocs);
+	const int32_t len = expected->scoreDocsLength;
+	CLUCENE_ASSERT(len > 0);
+	CLUCENE_ASSERT(actual->scoreDocsLength == len);
+	CLUCENE_ASSERT(actual->totalHits >= len);
+	CLUCENE_ASSERT(actual->totalHits <= expected->totalHits);
+	for ( int32_t i=0;i<len;i++ ){
+		//the term scores may be summed in another order, so equal scores can swap
+		CLUCENE_ASSERT(_scoresClose(actual->scoreDocs[i].score, expected->scoreDocs[i].score));
+		if ( actual->scoreDocs[i].doc != expected->scoreDocs[i].doc ){
+			CLUCENE_ASSERT(i == len-1 ||
+				(i > 0 && _scoresClose(expected->scoreDocs[i-1].score, expected->scoreDocs[i].score)) ||
+				_scoresClose(expected->scoreDocs[i+1].score, expected->scoreDocs[i].score));
+		}
+	}
+	int32_t ret = actual->totalHits;
+	_CLDELETE(expected);
+	_CLDELETE(actual);
+	return ret;
+}
+
+void testSrchDynamicPruning(CuTest *tc) {
+	WhitespaceAnalyzer analyzer;
+	RAMDirectory ram;
+	IndexWriter writer( &ram, &analyzer, true);
+	writer.setMaxBufferedDocs(100);
+	writer.setMergeFactor(100); //several segments, each with its own bounds
+
+	const TCHAR* terms[] = { _T("a"), _T("b"), _T("c"), _T("d"), _T("e") };
+	for (int32_t j = 0; j < 500; j++) {
+		//varying term frequencies and lengths, with a few high scoring docs
+		StringBuffer text;
+		for ( int32_t k=0;k<5;k++ ){
+			int32_t freq = (j*(k+3)+k) % (k+4);
+			if ( j % 97 == k )
+				freq += 10;
+			for ( int32_t f=0;f<freq;f++ ){
+				text.append(terms[k]);
+				text.appendChar(_T(' '));
+			}
+		}
+		for ( int32_t f=0;f<j%7;f++ )
+			text.append(_T("z "));
+		if ( j % 50 == 7 )
+			text.append(_T("r r r"));
+		Document* d = _CLNEW Document();
+		d->add(*_CLNEW Field(_T("contents"),text.getBuffer(),Field::STORE_NO | Field::INDEX_TOKENIZED));
+		writer.addDocument(d);
+		_CLDELETE(d);
+	}
+	writer.close();
+
+	IndexReader* reader = IndexReader::open(&ram);
+	reader->deleteDocument(3); //deleted docs must not count for the bounds
+	reader->deleteDocument(97);
+
+	IndexSearcher exhaustive(reader);
+	IndexSearcher pruning(reader);
+	pruning.setDynamicPruning(true);
+
+	//once the top docs all contain the rare term, the docs with just the
+	//common term can not compete and are skipped
+	BooleanQuery two;
+	Term* t = _CLNEW Term(_T("contents"), _T("a"));
+	two.add(_CLNEW TermQuery(t),true,false, false);
+	_CLDECDELETE(t);
+	t = _CLNEW Term(_T("contents"), _T("r"));
+	two.add(_CLNEW TermQuery(t),true,false, false);
+	_CLDECDELETE(t);
+	TopDocs* twoDocs = exhaustive._search(&two, NULL, 5);
+	int32_t twoHits = twoDocs->totalHits;
+	_CLDELETE(twoDocs);
+	CLUCENE_ASSERT(_testSrchDynamicPruningQuery(tc, &exhaustive, &pruning, &two, 5) < twoHits);
+	_testSrchDynamicPruningQuery(tc, &exhaustive, &pruning, &two, 20);
+
+	BooleanQuery all;
+	for ( int32_t k=0;k<5;k++ ){
+		t = _CLNEW Term(_T("contents"), terms[k]);
+		all.add(_CLNEW TermQuery(t),true,false, false);
+		_CLDECDELETE(t);
+	}
+	t = _CLNEW Term(_T("contents"), _T("missing"));
+	all.add(_CLNEW TermQuery(t),true,false, false);
+	_CLDECDELETE(t);
+	_testSrchDynamicPruningQuery(tc, &exhaustive, &pruning, &all, 5);
+	_testSrchDynamicPruningQuery(tc, &exhaustive, &pruning, &all, 1000);
+
+	//a boost changes the bounds of a clause
+	BooleanQuery boosted;
+	for ( int32_t k=0;k<5;k++ ){
+		t = _CLNEW Term(_T("contents"), terms[k]);
+		TermQuery* tq = _CLNEW TermQuery(t);
+		tq->setBoost(k == 4 ? 5.0f : 1.0f);
+		boosted.add(tq,true,false, false);
+		_CLDECDELETE(t);
+	}
+	_testSrchDynamicPruningQuery(tc, &exhaustive, &pruning, &boosted, 5);
+
+	exhaustive.close();
+	pruning.close();
+	reader->close();
+	_CLDELETE(reader);
+}
+
+//returns every third doc starting at offset, or NULL (all docs) if offset is -1
+class TestChainFilter: public Filter{
+	int32_t offset;
+public:
+	TestChainFilter(int32_t offset): offset(offset){}
+	BitSet* bits(IndexReader* reader){
+		if ( offset == -1 )
+			return NULL;
+		BitSet* bts = _CLNEW BitSet(reader->maxDoc());
+		for ( int32_t i=offset;i<reader->maxDoc();i+=3 )
+			bts->set(i);
+		return bts;
+	}
+	Filter* clone() const{ return _CLNEW TestChainFilter(offset); }
+	TCHAR* toString(){ return stringDuplicate(_T("TestChainFilter")); }
+};
+
+static bool _chainedFilterMatch(int32_t doc, int32_t offset){
+	return offset == -1 || doc % 3 == offset;
+}
+
+void testSrchChainedFilter(CuTest *tc) {
+	RAMDirectory ram;
+	SimpleAnalyzer analyzer;
+	IndexWriter writer( &ram, &analyzer, true);
+	for (int32_t j = 0; j < 200; j++) {
+		Document* d = _CLNEW Document();
+		d->add(*_CLNEW Field(_T("contents"),_T("a"),Field::STORE_NO | Field::INDEX_TOKENIZED));
+		writer.addDocument(d);
+		_CLDELETE(d);
+	}
+	writer.close();
+	IndexReader* reader = IndexReader::open(&ram);
+
+	//all pairs of the filters, with each logic, against the same bit by bit
+	int32_t offsets[] = { 0, 1, -1 };
+	int32_t logics[] = { ChainedFilter::OR, ChainedFilter::AND, ChainedFilter::ANDNOT, ChainedFilter::XOR };
+	for ( int32_t f=0;f<3;f++ ){
+		for ( int32_t g=0;g<3;g++ ){
+			for ( int32_t l=0;l<4;l++ ){
+				TestChainFilter first(offsets[f]);
+				TestChainFilter second(offsets[g]);
+				Filter* filters[] = { &first, &second, NULL };
+				ChainedFilter chain(filters, logics[l]);
+				BitSet* bts = chain.bits(reader);
+				for ( int32_t i=0;i<reader->maxDoc();i++ ){
+					bool a = _chainedFilterMatch(i, offsets[f]);
+					bool b = _chainedFilterMatch(i, offsets[g]);
+					bool expected;
+					if ( logics[l] == ChainedFilter::OR )
+						expected = a || b;
+					else if ( logics[l] == ChainedFilter::AND )
+						expected = a && b;
+					else if ( logics[l] == ChainedFilter::ANDNOT )
+						expected = !(a && b);
+					else
+						expected = a != b;
+					CLUCENE_ASSERT(bts->get(i) == expected);
+				}
+				_CLDELETE(bts);
+			}
+		}
+	}
+
+	reader->close();
+	_CLDELETE(reader);
+}
+
+//a filter which only implements bits, so it is applied through the BitSet
+class TestBitsOnlyFilter: public Filter{
+	QueryFilter filter;
+public:
+	TestBitsOnlyFilter(Query* query): filter(query){}
+	BitSet* bits(IndexReader* reader){ return filter.bits(reader); }
+	Filter* clone() const{ _CLTHROWA(CL_ERR_UnsupportedOperation, "not needed"); }
+	TCHAR* toString(){ return stringDuplicate(_T("TestBitsOnlyFilter")); }
+};
+
+class TestCountingCollector: public HitCollector{
+public:
+	int32_t count;
+	int32_t docSum;
+	TestCountingCollector(): count(0), docSum(0){}
+	void collect(const int32_t doc, const float_t /*score*/){
+		count++;
+		docSum += doc;
+	}
+};
+
+void _testSrchDocIdSetFilter(CuTest *tc, IndexSearcher* searcher, Query* query, Filter* expectedFilter, Filter* filter){
+	TopDocs* expected = searcher->_search(query, expectedFilter, 20);
+	TopDocs* actual = searcher->_search(query, filter, 20);
+	CLUCENE_ASSERT(expected->totalHits > 0);
+	CLUCENE_ASSERT(actual->totalHits == expected->totalHits);
+	CLUCENE_ASSERT(actual->scoreDocsLength == expected->scoreDocsLength);
+	for ( int32_t i=0;i<expected->scoreDocsLength;i++ ){
+		CLUCENE_ASSERT(actual->scoreDocs[i].doc == expected->scoreDocs[i].doc);
+		CLUCENE_ASSERT(actual->scoreDocs[i].score == expected->scoreDocs[i].score);
+	}
+	_CLDELETE(expected);
+	_CLDELETE(actual);
+
+	Sort sort(_T("id"));
+	Hits* expectedHits = searcher->search(query, expectedFilter, &sort);
+	Hits* actualHits = searcher->search(query, filter, &sort);
+	CLUCENE_ASSERT(actualHits->length() == expectedHits->length());
+	for ( size_t i=0;i<expectedHits->length();i++ )
+		CLUCENE_ASSERT(actualHits->id(i) == expectedHits->id(i));
+	_CLDELETE(expectedHits);
+	_CLDELETE(actualHits);
+
+	TestCountingCollector expectedCollector, actualCollector;
+	searcher->_search(query, expectedFilter, &expectedCollector);
+	searcher->_search(query, filter, &actualCollector);
+	CLUCENE_ASSERT(actualCollector.count == expectedCollector.count);
+	CLUCENE_ASSERT(actualCollector.docSum == expectedCollector.docSum);
+}
+
+void testSrchDocIdSetFilter(CuTest *tc) {
+	WhitespaceAnalyzer analyzer;
+	RAMDirectory ram;
+	IndexWriter writer( &ram, &analyzer, true);
+	writer.setMaxBufferedDocs(300);
+	TCHAR buf[20];
+	for (int32_t j = 0; j < 1000; j++) {
+		Document* d = _CLNEW Document();
+		_sntprintf(buf, 20, _T("%d"), j);
+		d->add(*_CLNEW Field(_T("id"),buf,Field::STORE_YES | Field::INDEX_UNTOKENIZED));
+		_sntprintf(buf, 20, _T("t%d"), j % 100);
+		d->add(*_CLNEW Field(_T("tenant"),buf,Field::STORE_NO | Field::INDEX_UNTOKENIZED));
+		d->add(*_CLNEW Field(_T("contents"),j % 3 == 0 ? _T("a b") : _T("a"),Field::STORE_NO | Field::INDEX_TOKENIZED));
+		writer.addDocument(d);
+		_CLDELETE(d);
+	}
+	writer.close();
+
+	IndexSearcher searcher(&ram);
+	ThreadPool pool(1);
+
+	Term* t = _CLNEW Term(_T("contents"), _T("a"));
+	TermQuery common(t);
+	_CLDECDELETE(t);
+	t = _CLNEW Term(_T("contents"), _T("b"));
+	TermQuery less(t);
+	_CLDECDELETE(t);
+
+	//10 of the 1000 documents: the filter is iterated from a SortedVIntList
+	t = _CLNEW Term(_T("tenant"), _T("t9"));
+	TermQuery tenantQuery(t);
+	_CLDECDELETE(t);
+	TestBitsOnlyFilter expectedFilter(&tenantQuery);
+	QueryFilter sparseFilter(&tenantQuery);
+	CachingWrapperFilter cachingFilter(_CLNEW QueryFilter(&tenantQuery));
+	for ( int32_t i=0;i<2;i++ ){
+		_testSrchDocIdSetFilter(tc, &searcher, &common, &expectedFilter, &sparseFilter);
+		_testSrchDocIdSetFilter(tc, &searcher, &less, &expectedFilter, &sparseFilter);
+		_testSrchDocIdSetFilter(tc, &searcher, &common, &expectedFilter, &cachingFilter);
+		_testSrchDocIdSetFilter(tc, &searcher, &less, &expectedFilter, &cachingFilter);
+		searcher.setThreadPool(&pool); //the second time per segment
+	}
+	searcher.setThreadPool(NULL);
+
+	//the cached filter still returns its BitSet
+	BitSet* bits = cachingFilter.bits(searcher.getReader());
+	CLUCENE_ASSERT(bits->count() == 10);
+	CLUCENE_ASSERT(bits->get(9) && bits->get(909));
+
+	//the documents of the cached set score in a ConstantScoreQuery, which
+	//must not delete the cached set
+	ConstantScoreQuery constantQuery(cachingFilter.clone());
+	for ( int32_t i=0;i<2;i++ ){
+		TopDocs* docs = searcher._search(&constantQuery, NULL, 20);
+		CLUCENE_ASSERT(docs->totalHits == 10);
+		_CLDELETE(docs);
+	}
+	TopDocs* docs = searcher._search(&constantQuery, &sparseFilter, 20);
+	CLUCENE_ASSERT(docs->totalHits == 10);
+	_CLDELETE(docs);
+
+	searcher.close();
+}
+
+//a filter whose set permits all documents
+class TestAllDocsFilter: public Filter{
+public:
+	BitSet* bits(IndexReader* /*reader*/){ _CLTHROWA(CL_ERR_UnsupportedOperation, "not needed"); }
+	DocIdSet* getDocIdSet(IndexReader* /*reader*/){ return NULL; }
+	Filter* clone() const{ return _CLNEW TestAllDocsFilter(); }
+	TCHAR* toString(){ return stringDuplicate(_T("TestAllDocsFilter")); }
+};
+
+//a filter which returns a compact set and keeps the default ownership
+class TestListFilter: public Filter{
+public:
+	BitSet* bits(IndexReader* /*reader*/){ _CLTHROWA(CL_ERR_UnsupportedOperation, "not needed"); }
+	DocIdSet* getDocIdSet(IndexReader* /*reader*/){
+		const int32_t docs[] = {1, 5, 6};
+		return _CLNEW SortedVIntList(docs, 3);
+	}
+	Filter* clone() const{ return _CLNEW TestListFilter(); }
+	TCHAR* toString(){ return stringDuplicate(_T("TestListFilter")); }
+};
+
+void testSrchConstantScoreDeletions(CuTest *tc) {
+	WhitespaceAnalyzer analyzer;
+	RAMDirectory ram;
+	IndexWriter writer( &ram, &analyzer, true);
+	for (int32_t j = 0; j < 10; j++) {
+		Document* d = _CLNEW Document();
+		d->add(*_CLNEW Field(_T("contents"),j % 2 == 0 ? _T("a b") : _T("a"),Field::STORE_NO | Field::INDEX_TOKENIZED));
+		writer.addDocument(d);
+		_CLDELETE(d);
+	}
+	writer.close();
+
+	IndexReader* reader = IndexReader::open(&ram);
+	reader->deleteDocument(3);
+	reader->deleteDocument(4);
+	IndexSearcher searcher(reader);
+
+	//deleted documents are not in a set which permits all documents
+	ConstantScoreQuery allQuery(_CLNEW TestAllDocsFilter());
+	TopDocs* docs = searcher._search(&allQuery, NULL, 20);
+	CLUCENE_ASSERT(docs->totalHits == 8);
+	_CLDELETE(docs);
+
+	//neither when skipped to, as in a conjunction
+	Term* t = _CLNEW Term(_T("contents"), _T("b"));
+	TermQuery less(t);
+	_CLDECDELETE(t);
+	BooleanQuery both;
+	both.add(&less, false, BooleanClause::MUST);
+	both.add(&allQuery, false, BooleanClause::MUST);
+	docs = searcher._search(&both, NULL, 20);
+	CLUCENE_ASSERT(docs->totalHits == 4);
+	_CLDELETE(docs);
+
+	//the compact set is deleted by the scorer
+	ConstantScoreQuery listQuery(_CLNEW TestListFilter());
+	docs = searcher._search(&listQuery, NULL, 20);
+	CLUCENE_ASSERT(docs->totalHits == 3);
+	_CLDELETE(docs);
+
+	searcher.close();
+	reader->close();
+	_CLDELETE(reader);
+}
+
 void testSrchMulti(CuTest *tc) {
   SimpleAnalyzer analyzer;
 	RAMDirectory ram0;
@@ -449,6 +880,14 @@ void testSrchMulti(CuTest *tc) {
 	  hits->doc(x);
 	}
   CLUCENE_ASSERT(hits->length() == 1);
+
+	//the parallel searcher must find the same
+	ParallelMultiSearcher parallel(searchers);
+	Hits* parallelHits = parallel.search(rewritten);
+	CLUCENE_ASSERT(parallelHits->length() == 1);
+	CLUCENE_ASSERT(parallelHits->id(0) == hits->id(0));
+	_CLDELETE(parallelHits);
+
 	if (&query != rewritten) {
 		_CLDELETE(rewritten);
 	}
@@ -456,6 +895,110 @@ void testSrchMulti(CuTest *tc) {
 	searcher.close();
 }
 
+//pages through the hits of query with _searchAfter, and checks them against a single search
+void _testSrchSearchAfter(CuTest *tc, Searchable* searcher, Query* query, Filter* filter, const int32_t pageSize){
+	TopDocs* all = searcher->_search(query, filter, searcher->maxDoc());
+	CLUCENE_ASSERT(all->scoreDocsLength > pageSize);
+	int32_t n = 0;
+	TopDocs* page = searcher->_searchAfter(query, filter, NULL, pageSize);
+	while ( page->scoreDocsLength > 0 ){
+		CLUCENE_ASSERT(page->totalHits == all->totalHits);
+		for ( int32_t i=0;i<page->scoreDocsLength;i++,n++ ){
+			CLUCENE_ASSERT(n < all->scoreDocsLength);
+			CLUCENE_ASSERT(page->scoreDocs[i].doc == all->scoreDocs[n].doc);
+			CLUCENE_ASSERT(page->scoreDocs[i].score == all->scoreDocs[n].score);
+		}
+		TopDocs* next = searcher->_searchAfter(query, filter, &page->scoreDocs[page->scoreDocsLength-1], pageSize);
+		_CLDELETE(page);
+		page = next;
+	}
+	_CLDELETE(page);
+	CLUCENE_ASSERT(n == all->scoreDocsLength);
+	_CLDELETE(all);
+}
+
+void testSrchSearchAfter(CuTest *tc) {
+	SimpleAnalyzer analyzer;
+	RAMDirectory ram;
+	IndexWriter writer( &ram, &analyzer, true);
+	writer.setMaxBufferedDocs(40);
+	writer.setMergeFactor(100); //keep the segments apart
+
+	//few distinct documents, so that most hits tie on their score
+	const TCHAR* docs[] = { _T("a b c d e"),
+		_T("a b c d e a b c d e"),
+		_T("a b c d e f g h i j"),
+		_T("a c e"),
+		_T("e c a"),
+		_T("a c e a c e"),
+		_T("a c e a b c")
+	};
+	for (int j = 0; j < 300; j++) {
+		Document* d = _CLNEW Document();
+		d->add(*_CLNEW Field(_T("contents"),docs[(j*3)%7],Field::STORE_YES | Field::INDEX_TOKENIZED));
+		writer.addDocument(d);
+		_CLDELETE(d);
+	}
+	writer.close();
+
+	Term* t = _CLNEW Term(_T("contents"), _T("a"));
+	TermQuery termQuery(t);
+	_CLDECDELETE(t);
+	BooleanQuery boolQuery;
+	t = _CLNEW Term(_T("contents"), _T("b"));
+	boolQuery.add(_CLNEW TermQuery(t),true,false, false);
+	_CLDECDELETE(t);
+	t = _CLNEW Term(_T("contents"), _T("e"));
+	boolQuery.add(_CLNEW TermQuery(t),true,false, false);
+	_CLDECDELETE(t);
+	t = _CLNEW Term(_T("contents"), _T("c"));
+	QueryFilter filter(_CLNEW TermQuery(t), true);
+	_CLDECDELETE(t);
+
+	IndexSearcher searcher(&ram);
+	_testSrchSearchAfter(tc, &searcher, &termQuery, NULL, 7);
+	_testSrchSearchAfter(tc, &searcher, &boolQuery, NULL, 16);
+	_testSrchSearchAfter(tc, &searcher, &boolQuery, &filter, 50);
+
+	//per segment in a pool
+	ThreadPool pool(2);
+	searcher.setThreadPool(&pool);
+	_testSrchSearchAfter(tc, &searcher, &termQuery, NULL, 7);
+	_testSrchSearchAfter(tc, &searcher, &boolQuery, &filter, 16);
+	searcher.setThreadPool(NULL);
+
+	//the same index twice, the cursor must be moved into each searcher
+	IndexSearcher searcher0(&ram);
+	IndexSearcher searcher1(&ram);
+	Searchable* searchers[3] = { &searcher0, &searcher1, NULL };
+	MultiSearcher multi(searchers);
+	_testSrchSearchAfter(tc, &multi, &termQuery, NULL, 7);
+	_testSrchSearchAfter(tc, &multi, &boolQuery, &filter, 50);
+	ParallelMultiSearcher parallel(searchers);
+	_testSrchSearchAfter(tc, &parallel, &termQuery, NULL, 7);
+	_testSrchSearchAfter(tc, &parallel, &boolQuery, &filter, 50);
+
+	//Hits page after the hits retrieved so far, and search again after a deletion
+	IndexReader* reader = IndexReader::open(&ram);
+	IndexSearcher deleting(reader);
+	TopDocs* all = deleting._search(&termQuery, NULL, 300);
+	Hits* hits = deleting.search(&termQuery);
+	CLUCENE_ASSERT(hits->length() == 300);
+	for ( size_t i=0;i<150;i++ )
+		CLUCENE_ASSERT(hits->id(i) == all->scoreDocs[i].doc);
+	reader->deleteDocument(all->scoreDocs[3].doc);
+	for ( size_t i=150;i<hits->length();i++ )
+		CLUCENE_ASSERT(hits->id(i) == all->scoreDocs[i].doc);
+	CLUCENE_ASSERT(hits->length() == 300);
+	_CLDELETE(hits);
+	_CLDELETE(all);
+
+	deleting.close();
+	reader->close();
+	_CLDELETE(reader);
+	searcher.close();
+}
+
 void ramSearchTest(CuTest *tc) { SearchTest(tc, true); }
 void fsSearchTest(CuTest *tc) { SearchTest(tc, false); }
 
@@ -468,6 +1011,12 @@ CuSuite *testsearch(void)
 	SUITE_ADD_TEST(suite, testNormEncoding);
 	SUITE_ADD_TEST(suite, testSrchManyHits);
 	SUITE_ADD_TEST(suite, testSrchMulti);
+	SUITE_ADD_TEST(suite, testSrchSearchAfter);
+	SUITE_ADD_TEST(suite, testSrchParallelSegments);
+	SUITE_ADD_TEST(suite, testSrchDynamicPruning);
+	SUITE_ADD_TEST(suite, testSrchChainedFilter);
+	SUITE_ADD_TEST(suite, testSrchDocIdSetFilter);
+	SUITE_ADD_TEST(suite, testSrchConstantScoreDeletions);
 	SUITE_ADD_TEST(suite, testSrchOpenIndex);
 	SUITE_ADD_TEST(suite, testSrchPunctuation);
 	SUITE_ADD_TEST(suite, testSrchSlop);
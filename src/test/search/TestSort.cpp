@@ -5,6 +5,8 @@
 * the GNU Lesser General Public License, as specified in the COPYING file.
 ------------------------------------------------------------------------------*/
 #include "test.h"
+#include "CLucene/util/ThreadPool.h"
+#include "CLucene/search/FieldCache.h"
 /**
  * Unit tests for sorting code.
  *
@@ -406,6 +408,56 @@ void testSortCombos(CuTest *tc) {
 	sortMatches (tc, sort_full, sort_queryX, _sort, _T("GICEA"));
 }
 
+// pages through the hits of query sorted by sort, and checks them against a single search
+static void sort_checkSearchAfter(CuTest* tc, Searchable* searcher, Query* query, Sort* sort, const int32_t pageSize){
+	TopFieldDocs* all = searcher->_search(query, NULL, 20, sort);
+	CLUCENE_ASSERT(all->scoreDocsLength > pageSize);
+	int32_t n = 0;
+	TopFieldDocs* page = searcher->_searchAfter(query, NULL, NULL, pageSize, sort);
+	while ( page->scoreDocsLength > 0 ){
+		assertEquals(all->totalHits, page->totalHits);
+		for ( int32_t i=0;i<page->scoreDocsLength;i++,n++ ){
+			CLUCENE_ASSERT(n < all->scoreDocsLength);
+			assertEquals(all->scoreDocs[n].doc, page->scoreDocs[i].doc);
+		}
+		TopFieldDocs* next = searcher->_searchAfter(query, NULL, page->fieldDocs[page->scoreDocsLength-1], pageSize, sort);
+		_CLDELETE(page);
+		page = next;
+	}
+	_CLDELETE(page);
+	assertEquals(all->scoreDocsLength, n);
+	_CLDELETE(all);
+}
+
+static void sort_checkSearchAfterSorts(CuTest* tc, Searchable* searcher){
+	//the int field has ties, which are broken by document number
+	const TCHAR* sorts1[3]= {_T("int"),_T("float"), NULL};
+	_sort->setSort ( sorts1 );
+	sort_checkSearchAfter(tc, searcher, sort_queryA, _sort, 3);
+
+	SortField* sorts2[3] = { _CLNEW SortField (_T("int"), SortField::INT, true), SortField::FIELD_SCORE(), NULL };
+	_sort->setSort ( sorts2 );
+	sort_checkSearchAfter(tc, searcher, sort_queryA, _sort, 2);
+
+	_sort->setSort (_CLNEW SortField (_T("string"), SortField::STRING, true));
+	sort_checkSearchAfter(tc, searcher, sort_queryA, _sort, 4);
+
+	_sort->setSort (SortField::FIELD_SCORE());
+	sort_checkSearchAfter(tc, searcher, sort_queryA, _sort, 3);
+}
+
+// test paging through sorted hits with a cursor
+void testSortSearchAfter(CuTest *tc) {
+	sort_checkSearchAfterSorts(tc, sort_full);
+
+	Searchable* searchables[3] ={ sort_searchX, sort_searchY, NULL };
+	MultiSearcher multi(searchables);
+	sort_checkSearchAfterSorts(tc, &multi);
+	ParallelMultiSearcher parallel(searchables);
+	sort_checkSearchAfterSorts(tc, &parallel);
+	//not closed: closing would close sort_searchX and sort_searchY
+}
+
 // test a custom _sort function
 /*void testCustomSorts(CuTest *tc) {
 	_sort->setSort (_CLNEW SortField (_T("custom"), SampleComparable.getComparatorSource()));
@@ -422,6 +474,19 @@ void testSortCombos(CuTest *tc) {
 	sortMatches (tc, sort_full, sort_queryY, _sort, _T("HJDBF"));
 }*/
 
+// test a variety of sorts using a parallel searcher
+void testParallelMultiSort(CuTest *tc) {
+	Searchable* searchables[3] ={ sort_searchX, sort_searchY, NULL };
+	ParallelMultiSearcher searcher(searchables);
+	sort_runMultiSorts (tc, &searcher);
+
+	//a shared pool with more threads than searchables
+	ThreadPool pool(4);
+	ParallelMultiSearcher shared(searchables, &pool);
+	sort_runMultiSorts (tc, &shared);
+	//not closed: closing would close sort_searchX and sort_searchY
+}
+
 // test a variety of sorts using more than one searcher
 void testMultiSort(CuTest *tc) {
 	Searchable* searchables[3] ={ sort_searchX, sort_searchY, NULL };
@@ -525,6 +590,241 @@ void testNormalizedScores(CuTest *tc) {
 	_CLDELETE(scoresA);
 }
 
+static void sort_addSegmentDocs(IndexWriter* writer, int32_t from, int32_t to){
+	TCHAR buf[20];
+	for ( int32_t i=from;i<to;i++ ){
+		Document doc;
+		_sntprintf(buf, 20, _T("%d"), (i * 7) % 23 - 11);
+		doc.add (*_CLNEW Field (_T("int"), buf, Field::INDEX_UNTOKENIZED));
+		_sntprintf(buf, 20, _T("%d.5"), i % 13);
+		doc.add (*_CLNEW Field (_T("float"), buf, Field::INDEX_UNTOKENIZED));
+		if ( i % 5 != 4 ){ //some documents have no string
+			_sntprintf(buf, 20, _T("s%02d"), (i * 11) % 31);
+			doc.add (*_CLNEW Field (_T("string"), buf, Field::INDEX_UNTOKENIZED));
+		}
+		writer->addDocument(&doc);
+	}
+}
+
+static void sort_checkFieldCache(CuTest* tc, IndexReader* reader){
+	TCHAR buf[20];
+	FieldCacheAuto* ints = FieldCache::DEFAULT()->getInts(reader, _T("int"));
+	FieldCacheAuto* floats = FieldCache::DEFAULT()->getFloats(reader, _T("float"));
+	FieldCacheAuto* strings = FieldCache::DEFAULT()->getStringIndex(reader, _T("string"));
+	CLUCENE_ASSERT(ints->contentLen == reader->maxDoc());
+	CLUCENE_ASSERT(strings->contentLen == reader->maxDoc());
+
+	FieldCache::StringIndex* index = strings->stringIndex;
+	for ( int32_t i=0;i<reader->maxDoc();i++ ){
+		assertEquals((i * 7) % 23 - 11, ints->intArray[i]);
+		CLUCENE_ASSERT(floats->floatArray[i] == (i % 13) + 0.5f);
+		const TCHAR* value = index->lookup[index->order[i]];
+		if ( i % 5 == 4 ){
+			CLUCENE_ASSERT(value == NULL);
+		}else{
+			_sntprintf(buf, 20, _T("s%02d"), (i * 11) % 31);
+			CLUCENE_ASSERT(value != NULL && _tcscmp(value, buf) == 0);
+		}
+	}
+	//the merged term numbers sort like the terms
+	for ( int32_t i=2;i<index->count;i++ )
+		CLUCENE_ASSERT(_tcscmp(index->lookup[i-1], index->lookup[i]) < 0);
+}
+
+void testSegmentFieldCache(CuTest *tc){
+	RAMDirectory dir;
+	WhitespaceAnalyzer analyzer;
+	IndexWriter* writer = _CLNEW IndexWriter(&dir, &analyzer, true);
+	writer->setMaxBufferedDocs(10);
+	writer->setMergeFactor(100);
+	sort_addSegmentDocs(writer, 0, 35);
+	writer->close();
+	_CLDELETE(writer);
+
+	IndexReader* reader = IndexReader::open(&dir);
+	const CL_NS(util)::ArrayBase<IndexReader*>* subReaders = reader->getSubReaders();
+	CLUCENE_ASSERT(subReaders != NULL && subReaders->length == 4);
+	sort_checkFieldCache(tc, reader);
+
+	//the values of every segment are cached for the segment reader
+	IndexReader* firstSegment = subReaders->values[0];
+	FieldCacheAuto* segmentInts = FieldCache::DEFAULT()->getInts(firstSegment, _T("int"));
+	FieldCacheAuto* segmentStrings = FieldCache::DEFAULT()->getStringIndex(firstSegment, _T("string"));
+	CLUCENE_ASSERT(segmentInts->contentLen == firstSegment->maxDoc());
+
+	writer = _CLNEW IndexWriter(&dir, &analyzer, false);
+	writer->setMaxBufferedDocs(10);
+	writer->setMergeFactor(100);
+	sort_addSegmentDocs(writer, 35, 42);
+	writer->close();
+	_CLDELETE(writer);
+
+	IndexReader* newReader = reader->reopen();
+	CLUCENE_ASSERT(newReader != reader);
+	reader->close();
+	_CLDELETE(reader);
+	subReaders = newReader->getSubReaders();
+	CLUCENE_ASSERT(subReaders != NULL && subReaders->length == 5);
+	CLUCENE_ASSERT(subReaders->values[0] == firstSegment);
+	sort_checkFieldCache(tc, newReader);
+
+	//unchanged segments were not read again
+	CLUCENE_ASSERT(FieldCache::DEFAULT()->getInts(firstSegment, _T("int")) == segmentInts);
+	CLUCENE_ASSERT(FieldCache::DEFAULT()->getStringIndex(firstSegment, _T("string")) == segmentStrings);
+
+	IndexSearcher searcher(newReader);
+	Term* t = _CLNEW Term(_T("float"), _T("3.5"));
+	TermQuery query(t);
+	_CLDECDELETE(t);
+	Sort sort(_T("string"));
+	Hits* hits = searcher.search(&query, &sort);
+	CLUCENE_ASSERT(hits->length() == 3); //docs 3, 16 and 29, which has no string
+	FieldCacheAuto* strings = FieldCache::DEFAULT()->getStringIndex(newReader, _T("string"));
+	for ( size_t i=1;i<hits->length();i++ ){
+		const TCHAR* a = strings->stringIndex->lookup[strings->stringIndex->order[hits->id(i-1)]];
+		const TCHAR* b = strings->stringIndex->lookup[strings->stringIndex->order[hits->id(i)]];
+		CLUCENE_ASSERT(a == NULL || (b != NULL && _tcscmp(a, b) <= 0));
+	}
+	_CLDELETE(hits);
+	searcher.close();
+	newReader->close();
+	_CLDELETE(newReader);
+}
+
+static int64_t sort_docValuesLong(int32_t i){
+	return (i % 3 - 1) * (LUCENE_INT64_MAX_SHOULDBE / 3) + i; //needs all 64 bits
+}
+
+static void sort_addDocValuesDocs(IndexWriter* writer, int32_t from, int32_t to){
+	TCHAR buf[30];
+	const int32_t docValuesOnly = Field::STORE_NO | Field::INDEX_NO;
+	for ( int32_t i=from;i<to;i++ ){
+		Document doc;
+		_sntprintf(buf, 30, _T("%d"), i);
+		doc.add (*_CLNEW Field (_T("id"), buf, Field::STORE_YES | Field::INDEX_UNTOKENIZED));
+		doc.add (*_CLNEW Field (_T("all"), _T("x"), Field::STORE_NO | Field::INDEX_UNTOKENIZED));
+		_sntprintf(buf, 30, _T("%d"), (i * 7) % 23 - 11);
+		doc.add (*_CLNEW Field (_T("dvint"), buf, docValuesOnly | Field::DOCVALUES_NUMERIC));
+		_i64tot(sort_docValuesLong(i), buf, 10);
+		doc.add (*_CLNEW Field (_T("dvlong"), buf, docValuesOnly | Field::DOCVALUES_NUMERIC));
+		if ( i % 5 == 3 ) //replaced by the value added after it
+			doc.add (*_CLNEW Field (_T("dvstring"), _T("zz"), docValuesOnly | Field::DOCVALUES_SORTED));
+		if ( i % 5 != 4 ){ //some documents have no string
+			_sntprintf(buf, 30, _T("s%02d"), (i * 11) % 31);
+			doc.add (*_CLNEW Field (_T("dvstring"), buf, docValuesOnly | Field::DOCVALUES_SORTED));
+		}
+		writer->addDocument(&doc);
+	}
+}
+
+//checks the doc values of a segment against the ids of its documents
+static void sort_checkDocValues(CuTest* tc, IndexReader* segment){
+	TCHAR buf[30];
+	NumericDocValues* ints = segment->getNumericDocValues(_T("dvint"));
+	NumericDocValues* longs = segment->getNumericDocValues(_T("dvlong"));
+	SortedDocValues* strings = segment->getSortedDocValues(_T("dvstring"));
+	CLUCENE_ASSERT(ints != NULL && longs != NULL && strings != NULL);
+	CLUCENE_ASSERT(segment->getSortedDocValues(_T("dvint")) == NULL);
+	CLUCENE_ASSERT(segment->getNumericDocValues(_T("id")) == NULL);
+
+	for ( int32_t i=0;i<segment->maxDoc();i++ ){
+		if ( segment->isDeleted(i) )
+			continue;
+		Document doc;
+		segment->document(i, doc);
+		const int32_t id = _ttoi(doc.get(_T("id")));
+		assertEquals((id * 7) % 23 - 11, (int32_t)ints->get(i));
+		CLUCENE_ASSERT(longs->get(i) == sort_docValuesLong(id));
+		if ( id % 5 == 4 ){
+			CLUCENE_ASSERT(strings->getOrd(i) == -1 && strings->get(i) == NULL);
+		}else{
+			_sntprintf(buf, 30, _T("s%02d"), (id * 11) % 31);
+			CuAssertStrEquals(tc, _T("sorted doc value"), buf, strings->get(i));
+		}
+	}
+	for ( int32_t i=1;i<strings->getValueCount();i++ )
+		CLUCENE_ASSERT(_tcscmp(strings->lookupOrd(i-1), strings->lookupOrd(i)) < 0);
+}
+
+//sorts on fields which only have doc values, so that there are no terms to un-invert
+static void sort_checkDocValuesSort(CuTest* tc, IndexReader* reader, int32_t numDocs){
+	IndexSearcher searcher(reader);
+	Term* t = _CLNEW Term(_T("all"), _T("x"));
+	TermQuery query(t);
+	_CLDECDELETE(t);
+
+	Sort intSort(_CLNEW SortField(_T("dvint"), SortField::INT, false));
+	Hits* hits = searcher.search(&query, &intSort);
+	assertEquals(numDocs, hits->length());
+	int32_t last = -100;
+	for ( size_t i=0;i<hits->length();i++ ){
+		const int32_t id = _ttoi(hits->doc(i).get(_T("id")));
+		const int32_t value = (id * 7) % 23 - 11;
+		CLUCENE_ASSERT(last <= value);
+		last = value;
+	}
+	_CLDELETE(hits);
+
+	Sort stringSort(_CLNEW SortField(_T("dvstring"), SortField::STRING, true));
+	hits = searcher.search(&query, &stringSort);
+	assertEquals(numDocs, hits->length());
+	TCHAR lastString[10] = _T("~");
+	for ( size_t i=0;i<hits->length();i++ ){
+		const int32_t id = _ttoi(hits->doc(i).get(_T("id")));
+		TCHAR value[10] = _T("");
+		if ( id % 5 != 4 )
+			_sntprintf(value, 10, _T("s%02d"), (id * 11) % 31);
+		CLUCENE_ASSERT(_tcscmp(lastString, value) >= 0); //documents without a value sort last in reverse
+		_tcscpy(lastString, value);
+	}
+	_CLDELETE(hits);
+
+	//the type of doc values is known without looking at terms
+	Sort autoSort(_T("dvint"));
+	hits = searcher.search(&query, &autoSort);
+	assertEquals(numDocs, hits->length());
+	_CLDELETE(hits);
+	searcher.close();
+}
+
+void testDocValuesSort(CuTest *tc){
+	RAMDirectory dir;
+	WhitespaceAnalyzer analyzer;
+	IndexWriter* writer = _CLNEW IndexWriter(&dir, &analyzer, true);
+	writer->setMaxBufferedDocs(10);
+	writer->setMergeFactor(100);
+	sort_addDocValuesDocs(writer, 0, 35);
+	writer->close();
+	_CLDELETE(writer);
+
+	IndexReader* reader = IndexReader::open(&dir);
+	const CL_NS(util)::ArrayBase<IndexReader*>* subReaders = reader->getSubReaders();
+	CLUCENE_ASSERT(subReaders != NULL && subReaders->length == 4);
+	//the values are held by the segments
+	CLUCENE_ASSERT(reader->getNumericDocValues(_T("dvint")) == NULL);
+	for ( size_t i=0;i<subReaders->length;i++ )
+		sort_checkDocValues(tc, subReaders->values[i]);
+	sort_checkDocValuesSort(tc, reader, 35);
+	reader->close();
+	_CLDELETE(reader);
+
+	//the merged segment has the values of the documents which are left
+	writer = _CLNEW IndexWriter(&dir, &analyzer, false);
+	Term* t = _CLNEW Term(_T("id"), _T("3"));
+	writer->deleteDocuments(t);
+	_CLDECDELETE(t);
+	writer->optimize();
+	writer->close();
+	_CLDELETE(writer);
+
+	reader = IndexReader::open(&dir);
+	CLUCENE_ASSERT(reader->maxDoc() == 34);
+	sort_checkDocValues(tc, reader);
+	sort_checkDocValuesSort(tc, reader, 34);
+	reader->close();
+	_CLDELETE(reader);
+}
+
 CuSuite *testsort(void)
 {
 	CuSuite *suite = CuSuiteNew(_T("CLucene Sort Test"));
@@ -536,10 +836,14 @@ CuSuite *testsort(void)
     SUITE_ADD_TEST(suite, testAutoSort);
 	SUITE_ADD_TEST(suite, testEmptyFieldSort);
 	SUITE_ADD_TEST(suite, testSortCombos);
+	SUITE_ADD_TEST(suite, testSortSearchAfter);
 	//SUITE_ADD_TEST(suite, testCustomSorts);
+	SUITE_ADD_TEST(suite, testParallelMultiSort);
 	SUITE_ADD_TEST(suite, testMultiSort);
 	SUITE_ADD_TEST(suite, testNormalizedScores);
 	SUITE_ADD_TEST(suite, testReverseSort);
+	SUITE_ADD_TEST(suite, testSegmentFieldCache);
+	SUITE_ADD_TEST(suite, testDocValuesSort);
 
     SUITE_ADD_TEST(suite, testSortCleanup);
     return suite;
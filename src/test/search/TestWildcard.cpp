@@ -5,6 +5,7 @@
 * the GNU Lesser General Public License, as specified in the COPYING file.
 ------------------------------------------------------------------------------*/
 #include "test.h"
+#include "CLucene/search/WildcardTermEnum.h"
 
 #ifndef NO_WILDCARD_QUERY
 
@@ -109,6 +110,78 @@ void _testWildcard(CuTest* tc, IndexSearcher* searcher, const TCHAR* qt, int exp
 		_CLDELETE(reader);
 		_CLDELETE(searcher);
 	}
+
+	/** Compares the terms of WildcardTermEnum with those of a scan of all terms,
+	* on enough terms that the enumeration seeks across segments */
+	void testWildcardTermEnum(CuTest *tc){
+		RAMDirectory indexStore;
+		WhitespaceAnalyzer an;
+		const TCHAR* alphabet = _T("abcd");
+		uint32_t seed = 1;
+		TCHAR word[8];
+		for ( int32_t seg=0;seg<3;seg++ ){
+			IndexWriter writer(&indexStore, &an, seg==0);
+			for ( int32_t i=0;i<40;i++ ){
+				StringBuffer text;
+				for ( int32_t j=0;j<25;j++ ){
+					seed = seed * 1103515245 + 12345;
+					int32_t len = 1 + (seed >> 16) % 6;
+					for ( int32_t k=0;k<len;k++ ){
+						seed = seed * 1103515245 + 12345;
+						word[k] = alphabet[(seed >> 16) % 4];
+					}
+					word[len] = 0;
+					text.append(word);
+					text.appendChar(' ');
+				}
+				Document doc;
+				doc.add(*_CLNEW Field(_T("body"), text.getBuffer(), Field::STORE_NO | Field::INDEX_TOKENIZED));
+				writer.addDocument(&doc);
+			}
+			writer.close();
+		}
+
+		IndexReader* reader = IndexReader::open(&indexStore);
+		const TCHAR* patterns[] = { _T("a*"), _T("*b"), _T("a?c*"), _T("*cd*"), _T("b*a?d"),
+			_T("??"), _T("c*d*a"), _T("d?*?b"), _T("dddd*"), _T("*"), _T("????c?"), NULL };
+		for ( int32_t p=0;patterns[p]!=NULL;p++ ){
+			const TCHAR* pattern = patterns[p];
+			int32_t patternLen = _tcslen(pattern);
+			Term* term = _CLNEW Term(_T("body"), pattern);
+
+			//all terms which match the pattern, in order
+			std::vector<std::tstring> expected;
+			TermEnum* all = reader->terms();
+			while ( all->next() ){
+				Term* t = all->term(false);
+				if ( _tcscmp(t->field(), _T("body")) == 0 &&
+						WildcardTermEnum::wildcardEquals(pattern, patternLen, 0, t->text(), t->textLength(), 0) )
+					expected.push_back(t->text());
+			}
+			all->close();
+			_CLDELETE(all);
+			CLUCENE_ASSERT(expected.size() > 0);
+
+			WildcardTermEnum terms(reader, term);
+			size_t count = 0;
+			do {
+				Term* t = terms.term(false);
+				if ( t == NULL )
+					break;
+				CLUCENE_ASSERT(count < expected.size());
+				assertEquals(0, _tcscmp(expected[count].c_str(), t->text()));
+				count++;
+			} while ( terms.next() );
+			CLUCENE_ASSERT(count == expected.size());
+			terms.close();
+
+			_CLDECDELETE(term);
+		}
+
+		reader->close();
+		_CLDELETE(reader);
+		indexStore.close();
+	}
 #else
 	void _NO_WILDCARD_QUERY(CuTest *tc){
 		CuNotImpl(tc,_T("Wildcard"));
@@ -123,6 +196,7 @@ CuSuite *testwildcard(void)
 	#ifndef NO_WILDCARD_QUERY
 		SUITE_ADD_TEST(suite, testQuestionmark);
 		SUITE_ADD_TEST(suite, testAsterisk);
+		SUITE_ADD_TEST(suite, testWildcardTermEnum);
 	#else
 		SUITE_ADD_TEST(suite, _NO_WILDCARD_QUERY);
     #endif
@@ -7,10 +7,11 @@
 #include "test.h"
 #include "CLucene/store/Directory.h"
 #include "CLucene/store/IndexInput.h"
+#include "CLucene/store/MMapDirectory.h"
 #include <stdlib.h>
 
 
-void StoreTest(CuTest *tc,int32_t count, bool ram){
+void StoreTest(CuTest *tc,int32_t count, bool ram, bool positional=false){
 	srand(1251971);
 	int32_t i;
 
@@ -43,6 +44,7 @@ void StoreTest(CuTest *tc,int32_t count, bool ram){
 		store->close();
 		_CLDECDELETE(store);
 		store = (Directory*)FSDirectory::getDirectory(fsdir);
+		((FSDirectory*)store)->setUsePositionalRead(positional);
   }else{
     CuMessageA(tc, "Memory used at end: %l", ((RAMDirectory*)store)->sizeInBytes);
   }
@@ -100,6 +102,244 @@ void ramtest(CuTest *tc){
 void fstest(CuTest *tc){
 	StoreTest(tc,100,false);
 }
+void fspositionaltest(CuTest *tc){
+	StoreTest(tc,100,false,true);
+}
+
+//clones of a positional input must each keep their own file position
+void fspositionalclonetest(CuTest *tc){
+	char fsdir[CL_MAX_PATH];
+	_snprintf(fsdir, CL_MAX_PATH, "%s/%s",cl_tempDir, "test.store");
+	FSDirectory* store = FSDirectory::getDirectory(fsdir);
+	store->setUsePositionalRead(true);
+
+	const int32_t length = 10000;
+	IndexOutput* out = store->createOutput("clone.dat");
+	for (int32_t i = 0; i < length; i++)
+		out->writeInt(i);
+	out->close();
+	_CLDELETE(out);
+
+	IndexInput* in = ((Directory*)store)->openInput("clone.dat");
+	IndexInput* clone1 = in->clone();
+	IndexInput* clone2 = in->clone();
+	clone1->seek(4 * 5000);
+	clone2->seek(4 * 9000);
+	for (int32_t i = 0; i < 1000; i++){
+		CLUCENE_ASSERT( in->readInt() == i );
+		CLUCENE_ASSERT( clone2->readInt() == 9000 + i );
+		CLUCENE_ASSERT( clone1->readInt() == 5000 + i );
+	}
+	clone1->close();
+	_CLDELETE(clone1);
+	clone2->close();
+	_CLDELETE(clone2);
+	in->close();
+	_CLDELETE(in);
+
+	store->deleteFile("clone.dat");
+	store->close();
+	_CLDECDELETE(store);
+}
+
+//reads across the boundaries of small mapped chunks
+void mmapchunktest(CuTest *tc){
+	char fsdir[CL_MAX_PATH];
+	_snprintf(fsdir, CL_MAX_PATH, "%s/%s",cl_tempDir, "test.mmapstore");
+	MMapDirectory* store = MMapDirectory::getDirectory(fsdir);
+	store->setMaxChunkSize(100000); //rounded down to 64KB
+	CLUCENE_ASSERT( store->getMaxChunkSize() == 65536 );
+	CLUCENE_ASSERT( store->getAdvice("frq") == MMapDirectory::ADVICE_RANDOM );
+	CLUCENE_ASSERT( store->getAdvice("xyz") == MMapDirectory::ADVICE_NORMAL );
+
+	const int32_t length = 100000; //400000 bytes, 7 chunks
+	IndexOutput* out = store->createOutput("chunks.dat");
+	for (int32_t i = 0; i < length; i++)
+		out->writeInt(i);
+	for (int32_t i = 0; i < 1000; i++)
+		out->writeVInt(i * 1000);
+	out->close();
+	_CLDELETE(out);
+
+	IndexInput* in = ((Directory*)store)->openInput("chunks.dat");
+	CLUCENE_ASSERT( in->length() > length * 4 );
+	for (int32_t i = 0; i < length; i++)
+		CLUCENE_ASSERT( in->readInt() == i );
+	for (int32_t i = 0; i < 1000; i++)
+		CLUCENE_ASSERT( in->readVInt() == i * 1000 );
+	CLUCENE_ASSERT( in->getFilePointer() == in->length() );
+
+	//ints that straddle a chunk boundary
+	for (int32_t chunk = 1; chunk * 65536 < length * 4; chunk++){
+		int64_t pos = (int64_t)chunk * 65536 - 2;
+		in->seek(pos);
+		CLUCENE_ASSERT( in->getFilePointer() == pos );
+		uint8_t b[6];
+		in->readBytes(b, 6);
+		int32_t v = (int32_t)(pos / 4);
+		CLUCENE_ASSERT( b[0] == (uint8_t)(v >> 8) && b[1] == (uint8_t)v );
+		CLUCENE_ASSERT( ((b[2] << 24) | (b[3] << 16) | (b[4] << 8) | b[5]) == v + 1 );
+		in->seek(pos);
+		in->readBytes(b, 2);
+		CLUCENE_ASSERT( in->readInt() == v + 1 );
+	}
+
+	//a read spanning several chunks
+	uint8_t* all = _CL_NEWARRAY(uint8_t, length * 4);
+	in->seek(0);
+	in->readBytes(all, length * 4);
+	CLUCENE_ASSERT( all[4*70000+3] == (uint8_t)70000 );
+	_CLDELETE_ARRAY(all);
+
+	//clones are positioned independently
+	in->seek(4 * 20000);
+	IndexInput* clone = in->clone();
+	clone->seek(4 * 90000);
+	CLUCENE_ASSERT( in->readInt() == 20000 );
+	CLUCENE_ASSERT( clone->readInt() == 90000 );
+	clone->close();
+	_CLDELETE(clone);
+
+	in->seek(in->length());
+	try{
+		in->readByte();
+		CuFail(tc, _T("read past EOF did not throw"));
+	}catch(CLuceneError& err){
+		if ( err.number() != CL_ERR_IO )
+			throw;
+	}
+	in->close();
+	_CLDELETE(in);
+
+	store->deleteFile("chunks.dat");
+	store->close();
+	_CLDECDELETE(store);
+}
+
+//index and search through an MMapDirectory
+void mmapindextest(CuTest *tc){
+	char fsdir[CL_MAX_PATH];
+	_snprintf(fsdir, CL_MAX_PATH, "%s/%s",cl_tempDir, "test.mmapindex");
+	MMapDirectory* store = MMapDirectory::getDirectory(fsdir);
+
+	//the directory is cached as an MMapDirectory now
+	try{
+		FSDirectory* other = FSDirectory::getDirectory(fsdir);
+		other->close();
+		_CLDECDELETE(other);
+		CuFail(tc, _T("opening an MMapDirectory as FSDirectory did not throw"));
+	}catch(CLuceneError& err){
+		if ( err.number() != CL_ERR_IO )
+			throw;
+	}
+
+	WhitespaceAnalyzer an;
+	IndexWriter* writer = _CLNEW IndexWriter(store, &an, true);
+	Document doc;
+	for (int32_t i = 0; i < 200; i++) {
+		doc.clear();
+		doc.add(*_CLNEW Field(_T("content"), (i % 2 == 0) ? _T("even number") : _T("odd number"), Field::STORE_YES | Field::INDEX_TOKENIZED));
+		writer->addDocument(&doc);
+	}
+	writer->optimize();
+	writer->close();
+	_CLDELETE(writer);
+
+	IndexSearcher searcher(store);
+	Term* term = _CLNEW Term(_T("content"), _T("even"));
+	TermQuery query(term);
+	_CLDECDELETE(term);
+	Hits* hits = searcher.search(&query);
+	CLUCENE_ASSERT( hits->length() == 100 );
+	_CLDELETE(hits);
+	searcher.close();
+
+	store->close();
+	_CLDECDELETE(store);
+}
+
+static uint8_t _mmapExpectedNorm(int32_t i){
+	return Similarity::encodeNorm(Similarity::getDefault()->lengthNorm(_T("content"), (i % 9) + 1));
+}
+
+//norms are used in place from the mapped files, and copied before a change
+void mmapnormstest(CuTest *tc){
+	char fsdir[CL_MAX_PATH];
+	_snprintf(fsdir, CL_MAX_PATH, "%s/%s",cl_tempDir, "test.mmapnorms");
+	MMapDirectory* store = MMapDirectory::getDirectory(fsdir);
+	store->setMaxChunkSize(65536);
+
+	//mapped bytes stay valid after the input they came from is closed
+	IndexOutput* out = store->createOutput("map.dat");
+	for (int32_t i = 0; i < 70000; i++)
+		out->writeByte((uint8_t)i);
+	out->close();
+	_CLDELETE(out);
+	IndexInput* in = ((Directory*)store)->openInput("map.dat");
+	const uint8_t* bytes = NULL;
+	const uint8_t* other = NULL;
+	IndexInput* mapped = in->mapBytes(10, 500, bytes);
+	CLUCENE_ASSERT( mapped != NULL );
+	CLUCENE_ASSERT( in->mapBytes(65530, 10, other) == NULL ); //crosses a chunk
+	CLUCENE_ASSERT( in->mapBytes(69990, 20, other) == NULL ); //past the end
+	in->close();
+	_CLDELETE(in);
+	for (int32_t i = 0; i < 500; i++)
+		CLUCENE_ASSERT( bytes[i] == (uint8_t)(i + 10) );
+	mapped->close();
+	_CLDELETE(mapped);
+	store->deleteFile("map.dat");
+
+	//a compound and a plain segment
+	WhitespaceAnalyzer an;
+	Document doc;
+	for (int32_t s = 0; s < 2; s++) {
+		IndexWriter* writer = _CLNEW IndexWriter(store, &an, s == 0);
+		writer->setUseCompoundFile(s == 0);
+		for (int32_t i = 0; i < 50; i++) {
+			doc.clear();
+			StringBuffer text;
+			for (int32_t j = 0; j <= i % 9; j++)
+				text.append(_T("w "));
+			doc.add(*_CLNEW Field(_T("content"), text.getBuffer(), Field::STORE_NO | Field::INDEX_TOKENIZED));
+			writer->addDocument(&doc);
+		}
+		writer->close();
+		_CLDELETE(writer);
+	}
+
+	IndexReader* reader = IndexReader::open(store);
+	const CL_NS(util)::ArrayBase<IndexReader*>* subReaders = reader->getSubReaders();
+	CLUCENE_ASSERT( subReaders != NULL && subReaders->length == 2 );
+	uint8_t* before[2];
+	for (int32_t s = 0; s < 2; s++) {
+		before[s] = subReaders->values[s]->norms(_T("content"));
+		for (int32_t i = 0; i < 50; i++)
+			CLUCENE_ASSERT( before[s][i] == _mmapExpectedNorm(i) );
+	}
+
+	//the changed norms are a copy, the mapped ones are still valid
+	reader->setNorm(5, _T("content"), (uint8_t)7);
+	reader->setNorm(60, _T("content"), (uint8_t)7);
+	for (int32_t s = 0; s < 2; s++) {
+		uint8_t* after = subReaders->values[s]->norms(_T("content"));
+		CLUCENE_ASSERT( after != before[s] );
+		CLUCENE_ASSERT( after[s == 0 ? 5 : 10] == 7 );
+		CLUCENE_ASSERT( before[s][s == 0 ? 5 : 10] == _mmapExpectedNorm(s == 0 ? 5 : 10) );
+	}
+	reader->close();
+	_CLDELETE(reader);
+
+	reader = IndexReader::open(store);
+	uint8_t* norms = reader->norms(_T("content"));
+	for (int32_t i = 0; i < 100; i++)
+		CLUCENE_ASSERT( norms[i] == (i == 5 || i == 60 ? 7 : _mmapExpectedNorm(i % 50)) );
+	reader->close();
+	_CLDELETE(reader);
+
+	store->close();
+	_CLDECDELETE(store);
+}
 
 CuSuite *teststore(void)
 {
@@ -107,6 +347,11 @@ CuSuite *teststore(void)
 
     SUITE_ADD_TEST(suite, ramtest);
     SUITE_ADD_TEST(suite, fstest);
+    SUITE_ADD_TEST(suite, fspositionaltest);
+    SUITE_ADD_TEST(suite, fspositionalclonetest);
+    SUITE_ADD_TEST(suite, mmapchunktest);
+    SUITE_ADD_TEST(suite, mmapindextest);
+    SUITE_ADD_TEST(suite, mmapnormstest);
 
     return suite;
 }
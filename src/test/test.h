@@ -61,6 +61,7 @@ CuSuite *testtermvector(void);
 CuSuite *testsort(void);
 CuSuite *testduplicates(void);
 CuSuite *testRangeFilter(void);
+CuSuite *testNumericRangeQuery(void);
 CuSuite *testdatefilter(void);
 CuSuite *testwildcard(void);
 CuSuite *testdebug(void);
@@ -29,6 +29,7 @@ unittest tests[] = {
     {"boolean", testBoolean},
     {"search", testsearch},
     {"rangefilter", testRangeFilter},
+    {"numericrange", testNumericRangeQuery},
     {"queries", testqueries},
     {"csrqueries", testConstantScoreQueries},
     {"termvector",testtermvector},
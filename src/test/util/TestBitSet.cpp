@@ -2,6 +2,7 @@
 #include "CLucene/store/Directory.h"
 #include "CLucene/store/IndexInput.h"
 #include "CLucene/util/BitSet.h"
+#include "CLucene/util/SortedVIntList.h"
 
 CL_NS_USE(util)
 CL_NS_USE(store)
@@ -245,6 +246,186 @@ void testNextSetBit(CuTest* tc)
     doTestNextSetBit(tc, 8);
     doTestNextSetBit(tc, 20);
     doTestNextSetBit(tc, 100);
+    doTestNextSetBit(tc, 1000);
+
+    // set bits far apart, so that whole words are skipped
+    BitSet bv( 1000 );
+    bv.set(3);
+    bv.set(64);
+    bv.set(700);
+    bv.set(999);
+    assertEquals( 3, bv.nextSetBit(0) );
+    assertEquals( 64, bv.nextSetBit(4) );
+    assertEquals( 700, bv.nextSetBit(65) );
+    assertEquals( 999, bv.nextSetBit(701) );
+    assertEquals( -1, bv.nextSetBit(1000) );
+}
+
+void doTestAnySet(CuTest* tc, int nSize)
+{
+    BitSet bv( nSize );
+    // a few isolated bits, so that most ranges are empty
+    for( int32_t i = 5; i < bv.size(); i+=37 )
+        bv.set(i);
+
+    for( int32_t from = 0; from < bv.size(); from++ ){
+        for( int32_t to = from; to < bv.size(); to+=3 ){
+            bool expected = false;
+            for( int32_t i = from; i <= to && !expected; i++ )
+                expected = bv.get(i);
+            CLUCENE_ASSERT( bv.anySet(from, to) == expected );
+        }
+    }
+}
+
+/**
+ * Test the anySet() method on BitVectors of various sizes.
+ * CLucene specific
+ */
+void testAnySet(CuTest* tc)
+{
+    doTestAnySet(tc, 8);
+    doTestAnySet(tc, 20);
+    doTestAnySet(tc, 100);
+}
+
+//fills a bitset with a pseudo random pattern
+void fillBitSet(BitSet& bv, int32_t seed, int32_t density){
+    for( int32_t i = 0; i < bv.size(); i++ ){
+        seed = seed * 1103515245 + 12345;
+        if ( ((seed >> 16) & 0x7FFF) % density == 0 )
+            bv.set(i);
+    }
+}
+
+void doTestSetOperations(CuTest* tc, int32_t nSize, int32_t otherSize)
+{
+    BitSet a( nSize );
+    BitSet b( otherSize );
+    fillBitSet(a, nSize, 3);
+    fillBitSet(b, otherSize+1, 2);
+
+    BitSet* r = a.clone();
+    r->andBits(&b);
+    for( int32_t i = 0; i < nSize; i++ )
+        CLUCENE_ASSERT( r->get(i) == (a.get(i) && i < otherSize && b.get(i)) );
+    _CLLDELETE(r);
+
+    r = a.clone();
+    r->orBits(&b);
+    int32_t expectedCount = 0;
+    for( int32_t i = 0; i < nSize; i++ ){
+        bool expected = a.get(i) || (i < otherSize && b.get(i));
+        CLUCENE_ASSERT( r->get(i) == expected );
+        if ( expected )
+            expectedCount++;
+    }
+    // the bits of b beyond the size of r must not be counted
+    assertEquals( expectedCount, r->count() );
+    _CLLDELETE(r);
+
+    r = a.clone();
+    r->andNotBits(&b);
+    for( int32_t i = 0; i < nSize; i++ )
+        CLUCENE_ASSERT( r->get(i) == (a.get(i) && !(i < otherSize && b.get(i))) );
+    _CLLDELETE(r);
+
+    r = a.clone();
+    r->xorBits(&b);
+    expectedCount = 0;
+    for( int32_t i = 0; i < nSize; i++ ){
+        bool expected = a.get(i) != (i < otherSize && b.get(i));
+        CLUCENE_ASSERT( r->get(i) == expected );
+        if ( expected )
+            expectedCount++;
+    }
+    assertEquals( expectedCount, r->count() );
+
+    r->flip();
+    assertEquals( nSize - expectedCount, r->count() );
+    CLUCENE_ASSERT( r->nextSetBit(nSize-1) == (r->get(nSize-1) ? nSize-1 : -1) );
+    r->clear();
+    assertEquals( 0, r->count() );
+    assertEquals( -1, r->nextSetBit(0) );
+    _CLLDELETE(r);
+}
+
+/**
+ * Test the word-wise set operations, also on sets of other sizes.
+ * CLucene specific
+ */
+void testSetOperations(CuTest* tc)
+{
+    doTestSetOperations(tc, 8, 8);
+    doTestSetOperations(tc, 100, 100);
+    doTestSetOperations(tc, 1000, 1000);
+    doTestSetOperations(tc, 1000, 130);
+    doTestSetOperations(tc, 130, 1000);
+}
+
+void doTestDocIdSetIterator(CuTest* tc, const BitSet& bv, CL_NS(search)::DocIdSet* set)
+{
+    // next() visits the set bits in order
+    CL_NS(search)::DocIdSetIterator* it = set->iterator();
+    for( int32_t i = bv.nextSetBit(0); i >= 0; i = bv.nextSetBit(i+1) ){
+        CLUCENE_ASSERT( it->next() );
+        assertEquals( i, it->doc() );
+    }
+    CLUCENE_ASSERT( !it->next() );
+    _CLLDELETE(it);
+
+    // skipTo() goes to the first bit at or after the target
+    it = set->iterator();
+    for( int32_t target = 0; target < bv.size(); target += 29 ){
+        int32_t expected = bv.nextSetBit(target);
+        if ( expected == -1 ){
+            CLUCENE_ASSERT( !it->skipTo(target) );
+            break;
+        }
+        CLUCENE_ASSERT( it->skipTo(target) );
+        assertEquals( expected, it->doc() );
+        target = it->doc();
+    }
+    _CLLDELETE(it);
+}
+
+/**
+ * Test iterating a BitSet and a SortedVIntList as DocIdSets.
+ * CLucene specific
+ */
+void testDocIdSets(CuTest* tc)
+{
+    BitSet bv( 100000 );
+    fillBitSet(bv, 7, 100);
+    doTestDocIdSetIterator(tc, bv, &bv);
+
+    SortedVIntList list(&bv);
+    assertEquals( bv.count(), list.size() );
+    // a sparse set takes a small part of the 12500 bytes of the bitset
+    CLUCENE_ASSERT( list.getByteSize() < bv.count() * 2 );
+    doTestDocIdSetIterator(tc, bv, &list);
+
+    // lists built from an array and from an iterator are the same
+    int32_t* docs = _CL_NEWARRAY(int32_t, bv.count());
+    int32_t n = 0;
+    for( int32_t i = bv.nextSetBit(0); i >= 0; i = bv.nextSetBit(i+1) )
+        docs[n++] = i;
+    SortedVIntList fromArray(docs, n);
+    CL_NS(search)::DocIdSetIterator* it = bv.iterator();
+    SortedVIntList fromIterator(it);
+    _CLLDELETE(it);
+    _CLDELETE_LARRAY(docs);
+    doTestDocIdSetIterator(tc, bv, &fromArray);
+    doTestDocIdSetIterator(tc, bv, &fromIterator);
+
+    // the input must be sorted
+    int32_t unsorted[] = { 1, 5, 3 };
+    try{
+        SortedVIntList bad(unsorted, 3);
+        CuFail(tc, _T("unsorted input was accepted"));
+    }catch(CLuceneError& err){
+        assertEquals( CL_ERR_IllegalArgument, err.number() );
+    }
 }
 
 CuSuite *testBitSet(void)
@@ -260,6 +441,9 @@ CuSuite *testBitSet(void)
     SUITE_ADD_TEST(suite, testBitAtEndOfBitSet);
 
     SUITE_ADD_TEST(suite, testNextSetBit);
+    SUITE_ADD_TEST(suite, testAnySet);
+    SUITE_ADD_TEST(suite, testSetOperations);
+    SUITE_ADD_TEST(suite, testDocIdSets);
 
     return suite; 
 }